@@ -0,0 +1,178 @@
+/******************************************************************************
+ * File: protocol.c
+ * Module: Protocol (HMI <-> Control UART5 link)
+ * Description: Frame encoder, CRC-16 and incremental frame parser
+ ******************************************************************************/
+
+#include "protocol.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define OFFSET_LEN      1U
+#define OFFSET_SEQ      2U
+#define OFFSET_TYPE     3U
+
+/* Proto_Check results */
+#define PARSE_MORE      0U      /* Frame incomplete so far */
+#define PARSE_FRAME     1U      /* Valid frame at the start of the buffer */
+#define PARSE_ERROR     2U      /* Buffer does not start a valid frame */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint8_t Proto_FrameSize(uint8_t length)
+{
+    return (uint8_t)(PROTO_HEADER_SIZE + length + PROTO_CRC_SIZE);
+}
+
+/*
+ * Proto_Check
+ * Classifies the bytes held by the parser.
+ */
+static uint8_t Proto_Check(const Proto_Parser *parser)
+{
+    const uint8_t *buffer = parser->buffer;
+    uint8_t size;
+    uint16_t crc;
+
+    if (buffer[0] != PROTO_SOF) {
+        return PARSE_ERROR;
+    }
+    if (parser->count <= OFFSET_LEN) {
+        return PARSE_MORE;
+    }
+    if (buffer[OFFSET_LEN] > PROTO_MAX_PAYLOAD) {
+        return PARSE_ERROR;
+    }
+
+    size = Proto_FrameSize(buffer[OFFSET_LEN]);
+    if (parser->count < size) {
+        return PARSE_MORE;
+    }
+
+    crc = Proto_Crc16(PROTO_CRC_INIT, &buffer[OFFSET_LEN], (uint16_t)(size - 1U - PROTO_CRC_SIZE));
+    if (buffer[size - 2U] != (uint8_t)(crc >> 8) || buffer[size - 1U] != (uint8_t)crc) {
+        return PARSE_ERROR;
+    }
+    return PARSE_FRAME;
+}
+
+/*
+ * Proto_Discard
+ * Drops the first n held bytes, then skips ahead to the next SOF.
+ */
+static void Proto_Discard(Proto_Parser *parser, uint8_t n)
+{
+    while (n < parser->count && parser->buffer[n] != PROTO_SOF) {
+        n++;
+    }
+    parser->count = (uint8_t)(parser->count - n);
+    memmove(parser->buffer, &parser->buffer[n], parser->count);
+}
+
+/******************************************************************************
+ *                          Function Implementations                           *
+ ******************************************************************************/
+
+/*
+ * Proto_Crc16
+ * Byte-wise CRC-16/CCITT without a lookup table.
+ */
+uint16_t Proto_Crc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    while (length-- > 0U) {
+        crc = (uint16_t)((crc >> 8) | (crc << 8));
+        crc ^= *data++;
+        crc ^= (uint16_t)((crc & 0xFFU) >> 4);
+        crc ^= (uint16_t)(crc << 12);
+        crc ^= (uint16_t)((crc & 0xFFU) << 5);
+    }
+    return crc;
+}
+
+/*
+ * Proto_Encode
+ * Writes header, payload and CRC into buffer.
+ */
+uint8_t Proto_Encode(uint8_t *buffer, uint8_t seq, uint8_t type,
+                     const uint8_t *payload, uint8_t length)
+{
+    uint8_t size = Proto_FrameSize(length);
+    uint16_t crc;
+
+    if (length > PROTO_MAX_PAYLOAD) {
+        return 0U;
+    }
+
+    buffer[0] = PROTO_SOF;
+    buffer[OFFSET_LEN] = length;
+    buffer[OFFSET_SEQ] = seq;
+    buffer[OFFSET_TYPE] = type;
+    if (length > 0U) {
+        memcpy(&buffer[PROTO_HEADER_SIZE], payload, length);
+    }
+
+    crc = Proto_Crc16(PROTO_CRC_INIT, &buffer[OFFSET_LEN], (uint16_t)(size - 1U - PROTO_CRC_SIZE));
+    buffer[size - 2U] = (uint8_t)(crc >> 8);
+    buffer[size - 1U] = (uint8_t)crc;
+    return size;
+}
+
+/*
+ * Proto_ParserInit
+ * Clears held bytes and the error count.
+ */
+void Proto_ParserInit(Proto_Parser *parser)
+{
+    parser->count = 0U;
+    parser->errors = 0U;
+}
+
+/*
+ * Proto_Parse
+ * Appends the byte and re-checks the held bytes.
+ */
+bool Proto_Parse(Proto_Parser *parser, uint8_t byte)
+{
+    if (parser->count == 0U && byte != PROTO_SOF) {
+        return false;
+    }
+    parser->buffer[parser->count++] = byte;
+    return Proto_ParsePending(parser);
+}
+
+/*
+ * Proto_ParsePending
+ * Checks the held bytes. On an error the first held byte is dropped and
+ * the rest are rescanned from the next SOF, so a frame that starts inside
+ * a damaged one is still found.
+ */
+bool Proto_ParsePending(Proto_Parser *parser)
+{
+    while (parser->count > 0U) {
+        uint8_t result = Proto_Check(parser);
+
+        if (result == PARSE_MORE) {
+            return false;
+        }
+        if (result == PARSE_FRAME) {
+            Proto_Frame *frame = &parser->frame;
+
+            frame->length = parser->buffer[OFFSET_LEN];
+            frame->seq = parser->buffer[OFFSET_SEQ];
+            frame->type = parser->buffer[OFFSET_TYPE];
+            memcpy(frame->payload, &parser->buffer[PROTO_HEADER_SIZE], frame->length);
+            Proto_Discard(parser, Proto_FrameSize(frame->length));
+            return true;
+        }
+        parser->errors++;
+        Proto_Discard(parser, 1U);
+    }
+    return false;
+}
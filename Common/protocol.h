@@ -0,0 +1,154 @@
+/******************************************************************************
+ * File: protocol.h
+ * Module: Protocol (HMI <-> Control UART5 link)
+ * Description: Message codes and frame format shared by both ECUs
+ *
+ * Frame layout (all fields one byte unless noted):
+ *
+ *   SOF | LEN | SEQ | TYPE | PAYLOAD[LEN] | CRC16 (high byte first)
+ *
+ *   SOF   - PROTO_SOF, start of frame
+ *   LEN   - payload length, 0..PROTO_MAX_PAYLOAD
+ *   SEQ   - request ID; every response carries the SEQ of its request, so
+ *           several requests can be outstanding at once
+ *   TYPE  - CMD_* (HMI -> Control) or RESP_* (Control -> HMI)
+ *   CRC16 - CRC-16/CCITT-FALSE over LEN..PAYLOAD
+ *
+ * The receiver feeds bytes one at a time to Proto_Parse(). A bad length
+ * or CRC makes the parser rescan the bytes it already holds for the next
+ * SOF, so a dropped or corrupted byte costs at most one frame.
+ ******************************************************************************/
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Commands (HMI -> Control) */
+#define CMD_SETUP_PASSWORD      0x01    /* Payload: password, confirmation */
+#define CMD_VERIFY_PASSWORD     0x02
+#define CMD_CHANGE_PASSWORD     0x03    /* Payload: old password */
+#define CMD_SET_TIMEOUT         0x04    /* Payload: password, seconds */
+#define CMD_OPEN_DOOR           0x05    /* Payload: password */
+#define CMD_ERASE_EEPROM        0x06    /* Payload: password */
+#define CMD_CHECK_PASSWORD      0x07
+#define CMD_TRIGGER_LOCKOUT     0x08
+#define CMD_GET_STATUS          0x09    /* Answered at any time, even mid door cycle */
+#define CMD_LOCK_NOW            0x0A    /* Emergency lock, no password needed */
+
+/* Responses (Control -> HMI) */
+#define RESP_PASSWORD_MATCH     0x10
+#define RESP_PASSWORD_MISMATCH  0x11
+#define RESP_TIMEOUT_SAVED      0x12
+#define RESP_DOOR_UNLOCKING     0x13
+#define RESP_DOOR_LOCKING       0x14
+#define RESP_DOOR_LOCKED        0x15
+#define RESP_SYSTEM_LOCKED      0x16
+#define RESP_EEPROM_ERASED      0x17
+#define RESP_PASSWORD_EXISTS    0x18
+#define RESP_NO_PASSWORD        0x19
+#define RESP_COUNTDOWN_START    0x1A
+#define RESP_COUNTDOWN          0x1B    /* Payload: seconds left */
+#define RESP_STATUS             0x1C    /* Payload: STATUS_* fields */
+#define RESP_BUSY               0x1D    /* Door cycle running, command refused */
+#define RESP_STORED             0x1E    /* Payload: STORED_* (see below) */
+
+/* RESP_STORED: a change answered with RESP_PASSWORD_MATCH (setup),
+ * RESP_TIMEOUT_SAVED or RESP_EEPROM_ERASED is answered once it is queued
+ * for the EEPROM; RESP_STORED follows under the same SEQ when it is
+ * programmed */
+#define STORED_OK               0x00U
+#define STORED_FAILED           0x01U
+
+/* RESP_STATUS payload */
+#define STATUS_DOOR_STATE       0U      /* DOOR_* */
+#define STATUS_SECONDS_LEFT     1U      /* Countdown while the door is open */
+#define STATUS_AUTO_LOCK        2U      /* Configured timeout, seconds */
+#define STATUS_LENGTH           3U
+
+/* Door states */
+#define DOOR_LOCKED             0U
+#define DOOR_UNLOCKING          1U
+#define DOOR_OPEN               2U
+#define DOOR_LOCKING            3U
+
+/* Password Configuration */
+#define PASSWORD_LENGTH         5
+
+/* Frame format */
+#define PROTO_SOF               0xA5U
+#define PROTO_HEADER_SIZE       4U      /* SOF, LEN, SEQ, TYPE */
+#define PROTO_CRC_SIZE          2U
+#define PROTO_MAX_PAYLOAD       16U
+#define PROTO_MAX_FRAME         (PROTO_HEADER_SIZE + PROTO_MAX_PAYLOAD + PROTO_CRC_SIZE)
+#define PROTO_CRC_INIT          0xFFFFU
+
+typedef struct {
+    uint8_t seq;
+    uint8_t type;
+    uint8_t length;
+    uint8_t payload[PROTO_MAX_PAYLOAD];
+} Proto_Frame;
+
+typedef struct {
+    uint8_t buffer[PROTO_MAX_FRAME];    /* Bytes of the frame being received */
+    uint8_t count;
+    uint32_t errors;                    /* Frame starts rejected (length or
+                                         * CRC); an SOF byte inside a damaged
+                                         * frame counts again */
+    Proto_Frame frame;                  /* Last complete frame */
+} Proto_Parser;
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Proto_Crc16
+ * CRC-16/CCITT-FALSE (polynomial 0x1021), continuing from crc.
+ * Start a new CRC with PROTO_CRC_INIT.
+ */
+uint16_t Proto_Crc16(uint16_t crc, const uint8_t *data, uint16_t length);
+
+/*
+ * Proto_Encode
+ * Builds a frame in buffer (at least PROTO_MAX_FRAME bytes).
+ * 
+ * Returns:
+ *   Frame length in bytes, or 0 if length exceeds PROTO_MAX_PAYLOAD
+ */
+uint8_t Proto_Encode(uint8_t *buffer, uint8_t seq, uint8_t type,
+                     const uint8_t *payload, uint8_t length);
+
+/*
+ * Proto_ParserInit
+ * Resets a parser to hunt for the next SOF.
+ */
+void Proto_ParserInit(Proto_Parser *parser);
+
+/*
+ * Proto_Parse
+ * Feeds one received byte to the parser.
+ * 
+ * Returns:
+ *   true when the byte completed a valid frame, now in parser->frame
+ */
+bool Proto_Parse(Proto_Parser *parser, uint8_t byte);
+
+/*
+ * Proto_ParsePending
+ * Re-checks the bytes still held after a frame was reported. After a
+ * resync they can already hold the next complete frame; call until it
+ * returns false, before feeding more bytes.
+ * 
+ * Returns:
+ *   true when the held bytes complete a valid frame, now in parser->frame
+ */
+bool Proto_ParsePending(Proto_Parser *parser);
+
+#endif /* PROTOCOL_H_ */
@@ -0,0 +1,132 @@
+/******************************************************************************
+ * File: sched.c
+ * Module: Scheduler (cooperative, run-to-completion)
+ * Description: Ready bitmap, event sets and the dispatch loop
+ ******************************************************************************/
+
+#include "sched.h"
+#include "systick.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Count leading zeros: a single CLZ instruction on the Cortex-M4 */
+#if defined(__ICCARM__)
+#include <intrinsics.h>
+#define SCHED_CLZ(x)            ((uint32_t)__CLZ(x))
+#else
+#define SCHED_CLZ(x)            ((uint32_t)__builtin_clz(x))
+#endif
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Sched_Task g_tasks[SCHED_MAX_TASKS];
+static volatile uint32_t g_events[SCHED_MAX_TASKS];
+static volatile uint32_t g_ready;           /* Bit n: task n has events */
+static uint32_t g_timersMs;                 /* Millisecond timers last ran in */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Sched_Step
+ * Runs due timers, then the highest ready task. If neither had anything
+ * to do, sleeps until the next interrupt. The idle check runs with
+ * interrupts masked; WFI still wakes on the interrupt that is pending.
+ */
+static void Sched_Step(void)
+{
+    uint32_t now = (uint32_t)Time_NowMs();
+    bool wasMasked;
+
+    if (now != g_timersMs) {
+        g_timersMs = now;
+        Timer_Dispatch();
+    }
+
+    wasMasked = IntMasterDisable();
+    if (g_ready != 0U) {
+        uint32_t priority = 31U - SCHED_CLZ(g_ready);
+        uint32_t events = g_events[priority];
+
+        g_events[priority] = 0U;
+        g_ready &= ~(1UL << priority);
+        if (!wasMasked) {
+            IntMasterEnable();
+        }
+        g_tasks[priority](events);
+        return;
+    }
+
+    if ((uint32_t)Time_NowMs() == g_timersMs) {
+        SysCtlSleep();
+    }
+    if (!wasMasked) {
+        IntMasterEnable();
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void Sched_Init(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < SCHED_MAX_TASKS; i++) {
+        g_tasks[i] = NULL;
+        g_events[i] = 0U;
+    }
+    g_ready = 0U;
+    g_timersMs = (uint32_t)Time_NowMs();
+}
+
+bool Sched_AddTask(uint8_t priority, Sched_Task task)
+{
+    if (priority >= SCHED_MAX_TASKS || task == NULL || g_tasks[priority] != NULL) {
+        return false;
+    }
+    g_tasks[priority] = task;
+    return true;
+}
+
+void Sched_Post(uint8_t priority, uint32_t events)
+{
+    bool wasMasked;
+
+    if (priority >= SCHED_MAX_TASKS || g_tasks[priority] == NULL || events == 0U) {
+        return;
+    }
+
+    wasMasked = IntMasterDisable();
+    g_events[priority] |= events;
+    g_ready |= 1UL << priority;
+    if (!wasMasked) {
+        IntMasterEnable();
+    }
+}
+
+void Sched_Run(void)
+{
+    for (;;) {
+        Sched_Step();
+    }
+}
+
+void Sched_RunFor(uint32_t ms)
+{
+    uint64_t deadline = Time_NowMs() + ms;
+
+    while (!Time_Reached(Time_NowMs(), deadline)) {
+        Sched_Step();
+    }
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File: sched.h
+ * Module: Scheduler (cooperative, run-to-completion)
+ * Description: Priority task scheduler shared by both ECUs
+ *
+ * Each task has a unique priority, 0 (lowest) to SCHED_MAX_TASKS - 1, and
+ * a set of pending events. Sched_Post() ORs event bits into a task's set
+ * and marks it ready in a 32-bit bitmap; it is safe from interrupt
+ * handlers. The scheduler picks the highest ready task with one CLZ
+ * instruction, clears its events and calls it with them. Tasks run to
+ * completion and never block: anything that has to wait arms a timer
+ * (systick.h) whose callback posts an event.
+ *
+ * Between tasks the scheduler runs due timers, and it sleeps with WFI when
+ * nothing is ready, so an interrupt that posts an event wakes it at once.
+ ******************************************************************************/
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SCHED_MAX_TASKS         32U
+
+/* For functions that never return, so main() may end in one */
+#if defined(__ICCARM__)
+#define SCHED_NORETURN          __noreturn
+#else
+#define SCHED_NORETURN          __attribute__((noreturn))
+#endif
+
+/* Called with the events posted since the task last ran (never 0) */
+typedef void (*Sched_Task)(uint32_t events);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+void Sched_Init(void);
+
+/*
+ * Sched_AddTask
+ * Registers task at priority.
+ * Returns: false if the priority is out of range or already taken
+ */
+bool Sched_AddTask(uint8_t priority, Sched_Task task);
+
+/*
+ * Sched_Post
+ * Adds events to the task at priority and makes it ready. Events posted
+ * again before the task runs are merged. Interrupt safe.
+ */
+void Sched_Post(uint8_t priority, uint32_t events);
+
+/*
+ * Sched_Run
+ * Runs tasks and timers forever. The Control ECU's main loop.
+ */
+SCHED_NORETURN void Sched_Run(void);
+
+/*
+ * Sched_RunFor
+ * Runs tasks and timers for ms milliseconds ((ms - 1, ms], like DelayMs),
+ * for blocking code in the background such as the HMI menus. Must not be
+ * called from a task.
+ */
+void Sched_RunFor(uint32_t ms);
+
+#endif /* SCHED_H_ */
@@ -6,6 +6,9 @@
 
 #include "buzzer.h"
 #include "tm4c123gh6pm.h"
+#include "dio.h"
+#include "systick.h"
+#include "driverlib/interrupt.h"
 
 /******************************************************************************
  *                              Pin Configuration                              *
@@ -18,6 +21,69 @@
 #define BUZZER_PIN          1
 #define BUZZER_PIN_MASK     (1 << BUZZER_PIN)
 
+/* Lockout alarm pattern, repeated every second */
+#define ALARM_PERIOD_MS     1000
+#define ALARM_TONE_MS       800
+
+/* Timer0A toggles PF1 every half period of the ~4kHz alarm tone */
+#define BUZZER_TIMER_VECTOR 35U     /* INT_TIMER0A */
+#define TONE_HALF_PERIOD_US 125U
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t g_alarmMsLeft = 0;
+static bool g_toneOn = false;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Buzzer_Write / Buzzer_Flip
+ * PF1 goes through the masked DATA alias, so neither the tone ISR nor the
+ * door task can overwrite the other's Port F pins (motor: PF0, PF4).
+ */
+static void Buzzer_Write(uint8_t level) {
+    DIO_WritePort(PORTF, BUZZER_PIN_MASK, level ? BUZZER_PIN_MASK : 0);
+}
+
+static void Buzzer_Flip(void) {
+    DIO_WritePort(PORTF, BUZZER_PIN_MASK,
+                  (uint8_t)~DIO_ReadPort(PORTF, BUZZER_PIN_MASK));
+}
+
+/*
+ * Buzzer_ToneHandler
+ * Timer0A ISR: one half period of the tone.
+ */
+static void Buzzer_ToneHandler(void) {
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    (void)TIMER0_ICR_R;     /* Clear lands before return: no re-entry */
+    Buzzer_Flip();
+}
+
+/*
+ * Buzzer_ToneStart
+ * Starts the tone; PF1 toggles from the next Timer0A interrupt.
+ */
+static void Buzzer_ToneStart(void) {
+    g_toneOn = true;
+    TIMER0_CTL_R = TIMER_CTL_TAEN;
+}
+
+/*
+ * Buzzer_ToneStop
+ * Stops the tone and leaves PF1 LOW.
+ */
+static void Buzzer_ToneStop(void) {
+    g_toneOn = false;
+    TIMER0_CTL_R = 0;
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    Buzzer_Write(LOW);
+}
+
 /******************************************************************************
  *                          Function Definitions                               *
  ******************************************************************************/
@@ -47,7 +113,19 @@ void Buzzer_Init(void) {
     GPIO_PORTF_DEN_R |= BUZZER_PIN_MASK;       /* Enable digital function on PF1 */
     GPIO_PORTF_AMSEL_R &= ~BUZZER_PIN_MASK;    /* Disable analog function */
     GPIO_PORTF_PCTL_R &= ~0x000000F0;          /* Clear PCTL for PF1 (bits 7-4) */
-    GPIO_PORTF_DATA_R &= ~BUZZER_PIN_MASK;     /* Start with buzzer off (LOW) */
+    Buzzer_Write(LOW);                         /* Start with buzzer off (LOW) */
+    
+    /* Timer0A: 32-bit periodic tone generator, left stopped until needed */
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
+    while((SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R0) == 0);
+    TIMER0_CTL_R = 0;
+    TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+    TIMER0_TAILR_R = (TONE_HALF_PERIOD_US * SYSTICK_CLOCK_MHZ) - 1U;
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER0_IMR_R = TIMER_IMR_TATOIM;
+    IntRegister(BUZZER_TIMER_VECTOR, Buzzer_ToneHandler);
+    IntEnable(BUZZER_TIMER_VECTOR);
 }
 
 /*
@@ -55,15 +133,15 @@ void Buzzer_Init(void) {
  * Turns the buzzer on by setting PF1 to HIGH.
  */
 void Buzzer_On(void) {
-    GPIO_PORTF_DATA_R |= BUZZER_PIN_MASK;
+    Buzzer_Write(HIGH);
 }
 
 /*
  * Buzzer_Off
- * Turns the buzzer off by setting PF1 to LOW.
+ * Turns the buzzer off by setting PF1 to LOW, silencing any alarm tone.
  */
 void Buzzer_Off(void) {
-    GPIO_PORTF_DATA_R &= ~BUZZER_PIN_MASK;
+    Buzzer_ToneStop();
 }
 
 /*
@@ -71,7 +149,7 @@ void Buzzer_Off(void) {
  * Toggles the buzzer state.
  */
 void Buzzer_Toggle(void) {
-    GPIO_PORTF_DATA_R ^= BUZZER_PIN_MASK;
+    Buzzer_Flip();
 }
 
 /*
@@ -87,7 +165,7 @@ void Buzzer_Beep(uint16_t duration_ms) {
     
     /* Generate tone by toggling */
     for (i = 0; i < toggles; i++) {
-        GPIO_PORTF_DATA_R ^= BUZZER_PIN_MASK;
+        Buzzer_Flip();
         
         /* Delay for ~125us (half period of 4kHz) */
         /* At 16MHz, need ~2000 cycles for 125us */
@@ -97,5 +175,40 @@ void Buzzer_Beep(uint16_t duration_ms) {
     }
     
     /* Ensure buzzer is off after beep */
-    GPIO_PORTF_DATA_R &= ~BUZZER_PIN_MASK;
+    Buzzer_Write(LOW);
+}
+
+/*
+ * Buzzer_StartAlarm
+ * Arms the lockout alarm, silent until the first Buzzer_Service() call.
+ */
+void Buzzer_StartAlarm(uint8_t seconds) {
+    Buzzer_ToneStop();
+    g_alarmMsLeft = (uint32_t)seconds * ALARM_PERIOD_MS;
+}
+
+/*
+ * Buzzer_Service
+ * Switches the tone on or off at the next edge of the alarm pattern.
+ */
+uint32_t Buzzer_Service(void) {
+    uint32_t step;
+    
+    if (g_alarmMsLeft == 0) {
+        Buzzer_ToneStop();
+        return 0;
+    }
+    
+    if (g_toneOn) {
+        Buzzer_ToneStop();
+        step = ALARM_PERIOD_MS - ALARM_TONE_MS;
+    } else {
+        Buzzer_ToneStart();
+        step = ALARM_TONE_MS;
+    }
+    if (step > g_alarmMsLeft) {
+        step = g_alarmMsLeft;
+    }
+    g_alarmMsLeft -= step;
+    return step;
 }
@@ -8,6 +8,7 @@
 #define BUZZER_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /******************************************************************************
  * Function Prototypes
@@ -50,4 +51,25 @@ void Buzzer_Toggle(void);
  */
 void Buzzer_Beep(uint16_t duration_ms);
 
+/*
+ * Buzzer_StartAlarm
+ * Starts the lockout alarm: every second, an 800ms tone then 200ms of
+ * silence. A timer interrupt plays the tone and Buzzer_Service() switches
+ * it, so the caller does not wait for it.
+ * 
+ * Parameters:
+ *   seconds - Length of the alarm
+ */
+void Buzzer_StartAlarm(uint8_t seconds);
+
+/*
+ * Buzzer_Service
+ * Switches the alarm tone on or off. Call once right after
+ * Buzzer_StartAlarm(), then again each time the returned delay elapses.
+ * 
+ * Returns:
+ *   milliseconds until the next call, or 0 once the alarm has ended
+ */
+uint32_t Buzzer_Service(void);
+
 #endif /* BUZZER_H_ */
@@ -0,0 +1,373 @@
+/******************************************************************************
+ * File: config.c
+ * Module: Config (persistent settings)
+ * Description: RAM copy of the password, auto-lock timeout and flags,
+ *              written back to EEPROM on Config_Flush()
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "config.h"
+#include "eeprom.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Settings record word 1 fields */
+#define SETTINGS_CHAR_SHIFT     24U
+#define SETTINGS_VERSION_SHIFT  16U
+#define SETTINGS_FLAGS_SHIFT    8U
+#define SETTINGS_TIMEOUT_MASK   0xFFU
+
+#define RECORD_WORDS            ((uint8_t)(sizeof(Record) / sizeof(uint32_t)))
+
+/* Words of the block 0 layout used before the record log */
+#define LEGACY_PASSWORD_0       0U      /* Characters 0-3 */
+#define LEGACY_PASSWORD_1       1U      /* Character 4 */
+#define LEGACY_TIMEOUT          2U
+#define LEGACY_VALID            3U
+#define LEGACY_WORDS            4U
+
+/* Settings writes in flight: one more than the EEPROM queue holds, as a
+ * flush keeps its entry while it waits for room in a full queue */
+#define PENDING_WRITES          (EEPROM_QUEUE_JOBS + 1U)
+
+/* Settings record as logged; read back whole with one EEPROM_LogGet() */
+typedef struct {
+    uint32_t password;          /* Characters 0-3 */
+    uint32_t settings;          /* Character 4, version, flags, timeout */
+} Record;
+
+/* Caller's completion of a settings write (or erase) in flight */
+typedef struct {
+    bool erase;
+    EEPROM_Callback done;
+    void *context;
+} PendingWrite;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Record g_record;                     /* As logged */
+static volatile bool g_dirty;               /* g_record not queued yet */
+static PendingWrite g_pending[PENDING_WRITES];
+static volatile uint8_t g_queued;           /* Settings writes queued... */
+static volatile uint8_t g_confirmed;        /* ...and finished, oldest first */
+static volatile bool g_remount;             /* An erase failed: the index is stale */
+static char g_password[PASSWORD_LENGTH + 1];
+static uint8_t g_timeout = CONFIG_TIMEOUT_DEFAULT;
+static uint8_t g_flags;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * ValidTimeout
+ * The timeout stored in a word, or the default if it is out of range.
+ */
+static uint8_t ValidTimeout(uint32_t word)
+{
+    if (word < CONFIG_TIMEOUT_MIN || word > CONFIG_TIMEOUT_MAX) {
+        return CONFIG_TIMEOUT_DEFAULT;
+    }
+    return (uint8_t)word;
+}
+
+/*
+ * SetRecord
+ * Replaces the record image; marks it dirty only if it changed.
+ */
+static void SetRecord(uint32_t password, uint32_t settings)
+{
+    if (password != g_record.password || settings != g_record.settings) {
+        g_record.password = password;
+        g_record.settings = settings;
+        g_dirty = true;
+    }
+}
+
+/*
+ * Encode
+ * Builds the record image from the settings, stamped with the current
+ * schema version.
+ */
+static void Encode(void)
+{
+    SetRecord(((uint32_t)(uint8_t)g_password[0] << 24) |
+              ((uint32_t)(uint8_t)g_password[1] << 16) |
+              ((uint32_t)(uint8_t)g_password[2] << 8) |
+              ((uint32_t)(uint8_t)g_password[3]),
+              ((uint32_t)(uint8_t)g_password[4] << SETTINGS_CHAR_SHIFT) |
+              ((uint32_t)CONFIG_RECORD_VERSION << SETTINGS_VERSION_SHIFT) |
+              ((uint32_t)g_flags << SETTINGS_FLAGS_SHIFT) |
+              (uint32_t)g_timeout);
+}
+
+/*
+ * Decode
+ * Rebuilds the settings from the record image. Every version so far
+ * keeps the fields of version 0 where they were (see config.h), so the
+ * version byte only tells which fields beyond those a record has.
+ */
+static void Decode(void)
+{
+    uint8_t i;
+
+    g_flags = (uint8_t)(g_record.settings >> SETTINGS_FLAGS_SHIFT);
+    g_timeout = ValidTimeout(g_record.settings & SETTINGS_TIMEOUT_MASK);
+    if ((g_flags & CONFIG_FLAG_PASSWORD) != 0U) {
+        for (i = 0; i < 4U; i++) {
+            g_password[i] = (char)((g_record.password >> (24U - (8U * i))) & 0xFFU);
+        }
+        g_password[4] = (char)(g_record.settings >> SETTINGS_CHAR_SHIFT);
+        g_password[PASSWORD_LENGTH] = '\0';
+    } else {
+        g_password[0] = '\0';
+    }
+}
+
+/*
+ * Reset
+ * No password, default timeout, nothing to write.
+ */
+static void Reset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i <= PASSWORD_LENGTH; i++) {
+        g_password[i] = '\0';
+    }
+    g_timeout = CONFIG_TIMEOUT_DEFAULT;
+    g_flags = 0;
+    Encode();
+    g_dirty = false;
+}
+
+/*
+ * OnWritten
+ * EEPROM callback of a queued settings write or erase. A failed one
+ * leaves the settings dirty, so the next flush logs them again; after a
+ * failed erase the log is remounted first, as it still holds records the
+ * emptied index knows nothing of. Then the caller's callback runs.
+ */
+static void OnWritten(uint8_t result, void *context)
+{
+    PendingWrite *pending = &g_pending[g_confirmed % PENDING_WRITES];
+    EEPROM_Callback done = pending->done;
+    void *doneContext = pending->context;
+
+    (void)context;
+    if (result != EEPROM_SUCCESS) {
+        g_remount = g_remount || pending->erase;
+        g_dirty = true;
+    }
+    g_confirmed++;
+    if (done != NULL) {
+        done(result, doneContext);
+    }
+}
+
+/*
+ * LoadLegacy
+ * Adopts settings saved by earlier firmware in block 0 words 0-3 and logs
+ * them as one record, so the old words are no longer needed.
+ */
+static void LoadLegacy(void)
+{
+    uint32_t words[LEGACY_WORDS];
+    uint32_t settings;
+
+    if (EEPROM_ReadBuffer(0, 0, (uint8_t *)words, sizeof(words)) != EEPROM_SUCCESS) {
+        return;
+    }
+
+    settings = ValidTimeout(words[LEGACY_TIMEOUT]);
+    if (words[LEGACY_VALID] == CONFIG_VALID_MARKER) {
+        settings |= (words[LEGACY_PASSWORD_1] & (0xFFUL << SETTINGS_CHAR_SHIFT)) |
+                    ((uint32_t)CONFIG_RECORD_VERSION << SETTINGS_VERSION_SHIFT) |
+                    ((uint32_t)CONFIG_FLAG_PASSWORD << SETTINGS_FLAGS_SHIFT);
+        SetRecord(words[LEGACY_PASSWORD_0], settings);
+    } else if (words[LEGACY_TIMEOUT] == settings) {
+        SetRecord(g_record.password,
+                  settings | ((uint32_t)CONFIG_RECORD_VERSION << SETTINGS_VERSION_SHIFT));
+    }
+    if (g_dirty) {
+        Decode();
+        (void)Config_Flush();
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Config_Load
+ * Mounts the record log and takes the newest settings record from it. An
+ * empty log is seeded from the old block 0 layout.
+ */
+void Config_Load(void)
+{
+    Reset();
+    if (EEPROM_LogMount() != EEPROM_SUCCESS) {
+        return;
+    }
+
+    if (EEPROM_LogGet(CONFIG_KEY_SETTINGS, (uint32_t *)&g_record, RECORD_WORDS) == RECORD_WORDS) {
+        Decode();
+    } else {
+        LoadLegacy();
+    }
+}
+
+bool Config_HasPassword(void)
+{
+    return (g_flags & CONFIG_FLAG_PASSWORD) != 0U;
+}
+
+const char *Config_GetPassword(void)
+{
+    return g_password;
+}
+
+uint8_t Config_GetTimeout(void)
+{
+    return g_timeout;
+}
+
+void Config_SetPassword(const char *password)
+{
+    uint8_t i;
+
+    for (i = 0; i < PASSWORD_LENGTH; i++) {
+        g_password[i] = password[i];
+    }
+    g_password[PASSWORD_LENGTH] = '\0';
+    g_flags |= CONFIG_FLAG_PASSWORD;
+    Encode();
+}
+
+void Config_SetTimeout(uint8_t seconds)
+{
+    if (seconds < CONFIG_TIMEOUT_MIN) {
+        seconds = CONFIG_TIMEOUT_MIN;
+    } else if (seconds > CONFIG_TIMEOUT_MAX) {
+        seconds = CONFIG_TIMEOUT_MAX;
+    }
+    g_timeout = seconds;
+    Encode();
+}
+
+bool Config_IsDirty(void)
+{
+    return g_dirty || g_queued != g_confirmed;
+}
+
+/*
+ * Config_Flush
+ * Queues the record and waits until the EEPROM has it.
+ */
+uint8_t Config_Flush(void)
+{
+    if (Config_FlushAsync(NULL, NULL) != EEPROM_SUCCESS) {
+        return EEPROM_ERROR;
+    }
+    return EEPROM_Sync();
+}
+
+/*
+ * Config_FlushAsync
+ * Queues the whole settings record with one EEPROM_LogPutAsync(), so
+ * every change made since the last flush commits with its final (CRC)
+ * word. The settings stop being dirty once queued, so a flush right after
+ * does not log them twice; OnWritten() marks them dirty again if the
+ * write fails.
+ */
+uint8_t Config_FlushAsync(EEPROM_Callback done, void *context)
+{
+    PendingWrite *pending = &g_pending[g_queued % PENDING_WRITES];
+
+    if (!g_dirty) {
+        if (done != NULL) {
+            done(EEPROM_SUCCESS, context);
+        }
+        return EEPROM_SUCCESS;
+    }
+    if ((uint8_t)(g_queued - g_confirmed) >= PENDING_WRITES) {
+        return EEPROM_ERROR;
+    }
+
+    if (g_remount) {
+        g_remount = false;
+        (void)EEPROM_LogMount();
+    }
+
+    pending->erase = false;
+    pending->done = done;
+    pending->context = context;
+    g_dirty = false;
+    if (EEPROM_LogPutAsync(CONFIG_KEY_SETTINGS, (const uint32_t *)&g_record, RECORD_WORDS,
+                           OnWritten, NULL) != EEPROM_SUCCESS) {
+        g_dirty = true;
+        return EEPROM_ERROR;
+    }
+    g_queued++;
+    return EEPROM_SUCCESS;
+}
+
+/*
+ * Config_Compact
+ * One step of the log's background compaction.
+ */
+bool Config_Compact(void)
+{
+    return EEPROM_LogCompact();
+}
+
+/*
+ * Config_Erase
+ * Queues the erase and waits until it is done.
+ */
+uint8_t Config_Erase(void)
+{
+    if (Config_EraseAsync(NULL, NULL) != EEPROM_SUCCESS) {
+        return EEPROM_ERROR;
+    }
+    return EEPROM_Sync();
+}
+
+/*
+ * Config_EraseAsync
+ * Queues the erase of the log; once it is queued, the RAM copy matches
+ * the blank EEPROM, so changes made meanwhile apply after the erase. The
+ * erase completes through OnWritten() like a flush.
+ */
+uint8_t Config_EraseAsync(EEPROM_Callback done, void *context)
+{
+    PendingWrite *pending = &g_pending[g_queued % PENDING_WRITES];
+    bool wasDirty = g_dirty;
+    bool failed;
+
+    if ((uint8_t)(g_queued - g_confirmed) >= PENDING_WRITES) {
+        return EEPROM_ERROR;
+    }
+
+    pending->erase = true;
+    pending->done = done;
+    pending->context = context;
+    g_dirty = false;
+    if (EEPROM_LogFormatAsync(OnWritten, NULL) != EEPROM_SUCCESS) {
+        g_dirty = wasDirty;
+        return EEPROM_ERROR;
+    }
+
+    /* OnWritten() may have run already, for nothing left to erase or a
+     * word that failed to start */
+    failed = g_dirty;
+    Reset();
+    g_dirty = failed;
+    g_queued++;
+    return EEPROM_SUCCESS;
+}
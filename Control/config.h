@@ -0,0 +1,164 @@
+/******************************************************************************
+ * File: config.h
+ * Module: Config (persistent settings)
+ * Description: RAM copy of the password, auto-lock timeout and flags,
+ *              written back to EEPROM on Config_Flush()
+ *
+ * Config_Load() reads the settings once at boot; after that every getter
+ * answers from RAM. Setters change the RAM copy and mark it dirty, only
+ * if a value really changes. Config_Flush() then appends all the settings
+ * as one record to the EEPROM record log (eeprom.h), which spreads the
+ * writes over all 32 blocks and returns once the EEPROM reports the
+ * record done. Config_FlushAsync() and Config_EraseAsync() return as soon
+ * as the write is queued and call back from the EEPROM interrupt when it
+ * is done. A record commits with its last word, so a reset during a
+ * flush leaves every setting as it was before the flush, never a mix.
+ *
+ * Settings record (log key CONFIG_KEY_SETTINGS, 2 words), everything the
+ * Control ECU needs at boot, read back with one EEPROM_LogGet():
+ *   word 0  password characters 0-3, first in the top byte
+ *   word 1  password character 4 (bits 31-24), schema version (23-16),
+ *           flags (15-8), auto-lock timeout in seconds (7-0)
+ *
+ * Schema versions:
+ *   0  records logged before the version byte existed (it reads as 0);
+ *      same fields as version 1
+ *   1  CONFIG_RECORD_VERSION
+ * A new version may only use bits that are free in the one before, so
+ * any firmware reads the fields it knows from any record. Flushes always
+ * write the current version.
+ *
+ * Earlier firmware kept the same words in block 0 words 0-3 (word 3 =
+ * CONFIG_VALID_MARKER once a password was set). Config_Load() moves such
+ * settings into the log, as a current record, when the log is empty.
+ ******************************************************************************/
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol.h"           /* PASSWORD_LENGTH */
+#include "eeprom.h"             /* EEPROM_Callback */
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Record log key */
+#define CONFIG_KEY_SETTINGS     0U
+
+#define CONFIG_RECORD_VERSION   1U      /* Settings record schema version */
+
+#define CONFIG_VALID_MARKER     0xAA55AA55U     /* Old block 0 layout */
+
+/* Auto-lock timeout */
+#define CONFIG_TIMEOUT_MIN      5U
+#define CONFIG_TIMEOUT_MAX      30U
+#define CONFIG_TIMEOUT_DEFAULT  5U      /* Also used when the stored value is out of range */
+
+/* Flags */
+#define CONFIG_FLAG_PASSWORD    0x01U   /* A password has been set */
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Config_Load
+ * Mounts the record log and reads the settings from its index. Call after
+ * EEPROM_Init().
+ */
+void Config_Load(void);
+
+/*
+ * Config_HasPassword
+ * True once a password has been set (CONFIG_FLAG_PASSWORD).
+ */
+bool Config_HasPassword(void);
+
+/*
+ * Config_GetPassword
+ * The stored password, PASSWORD_LENGTH characters and a terminating NUL.
+ */
+const char *Config_GetPassword(void);
+
+/*
+ * Config_GetTimeout
+ * Auto-lock timeout in seconds, CONFIG_TIMEOUT_MIN to CONFIG_TIMEOUT_MAX.
+ */
+uint8_t Config_GetTimeout(void);
+
+/*
+ * Config_SetPassword
+ * Stores a password (PASSWORD_LENGTH characters) and sets
+ * CONFIG_FLAG_PASSWORD. Takes effect in EEPROM on Config_Flush().
+ */
+void Config_SetPassword(const char *password);
+
+/*
+ * Config_SetTimeout
+ * Stores the auto-lock timeout; values out of range are clamped.
+ * Takes effect in EEPROM on Config_Flush().
+ */
+void Config_SetTimeout(uint8_t seconds);
+
+/*
+ * Config_IsDirty
+ * True if a setting has changed since the last flush, or a flushed record
+ * is not programmed yet.
+ */
+bool Config_IsDirty(void);
+
+/*
+ * Config_Flush
+ * Logs the settings if any has changed, as one record.
+ * Returns: EEPROM_SUCCESS, or EEPROM_ERROR (the settings stay dirty)
+ */
+uint8_t Config_Flush(void);
+
+/*
+ * Config_FlushAsync
+ * Queues the settings record if any setting has changed, and returns.
+ * done(result, context) runs from the EEPROM interrupt once the record is
+ * programmed, or before this returns if there was nothing to write. If
+ * programming fails, done gets EEPROM_ERROR and the settings are dirty
+ * again, for the next flush to retry.
+ * Parameters:
+ *   done    - Completion callback (may be NULL)
+ *   context - Passed to done
+ * Returns: EEPROM_SUCCESS if queued, or EEPROM_ERROR (the settings stay
+ *          dirty and done is not called)
+ */
+uint8_t Config_FlushAsync(EEPROM_Callback done, void *context);
+
+/*
+ * Config_Compact
+ * One step of background compaction of the record log
+ * (EEPROM_LogCompact()): queues at most one record move. Call while the
+ * EEPROM is idle until it returns false.
+ * Returns: true if more work may remain
+ */
+bool Config_Compact(void);
+
+/*
+ * Config_Erase
+ * Erases the EEPROM and resets the settings: no password, default
+ * timeout. Returns once the EEPROM is erased.
+ * Returns: EEPROM_SUCCESS or EEPROM_ERROR
+ */
+uint8_t Config_Erase(void);
+
+/*
+ * Config_EraseAsync
+ * Queues the erase of the EEPROM and, once it is queued, resets the
+ * settings as Config_Erase() does. done(result, context) runs from the
+ * EEPROM interrupt once it is erased (or before this returns if nothing
+ * needed erasing). If erasing fails, done gets EEPROM_ERROR and the reset
+ * settings are dirty, for the next flush to log over the old ones.
+ * Returns: EEPROM_SUCCESS if queued, or EEPROM_ERROR (the settings are
+ *          unchanged and done is not called)
+ */
+uint8_t Config_EraseAsync(EEPROM_Callback done, void *context);
+
+#endif /* CONFIG_H_ */
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * File: door.c
+ * Module: Door (lock/unlock sequence)
+ * Description: Non-blocking door cycle state machine
+ ******************************************************************************/
+
+#include "door.h"
+#include "motor.h"
+#include "systick.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Door_Listener g_listener;
+static uint8_t g_state = DOOR_LOCKED;
+static uint8_t g_secondsLeft;
+static uint32_t g_stateStart;       /* Time_NowMs() when the state began */
+static uint32_t g_deadline;         /* Next transition, in Time_NowMs() ms */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static void Door_Notify(Door_Event event)
+{
+    if (g_listener != NULL) {
+        g_listener(event, g_secondsLeft);
+    }
+}
+
+/*
+ * Door_Enter
+ * Switches state at time 'at' with the next transition 'durationMs' later.
+ */
+static void Door_Enter(uint8_t state, uint32_t at, uint32_t durationMs)
+{
+    g_state = state;
+    g_stateStart = at;
+    g_deadline = at + durationMs;
+}
+
+static void Door_StartLocking(uint32_t at, uint32_t durationMs)
+{
+    g_secondsLeft = 0;
+    Motor_RotateCCW();
+    Door_Enter(DOOR_LOCKING, at, durationMs);
+    Door_Notify(DOOR_EVENT_LOCKING);
+}
+
+/*
+ * Door_Advance
+ * Transition due at g_deadline. Following deadlines are counted from it,
+ * not from when Door_Update() ran, so a late call does not stretch the
+ * cycle.
+ */
+static void Door_Advance(void)
+{
+    uint32_t at = g_deadline;
+
+    switch (g_state) {
+        case DOOR_UNLOCKING:
+            Motor_Stop();
+            if (g_secondsLeft == 0U) {
+                Door_StartLocking(at, DOOR_MOTOR_MS);
+                break;
+            }
+            Door_Enter(DOOR_OPEN, at, DOOR_TICK_MS);
+            Door_Notify(DOOR_EVENT_OPEN);
+            Door_Notify(DOOR_EVENT_COUNTDOWN);
+            break;
+
+        case DOOR_OPEN:
+            g_secondsLeft--;
+            if (g_secondsLeft == 0U) {
+                Door_StartLocking(at, DOOR_MOTOR_MS);
+            } else {
+                g_deadline = at + DOOR_TICK_MS;
+                Door_Notify(DOOR_EVENT_COUNTDOWN);
+            }
+            break;
+
+        case DOOR_LOCKING:
+            Motor_Stop();
+            g_state = DOOR_LOCKED;
+            Door_Notify(DOOR_EVENT_LOCKED);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void Door_Init(Door_Listener listener)
+{
+    g_listener = listener;
+    g_state = DOOR_LOCKED;
+    g_secondsLeft = 0;
+}
+
+bool Door_Open(uint8_t autoLockSeconds, uint32_t nowMs)
+{
+    if (g_state != DOOR_LOCKED) {
+        return false;
+    }
+
+    g_secondsLeft = autoLockSeconds;
+    Motor_RotateCW();
+    Door_Enter(DOOR_UNLOCKING, nowMs, DOOR_MOTOR_MS);
+    Door_Notify(DOOR_EVENT_UNLOCKING);
+    return true;
+}
+
+bool Door_Lock(uint32_t nowMs)
+{
+    if (g_state == DOOR_UNLOCKING) {
+        /* Drive back only as far as the lock has moved */
+        Door_StartLocking(nowMs, nowMs - g_stateStart);
+        return true;
+    }
+    if (g_state == DOOR_OPEN) {
+        Door_StartLocking(nowMs, DOOR_MOTOR_MS);
+        return true;
+    }
+    return false;
+}
+
+void Door_Update(uint32_t nowMs)
+{
+    while (g_state != DOOR_LOCKED && Time_Reached32(nowMs, g_deadline)) {
+        Door_Advance();
+    }
+}
+
+uint8_t Door_GetState(void)
+{
+    return g_state;
+}
+
+uint8_t Door_GetSecondsLeft(void)
+{
+    return (g_state == DOOR_OPEN) ? g_secondsLeft : 0U;
+}
+
+bool Door_IsBusy(void)
+{
+    return g_state != DOOR_LOCKED;
+}
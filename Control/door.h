@@ -0,0 +1,87 @@
+/******************************************************************************
+ * File: door.h
+ * Module: Door (lock/unlock sequence)
+ * Description: Non-blocking door cycle state machine
+ *
+ * The cycle LOCKED -> UNLOCKING -> OPEN -> LOCKING -> LOCKED is driven by
+ * time: Door_Update() is called from the main loop with Time_NowMs()
+ * (truncated to 32 bits) and performs every transition whose deadline
+ * has passed. Nothing here waits, so the caller keeps serving the UART
+ * throughout. Each transition and every second of the countdown is
+ * reported to a listener.
+ ******************************************************************************/
+
+#ifndef DOOR_H_
+#define DOOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol.h"           /* DOOR_* states */
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define DOOR_MOTOR_MS           2000U   /* Time to drive the lock fully */
+#define DOOR_TICK_MS            1000U   /* Countdown step */
+
+typedef enum {
+    DOOR_EVENT_UNLOCKING,       /* Motor started opening */
+    DOOR_EVENT_OPEN,            /* Fully open, countdown starts */
+    DOOR_EVENT_COUNTDOWN,       /* One countdown step, secondsLeft valid */
+    DOOR_EVENT_LOCKING,         /* Motor started closing */
+    DOOR_EVENT_LOCKED           /* Fully locked, cycle over */
+} Door_Event;
+
+typedef void (*Door_Listener)(Door_Event event, uint8_t secondsLeft);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Door_Init
+ * Starts in DOOR_LOCKED. Call after Motor_Init().
+ */
+void Door_Init(Door_Listener listener);
+
+/*
+ * Door_Open
+ * Starts a door cycle that stays open for autoLockSeconds.
+ * Returns false if a cycle is already running
+ */
+bool Door_Open(uint8_t autoLockSeconds, uint32_t nowMs);
+
+/*
+ * Door_Lock
+ * Emergency lock: ends the countdown, or reverses an unlock in progress
+ * for as long as it has run.
+ * Returns false if the door is already locked or locking
+ */
+bool Door_Lock(uint32_t nowMs);
+
+/*
+ * Door_Update
+ * Performs the transitions that are due at nowMs.
+ */
+void Door_Update(uint32_t nowMs);
+
+/*
+ * Door_GetState
+ * Returns the current DOOR_* state
+ */
+uint8_t Door_GetState(void);
+
+/*
+ * Door_GetSecondsLeft
+ * Returns the countdown while DOOR_OPEN, 0 otherwise
+ */
+uint8_t Door_GetSecondsLeft(void);
+
+/*
+ * Door_IsBusy
+ * Returns true while a cycle is running
+ */
+bool Door_IsBusy(void);
+
+#endif /* DOOR_H_ */
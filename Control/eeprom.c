@@ -9,6 +9,10 @@
  *   - EEPROMProgram()
  *   - EEPROMRead()
  *   - EEPROMMassErase()
+ *   - EEPROMProgramNonBlocking() and the EEPROM interrupt (write queue)
+ * 
+ * The record log (EEPROM_Log*) is built on EEPROM_ReadBuffer() and the
+ * write queue; see eeprom.h for the slot format.
  * 
  * Include paths for TivaWare:
  *   - driverlib/sysctl.h
@@ -22,9 +26,118 @@
 /* TivaWare includes */
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
+#include "inc/hw_ints.h"
 #include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/eeprom.h"
 
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define LOG_SLOTS_PER_BLOCK     (EEPROM_BLOCK_SIZE / EEPROM_LOG_SLOT_WORDS)
+#define LOG_NO_SLOT             0xFFU
+#define LOG_ERASED              0xFFFFFFFFU
+
+/* An empty log starts at slot 1, so block 0 words 0-3 (where earlier
+ * firmware kept its settings) survive until those settings are logged */
+#define LOG_FIRST_SLOT          1U
+
+/* Slot words. EEPROMProgram() programs them in order, so the CRC word is
+ * the last one written: until it is, the slot fails its check. */
+#define LOG_WORD_TAG            0
+#define LOG_WORD_VALUE          1
+#define LOG_WORD_CRC            3
+
+/* Tag word: key (bits 31-29), length - 1 (bit 28), sequence (27-0). A
+ * 28-bit sequence number outlasts the EEPROM: 128 slots of 500K program
+ * cycles each hold fewer than 2^28 records. */
+#define LOG_SEQ_MASK            0x0FFFFFFFU     /* Also an erased tag: never valid */
+#define LOG_TAG(key, words, seq) \
+    (((uint32_t)(key) << 29) | ((uint32_t)((words) - 1U) << 28) | (uint32_t)(seq))
+#define LOG_TAG_KEY(tag)        ((uint8_t)((tag) >> 29))
+#define LOG_TAG_WORDS(tag)      ((uint8_t)((((tag) >> 28) & 1U) + 1U))
+#define LOG_TAG_SEQ(tag)        ((tag) & LOG_SEQ_MASK)
+
+#define LOG_CRC_INIT            0xFFFFFFFFU
+
+/* Write queue */
+#define EEPROM_TOTAL_WORDS      (EEPROM_TOTAL_SIZE / EEPROM_WORD_SIZE)
+#define JOB_WRITE               0U
+#define JOB_ERASE               1U
+
+/* Appends in flight: one more than the queue holds, as an append keeps
+ * its entry while it waits for room in a full queue */
+#define LOG_APPENDS             (EEPROM_QUEUE_JOBS + 1U)
+
+/******************************************************************************
+ *                          Private Types                                      *
+ ******************************************************************************/
+
+/* Newest record of a key */
+typedef struct
+{
+    uint32_t seq;
+    uint8_t slot;                               /* LOG_NO_SLOT: no record */
+    uint8_t words;
+    uint32_t value[EEPROM_LOG_MAX_WORDS];
+} LogEntry;
+
+/* Record queued but not programmed yet; the index moves to its slot once
+ * it is, so until then the key's previous record keeps its slot */
+typedef struct
+{
+    volatile bool used;
+    uint8_t key;
+    uint8_t slot;
+    uint8_t words;
+    uint8_t format;                             /* g_logFormats when queued */
+    uint32_t seq;
+    uint32_t value[EEPROM_LOG_MAX_WORDS];
+    EEPROM_Callback callback;
+    void *context;
+} LogAppend;
+
+/* Queued write or erase */
+typedef struct
+{
+    uint8_t kind;                               /* JOB_WRITE or JOB_ERASE */
+    uint8_t result;
+    uint16_t done;                              /* Words finished so far */
+    uint16_t words;
+    uint16_t first;                             /* Word index of the first word */
+    uint32_t data[EEPROM_JOB_MAX_WORDS];        /* JOB_WRITE only */
+    EEPROM_Callback callback;
+    void *context;
+} EepromJob;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/* CRC-32 (IEEE 802.3, reflected) remainders of each 4-bit value */
+static const uint32_t g_crcTable[16] =
+{
+    0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+    0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+    0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+    0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+static LogEntry g_logIndex[EEPROM_LOG_KEYS];
+static uint8_t g_logHead = LOG_FIRST_SLOT;      /* Next slot to write */
+static uint32_t g_logSeq = 1;                   /* Sequence of the next record */
+static LogAppend g_logAppends[LOG_APPENDS];
+static volatile uint8_t g_logFormats;           /* Bumped when the index is emptied */
+static volatile uint32_t g_logChanges;          /* Bumped when an append is taken or lands */
+
+static EepromJob g_jobs[EEPROM_QUEUE_JOBS];
+static volatile uint8_t g_jobFirst;             /* Job in progress */
+static volatile uint8_t g_jobCount;
+static volatile bool g_jobFailed;               /* Since the last EEPROM_Sync() */
+static volatile bool g_jobsRunning;             /* In JobsRun(), callbacks included */
+static EEPROM_IdleCallback volatile g_idleNotify;
+
 /******************************************************************************
  *                          Private Functions                                  *
  ******************************************************************************/
@@ -39,6 +152,349 @@ static uint32_t CalculateAddress(uint32_t block, uint32_t offset)
            (offset * EEPROM_WORD_SIZE);
 }
 
+/*
+ * JobsFull / JobsPending
+ * Wait conditions of the write queue.
+ */
+static bool JobsFull(void)
+{
+    return g_jobCount >= EEPROM_QUEUE_JOBS;
+}
+
+static bool JobsPending(void)
+{
+    return g_jobCount != 0U;
+}
+
+/*
+ * SleepWhile
+ * Sleeps until busy() no longer holds. The check runs with interrupts
+ * masked; WFI wakes on a pending interrupt even then, so a job that
+ * finishes just before the sleep cannot be missed. Not for use from an
+ * interrupt handler.
+ */
+static void SleepWhile(bool (*busy)(void))
+{
+    bool wasMasked;
+    
+    while(busy())
+    {
+        wasMasked = IntMasterDisable();
+        if(busy())
+        {
+            SysCtlSleep();
+        }
+        if(!wasMasked)
+        {
+            IntMasterEnable();
+        }
+    }
+}
+
+/*
+ * JobStart
+ * Starts programming the job's next word. An erase reads ahead up to the
+ * end of the block and skips the words it finds already erased.
+ * Returns: false if the job has nothing left to program
+ */
+static bool JobStart(EepromJob *job)
+{
+    uint32_t words[EEPROM_BLOCK_SIZE];
+    uint32_t index;
+    uint32_t count;
+    uint32_t value;
+    uint32_t i;
+    
+    while(job->done < job->words)
+    {
+        index = (uint32_t)(job->first + job->done) % EEPROM_TOTAL_WORDS;
+        if(job->kind == JOB_WRITE)
+        {
+            value = job->data[job->done];
+        }
+        else
+        {
+            count = EEPROM_BLOCK_SIZE - (index % EEPROM_BLOCK_SIZE);
+            if(count > (uint32_t)(job->words - job->done))
+            {
+                count = (uint32_t)(job->words - job->done);
+            }
+            EEPROMRead(words, index * EEPROM_WORD_SIZE, count * EEPROM_WORD_SIZE);
+            for(i = 0; i < count && words[i] == LOG_ERASED; i++)
+            {
+            }
+            job->done = (uint16_t)(job->done + i);
+            if(i == count)
+            {
+                continue;
+            }
+            index += i;
+            value = LOG_ERASED;
+        }
+        
+        if((EEPROMProgramNonBlocking(value, index * EEPROM_WORD_SIZE) & ~(uint32_t)EEPROM_RC_WORKING) != 0U)
+        {
+            job->result = EEPROM_ERROR;
+            return false;
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+/*
+ * JobsRun
+ * Starts the next word of the queue, finishing (and calling back) every
+ * job that has nothing left. Runs from the EEPROM interrupt, or with
+ * interrupts masked when a job is queued on an idle EEPROM. Jobs queued
+ * by a callback are only appended (see JobQueue()); this loop starts
+ * them, so no word is ever started twice.
+ */
+static void JobsRun(void)
+{
+    EepromJob *job;
+    EEPROM_Callback callback;
+    void *context;
+    uint8_t result;
+    
+    g_jobsRunning = true;
+    while(g_jobCount != 0U)
+    {
+        job = &g_jobs[g_jobFirst];
+        if(JobStart(job))
+        {
+            g_jobsRunning = false;
+            return;
+        }
+        
+        /* Free the entry before the callback, which may queue another job */
+        callback = job->callback;
+        context = job->context;
+        result = job->result;
+        if(result != EEPROM_SUCCESS)
+        {
+            g_jobFailed = true;
+        }
+        g_jobFirst = (uint8_t)((g_jobFirst + 1U) % EEPROM_QUEUE_JOBS);
+        g_jobCount--;
+        if(callback != 0)
+        {
+            callback(result, context);
+        }
+    }
+    g_jobsRunning = false;
+    
+    if(g_idleNotify != 0)
+    {
+        g_idleNotify();
+    }
+}
+
+/*
+ * EEPROM_ISR
+ * EEPROM done interrupt: the word in progress is programmed (or failed);
+ * go on with the next one.
+ */
+static void EEPROM_ISR(void)
+{
+    EepromJob *job;
+    
+    EEPROMIntClear(EEPROM_INT_PROGRAM);
+    if(g_jobCount == 0U)
+    {
+        return;
+    }
+    
+    job = &g_jobs[g_jobFirst];
+    if(EEPROMStatusGet() != 0U)
+    {
+        job->result = EEPROM_ERROR;
+        job->done = job->words;
+    }
+    else
+    {
+        job->done++;
+    }
+    
+    JobsRun();
+}
+
+/*
+ * JobQueue
+ * Appends a job, waiting while the queue is full, and starts it if the
+ * EEPROM is idle. From a job callback it only appends, and fails rather
+ * than wait: the callback runs in the interrupt handler, or with
+ * interrupts masked.
+ * Returns: EEPROM_SUCCESS, or EEPROM_ERROR if a callback found the
+ *          queue full
+ */
+static uint8_t JobQueue(const EepromJob *job)
+{
+    bool wasMasked;
+    
+    if(g_jobsRunning)
+    {
+        if(JobsFull())
+        {
+            return EEPROM_ERROR;
+        }
+    }
+    else
+    {
+        SleepWhile(JobsFull);
+    }
+    
+    wasMasked = IntMasterDisable();
+    g_jobs[(g_jobFirst + g_jobCount) % EEPROM_QUEUE_JOBS] = *job;
+    g_jobCount++;
+    if(g_jobCount == 1U && !g_jobsRunning)
+    {
+        JobsRun();
+    }
+    if(!wasMasked)
+    {
+        IntMasterEnable();
+    }
+    
+    return EEPROM_SUCCESS;
+}
+
+/*
+ * LogCrc
+ * CRC-32 of the tag and value words of a slot, a nibble at a time (16-word
+ * table), least significant byte of each word first as stored.
+ */
+static uint32_t LogCrc(const uint32_t *slot)
+{
+    uint32_t crc = LOG_CRC_INIT;
+    uint8_t i;
+    uint8_t bit;
+    
+    for(i = 0; i < LOG_WORD_CRC; i++)
+    {
+        for(bit = 0; bit < 32U; bit += 4U)
+        {
+            crc = g_crcTable[(crc ^ (slot[i] >> bit)) & 0x0FU] ^ (crc >> 4);
+        }
+    }
+    
+    return ~crc;
+}
+
+/*
+ * LogIsLive
+ * True if a slot holds the newest programmed record of some key, or a
+ * record still being appended.
+ */
+static bool LogIsLive(uint8_t slot)
+{
+    uint8_t key;
+    uint8_t i;
+    
+    for(key = 0; key < EEPROM_LOG_KEYS; key++)
+    {
+        if(g_logIndex[key].slot == slot)
+        {
+            return true;
+        }
+    }
+    for(i = 0; i < LOG_APPENDS; i++)
+    {
+        if(g_logAppends[i].used && g_logAppends[i].slot == slot)
+        {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/*
+ * LogNewestAppend
+ * The newest append of a key still in flight, or 0 if there is none.
+ */
+static const LogAppend *LogNewestAppend(uint8_t key)
+{
+    const LogAppend *newest = 0;
+    uint8_t i;
+    
+    for(i = 0; i < LOG_APPENDS; i++)
+    {
+        const LogAppend *append = &g_logAppends[i];
+        
+        if(append->used && append->key == key && append->format == g_logFormats &&
+           (newest == 0 || append->seq > newest->seq))
+        {
+            newest = append;
+        }
+    }
+    
+    return newest;
+}
+
+/*
+ * LogAppended
+ * EEPROM callback of an append: a programmed record becomes the key's
+ * newest in the index, a failed one is dropped and the previous record
+ * stays in force. Then the caller's callback runs.
+ */
+static void LogAppended(uint8_t result, void *context)
+{
+    LogAppend *append = (LogAppend *)context;
+    LogEntry *entry = &g_logIndex[append->key];
+    EEPROM_Callback callback = append->callback;
+    void *callbackContext = append->context;
+    uint8_t i;
+    
+    if(result == EEPROM_SUCCESS && append->format == g_logFormats &&
+       (entry->slot == LOG_NO_SLOT || append->seq > entry->seq))
+    {
+        entry->seq = append->seq;
+        entry->slot = append->slot;
+        entry->words = append->words;
+        for(i = 0; i < EEPROM_LOG_MAX_WORDS; i++)
+        {
+            entry->value[i] = append->value[i];
+        }
+    }
+    append->used = false;
+    g_logChanges++;
+    
+    if(callback != 0)
+    {
+        callback(result, callbackContext);
+    }
+}
+
+/*
+ * LogNext
+ * The slot after slot, wrapping round.
+ */
+static uint8_t LogNext(uint8_t slot)
+{
+    return (uint8_t)((slot + 1U) % EEPROM_LOG_SLOTS);
+}
+
+/*
+ * LogReset
+ * Empties the RAM index.
+ */
+static void LogReset(void)
+{
+    uint8_t key;
+    
+    for(key = 0; key < EEPROM_LOG_KEYS; key++)
+    {
+        g_logIndex[key].seq = 0;
+        g_logIndex[key].slot = LOG_NO_SLOT;
+        g_logIndex[key].words = 0;
+    }
+    g_logHead = LOG_FIRST_SLOT;
+    g_logSeq = 1;
+    g_logFormats++;     /* Appends in flight no longer update the index */
+}
+
 /******************************************************************************
  *                          Public Functions                                   *
  ******************************************************************************/
@@ -68,6 +524,11 @@ uint8_t EEPROM_Init(void)
         return EEPROM_ERROR;
     }
     
+    /* Write queue: the done interrupt starts each next word */
+    IntRegister(INT_FLASH, EEPROM_ISR);
+    EEPROMIntEnable(EEPROM_INT_PROGRAM);
+    IntEnable(INT_FLASH);
+    
     return EEPROM_SUCCESS;
 }
 
@@ -89,6 +550,9 @@ uint8_t EEPROM_WriteWord(uint32_t block, uint32_t offset, uint32_t data)
     /* Calculate byte address */
     address = CalculateAddress(block, offset);
     
+    /* After any queued job */
+    SleepWhile(JobsPending);
+    
     /* Write data using TivaWare function */
     result = EEPROMProgram(&data, address, sizeof(uint32_t));
     
@@ -117,6 +581,9 @@ uint8_t EEPROM_ReadWord(uint32_t block, uint32_t offset, uint32_t *data)
     /* Calculate byte address */
     address = CalculateAddress(block, offset);
     
+    /* After any queued job */
+    SleepWhile(JobsPending);
+    
     /* Read data using TivaWare function */
     EEPROMRead(data, address, sizeof(uint32_t));
     
@@ -146,6 +613,9 @@ uint8_t EEPROM_WriteBuffer(uint32_t block, uint32_t offset, const uint8_t *buffe
     /* Calculate starting byte address */
     address = CalculateAddress(block, offset);
     
+    /* After any queued job */
+    SleepWhile(JobsPending);
+    
     /* Write buffer using TivaWare function */
     /* Note: EEPROMProgram accepts uint32_t* so we cast, but data must be word-aligned */
     result = EEPROMProgram((uint32_t*)buffer, address, length);
@@ -180,6 +650,9 @@ uint8_t EEPROM_ReadBuffer(uint32_t block, uint32_t offset, uint8_t *buffer, uint
     /* Calculate starting byte address */
     address = CalculateAddress(block, offset);
     
+    /* After any queued job */
+    SleepWhile(JobsPending);
+    
     /* Read buffer using TivaWare function */
     EEPROMRead((uint32_t*)buffer, address, length);
     
@@ -194,6 +667,9 @@ uint8_t EEPROM_MassErase(void)
 {
     uint32_t result;
     
+    /* After any queued job */
+    SleepWhile(JobsPending);
+    
     /* Erase using TivaWare function */
     result = EEPROMMassErase();
     
@@ -204,3 +680,357 @@ uint8_t EEPROM_MassErase(void)
     
     return EEPROM_SUCCESS;
 }
+
+/*
+ * EEPROM_QueueWrite
+ * Copies the words into a write job.
+ */
+uint8_t EEPROM_QueueWrite(uint32_t block, uint32_t offset, const uint32_t *data, uint8_t words,
+                          EEPROM_Callback done, void *context)
+{
+    EepromJob job;
+    uint8_t i;
+    
+    /* Validate parameters */
+    if(data == 0 || words == 0 || words > EEPROM_JOB_MAX_WORDS ||
+       block >= EEPROM_TOTAL_BLOCKS || offset >= EEPROM_BLOCK_SIZE ||
+       ((block * EEPROM_BLOCK_SIZE) + offset + words) > EEPROM_TOTAL_WORDS)
+    {
+        return EEPROM_ERROR;
+    }
+    
+    job.kind = JOB_WRITE;
+    job.result = EEPROM_SUCCESS;
+    job.done = 0;
+    job.words = words;
+    job.first = (uint16_t)((block * EEPROM_BLOCK_SIZE) + offset);
+    for(i = 0; i < words; i++)
+    {
+        job.data[i] = data[i];
+    }
+    job.callback = done;
+    job.context = context;
+    
+    return JobQueue(&job);
+}
+
+/*
+ * EEPROM_QueueErase
+ * Queues an erase job; erased words are skipped when the job reaches them.
+ */
+uint8_t EEPROM_QueueErase(uint32_t block, uint32_t offset, uint32_t words,
+                          EEPROM_Callback done, void *context)
+{
+    EepromJob job;
+    
+    /* Validate parameters */
+    if(words == 0 || words > EEPROM_TOTAL_WORDS ||
+       block >= EEPROM_TOTAL_BLOCKS || offset >= EEPROM_BLOCK_SIZE)
+    {
+        return EEPROM_ERROR;
+    }
+    
+    job.kind = JOB_ERASE;
+    job.result = EEPROM_SUCCESS;
+    job.done = 0;
+    job.words = (uint16_t)words;
+    job.first = (uint16_t)((block * EEPROM_BLOCK_SIZE) + offset);
+    job.callback = done;
+    job.context = context;
+    
+    return JobQueue(&job);
+}
+
+bool EEPROM_IsBusy(void)
+{
+    return JobsPending();
+}
+
+/*
+ * EEPROM_Sync
+ * Sleeps until the queue drains and reports any failed job.
+ */
+uint8_t EEPROM_Sync(void)
+{
+    SleepWhile(JobsPending);
+    
+    if(g_jobFailed)
+    {
+        g_jobFailed = false;
+        return EEPROM_ERROR;
+    }
+    
+    return EEPROM_SUCCESS;
+}
+
+void EEPROM_SetIdleCallback(EEPROM_IdleCallback onIdle)
+{
+    g_idleNotify = onIdle;
+}
+
+/*
+ * EEPROM_LogMount
+ * Reads the EEPROM one block at a time and indexes the newest valid
+ * record of each key. Writing resumes after the newest record of all.
+ */
+uint8_t EEPROM_LogMount(void)
+{
+    uint32_t words[EEPROM_BLOCK_SIZE];
+    uint32_t newest = 0;
+    uint32_t block;
+    uint8_t i;
+    
+    LogReset();
+    
+    for(block = 0; block < EEPROM_TOTAL_BLOCKS; block++)
+    {
+        if(EEPROM_ReadBuffer(block, 0, (uint8_t*)words, sizeof(words)) != EEPROM_SUCCESS)
+        {
+            return EEPROM_ERROR;
+        }
+        
+        for(i = 0; i < LOG_SLOTS_PER_BLOCK; i++)
+        {
+            const uint32_t *slot = &words[i * EEPROM_LOG_SLOT_WORDS];
+            uint32_t seq = LOG_TAG_SEQ(slot[LOG_WORD_TAG]);
+            uint8_t key = LOG_TAG_KEY(slot[LOG_WORD_TAG]);
+            LogEntry *entry;
+            
+            /* Free slot: erased, cut off before its CRC word, or not a record */
+            if(seq == LOG_SEQ_MASK || slot[LOG_WORD_CRC] != LogCrc(slot))
+            {
+                continue;
+            }
+            
+            entry = &g_logIndex[key];
+            if(entry->slot == LOG_NO_SLOT || seq > entry->seq)
+            {
+                entry->seq = seq;
+                entry->slot = (uint8_t)((block * LOG_SLOTS_PER_BLOCK) + i);
+                entry->words = LOG_TAG_WORDS(slot[LOG_WORD_TAG]);
+                entry->value[0] = slot[LOG_WORD_VALUE];
+                entry->value[1] = slot[LOG_WORD_VALUE + 1];
+            }
+            
+            if(seq >= newest)
+            {
+                newest = seq;
+                g_logHead = LogNext((uint8_t)((block * LOG_SLOTS_PER_BLOCK) + i));
+                g_logSeq = seq + 1U;
+            }
+        }
+    }
+    
+    return EEPROM_SUCCESS;
+}
+
+/*
+ * EEPROM_LogGet
+ * Answers from the newest append in flight, else from the RAM index.
+ * Copies again if an append landed meanwhile, rather than mask
+ * interrupts, so a lookup costs no more than the copy.
+ */
+uint8_t EEPROM_LogGet(uint8_t key, uint32_t *value, uint8_t words)
+{
+    const LogAppend *append;
+    const uint32_t *newest = 0;
+    uint32_t changes;
+    uint8_t length;
+    uint8_t i;
+    
+    if(key >= EEPROM_LOG_KEYS || value == 0)
+    {
+        return 0;
+    }
+    
+    do
+    {
+        changes = g_logChanges;
+        length = 0;
+        append = LogNewestAppend(key);
+        if(append != 0)
+        {
+            newest = append->value;
+            length = append->words;
+        }
+        else if(g_logIndex[key].slot != LOG_NO_SLOT)
+        {
+            newest = g_logIndex[key].value;
+            length = g_logIndex[key].words;
+        }
+        for(i = 0; i < length && i < words; i++)
+        {
+            value[i] = newest[i];
+        }
+    } while(changes != g_logChanges);
+    
+    return length;
+}
+
+/*
+ * EEPROM_LogPut
+ * Queues the record and waits for it.
+ */
+uint8_t EEPROM_LogPut(uint8_t key, const uint32_t *value, uint8_t words)
+{
+    if(EEPROM_LogPutAsync(key, value, words, 0, 0) != EEPROM_SUCCESS)
+    {
+        return EEPROM_ERROR;
+    }
+    
+    return EEPROM_Sync();
+}
+
+/*
+ * EEPROM_LogPutAsync
+ * Queues the whole slot as one write job, CRC word last. A reset before
+ * the CRC word is programmed leaves the previous value in force; so does
+ * a failed write, as the index only moves to the slot once it is
+ * programmed (LogAppended()).
+ */
+uint8_t EEPROM_LogPutAsync(uint8_t key, const uint32_t *value, uint8_t words,
+                           EEPROM_Callback done, void *context)
+{
+    uint32_t slot[EEPROM_LOG_SLOT_WORDS];
+    LogAppend *append = 0;
+    uint8_t target;
+    uint8_t i;
+    bool wasMasked;
+    
+    if(key >= EEPROM_LOG_KEYS || value == 0 || words == 0 || words > EEPROM_LOG_MAX_WORDS ||
+       g_logSeq >= LOG_SEQ_MASK)
+    {
+        return EEPROM_ERROR;
+    }
+    
+    wasMasked = IntMasterDisable();
+    for(i = 0; i < LOG_APPENDS && append == 0; i++)
+    {
+        if(!g_logAppends[i].used)
+        {
+            append = &g_logAppends[i];
+        }
+    }
+    if(append == 0)
+    {
+        if(!wasMasked)
+        {
+            IntMasterEnable();
+        }
+        return EEPROM_ERROR;
+    }
+    
+    /* Never overwrite a key's newest record, nor one being appended; at
+     * most EEPROM_LOG_KEYS + LOG_APPENDS are live, so a free slot is
+     * always close */
+    target = g_logHead;
+    while(LogIsLive(target))
+    {
+        target = LogNext(target);
+    }
+    
+    slot[LOG_WORD_TAG] = LOG_TAG(key, words, g_logSeq);
+    slot[LOG_WORD_VALUE] = value[0];
+    slot[LOG_WORD_VALUE + 1] = (words > 1U) ? value[1] : LOG_ERASED;
+    slot[LOG_WORD_CRC] = LogCrc(slot);
+    
+    append->key = key;
+    append->slot = target;
+    append->words = words;
+    append->format = g_logFormats;
+    append->seq = g_logSeq;
+    for(i = 0; i < EEPROM_LOG_MAX_WORDS; i++)
+    {
+        append->value[i] = slot[LOG_WORD_VALUE + i];
+    }
+    append->callback = done;
+    append->context = context;
+    append->used = true;
+    g_logChanges++;
+    if(!wasMasked)
+    {
+        IntMasterEnable();
+    }
+    
+    if(EEPROM_QueueWrite(target / LOG_SLOTS_PER_BLOCK,
+                         (target % LOG_SLOTS_PER_BLOCK) * EEPROM_LOG_SLOT_WORDS,
+                         slot, EEPROM_LOG_SLOT_WORDS, LogAppended, append) != EEPROM_SUCCESS)
+    {
+        append->used = false;
+        return EEPROM_ERROR;
+    }
+    
+    g_logHead = LogNext(target);
+    g_logSeq++;
+    
+    return EEPROM_SUCCESS;
+}
+
+/*
+ * EEPROM_LogCompact
+ * Re-appends the first newest-of-its-key record found in the next
+ * EEPROM_LOG_COMPACT_AHEAD slots, unless a newer one of the key is being
+ * appended already.
+ */
+bool EEPROM_LogCompact(void)
+{
+    uint32_t value[EEPROM_LOG_MAX_WORDS];
+    uint8_t slot = g_logHead;
+    uint8_t words;
+    uint8_t n;
+    uint8_t key;
+    
+    for(n = 0; n < EEPROM_LOG_COMPACT_AHEAD; n++)
+    {
+        for(key = 0; key < EEPROM_LOG_KEYS; key++)
+        {
+            if(g_logIndex[key].slot == slot && LogNewestAppend(key) == 0)
+            {
+                words = EEPROM_LogGet(key, value, EEPROM_LOG_MAX_WORDS);
+                return words != 0U &&
+                       EEPROM_LogPutAsync(key, value, words, 0, 0) == EEPROM_SUCCESS;
+            }
+        }
+        slot = LogNext(slot);
+    }
+    
+    return false;
+}
+
+/*
+ * EEPROM_LogFormat
+ * Queues the erase and waits for it.
+ */
+uint8_t EEPROM_LogFormat(void)
+{
+    if(EEPROM_LogFormatAsync(0, 0) != EEPROM_SUCCESS)
+    {
+        return EEPROM_ERROR;
+    }
+    
+    return EEPROM_Sync();
+}
+
+/*
+ * EEPROM_LogFormatAsync
+ * Erases word by word from the write position round, so the oldest
+ * records go first and the newest last. Block 0 words 0-3 go before
+ * everything unless they hold a live record: if they still hold the
+ * settings of earlier firmware, an empty log must not find them there.
+ */
+uint8_t EEPROM_LogFormatAsync(EEPROM_Callback done, void *context)
+{
+    uint8_t head = g_logHead;
+    
+    if(!LogIsLive(0) &&
+       EEPROM_QueueErase(0, 0, EEPROM_LOG_SLOT_WORDS, 0, 0) != EEPROM_SUCCESS)
+    {
+        return EEPROM_ERROR;
+    }
+    
+    LogReset();
+    
+    return EEPROM_QueueErase(head / LOG_SLOTS_PER_BLOCK,
+                             (head % LOG_SLOTS_PER_BLOCK) * EEPROM_LOG_SLOT_WORDS,
+                             EEPROM_TOTAL_WORDS, done, context);
+}
@@ -10,6 +10,8 @@
  *   - EEPROMProgram(pui32Data, ui32Address, ui32Count)
  *   - EEPROMRead(pui32Data, ui32Address, ui32Count)
  *   - EEPROMMassErase()
+ *   - EEPROMProgramNonBlocking(), EEPROMIntEnable(), EEPROMIntClear()
+ *     and EEPROMStatusGet() for the write queue
  * 
  * Required TivaWare includes (in eeprom.c):
  *   - inc/hw_memmap.h
@@ -22,6 +24,34 @@
  *   - Organized as 32 blocks of 16 words (64 bytes) each
  *   - Word size: 32 bits (4 bytes)
  *   - Access: Word-aligned addresses only
+ * 
+ * Write queue (EEPROM_Queue* functions):
+ *   Writes are queued as jobs and programmed one word at a time with
+ *   EEPROMProgramNonBlocking(); the EEPROM done interrupt (INT_FLASH)
+ *   starts the next word, so the CPU is free while a job runs. Jobs run
+ *   in the order they were queued, and each may name a callback that runs
+ *   once its last word is programmed. The blocking functions below first
+ *   wait for the queue to drain, so they never interleave with a job.
+ * 
+ * Record log (EEPROM_Log* functions):
+ *   Small values are kept as versioned records appended round-robin over
+ *   all 32 blocks, instead of rewriting the same words, so program cycles
+ *   are spread over the whole EEPROM. Each record fills a 4-word slot:
+ *     word 0    - key (bits 31-29), length - 1 (bit 28) and sequence
+ *                 number (27-0); the newest record of a key wins
+ *     word 1-2  - value
+ *     word 3    - CRC-32 of words 0-2
+ *   The CRC word is programmed last and commits the record: a slot whose
+ *   CRC does not match (erased, or cut off by a reset) is free, and the
+ *   key's previous record, which an append never overwrites, stays in
+ *   force. EEPROM_LogMount() scans the slots once and keeps a RAM index of
+ *   the newest record of each key, so EEPROM_LogGet() never touches the
+ *   EEPROM. Appends skip slots that hold a key's newest record;
+ *   EEPROM_LogCompact() moves such records out of the way ahead of the
+ *   write position, so in steady state every slot is written in turn.
+ *   Appends go through the write queue: the index moves to a record when
+ *   it is queued, and since jobs run in order the key's previous record
+ *   is not overwritten before the new one is programmed.
  *****************************************************************************/
 
 #ifndef EEPROM_H_
@@ -44,6 +74,31 @@
 #define EEPROM_TOTAL_BLOCKS     32      /* 32 blocks total */
 #define EEPROM_TOTAL_SIZE       2048    /* 2KB total */
 
+/* Record log */
+#define EEPROM_LOG_SLOT_WORDS   4       /* Words per record slot */
+#define EEPROM_LOG_SLOTS        128     /* All 32 blocks */
+#define EEPROM_LOG_MAX_WORDS    2       /* Value words per record */
+#define EEPROM_LOG_KEYS         8       /* Keys 0-7 */
+#define EEPROM_LOG_COMPACT_AHEAD 4      /* Slots kept free ahead of the write position */
+
+/* Write queue */
+#define EEPROM_QUEUE_JOBS       4       /* Jobs queued or running at a time */
+#define EEPROM_JOB_MAX_WORDS    4       /* Words per write job (one log slot) */
+
+/*
+ * Called from the EEPROM interrupt when a queued job has finished, with
+ * EEPROM_SUCCESS or EEPROM_ERROR. An erase that finds nothing to erase
+ * on an idle EEPROM calls back before EEPROM_QueueErase() returns. A
+ * callback may queue further jobs; the job it finishes has already left
+ * the queue, so one always fits, and queueing from a callback never waits
+ * (it fails with EEPROM_ERROR if the queue is full).
+ */
+typedef void (*EEPROM_Callback)(uint8_t result, void *context);
+
+/* Called from the EEPROM interrupt when the last queued job has finished;
+ * must not queue jobs */
+typedef void (*EEPROM_IdleCallback)(void);
+
 /******************************************************************************
  *                          Function Prototypes                                *
  ******************************************************************************/
@@ -108,4 +163,136 @@ uint8_t EEPROM_ReadBuffer(uint32_t block, uint32_t offset, uint8_t *buffer, uint
  */
 uint8_t EEPROM_MassErase(void);
 
+/*
+ * EEPROM_QueueWrite
+ * Queues words to be programmed in the background, in address order.
+ * Waits only while the queue is full. Not for use from an interrupt
+ * handler, other than a job callback (EEPROM_Callback).
+ * Parameters:
+ *   block   - Starting block number (0-31)
+ *   offset  - Starting word offset within block (0-15)
+ *   data    - Words to write (copied)
+ *   words   - Number of words, 1 to EEPROM_JOB_MAX_WORDS
+ *   done    - Called when the words are programmed (may be 0)
+ *   context - Passed to done
+ * Returns: EEPROM_SUCCESS if queued, EEPROM_ERROR on bad parameters or
+ *          a full queue seen from a callback
+ */
+uint8_t EEPROM_QueueWrite(uint32_t block, uint32_t offset, const uint32_t *data, uint8_t words,
+                          EEPROM_Callback done, void *context);
+
+/*
+ * EEPROM_QueueErase
+ * Queues an erase of words words, one word at a time, starting at
+ * block/offset and wrapping round after the last word. Words already
+ * erased are skipped. Unlike EEPROMMassErase() the CPU is not held up,
+ * and the caller chooses which words go last.
+ * Parameters:
+ *   block   - Starting block number (0-31)
+ *   offset  - Starting word offset within block (0-15)
+ *   words   - Number of words, up to the whole EEPROM
+ *   done    - Called when the words are erased (may be 0)
+ *   context - Passed to done
+ * Returns: EEPROM_SUCCESS if queued, EEPROM_ERROR on bad parameters or
+ *          a full queue seen from a callback
+ */
+uint8_t EEPROM_QueueErase(uint32_t block, uint32_t offset, uint32_t words,
+                          EEPROM_Callback done, void *context);
+
+/*
+ * EEPROM_IsBusy
+ * True while a queued job has not finished.
+ */
+bool EEPROM_IsBusy(void);
+
+/*
+ * EEPROM_Sync
+ * Sleeps until every queued job has finished.
+ * Returns: EEPROM_ERROR if a job failed since the last call, else
+ *          EEPROM_SUCCESS
+ */
+uint8_t EEPROM_Sync(void);
+
+/*
+ * EEPROM_SetIdleCallback
+ * Registers a function called when the queue drains (0 to remove).
+ */
+void EEPROM_SetIdleCallback(EEPROM_IdleCallback onIdle);
+
+/*
+ * EEPROM_LogMount
+ * Scans every record slot and rebuilds the RAM index. Call once after
+ * EEPROM_Init(), and again to pick up changes made behind the log's back.
+ * Returns: EEPROM_SUCCESS on success, EEPROM_ERROR on failure
+ */
+uint8_t EEPROM_LogMount(void);
+
+/*
+ * EEPROM_LogGet
+ * Copies the newest value of a key from the RAM index.
+ * Parameters:
+ *   key   - Key (0 to EEPROM_LOG_KEYS - 1)
+ *   value - Buffer for the value
+ *   words - Size of the buffer in words
+ * Returns: Length of the value in words, 0 if the key has no record
+ */
+uint8_t EEPROM_LogGet(uint8_t key, uint32_t *value, uint8_t words);
+
+/*
+ * EEPROM_LogPut
+ * Appends a record for a key at the write position. Returns once the
+ * EEPROM has programmed it; the previous record of the key is superseded.
+ * Parameters:
+ *   key   - Key (0 to EEPROM_LOG_KEYS - 1)
+ *   value - Value words
+ *   words - Length of the value (1 to EEPROM_LOG_MAX_WORDS)
+ * Returns: EEPROM_SUCCESS on success, EEPROM_ERROR on failure
+ */
+uint8_t EEPROM_LogPut(uint8_t key, const uint32_t *value, uint8_t words);
+
+/*
+ * EEPROM_LogPutAsync
+ * As EEPROM_LogPut(), but returns once the record is queued;
+ * EEPROM_LogGet() sees it at once. The key's previous record keeps its
+ * slot until the new one is programmed, and stays in force if that
+ * fails.
+ * Parameters:
+ *   done    - Called when the record is programmed (may be 0)
+ *   context - Passed to done
+ * Returns: EEPROM_SUCCESS if queued, EEPROM_ERROR on bad parameters or
+ *          a full queue seen from a callback
+ */
+uint8_t EEPROM_LogPutAsync(uint8_t key, const uint32_t *value, uint8_t words,
+                           EEPROM_Callback done, void *context);
+
+/*
+ * EEPROM_LogCompact
+ * One step of background compaction: if a key's newest record lies in the
+ * next EEPROM_LOG_COMPACT_AHEAD slots, queues a copy of it so the slot
+ * can be reused. Call while idle until it returns false.
+ * Returns: true if a record was moved (more work may remain)
+ */
+bool EEPROM_LogCompact(void);
+
+/*
+ * EEPROM_LogFormat
+ * Erases the EEPROM and empties the log. Returns once the EEPROM is
+ * erased.
+ * Returns: EEPROM_SUCCESS on success, EEPROM_ERROR on failure
+ */
+uint8_t EEPROM_LogFormat(void);
+
+/*
+ * EEPROM_LogFormatAsync
+ * As EEPROM_LogFormat(), but returns once the erase is queued; the log
+ * is empty at once. Records are erased oldest first, so a reset part way
+ * through leaves each key at its newest value or with no record, never
+ * at an older value.
+ * Parameters:
+ *   done    - Called when the EEPROM is erased (may be 0)
+ *   context - Passed to done
+ * Returns: EEPROM_SUCCESS if queued, EEPROM_ERROR on failure
+ */
+uint8_t EEPROM_LogFormatAsync(EEPROM_Callback done, void *context);
+
 #endif /* EEPROM_H_ */
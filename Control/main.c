@@ -4,11 +4,11 @@
  * Description: Smart Door Lock System - Control Application
  * 
  * System Features:
- *   - Password storage and verification (EEPROM)
+ *   - Password storage and verification (EEPROM, cached by config.c)
  *   - Motor control for door lock/unlock
  *   - Buzzer alarm for security
  *   - Auto-lock timeout configuration
- *   - Communication with HMI ECU via UART5
+ *   - Communication with HMI ECU via UART5 (framed, see protocol.h)
  ******************************************************************************/
 
 #include <stdint.h>
@@ -16,83 +16,91 @@
 #include <string.h>
 #include "uart.h"
 #include "eeprom.h"
+#include "config.h"
 #include "motor.h"
+#include "door.h"
 #include "buzzer.h"
 #include "systick.h"
+#include "sched.h"
+#include "protocol.h"
 
 /******************************************************************************
  *                              Definitions                                    *
  ******************************************************************************/
 
-/* UART Communication Commands */
-#define CMD_SETUP_PASSWORD      0x01
-#define CMD_VERIFY_PASSWORD     0x02
-#define CMD_CHANGE_PASSWORD     0x03
-#define CMD_SET_TIMEOUT         0x04
-#define CMD_OPEN_DOOR           0x05
-#define CMD_ERASE_EEPROM        0x06
-#define CMD_CHECK_PASSWORD      0x07
-#define CMD_TRIGGER_LOCKOUT     0x08
-
-/* UART Response Codes */
-#define RESP_PASSWORD_MATCH     0x10
-#define RESP_PASSWORD_MISMATCH  0x11
-#define RESP_TIMEOUT_SAVED      0x12
-#define RESP_DOOR_UNLOCKING     0x13
-#define RESP_DOOR_LOCKING       0x14
-#define RESP_DOOR_LOCKED        0x15
-#define RESP_SYSTEM_LOCKED      0x16
-#define RESP_EEPROM_ERASED      0x17
-#define RESP_PASSWORD_EXISTS    0x18
-#define RESP_NO_PASSWORD        0x19
-#define RESP_COUNTDOWN_START    0x1A
-
 /* Password Configuration */
-#define PASSWORD_LENGTH         5
 #define MAX_ATTEMPTS            3
 
-/* EEPROM Memory Map */
-#define EEPROM_PASSWORD_BLOCK   0
-#define EEPROM_PASSWORD_OFFSET  0
-#define EEPROM_TIMEOUT_BLOCK    0
-#define EEPROM_TIMEOUT_OFFSET   2
-#define EEPROM_VALID_FLAG_BLOCK 0
-#define EEPROM_VALID_FLAG_OFFSET 3
-#define PASSWORD_VALID_MARKER   0xAA55AA55
-
 /* Default Settings */
-#define DEFAULT_TIMEOUT         5   /* 5 seconds default */
 #define LOCKOUT_DURATION        10  /* 10 seconds lockout after 3 failed attempts */
 
+/* Tasks, by priority (highest first) */
+#define TASK_LINK               3   /* Parses and handles requests */
+#define TASK_DOOR               2   /* Door state machine and motor */
+#define TASK_BUZZER             1   /* Lockout alarm tone */
+#define TASK_STORE              0   /* Save confirmations, log compaction */
+
+/* Task events */
+#define EVENT_RX                0x01U   /* UART5 received bytes */
+#define EVENT_TICK              0x02U   /* Periodic timer */
+#define EVENT_COMPACT           0x04U   /* EEPROM write queue drained */
+#define EVENT_STORED            0x08U   /* A queued settings write finished */
+
+#define TICK_MS                 1   /* Door state machine step */
+
+/* Settings writes awaiting their RESP_STORED */
+#define MAX_STORES              EEPROM_QUEUE_JOBS
+
+/* A request answered before its settings write finished */
+typedef struct {
+    bool used;
+    volatile bool done;     /* Set from the EEPROM interrupt */
+    uint8_t seq;
+    uint8_t result;
+} PendingStore;
+
 /******************************************************************************
  *                          Global Variables                                   *
  ******************************************************************************/
 
-static char g_storedPassword[PASSWORD_LENGTH + 1];
-static uint8_t g_autoLockTimeout = DEFAULT_TIMEOUT;
+static Proto_Parser g_rxParser;
+static uint8_t g_doorSeq;     /* Request whose door cycle is running */
+static Timer_Id g_alarmTimer = TIMER_NONE;
+static PendingStore g_stores[MAX_STORES];
 
 /******************************************************************************
  *                          Function Prototypes                                *
  ******************************************************************************/
 
-void ReceivePassword(char *password);
+static bool ReadPassword(const Proto_Frame *request, uint8_t offset, char *password);
+static void SendResponse(uint8_t seq, uint8_t type, const uint8_t *payload, uint8_t length);
+static void ServiceLink(void);
+static void DispatchCommand(const Proto_Frame *request);
+static void OnDoorEvent(Door_Event event, uint8_t secondsLeft);
+static void OnUartRx(void);
+static bool OnTick(void *context);
+static bool OnAlarmEdge(void *context);
+static void LinkTask(uint32_t events);
+static void DoorTask(uint32_t events);
+static void BuzzerTask(uint32_t events);
+static void StoreTask(uint32_t events);
+static void OnStored(uint8_t result, void *context);
+static void OnEepromIdle(void);
+static void SendStored(uint8_t seq, uint8_t result);
+static void SaveSettings(const Proto_Frame *request, uint8_t response, bool erase);
 bool VerifyPassword(const char *password);
-void SavePassword(const char *password);
-void LoadPassword(void);
-void LoadTimeout(void);
-void SaveTimeout(uint8_t timeout);
 bool IsPasswordValid(void);
-void MarkPasswordAsValid(void);
-void HandleCheckPassword(void);
-void HandleSetupPassword(void);
-void HandleChangePassword(void);
-void HandleSetTimeout(void);
-void HandleOpenDoor(void);
-void HandleEraseEEPROM(void);
-void HandleTriggerLockout(void);
-void PerformDoorOperation(void);
-void TriggerLockout(void);
-void SendCountdown(uint8_t seconds);
+void HandleCheckPassword(const Proto_Frame *request);
+void HandleSetupPassword(const Proto_Frame *request);
+void HandleChangePassword(const Proto_Frame *request);
+void HandleSetTimeout(const Proto_Frame *request);
+void HandleOpenDoor(const Proto_Frame *request);
+void HandleEraseEEPROM(const Proto_Frame *request);
+void HandleTriggerLockout(const Proto_Frame *request);
+void HandleGetStatus(const Proto_Frame *request);
+void HandleLockNow(const Proto_Frame *request);
+void TriggerLockout(uint8_t seq);
+void SendCountdown(uint8_t seq, uint8_t seconds);
 
 /******************************************************************************
  *                          Main Application                                   *
@@ -100,63 +108,32 @@ void SendCountdown(uint8_t seconds);
 
 int main(void)
 {
-    uint8_t command;
-    
     /* Initialize all peripherals */
-    SysTick_Init(16000, SYSTICK_NOINT);
+    SysTick_Init(16000, SYSTICK_INT);   /* 1ms tick interrupt */
     UART5_Init();  
+    Proto_ParserInit(&g_rxParser);
     EEPROM_Init();
     Motor_Init();      /* Initialize motor first (PF0, PF4) */
     Buzzer_Init();     /* Initialize buzzer after motor (PF1) */
-    
-    /* Load stored password and timeout from EEPROM */
-    LoadPassword();
-    LoadTimeout();
-    
-    /* Main loop - wait for commands from HMI ECU */
-    while (1) {
-        /* Wait for command from HMI */
-        if (UART5_IsDataAvailable()) {
-            command = UART5_ReceiveChar();
-            
-            /* Process command */
-            switch (command) {
-                case CMD_CHECK_PASSWORD:
-                    HandleCheckPassword();
-                    break;
-                    
-                case CMD_SETUP_PASSWORD:
-                    HandleSetupPassword();
-                    break;
-                    
-                case CMD_CHANGE_PASSWORD:
-                    HandleChangePassword();
-                    break;
-                    
-                case CMD_SET_TIMEOUT:
-                    HandleSetTimeout();
-                    break;
-                    
-                case CMD_OPEN_DOOR:
-                    HandleOpenDoor();
-                    break;
-                    
-                case CMD_ERASE_EEPROM:
-                    HandleEraseEEPROM();
-                    break;
-                    
-                case CMD_TRIGGER_LOCKOUT:
-                    HandleTriggerLockout();
-                    break;
-                    
-                default:
-                    /* Unknown command - ignore */
-                    break;
-            }
-        }
-        
-        DelayMs(10);
-    }
+    Door_Init(OnDoorEvent);
+    
+    /* Load stored password and timeout from the EEPROM settings log; later
+     * reads hit RAM */
+    Config_Load();
+    
+    /* Tasks: the link wakes on received bytes, the door runs every tick */
+    Sched_Init();
+    (void)Sched_AddTask(TASK_LINK, LinkTask);
+    (void)Sched_AddTask(TASK_DOOR, DoorTask);
+    (void)Sched_AddTask(TASK_BUZZER, BuzzerTask);
+    (void)Sched_AddTask(TASK_STORE, StoreTask);
+    UART5_SetRxCallback(OnUartRx);
+    EEPROM_SetIdleCallback(OnEepromIdle);
+    (void)Timer_Start(TICK_MS, OnTick, (void *)(uintptr_t)TASK_DOOR);
+    Sched_Post(TASK_LINK, EVENT_RX);    /* Bytes that arrived during start-up */
+    Sched_Post(TASK_STORE, EVENT_COMPACT);
+    
+    Sched_Run();
 }
 
 /******************************************************************************
@@ -164,127 +141,324 @@ int main(void)
  ******************************************************************************/
 
 /*
- * ReceivePassword
- * Receives a 5-character password from UART
+ * ReadPassword
+ * Copies a 5-character password out of a request payload
+ * Returns false if the payload is too short to hold it
  */
-void ReceivePassword(char *password)
+static bool ReadPassword(const Proto_Frame *request, uint8_t offset, char *password)
 {
-    uint8_t i;
-    uint16_t timeout;
-    
-    for (i = 0; i < PASSWORD_LENGTH; i++) {
-        timeout = 0;
-        
-        /* Wait for character with timeout */
-        while (!UART5_IsDataAvailable() && timeout < 1000) {
-            DelayMs(1);
-            timeout++;
-        }
-        
-        if (UART5_IsDataAvailable()) {
-            password[i] = UART5_ReceiveChar();
-        } else {
-            password[i] = '0'; /* Default on timeout */
-        }
+    if (request->length < offset + PASSWORD_LENGTH) {
+        return false;
     }
     
+    memcpy(password, &request->payload[offset], PASSWORD_LENGTH);
     password[PASSWORD_LENGTH] = '\0';
+    return true;
 }
 
 /*
- * VerifyPassword
- * Compares received password with stored password
- * Returns true if match, false otherwise
+ * SendResponse
+ * Sends one protocol frame to the HMI, tagged with the request's sequence
+ * number. The frame is copied into the TX ring, so this only sleeps if
+ * the ring is full.
  */
-bool VerifyPassword(const char *password)
+static void SendResponse(uint8_t seq, uint8_t type, const uint8_t *payload, uint8_t length)
 {
-    return (strcmp(password, g_storedPassword) == 0);
+    uint8_t frame[PROTO_MAX_FRAME];
+    uint8_t size = Proto_Encode(frame, seq, type, payload, length);
+    uint32_t queued = UART5_Write(frame, size);
+    
+    while (queued < size) {
+        UART5_SendChar((char)frame[queued++]);
+    }
 }
 
 /*
- * SavePassword
- * Saves password to EEPROM
+ * OnUartRx
+ * UART5 ISR callback: wakes the link task
  */
-void SavePassword(const char *password)
+static void OnUartRx(void)
 {
-    uint32_t data1, data2;
-    
-    /* Pack password into two 32-bit words */
-    data1 = ((uint32_t)password[0] << 24) | 
-            ((uint32_t)password[1] << 16) | 
-            ((uint32_t)password[2] << 8) | 
-            ((uint32_t)password[3]);
-    
-    data2 = ((uint32_t)password[4] << 24);
-    
-    /* Write to EEPROM */
-    EEPROM_WriteWord(EEPROM_PASSWORD_BLOCK, EEPROM_PASSWORD_OFFSET, data1);
-    DelayMs(10); /* Delay to ensure write completes */
-    EEPROM_WriteWord(EEPROM_PASSWORD_BLOCK, EEPROM_PASSWORD_OFFSET + 1, data2);
-    DelayMs(10); /* Delay to ensure write completes */
+    Sched_Post(TASK_LINK, EVENT_RX);
+}
+
+/*
+ * OnTick
+ * Timer callback: posts a tick to the task given as context
+ */
+static bool OnTick(void *context)
+{
+    Sched_Post((uint8_t)(uintptr_t)context, EVENT_TICK);
+    return true;
+}
+
+/*
+ * OnAlarmEdge
+ * One-shot timer callback: the alarm tone is due to switch
+ */
+static bool OnAlarmEdge(void *context)
+{
+    (void)context;
+    Sched_Post(TASK_BUZZER, EVENT_TICK);
+    return false;
+}
+
+/*
+ * LinkTask
+ * Handles every request received so far
+ */
+static void LinkTask(uint32_t events)
+{
+    (void)events;
+    ServiceLink();
+}
+
+/*
+ * DoorTask
+ * Steps the door state machine
+ */
+static void DoorTask(uint32_t events)
+{
+    (void)events;
+    Door_Update((uint32_t)Time_NowMs());
+}
+
+/*
+ * BuzzerTask
+ * Switches the lockout alarm tone at each edge of its pattern and waits
+ * for the next one
+ */
+static void BuzzerTask(uint32_t events)
+{
+    uint32_t step;
+    
+    (void)events;
+    step = Buzzer_Service();
+    g_alarmTimer = TIMER_NONE;
+    if (step != 0U) {
+        g_alarmTimer = Timer_Start(step, OnAlarmEdge, NULL);
+        if (g_alarmTimer == TIMER_NONE) {
+            Buzzer_Off();   /* No timer to end the tone: stay silent */
+        }
+    }
+}
+
+/*
+ * StoreTask
+ * Confirms finished settings writes to the HMI, then, while the EEPROM is
+ * idle, queues one settings record move out of the way of the log's write
+ * position; the queue draining runs it again until none is left
+ */
+static void StoreTask(uint32_t events)
+{
+    uint8_t i;
     
-    /* Mark password as valid */
-    MarkPasswordAsValid();
-    DelayMs(10); /* Delay to ensure write completes */
+    if ((events & EVENT_STORED) != 0U) {
+        for (i = 0; i < MAX_STORES; i++) {
+            if (g_stores[i].used && g_stores[i].done) {
+                SendStored(g_stores[i].seq, g_stores[i].result);
+                g_stores[i].used = false;
+            }
+        }
+    }
     
-    /* Update global variable */
-    strcpy(g_storedPassword, password);
+    if (!EEPROM_IsBusy()) {
+        (void)Config_Compact();
+    }
 }
 
 /*
- * LoadPassword
- * Loads password from EEPROM
+ * OnStored
+ * EEPROM callback of a queued settings write: hands the result to the
+ * store task
  */
-void LoadPassword(void)
+static void OnStored(uint8_t result, void *context)
 {
-    uint32_t data1, data2;
+    PendingStore *store = (PendingStore *)context;
     
-    /* Read from EEPROM */
-    EEPROM_ReadWord(EEPROM_PASSWORD_BLOCK, EEPROM_PASSWORD_OFFSET, &data1);
-    EEPROM_ReadWord(EEPROM_PASSWORD_BLOCK, EEPROM_PASSWORD_OFFSET + 1, &data2);
+    store->result = result;
+    store->done = true;
+    Sched_Post(TASK_STORE, EVENT_STORED);
+}
+
+/*
+ * OnEepromIdle
+ * EEPROM callback: the write queue is empty, time for compaction
+ */
+static void OnEepromIdle(void)
+{
+    Sched_Post(TASK_STORE, EVENT_COMPACT);
+}
+
+/*
+ * SendStored
+ * Confirms a settings write to the HMI
+ */
+static void SendStored(uint8_t seq, uint8_t result)
+{
+    uint8_t payload = (result == EEPROM_SUCCESS) ? STORED_OK : STORED_FAILED;
     
-    /* Unpack password */
-    g_storedPassword[0] = (char)((data1 >> 24) & 0xFF);
-    g_storedPassword[1] = (char)((data1 >> 16) & 0xFF);
-    g_storedPassword[2] = (char)((data1 >> 8) & 0xFF);
-    g_storedPassword[3] = (char)(data1 & 0xFF);
-    g_storedPassword[4] = (char)((data2 >> 24) & 0xFF);
-    g_storedPassword[5] = '\0';
+    SendResponse(seq, RESP_STORED, &payload, 1U);
 }
 
 /*
- * LoadTimeout
- * Loads auto-lock timeout from EEPROM
+ * SaveSettings
+ * Queues the changed settings (or the erase) and answers the request at
+ * once; RESP_STORED follows from the store task when the EEPROM has it.
+ * With every confirmation slot taken, writes and waits instead.
  */
-void LoadTimeout(void)
+static void SaveSettings(const Proto_Frame *request, uint8_t response, bool erase)
 {
-    uint32_t data;
+    PendingStore *store = NULL;
+    uint8_t result;
+    uint8_t i;
     
-    /* Read from EEPROM */
-    EEPROM_ReadWord(EEPROM_TIMEOUT_BLOCK, EEPROM_TIMEOUT_OFFSET, &data);
+    for (i = 0; i < MAX_STORES && store == NULL; i++) {
+        if (!g_stores[i].used) {
+            store = &g_stores[i];
+        }
+    }
     
-    g_autoLockTimeout = (uint8_t)(data & 0xFF);
+    if (store == NULL) {
+        result = erase ? Config_Erase() : Config_Flush();
+        SendResponse(request->seq, response, NULL, 0);
+        SendStored(request->seq, result);
+        return;
+    }
     
-    /* Validate range (5-30 seconds) */
-    if (g_autoLockTimeout < 5 || g_autoLockTimeout > 30) {
-        g_autoLockTimeout = DEFAULT_TIMEOUT;
+    store->used = true;
+    store->done = false;
+    store->seq = request->seq;
+    result = erase ? Config_EraseAsync(OnStored, store) : Config_FlushAsync(OnStored, store);
+    SendResponse(request->seq, response, NULL, 0);
+    if (result != EEPROM_SUCCESS) {
+        store->used = false;
+        SendStored(request->seq, result);
     }
 }
 
 /*
- * SaveTimeout
- * Saves auto-lock timeout to EEPROM
+ * ServiceLink
+ * Feeds received bytes to the frame parser and handles every complete
+ * request.
  */
-void SaveTimeout(uint8_t timeout)
+static void ServiceLink(void)
 {
-    uint32_t data = (uint32_t)timeout;
-    
-    /* Write to EEPROM */
-    EEPROM_WriteWord(EEPROM_TIMEOUT_BLOCK, EEPROM_TIMEOUT_OFFSET, data);
-    DelayMs(10); /* Delay to ensure write completes */
+    Proto_Frame request;
+    uint8_t byte;
+    
+    while (UART5_Read(&byte, 1U) == 1U) {
+        if (Proto_Parse(&g_rxParser, byte)) {
+            /* A resync can leave a further complete frame held */
+            do {
+                /* Copy: a handler may parse further frames while it runs */
+                request = g_rxParser.frame;
+                DispatchCommand(&request);
+            } while (Proto_ParsePending(&g_rxParser));
+        }
+    }
+}
+
+/*
+ * DispatchCommand
+ * Runs the handler for one request. During the door cycle only queries
+ * and an emergency lock are served; anything that would start another
+ * operation or stall the door task (EEPROM writes, the lockout alarm) is
+ * answered with RESP_BUSY.
+ */
+static void DispatchCommand(const Proto_Frame *request)
+{
+    if (Door_IsBusy() && request->type != CMD_GET_STATUS &&
+        request->type != CMD_CHECK_PASSWORD && request->type != CMD_LOCK_NOW) {
+        SendResponse(request->seq, RESP_BUSY, NULL, 0);
+        return;
+    }
     
-    /* Update global variable */
-    g_autoLockTimeout = timeout;
+    /* Process command */
+    switch (request->type) {
+        case CMD_CHECK_PASSWORD:
+            HandleCheckPassword(request);
+            break;
+            
+        case CMD_SETUP_PASSWORD:
+            HandleSetupPassword(request);
+            break;
+            
+        case CMD_CHANGE_PASSWORD:
+            HandleChangePassword(request);
+            break;
+            
+        case CMD_SET_TIMEOUT:
+            HandleSetTimeout(request);
+            break;
+            
+        case CMD_OPEN_DOOR:
+            HandleOpenDoor(request);
+            break;
+            
+        case CMD_ERASE_EEPROM:
+            HandleEraseEEPROM(request);
+            break;
+            
+        case CMD_TRIGGER_LOCKOUT:
+            HandleTriggerLockout(request);
+            break;
+            
+        case CMD_GET_STATUS:
+            HandleGetStatus(request);
+            break;
+            
+        case CMD_LOCK_NOW:
+            HandleLockNow(request);
+            break;
+            
+        default:
+            /* Unknown command - ignore */
+            break;
+    }
+}
+
+/*
+ * OnDoorEvent
+ * Door state machine listener: reports the cycle to the HMI under the
+ * sequence number of the open door request
+ */
+static void OnDoorEvent(Door_Event event, uint8_t secondsLeft)
+{
+    switch (event) {
+        case DOOR_EVENT_UNLOCKING:
+            SendResponse(g_doorSeq, RESP_DOOR_UNLOCKING, NULL, 0);
+            break;
+            
+        case DOOR_EVENT_OPEN:
+            SendResponse(g_doorSeq, RESP_COUNTDOWN_START, NULL, 0);
+            break;
+            
+        case DOOR_EVENT_COUNTDOWN:
+            SendCountdown(g_doorSeq, secondsLeft);
+            break;
+            
+        case DOOR_EVENT_LOCKING:
+            SendResponse(g_doorSeq, RESP_DOOR_LOCKING, NULL, 0);
+            break;
+            
+        case DOOR_EVENT_LOCKED:
+            SendResponse(g_doorSeq, RESP_DOOR_LOCKED, NULL, 0);
+            break;
+            
+        default:
+            break;
+    }
+}
+
+/*
+ * VerifyPassword
+ * Compares received password with stored password
+ * Returns true if match, false otherwise
+ */
+bool VerifyPassword(const char *password)
+{
+    return Config_HasPassword() && (strcmp(password, Config_GetPassword()) == 0);
 }
 
 /*
@@ -292,25 +466,21 @@ void SaveTimeout(uint8_t timeout)
  * Handles initial password setup command
  * Receives two passwords and compares them
  */
-void HandleSetupPassword(void)
+void HandleSetupPassword(const Proto_Frame *request)
 {
     char password1[PASSWORD_LENGTH + 1];
     char password2[PASSWORD_LENGTH + 1];
     
-    /* Receive both passwords */
-    ReceivePassword(password1);
-    DelayMs(50);
-    ReceivePassword(password2);
-    
-    /* Compare passwords */
-    if (strcmp(password1, password2) == 0) {
-        /* Passwords match - save to EEPROM */
-        SavePassword(password1);
-        DelayMs(100); /* Ensure EEPROM write completes */
-        UART5_SendChar(RESP_PASSWORD_MATCH);
+    /* Both passwords arrive in one frame */
+    if (ReadPassword(request, 0, password1) &&
+        ReadPassword(request, PASSWORD_LENGTH, password2) &&
+        strcmp(password1, password2) == 0) {
+        /* Passwords match - save to EEPROM, confirmed when written */
+        Config_SetPassword(password1);
+        SaveSettings(request, RESP_PASSWORD_MATCH, false);
     } else {
         /* Passwords don't match */
-        UART5_SendChar(RESP_PASSWORD_MISMATCH);
+        SendResponse(request->seq, RESP_PASSWORD_MISMATCH, NULL, 0);
     }
 }
 
@@ -319,20 +489,17 @@ void HandleSetupPassword(void)
  * Handles change password command
  * Verifies old password before allowing change
  */
-void HandleChangePassword(void)
+void HandleChangePassword(const Proto_Frame *request)
 {
     char password[PASSWORD_LENGTH + 1];
-    uint8_t attempts = 0;
     
-    /* Receive and verify old password */
-    ReceivePassword(password);
-    
-    if (VerifyPassword(password)) {
+    /* Verify old password */
+    if (ReadPassword(request, 0, password) && VerifyPassword(password)) {
         /* Old password correct */
-        UART5_SendChar(RESP_PASSWORD_MATCH);
+        SendResponse(request->seq, RESP_PASSWORD_MATCH, NULL, 0);
     } else {
         /* Old password incorrect */
-        UART5_SendChar(RESP_PASSWORD_MISMATCH);
+        SendResponse(request->seq, RESP_PASSWORD_MISMATCH, NULL, 0);
     }
 }
 
@@ -341,37 +508,26 @@ void HandleChangePassword(void)
  * Handles set timeout command
  * Verifies password before saving new timeout
  */
-void HandleSetTimeout(void)
+void HandleSetTimeout(const Proto_Frame *request)
 {
     char password[PASSWORD_LENGTH + 1];
     uint8_t timeout;
-    uint16_t waitTime;
-    
-    /* Receive password */
-    ReceivePassword(password);
     
-    /* Wait for timeout value */
-    waitTime = 0;
-    while (!UART5_IsDataAvailable() && waitTime < 1000) {
-        DelayMs(1);
-        waitTime++;
-    }
-    
-    if (UART5_IsDataAvailable()) {
-        timeout = UART5_ReceiveChar();
+    /* Payload: password followed by the timeout value */
+    if (request->length > PASSWORD_LENGTH) {
+        timeout = request->payload[PASSWORD_LENGTH];
     } else {
-        timeout = DEFAULT_TIMEOUT;
+        timeout = CONFIG_TIMEOUT_DEFAULT;
     }
     
     /* Verify password */
-    if (VerifyPassword(password)) {
-        /* Password correct - save timeout */
-        SaveTimeout(timeout);
-        DelayMs(50); /* Ensure EEPROM write completes */
-        UART5_SendChar(RESP_TIMEOUT_SAVED);
+    if (ReadPassword(request, 0, password) && VerifyPassword(password)) {
+        /* Password correct - save timeout, confirmed when written */
+        Config_SetTimeout(timeout);
+        SaveSettings(request, RESP_TIMEOUT_SAVED, false);
     } else {
         /* Password incorrect */
-        UART5_SendChar(RESP_PASSWORD_MISMATCH);
+        SendResponse(request->seq, RESP_PASSWORD_MISMATCH, NULL, 0);
     }
 }
 
@@ -380,82 +536,41 @@ void HandleSetTimeout(void)
  * Handles open door command
  * Verifies password and performs door operation
  */
-void HandleOpenDoor(void)
+void HandleOpenDoor(const Proto_Frame *request)
 {
     char password[PASSWORD_LENGTH + 1];
     
-    /* Receive password */
-    ReceivePassword(password);
-    
     /* Verify password */
-    if (VerifyPassword(password)) {
+    if (ReadPassword(request, 0, password) && VerifyPassword(password)) {
         /* Password correct */
-        UART5_SendChar(RESP_PASSWORD_MATCH);
-        DelayMs(100);
+        SendResponse(request->seq, RESP_PASSWORD_MATCH, NULL, 0);
         
-        /* Perform door unlock/lock sequence */
-        PerformDoorOperation();
+        /* Start the door unlock/lock sequence; the door task runs it */
+        g_doorSeq = request->seq;
+        (void)Door_Open(Config_GetTimeout(), (uint32_t)Time_NowMs());
     } else {
         /* Password incorrect */
-        UART5_SendChar(RESP_PASSWORD_MISMATCH);
+        SendResponse(request->seq, RESP_PASSWORD_MISMATCH, NULL, 0);
     }
 }
 
-/*
- * PerformDoorOperation
- * Executes the door unlock/lock sequence
- * 1. Unlock (rotate motor CW for 2 seconds)
- * 2. Wait (door remains open with countdown)
- * 3. Lock (rotate motor CCW for 2 seconds)
- */
-void PerformDoorOperation(void)
-{
-    uint8_t i;
-    
-    /* Step 1: Unlock door */
-    UART5_SendChar(RESP_DOOR_UNLOCKING);
-    Motor_RotateCW();
-    DelayMs(2000); /* 2 seconds to unlock */
-    Motor_Stop();
-    
-    /* Step 2: Wait while door is open with countdown */
-    UART5_SendChar(RESP_COUNTDOWN_START); /* Signal countdown is starting */
-    DelayMs(50);
-    
-    for (i = g_autoLockTimeout; i > 0; i--) {
-        SendCountdown(i);
-        DelayMs(1000);
-    }
-    
-    /* Step 3: Lock door */
-    DelayMs(100); /* Small delay before sending lock command */
-    UART5_SendChar(RESP_DOOR_LOCKING);
-    Motor_RotateCCW();
-    DelayMs(2000); /* 2 seconds to lock */
-    Motor_Stop();
-    
-    /* Door locked */
-    DelayMs(50);
-    UART5_SendChar(RESP_DOOR_LOCKED);
-}
-
 /*
  * TriggerLockout
  * Triggers security lockout after 3 failed attempts
- * Sounds buzzer for LOCKOUT_DURATION seconds
+ * Sounds buzzer for LOCKOUT_DURATION seconds from the buzzer task
  */
-void TriggerLockout(void)
+void TriggerLockout(uint8_t seq)
 {
-    uint8_t i;
-    
     /* Send lockout notification */
-    UART5_SendChar(RESP_SYSTEM_LOCKED);
+    SendResponse(seq, RESP_SYSTEM_LOCKED, NULL, 0);
     
     /* Sound buzzer - beep pattern for lockout duration */
-    for (i = 0; i < LOCKOUT_DURATION; i++) {
-        Buzzer_Beep(800);  /* 800ms beep */
-        DelayMs(200);      /* 200ms silence */
+    Buzzer_StartAlarm(LOCKOUT_DURATION);
+    if (g_alarmTimer != TIMER_NONE) {
+        (void)Timer_Cancel(g_alarmTimer);
+        g_alarmTimer = TIMER_NONE;
     }
+    Sched_Post(TASK_BUZZER, EVENT_TICK);
 }
 
 /*
@@ -463,51 +578,28 @@ void TriggerLockout(void)
  * Handles EEPROM erase command
  * Verifies password before erasing entire EEPROM
  */
-void HandleEraseEEPROM(void)
+void HandleEraseEEPROM(const Proto_Frame *request)
 {
     char password[PASSWORD_LENGTH + 1];
     
-    /* Receive password */
-    ReceivePassword(password);
-    
     /* Verify password */
-    if (VerifyPassword(password)) {
-        /* Password correct - erase EEPROM */
-        EEPROM_MassErase();
-        
-        /* Reset password and timeout to defaults */
-        strcpy(g_storedPassword, "00000");
-        g_autoLockTimeout = DEFAULT_TIMEOUT;
-        
-        /* Send success response */
-        DelayMs(50);
-        UART5_SendChar(RESP_EEPROM_ERASED);
+    if (ReadPassword(request, 0, password) && VerifyPassword(password)) {
+        /* Password correct - erase EEPROM; no password, default timeout
+         * at once, the erase confirmed when done */
+        SaveSettings(request, RESP_EEPROM_ERASED, true);
     } else {
         /* Password incorrect */
-        UART5_SendChar(RESP_PASSWORD_MISMATCH);
+        SendResponse(request->seq, RESP_PASSWORD_MISMATCH, NULL, 0);
     }
 }
 
 /*
  * IsPasswordValid
- * Checks if a valid password exists in EEPROM
+ * Checks if a valid password exists in EEPROM (from the RAM copy)
  */
 bool IsPasswordValid(void)
 {
-    uint32_t validFlag;
-    
-    EEPROM_ReadWord(EEPROM_VALID_FLAG_BLOCK, EEPROM_VALID_FLAG_OFFSET, &validFlag);
-    
-    return (validFlag == PASSWORD_VALID_MARKER);
-}
-
-/*
- * MarkPasswordAsValid
- * Marks password as valid in EEPROM
- */
-void MarkPasswordAsValid(void)
-{
-    EEPROM_WriteWord(EEPROM_VALID_FLAG_BLOCK, EEPROM_VALID_FLAG_OFFSET, PASSWORD_VALID_MARKER);
+    return Config_HasPassword();
 }
 
 /*
@@ -515,29 +607,61 @@ void MarkPasswordAsValid(void)
  * Handles lockout trigger command from HMI
  * Activates buzzer alarm
  */
-void HandleTriggerLockout(void)
+void HandleTriggerLockout(const Proto_Frame *request)
 {
-    TriggerLockout();
+    TriggerLockout(request->seq);
 }
 
 /*
  * HandleCheckPassword
  * Checks if password exists and responds to HMI
  */
-void HandleCheckPassword(void)
+void HandleCheckPassword(const Proto_Frame *request)
 {
     if (IsPasswordValid()) {
-        UART5_SendChar(RESP_PASSWORD_EXISTS);
+        SendResponse(request->seq, RESP_PASSWORD_EXISTS, NULL, 0);
+    } else {
+        SendResponse(request->seq, RESP_NO_PASSWORD, NULL, 0);
+    }
+}
+
+/*
+ * HandleGetStatus
+ * Reports the door state, the countdown and the auto-lock timeout
+ */
+void HandleGetStatus(const Proto_Frame *request)
+{
+    uint8_t status[STATUS_LENGTH];
+    
+    status[STATUS_DOOR_STATE] = Door_GetState();
+    status[STATUS_SECONDS_LEFT] = Door_GetSecondsLeft();
+    status[STATUS_AUTO_LOCK] = Config_GetTimeout();
+    SendResponse(request->seq, RESP_STATUS, status, STATUS_LENGTH);
+}
+
+/*
+ * HandleLockNow
+ * Emergency lock: cuts the door cycle short. The open door request still
+ * gets its RESP_DOOR_LOCKING and RESP_DOOR_LOCKED; this request is
+ * answered with the state the door is heading for.
+ */
+void HandleLockNow(const Proto_Frame *request)
+{
+    /* Answer first, so the reply precedes the door request's LOCKING */
+    if (Door_GetState() == DOOR_LOCKED) {
+        SendResponse(request->seq, RESP_DOOR_LOCKED, NULL, 0);
     } else {
-        UART5_SendChar(RESP_NO_PASSWORD);
+        SendResponse(request->seq, RESP_DOOR_LOCKING, NULL, 0);
     }
+    
+    (void)Door_Lock((uint32_t)Time_NowMs());
 }
 
 /*
  * SendCountdown
  * Sends countdown value to HMI
  */
-void SendCountdown(uint8_t seconds)
+void SendCountdown(uint8_t seq, uint8_t seconds)
 {
-    UART5_SendChar(seconds);
+    SendResponse(seq, RESP_COUNTDOWN, &seconds, 1);
 }
@@ -1,14 +1,60 @@
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "tm4c123gh6pm.h"
 #include "systick.h"
-#include "dio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
 
-volatile uint32_t msTicks = 0;
+#define SYSTICK_VECTOR  15U             /* FAULT_SYSTICK */
+
+// Timer wheel: 4 levels of 64 slots, 1 ms per level-0 slot. A timer sits
+// in the level whose range covers its distance to the deadline and moves
+// down a level (cascades) as the lower level turns over.
+#define WHEEL_BITS      6U
+#define WHEEL_SLOTS     (1U << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SLOTS - 1U)
+#define WHEEL_LEVELS    4U
+#define WHEEL_SPAN      (1UL << (WHEEL_BITS * WHEEL_LEVELS))
+#define WHEEL_DUE       (WHEEL_LEVELS * WHEEL_SLOTS)   // List of timers being run
+#define TIMER_NIL       0xFFU
+
+#define TIMER_FREE      0U
+#define TIMER_ARMED     1U
+#define TIMER_FIRING    2U
+#define TIMER_CANCELLED 3U
+
+typedef struct
+{
+    Timer_Callback callback;
+    void *context;
+    uint32_t periodMs;
+    uint32_t expiresMs;
+    uint16_t list;                      // Wheel slot or WHEEL_DUE
+    uint8_t next;
+    uint8_t prev;
+    uint8_t state;
+    uint8_t generation;                 // Tells a reused timer from a stale Timer_Id
+} Timer;
+
+static volatile uint64_t g_ticks = 0;   /* Incremented by SystickHandler */
+static uint32_t g_tickCycles = 16000U;  /* Reload period in clock cycles */
 static uint8_t interruptMode = 0;
 
+static Timer g_timers[TIMER_MAX];
+static uint8_t g_lists[WHEEL_DUE + 1U];
+static uint8_t g_freeTimer;
+static uint64_t g_level0Busy;           // Bit per non-empty level-0 slot
+static uint32_t g_wheelMs;              // Next millisecond to process
+
+static void Timer_Reset(void);
+
 void SysTick_Init(uint32_t reload, uint8_t mode)
 {
     interruptMode = mode;
+    g_tickCycles = reload;
+    g_ticks = 0;
+    Timer_Reset();
 
     NVIC_ST_CTRL_R = 0;               // Disable SysTick
     NVIC_ST_RELOAD_R = reload - 1;    // Set reload value
@@ -16,6 +62,7 @@ void SysTick_Init(uint32_t reload, uint8_t mode)
 
     if (mode == SYSTICK_INT)
     {
+        IntRegister(SYSTICK_VECTOR, SystickHandler);
         NVIC_ST_CTRL_R = 0x07;        // ENABLE | TICKINT | CLK_SRC
     }
     else
@@ -37,13 +84,359 @@ void DelayMs(uint32_t ms)
             NVIC_ST_CURRENT_R = 0;
         }
     }
+    else
+    {
+        // INTERRUPT MODE - sleep until the deadline tick. The check runs
+        // masked; WFI still wakes on the pending tick.
+        uint64_t deadline = Time_NowMs() + ms;
+
+        while (!Time_Reached(Time_NowMs(), deadline))
+        {
+            bool wasMasked = IntMasterDisable();
+
+            if (!Time_Reached(Time_NowMs(), deadline))
+            {
+                SysCtlSleep();
+            }
+            if (!wasMasked)
+            {
+                IntMasterEnable();
+            }
+        }
+    }
+}
+
+void DelayUs(uint32_t us)
+{
+    // Counts elapsed SysTick cycles, adding a reload period whenever the
+    // counter wraps. Polled far more often than once per reload, so no
+    // wrap is missed unless a long handler runs meanwhile, which only
+    // lengthens the wait.
+    uint64_t wait = (uint64_t)us * SYSTICK_CLOCK_MHZ;
+    uint64_t elapsed = 0;
+    uint32_t last = NVIC_ST_CURRENT_R;
+
+    while (elapsed < wait)
+    {
+        uint32_t current = NVIC_ST_CURRENT_R;
+
+        elapsed += (current <= last) ? (last - current) : (last + g_tickCycles - current);
+        last = current;
+    }
+}
+
+uint64_t Time_NowUs(void)
+{
+    uint64_t ticks;
+    uint32_t current;
+    bool pending;
+
+    // Retry if the handler ran or the counter reloaded while sampling, so
+    // ticks, current and pending all describe the same tick
+    do
+    {
+        ticks = g_ticks;
+        current = NVIC_ST_CURRENT_R;
+        pending = (NVIC_INT_CTRL_R & NVIC_INT_CTRL_PENDSTSET) != 0;
+    } while ((ticks != g_ticks) || (NVIC_ST_CURRENT_R > current));
+
+    // A wrap the handler has not counted yet (interrupts masked, or called
+    // from another handler)
+    if (pending)
+    {
+        ticks++;
+    }
+
+    return ((ticks * g_tickCycles) + (g_tickCycles - 1U - current)) / SYSTICK_CLOCK_MHZ;
 }
 
-/* SysTick Interrupt Handler */
+uint64_t Time_NowMs(void)
+{
+    return Time_NowUs() / 1000U;
+}
+
+bool Time_Reached(uint64_t now, uint64_t deadline)
+{
+    return (int64_t)(now - deadline) >= 0;
+}
+
+bool Time_Reached32(uint32_t now, uint32_t deadline)
+{
+    return (int32_t)(now - deadline) >= 0;
+}
+
+/* SysTick Interrupt Handler: one tick per reload period */
 void SystickHandler(void)
 {
-    /* Toggle Green LED every SysTick interrupt */
-    DIO_TogglePin(PORTF, PIN3);
-    DIO_TogglePin(PORTF, PIN3);
-    DIO_TogglePin(PORTF, PIN3);
+    g_ticks++;
+}
+
+/* Software timer wheel */
+
+static void Timer_Reset(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TIMER_MAX; i++)
+    {
+        g_timers[i].state = TIMER_FREE;
+        g_timers[i].next = (i + 1U < TIMER_MAX) ? (uint8_t)(i + 1U) : TIMER_NIL;
+    }
+    for (i = 0; i <= WHEEL_DUE; i++)
+    {
+        g_lists[i] = TIMER_NIL;
+    }
+    g_freeTimer = 0U;
+    g_level0Busy = 0U;
+    g_wheelMs = 1U;                     // Time_NowMs() is 0 after SysTick_Init
+}
+
+static void Timer_Link(uint8_t index, uint16_t list)
+{
+    Timer *timer = &g_timers[index];
+
+    timer->list = list;
+    timer->prev = TIMER_NIL;
+    timer->next = g_lists[list];
+    if (timer->next != TIMER_NIL)
+    {
+        g_timers[timer->next].prev = index;
+    }
+    g_lists[list] = index;
+    if (list < WHEEL_SLOTS)
+    {
+        g_level0Busy |= 1ULL << list;
+    }
+}
+
+static void Timer_Unlink(uint8_t index)
+{
+    Timer *timer = &g_timers[index];
+
+    if (timer->prev != TIMER_NIL)
+    {
+        g_timers[timer->prev].next = timer->next;
+    }
+    else
+    {
+        g_lists[timer->list] = timer->next;
+    }
+    if (timer->next != TIMER_NIL)
+    {
+        g_timers[timer->next].prev = timer->prev;
+    }
+    if ((timer->list < WHEEL_SLOTS) && (g_lists[timer->list] == TIMER_NIL))
+    {
+        g_level0Busy &= ~(1ULL << timer->list);
+    }
+}
+
+// Files a timer under the slot for its deadline, measured from g_wheelMs
+static void Timer_Insert(uint8_t index)
+{
+    Timer *timer = &g_timers[index];
+    uint32_t expires = timer->expiresMs;
+    uint32_t delta = expires - g_wheelMs;
+    uint32_t level = 0;
+
+    if (delta >= WHEEL_SPAN)
+    {
+        // Further than the wheel reaches: park it in the last slot and let
+        // the cascade file it again on the way round
+        expires = g_wheelMs + (uint32_t)(WHEEL_SPAN - 1U);
+        delta = WHEEL_SPAN - 1U;
+    }
+    while (delta >= (1UL << (WHEEL_BITS * (level + 1U))))
+    {
+        level++;
+    }
+    Timer_Link(index, (uint16_t)((level * WHEEL_SLOTS) +
+                                 ((expires >> (WHEEL_BITS * level)) & WHEEL_MASK)));
+}
+
+static void Timer_Free(uint8_t index)
+{
+    g_timers[index].state = TIMER_FREE;
+    g_timers[index].generation++;
+    g_timers[index].next = g_freeTimer;
+    g_freeTimer = index;
+}
+
+// Level 0 has turned over: move the due slot of each higher level down
+static void Timer_Cascade(void)
+{
+    uint32_t level;
+
+    for (level = 1; level < WHEEL_LEVELS; level++)
+    {
+        uint32_t slot = (g_wheelMs >> (WHEEL_BITS * level)) & WHEEL_MASK;
+        uint16_t list = (uint16_t)((level * WHEEL_SLOTS) + slot);
+
+        while (g_lists[list] != TIMER_NIL)
+        {
+            uint8_t index = g_lists[list];
+
+            Timer_Unlink(index);
+            Timer_Insert(index);
+        }
+        if (slot != 0U)
+        {
+            break;
+        }
+    }
+}
+
+// Lowest set bit of a non-zero word (de Bruijn multiply, no CLZ needed)
+static uint32_t Timer_LowestBit(uint32_t word)
+{
+    static const uint8_t position[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+
+    return position[((word & (0U - word)) * 0x077CB531U) >> 27];
+}
+
+// First busy level-0 slot at or after slot, or WHEEL_SLOTS if none
+static uint32_t Timer_NextBusy(uint32_t slot)
+{
+    uint64_t busy = g_level0Busy >> slot;
+
+    if (busy == 0U)
+    {
+        return WHEEL_SLOTS;
+    }
+    if ((uint32_t)busy != 0U)
+    {
+        return slot + Timer_LowestBit((uint32_t)busy);
+    }
+    return slot + 32U + Timer_LowestBit((uint32_t)(busy >> 32));
+}
+
+// Runs the timers of one level-0 slot; g_wheelMs is already past it
+static void Timer_Expire(uint32_t slot)
+{
+    // Move the slot to the due list first: a periodic timer can land back
+    // in the same slot one rotation later
+    while (g_lists[slot] != TIMER_NIL)
+    {
+        uint8_t index = g_lists[slot];
+
+        Timer_Unlink(index);
+        Timer_Link(index, WHEEL_DUE);
+    }
+
+    while (g_lists[WHEEL_DUE] != TIMER_NIL)
+    {
+        uint8_t index = g_lists[WHEEL_DUE];
+        Timer *timer = &g_timers[index];
+        bool again;
+
+        Timer_Unlink(index);
+        timer->state = TIMER_FIRING;
+        again = timer->callback(timer->context);
+
+        if (again && (timer->state == TIMER_FIRING))
+        {
+            timer->state = TIMER_ARMED;
+            timer->expiresMs += timer->periodMs;
+            Timer_Insert(index);
+        }
+        else
+        {
+            Timer_Free(index);
+        }
+    }
+}
+
+Timer_Id Timer_Start(uint32_t periodMs, Timer_Callback callback, void *context)
+{
+    uint8_t index = g_freeTimer;
+    Timer *timer;
+
+    if ((index == TIMER_NIL) || (callback == NULL))
+    {
+        return TIMER_NONE;
+    }
+    if (periodMs == 0U)
+    {
+        periodMs = 1U;
+    }
+    else if (periodMs > TIMER_MAX_PERIOD_MS)
+    {
+        periodMs = TIMER_MAX_PERIOD_MS;
+    }
+
+    timer = &g_timers[index];
+    g_freeTimer = timer->next;
+    timer->callback = callback;
+    timer->context = context;
+    timer->periodMs = periodMs;
+    timer->expiresMs = (uint32_t)Time_NowMs() + periodMs;
+    timer->state = TIMER_ARMED;
+    Timer_Insert(index);
+
+    return (Timer_Id)(((uint16_t)timer->generation << 8) | (index + 1U));
+}
+
+bool Timer_Cancel(Timer_Id id)
+{
+    uint32_t index = (id & 0xFFU) - 1U;
+    Timer *timer;
+
+    if (index >= TIMER_MAX)
+    {
+        return false;
+    }
+    timer = &g_timers[index];
+    if ((timer->generation != (uint8_t)(id >> 8)) || (timer->state == TIMER_FREE) ||
+        (timer->state == TIMER_CANCELLED))
+    {
+        return false;
+    }
+
+    if (timer->state == TIMER_FIRING)
+    {
+        // Cancelled from its own callback: Timer_Expire frees it
+        timer->state = TIMER_CANCELLED;
+    }
+    else
+    {
+        Timer_Unlink((uint8_t)index);
+        Timer_Free((uint8_t)index);
+    }
+    return true;
+}
+
+void Timer_Dispatch(void)
+{
+    uint32_t now = (uint32_t)Time_NowMs();
+
+    while (Time_Reached32(now, g_wheelMs))
+    {
+        uint32_t slot = g_wheelMs & WHEEL_MASK;
+        uint32_t step;
+
+        if (slot == 0U)
+        {
+            Timer_Cascade();
+        }
+
+        // Skip straight to the next busy slot or the next turn-over
+        step = Timer_NextBusy(slot) - slot;
+        if (step == 0U)
+        {
+            g_wheelMs++;
+            Timer_Expire(slot);
+        }
+        else
+        {
+            if (step > (now - g_wheelMs) + 1U)
+            {
+                step = (now - g_wheelMs) + 1U;
+            }
+            g_wheelMs += step;
+        }
+    }
 }
@@ -9,6 +9,12 @@
  *   - Data: 8 bits
  *   - Parity: None
  *   - Stop: 1 bit
+ *
+ * Reception and transmission are interrupt driven: the UART5 ISR moves
+ * bytes between the hardware FIFOs and two software ring buffers, so the
+ * application can poll at its own pace without losing data. Whole frames
+ * can instead be handed to uDMA channel 7 with UART5_SendFrame(), which
+ * feeds the TX FIFO without any per-byte CPU work.
  ******************************************************************************/
 
 #ifndef UART_H_
@@ -17,6 +23,20 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Ring buffer sizes (must be powers of two) */
+#define UART5_RX_BUFFER_SIZE    64U
+#define UART5_TX_BUFFER_SIZE    64U
+
+/* Called from interrupt context when a UART5_SendFrame() frame is done */
+typedef void (*UART5_TxCallback)(void);
+
+/* Called from interrupt context when bytes have been added to the RX ring */
+typedef void (*UART5_RxCallback)(void);
+
 /******************************************************************************
  *                          Function Prototypes                                *
  ******************************************************************************/
@@ -32,7 +52,7 @@ void UART5_Init(void);
 /*
  * UART5_SendChar
  * Transmits a single character through UART5.
- * Blocks until the transmit FIFO is ready.
+ * Blocks (sleeping) only while the transmit buffer is full.
  * 
  * Parameters:
  *   data - Character to transmit
@@ -42,7 +62,7 @@ void UART5_SendChar(char data);
 /*
  * UART5_ReceiveChar
  * Receives a single character from UART5.
- * Blocks until a character is available in the receive FIFO.
+ * Blocks (sleeping) until a character is available in the receive buffer.
  * 
  * Returns:
  *   Received character
@@ -60,11 +80,79 @@ void UART5_SendString(const char *str);
 
 /*
  * UART5_IsDataAvailable
- * Checks if data is available in the receive FIFO.
+ * Checks if data is available in the receive buffer.
  * 
  * Returns:
  *   1 if data is available, 0 otherwise
  */
 uint8_t UART5_IsDataAvailable(void);
 
+/*
+ * UART5_SetRxCallback
+ * Registers a function the ISR calls after receiving bytes, so the
+ * application can be woken instead of polling. NULL disables it.
+ */
+void UART5_SetRxCallback(UART5_RxCallback onRx);
+
+/*
+ * UART5_Read
+ * Copies up to n received bytes into buf without blocking.
+ * 
+ * Parameters:
+ *   buf - Destination buffer
+ *   n   - Maximum number of bytes to read
+ * 
+ * Returns:
+ *   Number of bytes copied (0 if nothing was received)
+ */
+uint32_t UART5_Read(uint8_t *buf, uint32_t n);
+
+/*
+ * UART5_Write
+ * Queues up to n bytes for transmission without blocking.
+ * 
+ * Parameters:
+ *   buf - Bytes to transmit
+ *   n   - Number of bytes
+ * 
+ * Returns:
+ *   Number of bytes queued (less than n if the transmit buffer filled up)
+ */
+uint32_t UART5_Write(const uint8_t *buf, uint32_t n);
+
+/*
+ * UART5_SendFrame
+ * Transmits a whole frame by uDMA and returns without waiting.
+ * Bytes queued earlier with UART5_Write() are sent first. The buffer is
+ * not copied and must stay unchanged until the frame completes.
+ * 
+ * Parameters:
+ *   frame  - Bytes to transmit
+ *   length - Number of bytes (1..UDMA_MAX_TRANSFER)
+ *   onDone - Completion callback (interrupt context), or NULL
+ * 
+ * Returns:
+ *   true if queued, false if a frame is already in flight or the
+ *   arguments are invalid
+ */
+bool UART5_SendFrame(const uint8_t *frame, uint16_t length, UART5_TxCallback onDone);
+
+/*
+ * UART5_IsFrameBusy
+ * True while a UART5_SendFrame() frame is queued or in flight.
+ */
+bool UART5_IsFrameBusy(void);
+
+/*
+ * UART5_GetRxOverruns
+ * Bytes dropped because the receive ring buffer was full.
+ */
+uint32_t UART5_GetRxOverruns(void);
+
+/*
+ * UART5_GetHwOverruns
+ * Hardware FIFO overrun errors (the ISR was not serviced in time).
+ */
+uint32_t UART5_GetHwOverruns(void);
+
 #endif /* UART_H_ */
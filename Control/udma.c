@@ -0,0 +1,58 @@
+/******************************************************************************
+ * File: udma.c
+ * Module: uDMA (Micro Direct Memory Access)
+ * Description: Source file for TM4C123GH6PM uDMA controller setup (TivaWare)
+ ******************************************************************************/
+
+#include "udma.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* TivaWare includes */
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* 32 channels x primary/alternate x 16-byte structure */
+#define CONTROL_TABLE_SIZE      1024U
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/* The controller requires the table on a 1024-byte boundary */
+#if defined(__ICCARM__)
+#pragma data_alignment=1024
+static uint8_t g_controlTable[CONTROL_TABLE_SIZE];
+#else
+static uint8_t g_controlTable[CONTROL_TABLE_SIZE] __attribute__((aligned(1024)));
+#endif
+
+static bool g_initialized = false;
+
+/******************************************************************************
+ *                          Function Implementations                           *
+ ******************************************************************************/
+
+/*
+ * UDMA_Init
+ * Enables the uDMA clock and controller and points it at the control table.
+ */
+void UDMA_Init(void)
+{
+    if (g_initialized) {
+        return;
+    }
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA));
+
+    uDMAEnable();
+    uDMAControlBaseSet(g_controlTable);
+    g_initialized = true;
+}
@@ -0,0 +1,33 @@
+/******************************************************************************
+ * File: udma.h
+ * Module: uDMA (Micro Direct Memory Access)
+ * Description: Header file for TM4C123GH6PM uDMA controller setup (TivaWare)
+ *
+ * Owns the channel control table shared by every uDMA channel. Drivers
+ * call UDMA_Init() before configuring their own channel.
+ ******************************************************************************/
+
+#ifndef UDMA_H_
+#define UDMA_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Largest basic-mode transfer (items per channel structure) */
+#define UDMA_MAX_TRANSFER       1024U
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * UDMA_Init
+ * Enables the uDMA controller and installs the control table.
+ * Safe to call from several drivers; only the first call has an effect.
+ */
+void UDMA_Init(void);
+
+#endif /* UDMA_H_ */
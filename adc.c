@@ -5,7 +5,64 @@
  ******************************************************************************/
 
 #include "adc.h"
+#include "systick.h"
 #include "tm4c123gh6pm.h"
+#include "driverlib/interrupt.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define ADC_SS0_VECTOR      30U     /* INT_ADC0SS0 */
+#define ADC_CODE_MASK       0xFFFU
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/* Continuous sampling, written by the SS0 ISR */
+static volatile uint16_t g_buffer[ADC_BUFFER_SIZE];  /* Sequence averages */
+static volatile uint32_t g_sum;                      /* Sum of g_buffer */
+static volatile uint8_t g_next;                      /* Oldest entry */
+static volatile uint32_t g_sequences;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * ADC_Ss0Handler
+ * SS0 ISR: the sequence is complete, so all ADC_SS0_STEPS results are in
+ * the FIFO. Their average replaces the oldest buffer entry and the
+ * running sum is updated, so readers never have to add up the buffer.
+ */
+static void ADC_Ss0Handler(void)
+{
+    uint32_t sum = 0;
+    uint16_t average;
+    uint8_t i;
+
+    ADC0_ISC_R = ADC_ISC_IN0;
+    (void)ADC0_ISC_R;       /* Clear lands before return: no re-entry */
+
+    for (i = 0; i < ADC_SS0_STEPS; i++) {
+        sum += ADC0_SSFIFO0_R & ADC_CODE_MASK;
+    }
+    average = (uint16_t)((sum + (ADC_SS0_STEPS / 2U)) / ADC_SS0_STEPS);
+
+    if (g_sequences == 0U) {
+        /* The first sequence fills the whole window: no ramp up from 0 */
+        for (i = 0; i < ADC_BUFFER_SIZE; i++) {
+            g_buffer[i] = average;
+        }
+        g_sum = (uint32_t)average * ADC_BUFFER_SIZE;
+    } else {
+        g_sum = g_sum - g_buffer[g_next] + average;
+        g_buffer[g_next] = average;
+    }
+    g_next = (uint8_t)((g_next + 1U) & (ADC_BUFFER_SIZE - 1U));
+    g_sequences++;
+}
 
 /******************************************************************************
  *                         Function Definitions                                *
@@ -67,6 +124,74 @@ uint16_t ADC_Read(void)
     return result;
 }
 
+/*
+ * Description: Starts timer-triggered sampling of a channel on SS0
+ * Parameters:
+ *   - channel: ADC input channel (0-11)
+ * Returns: None
+ * Note: Timer2A only triggers the ADC; it raises no interrupt of its own
+ */
+void ADC_StartContinuous(uint8_t channel)
+{
+    uint32_t sac = 0;
+    
+    /* Configure SS0: every step samples the channel, interrupt after the last */
+    ADC0_ACTSS_R &= ~ADC_ACTSS_ASEN0;
+    ADC0_EMUX_R = (ADC0_EMUX_R & ~ADC_EMUX_EM0_M) | ADC_EMUX_EM0_TIMER;
+    ADC0_SSMUX0_R = (channel & 0x0FUL) * 0x11111111UL;
+    ADC0_SSCTL0_R = ADC_SSCTL0_END7 | ADC_SSCTL0_IE7;
+    while ((1UL << sac) < ADC_HW_AVERAGING) {
+        sac++;
+    }
+    ADC0_SAC_R = sac;
+    
+    /* Drop anything left from an earlier run */
+    while ((ADC0_SSFSTAT0_R & ADC_SSFSTAT0_EMPTY) == 0) {
+        (void)ADC0_SSFIFO0_R;
+    }
+    ADC0_ISC_R = ADC_ISC_IN0;
+    g_sum = 0;
+    g_next = 0;
+    g_sequences = 0;
+    
+    ADC0_IM_R |= ADC_IM_MASK0;
+    IntRegister(ADC_SS0_VECTOR, ADC_Ss0Handler);
+    IntEnable(ADC_SS0_VECTOR);
+    ADC0_ACTSS_R |= ADC_ACTSS_ASEN0;
+    
+    /* Timer2A: 32-bit periodic, ADC trigger on every time-out */
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+    while ((SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R2) == 0) {
+    }
+    TIMER2_CTL_R = 0;
+    TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+    TIMER2_TAILR_R = (ADC_SAMPLE_PERIOD_MS * 1000U * SYSTICK_CLOCK_MHZ) - 1U;
+    TIMER2_IMR_R = 0;
+    TIMER2_CTL_R = TIMER_CTL_TAOTE | TIMER_CTL_TAEN;
+}
+
+/*
+ * Description: Average of the buffered SS0 sequences
+ * Parameters: None
+ * Returns: 12-bit value (0-4095), 0 before the first sequence completes
+ * Note: One load of the running sum, so no locking against the ISR
+ */
+uint16_t ADC_ReadLatest(void)
+{
+    return (uint16_t)((g_sum + (ADC_BUFFER_SIZE / 2U)) / ADC_BUFFER_SIZE);
+}
+
+/*
+ * Description: Number of SS0 sequences stored since ADC_StartContinuous
+ * Parameters: None
+ * Returns: Sequence count
+ */
+uint32_t ADC_Sequences(void)
+{
+    return g_sequences;
+}
+
 /*
  * Description: Converts ADC value to millivolts (assuming 3.3V reference)
  * Parameters:
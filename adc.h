@@ -52,6 +52,18 @@
  */
 #define ADC_MAX_VALUE       4095
 
+/*
+ * Continuous sampling (ADC_StartContinuous)
+ * Timer2A triggers SS0 every ADC_SAMPLE_PERIOD_MS. The sequence takes
+ * ADC_SS0_STEPS samples of the channel, each the hardware average of
+ * ADC_HW_AVERAGING conversions. The interrupt keeps the last
+ * ADC_BUFFER_SIZE sequence averages.
+ */
+#define ADC_SAMPLE_PERIOD_MS    10U
+#define ADC_SS0_STEPS           8U
+#define ADC_HW_AVERAGING        16U     /* Power of two, 2 to 64 */
+#define ADC_BUFFER_SIZE         8U      /* Power of two */
+
 /******************************************************************************
  *                         Function Prototypes                                 *
  ******************************************************************************/
@@ -72,6 +84,33 @@ void ADC_Init(uint8_t channel);
  */
 uint16_t ADC_Read(void);
 
+/*
+ * Description: Starts timer-triggered sampling of a channel on SS0 with
+ *              hardware averaging. The SS0 interrupt stores each sequence
+ *              into a buffer; ADC_ReadLatest reads it. Turns on hardware
+ *              averaging for ADC_Read as well (ADC0_SAC is shared).
+ * Parameters:
+ *   - channel: ADC input channel (0-11)
+ * Returns: None
+ * Note: Call after ADC_Init, which sets up the pin
+ */
+void ADC_StartContinuous(uint8_t channel);
+
+/*
+ * Description: Average of the buffered SS0 sequences, without starting
+ *              or waiting for a conversion
+ * Parameters: None
+ * Returns: 12-bit value (0-4095), 0 before the first sequence completes
+ */
+uint16_t ADC_ReadLatest(void);
+
+/*
+ * Description: Number of SS0 sequences stored since ADC_StartContinuous
+ * Parameters: None
+ * Returns: Sequence count
+ */
+uint32_t ADC_Sequences(void);
+
 /*
  * Description: Converts ADC value to millivolts (assuming 3.3V reference)
  * Parameters:
@@ -0,0 +1,168 @@
+/******************************************************************************
+ * File: comm.c
+ * Module: COMM (HMI side transaction layer)
+ * Description: Request/response transactions with the Control ECU
+ ******************************************************************************/
+
+#include "comm.h"
+#include "uart.h"
+#include "systick.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+typedef struct {
+    uint8_t id;                     /* COMM_NO_REQUEST when the slot is free */
+    Comm_Handler handler;
+    void *context;
+    uint32_t timeoutMs;
+    uint32_t idleMs;                /* Time since the last response */
+} Comm_Request;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/* Read by the uDMA until the frame completes; see Comm_Send() */
+static uint8_t g_txFrame[PROTO_MAX_FRAME];
+static uint8_t g_lastId;
+
+static Proto_Parser g_rxParser;
+static Comm_Request g_requests[COMM_MAX_PENDING];
+static uint32_t g_unmatched;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static Comm_Request *Comm_Find(uint8_t id)
+{
+    uint8_t i;
+
+    for (i = 0; i < COMM_MAX_PENDING; i++) {
+        if (g_requests[i].id == id) {
+            return &g_requests[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Comm_Dispatch
+ * Hands one received frame to the request it answers and closes the
+ * request after its final response.
+ */
+static void Comm_Dispatch(const Proto_Frame *response)
+{
+    Comm_Request *request;
+
+    request = (response->seq != COMM_NO_REQUEST) ? Comm_Find(response->seq) : NULL;
+    if (request == NULL) {
+        g_unmatched++;
+        return;
+    }
+
+    request->idleMs = 0U;
+    if (request->handler(response, request->context)) {
+        request->id = COMM_NO_REQUEST;
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void Comm_Init(void)
+{
+    uint8_t i;
+
+    Proto_ParserInit(&g_rxParser);
+    for (i = 0; i < COMM_MAX_PENDING; i++) {
+        g_requests[i].id = COMM_NO_REQUEST;
+    }
+    g_unmatched = 0U;
+}
+
+uint8_t Comm_Send(uint8_t command, const uint8_t *payload, uint8_t length,
+                  uint32_t timeoutMs, Comm_Handler handler, void *context)
+{
+    Comm_Request *request = Comm_Find(COMM_NO_REQUEST);
+    uint8_t size;
+
+    if (request == NULL || handler == NULL) {
+        return COMM_NO_REQUEST;
+    }
+
+    /* Skip ID 0 and any ID still in use after a wrap */
+    do {
+        g_lastId++;
+    } while (g_lastId == COMM_NO_REQUEST || Comm_Find(g_lastId) != NULL);
+
+    while (UART5_IsFrameBusy()) {
+        DelayMs(1);
+    }
+
+    /* Register only a frame that is on its way; responses are matched
+     * in Comm_Poll(), so none can arrive before this returns */
+    size = Proto_Encode(g_txFrame, g_lastId, command, payload, length);
+    if (size == 0U || !UART5_SendFrame(g_txFrame, size, NULL)) {
+        return COMM_NO_REQUEST;
+    }
+
+    request->id = g_lastId;
+    request->handler = handler;
+    request->context = context;
+    request->timeoutMs = timeoutMs;
+    request->idleMs = 0U;
+    return g_lastId;
+}
+
+void Comm_Poll(uint32_t elapsedMs)
+{
+    Comm_Handler handler;
+    uint8_t byte;
+    uint8_t i;
+
+    while (UART5_Read(&byte, 1U) == 1U) {
+        if (Proto_Parse(&g_rxParser, byte)) {
+            do {
+                Comm_Dispatch(&g_rxParser.frame);
+            } while (Proto_ParsePending(&g_rxParser));
+        }
+    }
+
+    for (i = 0; i < COMM_MAX_PENDING; i++) {
+        if (g_requests[i].id == COMM_NO_REQUEST) {
+            continue;
+        }
+        g_requests[i].idleMs += elapsedMs;
+        if (g_requests[i].idleMs >= g_requests[i].timeoutMs) {
+            /* Free the slot first: the handler may send a retry */
+            handler = g_requests[i].handler;
+            g_requests[i].id = COMM_NO_REQUEST;
+            (void)handler(NULL, g_requests[i].context);
+        }
+    }
+}
+
+bool Comm_IsPending(uint8_t id)
+{
+    return id != COMM_NO_REQUEST && Comm_Find(id) != NULL;
+}
+
+void Comm_Cancel(uint8_t id)
+{
+    Comm_Request *request = (id != COMM_NO_REQUEST) ? Comm_Find(id) : NULL;
+
+    if (request != NULL) {
+        request->id = COMM_NO_REQUEST;
+    }
+}
+
+uint32_t Comm_Unmatched(void)
+{
+    return g_unmatched;
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * File: comm.h
+ * Module: COMM (HMI side transaction layer)
+ * Description: Request/response transactions with the Control ECU
+ *
+ * Every request gets its own ID (the frame SEQ) and a handler. Several
+ * requests can be outstanding at once; Comm_Poll() matches each received
+ * frame to its request by ID and calls that request's handler, so e.g. a
+ * status query can be answered while an open-door request is still
+ * streaming progress messages.
+ *
+ * A request stays open until its handler reports the final response, or
+ * until no response arrived for its timeout, in which case the handler is
+ * called once with a NULL response.
+ ******************************************************************************/
+
+#ifndef COMM_H_
+#define COMM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Requests that can be outstanding at the same time */
+#define COMM_MAX_PENDING        4U
+
+/* No request (Comm_Send failure); never used as a request ID */
+#define COMM_NO_REQUEST         0U
+
+/*
+ * Called from Comm_Poll() for every response to a request, or with NULL
+ * when the request timed out.
+ * Returns: true if this was the final response (the request is closed)
+ */
+typedef bool (*Comm_Handler)(const Proto_Frame *response, void *context);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Comm_Init
+ * Resets the parser and the request table. Call after UART5_Init().
+ */
+void Comm_Init(void);
+
+/*
+ * Comm_Send
+ * Sends a request frame and registers its handler. Waits only while the
+ * previous frame is still being sent.
+ *
+ * Parameters:
+ *   command   - CMD_* code
+ *   payload   - Request payload (may be NULL if length is 0)
+ *   length    - Payload length, up to PROTO_MAX_PAYLOAD
+ *   timeoutMs - Longest gap allowed between responses
+ *   handler   - Response handler
+ *   context   - Passed to the handler
+ *
+ * Returns:
+ *   Request ID, or COMM_NO_REQUEST if COMM_MAX_PENDING requests are open
+ *   or the frame could not be encoded or sent
+ */
+uint8_t Comm_Send(uint8_t command, const uint8_t *payload, uint8_t length,
+                  uint32_t timeoutMs, Comm_Handler handler, void *context);
+
+/*
+ * Comm_Poll
+ * Parses received bytes, dispatches responses to their handlers and
+ * expires requests that have waited too long.
+ *
+ * Parameters:
+ *   elapsedMs - Time since the previous call
+ */
+void Comm_Poll(uint32_t elapsedMs);
+
+/*
+ * Comm_IsPending
+ * Returns true while the request is open
+ */
+bool Comm_IsPending(uint8_t id);
+
+/*
+ * Comm_Cancel
+ * Closes a request without calling its handler, e.g. before its context
+ * goes out of scope. Later responses to it count as unmatched.
+ */
+void Comm_Cancel(uint8_t id);
+
+/*
+ * Comm_Unmatched
+ * Returns the number of frames that answered no open request
+ */
+uint32_t Comm_Unmatched(void);
+
+#endif /* COMM_H_ */
@@ -7,6 +7,8 @@
 
 #include "dio.h"
 #include "tm4c123gh6pm.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
 
 
 /******************************************************************************
@@ -16,6 +18,12 @@
 
 #define GPIO_LOCK_KEY           0x4C4F434B
 
+/*
+ * GPIODATA is mirrored over offsets 0x000-0x3FC: address bits [9:2] mask
+ * which pins a store changes, so a masked write needs no read-back.
+ */
+#define GPIO_DATA_ALIAS(mask)   ((uint32_t)(mask) << 2)
+
 /* Helper macros to get register address based on port (0-5) */
 #define GET_GPIO_DATA(port)   ((port) == 0 ? &GPIO_PORTA_DATA_R : \
                                (port) == 1 ? &GPIO_PORTB_DATA_R : \
@@ -73,6 +81,11 @@
                                (port) == 4 ? &GPIO_PORTE_CR_R : \
                                &GPIO_PORTF_CR_R)
 
+static const uint32_t g_portBase[] = {
+    GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+    GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE
+};
+
 /******************************************************************************
  *                              Function Implementations                       *
  ******************************************************************************/
@@ -129,6 +142,16 @@ void DIO_WritePin(uint8_t port, uint8_t pin, uint8_t value) {
 }
 
 
+/*
+ * DIO_WritePort
+ * Sets the pins selected by mask to the matching bits of value in one store
+ * through the masked DATA alias.
+ */
+void DIO_WritePort(uint8_t port, uint8_t mask, uint8_t value) {
+    HWREG(g_portBase[port] + GPIO_DATA_ALIAS(mask)) = value;
+}
+
+
 /*
  * DIO_ReadPin
  * Reads the current value of a GPIO pin (returns HIGH or LOW).
@@ -138,6 +161,16 @@ uint8_t DIO_ReadPin(uint8_t port, uint8_t pin) {
 }
 
 
+/*
+ * DIO_ReadPort
+ * Reads the pins selected by mask in one load through the masked DATA
+ * alias; the other bits read 0.
+ */
+uint8_t DIO_ReadPort(uint8_t port, uint8_t mask) {
+    return (uint8_t)HWREG(g_portBase[port] + GPIO_DATA_ALIAS(mask));
+}
+
+
 /*
  * DIO_TogglePin
  * Toggles the output value of a GPIO pin.
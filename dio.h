@@ -78,12 +78,25 @@ void DIO_Init(uint8_t port, uint8_t pin, uint8_t direction);
  */
 void DIO_WritePin(uint8_t port, uint8_t pin, uint8_t value);
 
+/*
+ * DIO_WritePort
+ * Writes value to the pins set in mask with a single store; the port's
+ * other pins are unchanged. Pass pin masks, e.g. (1 << PIN2).
+ */
+void DIO_WritePort(uint8_t port, uint8_t mask, uint8_t value);
+
 /*
  * DIO_ReadPin
  * Reads the value of a GPIO pin (returns HIGH/LOW).
  */
 uint8_t DIO_ReadPin(uint8_t port, uint8_t pin);
 
+/*
+ * DIO_ReadPort
+ * Reads the pins set in mask with a single load; the other bits read 0.
+ */
+uint8_t DIO_ReadPort(uint8_t port, uint8_t mask);
+
 /*
  * DIO_TogglePin
  * Toggles the value of a GPIO pin.
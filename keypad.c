@@ -6,6 +6,9 @@
 
 #include "keypad.h"
 #include "dio.h"
+#include "systick.h"
+#include "tm4c123gh6pm.h"
+#include "driverlib/interrupt.h"
 
 /*
  * Keypad mapping array.
@@ -30,13 +33,354 @@ const char keypad_codes[4][4] = {
 #define KEYPAD_ROW_PORT PORTA
 #define KEYPAD_ROW_PINS {PIN2, PIN3, PIN4, PIN5} // PA2-PA5
 
+/* The same pins as port masks, for whole-port access */
+#define KEYPAD_COL_MASK     0xF0U   // PC4-PC7
+#define KEYPAD_COL_SHIFT    4U
+#define KEYPAD_ROW_MASK     0x3CU   // PA2-PA5
+#define KEYPAD_ROW_SHIFT    2U
+#define KEYPAD_ROW_BITS     0x0FU
+
+#define KEYPAD_KEYS         (KEYPAD_ROWS * KEYPAD_COLS)
+#define KEYPAD_QUEUE_MASK   (KEYPAD_QUEUE_SIZE - 1U)
+#define KEYPAD_SETTLE_US    1U      /* Row lines follow a column change */
+#define KEYPAD_TIMER_VECTOR 37U     /* INT_TIMER1A */
+
+/* Count leading zeros: a single CLZ instruction on the Cortex-M4 */
+#if defined(__ICCARM__)
+#include <intrinsics.h>
+#define KEYPAD_CLZ(x)       ((uint32_t)__CLZ(x))
+#else
+#define KEYPAD_CLZ(x)       ((uint32_t)__builtin_clz(x))
+#endif
+
+/* Debounce states of a key */
+#define KEY_UP              0U
+#define KEY_PRESSING        1U      /* Read down, not yet stable */
+#define KEY_DOWN            2U
+#define KEY_RELEASING       3U      /* Read up, not yet stable */
+
+/* Chord flags of a key that is down */
+#define KEY_DEFERRED        0x01U   /* Press held back for a chord partner */
+#define KEY_CHORDED         0x02U   /* Part of a chord: no events of its own */
+
+#define KEYPAD_HELD_MAX     0xFFFFU
+
+typedef struct {
+    uint8_t state;
+    uint8_t count;              /* Stable readings so far (PRESSING/RELEASING) */
+    uint8_t flags;              /* KEY_DEFERRED, KEY_CHORDED */
+    uint16_t heldMs;            /* Time down, saturating */
+    uint16_t repeatMs;          /* Time to the next auto-repeat */
+    uint32_t pressedAt;         /* Time_NowMs() when the press was accepted */
+} Keypad_KeyState;
+
+typedef struct {
+    uint8_t first;              /* Bitmap bits of the two keys */
+    uint8_t second;
+    char code;                  /* Reported as the key of the chord event */
+} Keypad_Chord;
+
+/*
+ * Key of each bit of a scan bitmap. A scan reads one column at a time,
+ * so bit (col * KEYPAD_ROWS + row) is key [row][col] of keypad_codes.
+ */
+static const char g_keyOfBit[KEYPAD_KEYS] = {
+    '1', '4', '7', '*',     // Column 0
+    '2', '5', '8', '0',     // Column 1
+    '3', '6', '9', '#',     // Column 2
+    'A', 'B', 'C', 'D'      // Column 3
+};
+
+/* Scanner state, owned by the Timer1A ISR */
+static Keypad_KeyState g_keys[KEYPAD_KEYS];
+static uint16_t g_busy;             /* Bit set while a key is not KEY_UP */
+static uint32_t g_scanMs;           /* Time of the scan being processed */
+static volatile uint32_t g_ghostScans;
+
+/* Settings, written by the application and read by the ISR */
+static volatile uint16_t g_repeatDelayMs;   /* 0: no auto-repeat */
+static volatile uint16_t g_repeatPeriodMs;
+static Keypad_Chord g_chords[KEYPAD_MAX_CHORDS];
+static volatile uint8_t g_chordCount;
+static volatile uint16_t g_chordKeys;       /* Bits of keys in any chord */
+
+/* Event queue: the ISR advances g_head, Keypad_GetEvent advances g_tail.
+ * Both count freely; head - tail is the number of queued events. The
+ * entries are volatile too, so their stores stay ahead of g_head's. */
+static volatile Keypad_Event g_queue[KEYPAD_QUEUE_SIZE];
+static volatile uint8_t g_head;
+static volatile uint8_t g_tail;
+static volatile uint32_t g_overflows;
+
+/*
+ * Keypad_Push
+ * Queues an event. Drops it if the queue is full.
+ */
+static void Keypad_Push(char key, uint8_t type, uint32_t timeMs)
+{
+    volatile Keypad_Event *event;
+
+    if ((uint8_t)(g_head - g_tail) >= KEYPAD_QUEUE_SIZE) {
+        g_overflows++;
+        return;
+    }
+    event = &g_queue[g_head & KEYPAD_QUEUE_MASK];
+    event->key = key;
+    event->type = type;
+    event->timeMs = timeMs;
+    g_head++;
+}
+
+/*
+ * Keypad_BitOf
+ * Returns: bitmap bit of a key character, or KEYPAD_KEYS if unknown
+ */
+static uint8_t Keypad_BitOf(char key)
+{
+    uint8_t i = 0;
+
+    while (i < KEYPAD_KEYS && g_keyOfBit[i] != key) {
+        i++;
+    }
+    return i;
+}
+
+/*
+ * Keypad_ReadRows
+ * Returns: bit n set if row n reads low, from one masked load
+ */
+static uint8_t Keypad_ReadRows(void)
+{
+    uint8_t levels = DIO_ReadPort(KEYPAD_ROW_PORT, KEYPAD_ROW_MASK);
+
+    return (uint8_t)((~levels & KEYPAD_ROW_MASK) >> KEYPAD_ROW_SHIFT);
+}
+
+/*
+ * Keypad_ScanMatrix
+ * Drives each column low in turn with one masked store and reads all
+ * rows with one masked load. Columns are left low, so between scans a
+ * single row read tells whether any key is down.
+ * Returns: bit (col * KEYPAD_ROWS + row) set for every key that reads down
+ */
+static uint16_t Keypad_ScanMatrix(void)
+{
+    uint16_t down = 0;
+
+    for (uint8_t col = 0; col < KEYPAD_COLS; col++) {
+        DIO_WritePort(KEYPAD_COL_PORT, KEYPAD_COL_MASK,
+                      (uint8_t)~(1U << (col + KEYPAD_COL_SHIFT)));
+        DelayUs(KEYPAD_SETTLE_US);
+        down |= (uint16_t)((uint16_t)Keypad_ReadRows() << (col * KEYPAD_ROWS));
+    }
+    DIO_WritePort(KEYPAD_COL_PORT, KEYPAD_COL_MASK, 0);
+    return down;
+}
+
+/*
+ * Keypad_Ghosted
+ * Without diodes, three keys on the corners of a rectangle also pull the
+ * fourth corner low. Such a scan cannot be trusted: true if two columns
+ * share two or more rows.
+ */
+static bool Keypad_Ghosted(uint16_t down)
+{
+    for (uint8_t a = 0; a < KEYPAD_COLS - 1; a++) {
+        uint8_t rowsA = (uint8_t)((down >> (a * KEYPAD_ROWS)) & KEYPAD_ROW_BITS);
+        for (uint8_t b = a + 1; b < KEYPAD_COLS; b++) {
+            uint8_t shared = rowsA & (uint8_t)(down >> (b * KEYPAD_ROWS));
+            if ((shared & (shared - 1U)) != 0U) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * Keypad_Accept
+ * A press of key index has been debounced. A key that belongs to a chord
+ * completes it if its partner's press is still held back; otherwise its
+ * own press is held back for KEYPAD_CHORD_MS.
+ */
+static void Keypad_Accept(uint8_t index)
+{
+    Keypad_KeyState *key = &g_keys[index];
+
+    key->heldMs = 0U;
+    key->repeatMs = g_repeatDelayMs;
+    key->pressedAt = g_scanMs;
+    key->flags = 0U;
+
+    if ((g_chordKeys & (1U << index)) == 0U) {
+        Keypad_Push(g_keyOfBit[index], KEYPAD_EVENT_PRESS, g_scanMs);
+        return;
+    }
+    for (uint8_t c = 0; c < g_chordCount; c++) {
+        const Keypad_Chord *chord = &g_chords[c];
+        uint8_t partner;
+
+        if (chord->first == index) {
+            partner = chord->second;
+        } else if (chord->second == index) {
+            partner = chord->first;
+        } else {
+            continue;
+        }
+        if ((g_keys[partner].flags & KEY_DEFERRED) != 0U) {
+            g_keys[partner].flags = KEY_CHORDED;
+            key->flags = KEY_CHORDED;
+            Keypad_Push(chord->code, KEYPAD_EVENT_CHORD, g_scanMs);
+            return;
+        }
+    }
+    key->flags = KEY_DEFERRED;
+}
+
+/*
+ * Keypad_Held
+ * One more scan with key index down: ends a held-back press, then runs
+ * the long-press and auto-repeat timers.
+ */
+static void Keypad_Held(uint8_t index)
+{
+    Keypad_KeyState *key = &g_keys[index];
+    char code = g_keyOfBit[index];
+
+    if (key->heldMs < KEYPAD_HELD_MAX) {
+        key->heldMs += KEYPAD_SCAN_MS;
+    }
+    if ((key->flags & KEY_CHORDED) != 0U) {
+        return;
+    }
+    if ((key->flags & KEY_DEFERRED) != 0U) {
+        if (key->heldMs >= KEYPAD_CHORD_MS) {
+            key->flags = 0U;                    /* No partner came */
+            Keypad_Push(code, KEYPAD_EVENT_PRESS, key->pressedAt);
+        }
+        return;
+    }
+
+    if (key->heldMs == KEYPAD_HOLD_MS) {
+        Keypad_Push(code, KEYPAD_EVENT_HOLD, g_scanMs);
+    }
+    if (g_repeatDelayMs != 0U) {
+        if (key->repeatMs > KEYPAD_SCAN_MS) {
+            key->repeatMs -= KEYPAD_SCAN_MS;
+        } else {
+            key->repeatMs = g_repeatPeriodMs;
+            Keypad_Push(code, KEYPAD_EVENT_REPEAT, g_scanMs);
+        }
+    }
+}
+
+/*
+ * Keypad_Released
+ * The release of key index has been debounced. A press still held back
+ * for a chord is reported first; keys of a chord report no release.
+ */
+static void Keypad_Released(uint8_t index)
+{
+    Keypad_KeyState *key = &g_keys[index];
+    char code = g_keyOfBit[index];
+
+    if ((key->flags & KEY_DEFERRED) != 0U) {
+        Keypad_Push(code, KEYPAD_EVENT_PRESS, key->pressedAt);
+    }
+    if ((key->flags & KEY_CHORDED) == 0U) {
+        Keypad_Push(code, KEYPAD_EVENT_RELEASE, g_scanMs);
+    }
+    key->flags = 0U;
+}
+
+/*
+ * Keypad_Debounce
+ * Advances the state machine of one key by one scan.
+ */
+static void Keypad_Debounce(uint8_t index, bool down)
+{
+    Keypad_KeyState *key = &g_keys[index];
+
+    switch (key->state) {
+        case KEY_UP:
+            if (down) {
+                key->state = KEY_PRESSING;
+                key->count = 1U;
+                g_busy |= (uint16_t)(1U << index);
+            }
+            break;
+
+        case KEY_PRESSING:
+            if (!down) {
+                key->state = KEY_UP;            /* Bounce or glitch */
+                g_busy &= (uint16_t)~(1U << index);
+            } else if (++key->count >= KEYPAD_DEBOUNCE_SCANS) {
+                key->state = KEY_DOWN;
+                Keypad_Accept(index);
+            }
+            break;
+
+        case KEY_DOWN:
+            if (!down) {
+                key->state = KEY_RELEASING;
+                key->count = 1U;
+            } else {
+                Keypad_Held(index);
+            }
+            break;
+
+        default:    /* KEY_RELEASING */
+            if (down) {
+                key->state = KEY_DOWN;
+            } else if (++key->count >= KEYPAD_DEBOUNCE_SCANS) {
+                key->state = KEY_UP;
+                g_busy &= (uint16_t)~(1U << index);
+                Keypad_Released(index);
+            }
+            break;
+    }
+}
+
+/*
+ * Keypad_ScanHandler
+ * Timer1A ISR: one scan of the matrix, every KEYPAD_SCAN_MS. With all
+ * keys up and settled it costs one row read. Only keys that read down or
+ * are mid-debounce go through the state machine.
+ */
+static void Keypad_ScanHandler(void)
+{
+    uint16_t down;
+    uint32_t pending;
+
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+    (void)TIMER1_ICR_R;     /* Clear lands before return: no re-entry */
+
+    if (g_busy == 0U && Keypad_ReadRows() == 0U) {
+        return;
+    }
+    down = Keypad_ScanMatrix();
+    if (Keypad_Ghosted(down)) {
+        g_ghostScans++;     /* Keys keep their state until it clears */
+        return;
+    }
+    g_scanMs = (uint32_t)Time_NowMs();
+
+    pending = (uint32_t)(down | g_busy);
+    while (pending != 0U) {
+        uint8_t i = (uint8_t)(31U - KEYPAD_CLZ(pending));
+        pending &= ~(1UL << i);
+        Keypad_Debounce(i, ((down >> i) & 1U) != 0U);
+    }
+}
+
 
 /*
  * Keypad_Init
  * Initializes the GPIO pins for keypad operation.
  * - Rows are set as inputs with internal pull-up resistors (PortA).
- * - Columns are set as outputs and driven HIGH (PortB).
- * This function must be called before using Keypad_GetKey.
+ * - Columns are set as outputs (PortC), driven LOW between scans.
+ * - Timer1A interrupts every KEYPAD_SCAN_MS to run the scanner.
+ * This function must be called before using the other functions.
  */
 void Keypad_Init(void) {
     uint8_t row_pins[4] = KEYPAD_ROW_PINS;
@@ -46,48 +390,125 @@ void Keypad_Init(void) {
         DIO_Init(KEYPAD_ROW_PORT, row_pins[i], INPUT);
         DIO_SetPUR(KEYPAD_ROW_PORT, row_pins[i], ENABLE);
     }
-    // Configure columns (PortB) as output and set HIGH
+    // Configure columns (PortC) as output, all LOW between scans
     for (uint8_t i = 0; i < 4; i++) {
         DIO_Init(KEYPAD_COL_PORT, col_pins[i], OUTPUT);
-        DIO_WritePin(KEYPAD_COL_PORT, col_pins[i], HIGH);
     }
+    DIO_WritePort(KEYPAD_COL_PORT, KEYPAD_COL_MASK, 0);
+
+    for (uint8_t i = 0; i < KEYPAD_KEYS; i++) {
+        g_keys[i].state = KEY_UP;
+    }
+    g_busy = 0;
+    g_ghostScans = 0;
+    g_repeatDelayMs = 0;
+    g_repeatPeriodMs = 0;
+    g_chordCount = 0;
+    g_chordKeys = 0;
+    g_head = 0;
+    g_tail = 0;
+    g_overflows = 0;
+
+    // Timer1A: 32-bit periodic, one scan per period
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+    while ((SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R1) == 0) {
+    }
+    TIMER1_CTL_R = 0;
+    TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+    TIMER1_TAILR_R = (KEYPAD_SCAN_MS * 1000U * SYSTICK_CLOCK_MHZ) - 1U;
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER1_IMR_R = TIMER_IMR_TATOIM;
+    IntRegister(KEYPAD_TIMER_VECTOR, Keypad_ScanHandler);
+    IntEnable(KEYPAD_TIMER_VECTOR);
+    TIMER1_CTL_R = TIMER_CTL_TAEN;
+}
+
+
+/*
+ * Keypad_GetEvent
+ * Takes the oldest event from the queue. The ISR only adds entries past
+ * g_head, so reading at g_tail needs no locking.
+ */
+bool Keypad_GetEvent(Keypad_Event *event) {
+    const volatile Keypad_Event *oldest;
+
+    if (g_head == g_tail) {
+        return false;
+    }
+    oldest = &g_queue[g_tail & KEYPAD_QUEUE_MASK];
+    event->key = oldest->key;
+    event->type = oldest->type;
+    event->timeMs = oldest->timeMs;
+    g_tail++;
+    return true;
+}
+
+
+/*
+ * Keypad_SetRepeat
+ * Sets the auto-repeat timing for all keys; a delay of 0 turns it off.
+ */
+void Keypad_SetRepeat(uint16_t delayMs, uint16_t periodMs) {
+    if (periodMs < KEYPAD_SCAN_MS) {
+        periodMs = KEYPAD_SCAN_MS;
+    }
+    g_repeatPeriodMs = periodMs;
+    g_repeatDelayMs = delayMs;
+}
+
+
+/*
+ * Keypad_AddChord
+ * Registers two keys pressed together as a chord reported as code. The
+ * entry is complete before the ISR can see it.
+ */
+bool Keypad_AddChord(char first, char second, char code) {
+    uint8_t a = Keypad_BitOf(first);
+    uint8_t b = Keypad_BitOf(second);
+
+    if (g_chordCount >= KEYPAD_MAX_CHORDS || a >= KEYPAD_KEYS || b >= KEYPAD_KEYS || a == b) {
+        return false;
+    }
+    g_chords[g_chordCount].first = a;
+    g_chords[g_chordCount].second = b;
+    g_chords[g_chordCount].code = code;
+    g_chordCount++;
+    g_chordKeys |= (uint16_t)((1U << a) | (1U << b));
+    return true;
 }
 
 
 /*
  * Keypad_GetKey
- * Scans the keypad and returns the character of the pressed key.
- * Returns 0 if no key is pressed.
- *
- * Scanning logic:
- *   1. Set each column LOW one at a time, others HIGH.
- *   2. Read all row inputs; if any row reads LOW, a key is pressed.
- *   3. Wait for key release (debounce).
- *   4. Return the mapped character from keypad_codes.
+ * Returns the character of a debounced key that is down, or 0.
  */
 char Keypad_GetKey(void) {
-    uint8_t row_pins[4] = KEYPAD_ROW_PINS;
-    uint8_t col_pins[4] = KEYPAD_COL_PINS;
-    for (uint8_t col = 0; col < 4; col++) {
-        // Set all columns HIGH (inactive)
-        for (uint8_t c = 0; c < 4; c++) {
-            DIO_WritePin(KEYPAD_COL_PORT, col_pins[c], HIGH);
-        }
-        // Set current column LOW (active)
-        DIO_WritePin(KEYPAD_COL_PORT, col_pins[col], LOW);
-        // Small delay for signal to settle
-        for (volatile int d = 0; d < 100; d++);
-        // Scan rows for key press
-        for (uint8_t row = 0; row < 4; row++) {
-            uint8_t pin_val = DIO_ReadPin(KEYPAD_ROW_PORT, row_pins[row]);
-            if (pin_val == LOW) {
-                // Key detected at (col, row)
-                // Wait for key release (debounce)
-                while (DIO_ReadPin(KEYPAD_ROW_PORT, row_pins[row]) == LOW);
-                // Return the mapped character from keypad_codes
-                return keypad_codes[row][col];
-            }
+    for (uint8_t i = 0; i < KEYPAD_KEYS; i++) {
+        uint8_t state = g_keys[i].state;
+        if (state == KEY_DOWN || state == KEY_RELEASING) {
+            return g_keyOfBit[i];
         }
     }
     return 0; // No key pressed
 }
+
+
+/*
+ * Keypad_Overflows
+ * Number of events dropped because the queue was full.
+ */
+uint32_t Keypad_Overflows(void) {
+    return g_overflows;
+}
+
+
+/*
+ * Keypad_GhostScans
+ * Number of scans ignored because of ghosting.
+ */
+uint32_t Keypad_GhostScans(void) {
+    return g_ghostScans;
+}
+
+
@@ -2,12 +2,28 @@
 /*****************************************************************************
  * File: keypad.h
  * Description: Header for 4x4 Keypad Driver
+ *
+ * Timer1A scans the matrix every KEYPAD_SCAN_MS from its interrupt: one
+ * port store and one port load per column give a 16-bit bitmap of the
+ * keys that read down. Scans where three pressed keys make a fourth
+ * appear pressed (ghosting) are ignored. Each key is debounced on its
+ * own: it must read the same for KEYPAD_DEBOUNCE_SCANS scans in a row
+ * before it counts as pressed or released. Every change goes into an
+ * event queue with its time, so keys typed while the application is busy
+ * are kept in order and a key that stays down never blocks anything.
+ *
+ * On top of press and release the scanner reports a long press, optional
+ * auto-repeat and two-key chords. The press of a key that belongs to a
+ * chord is held back for KEYPAD_CHORD_MS: if the partner comes within
+ * that time only the chord is reported, with no press, hold, repeat or
+ * release of either key.
  *****************************************************************************/
 
 #ifndef KEYPAD_H
 #define KEYPAD_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*
  * Keypad mapping array declaration.
@@ -19,16 +35,69 @@ extern const char keypad_codes[4][4];
 #define KEYPAD_ROWS 4
 #define KEYPAD_COLS 4
 
+/* Scanner timing */
+#define KEYPAD_SCAN_MS          1U
+#define KEYPAD_DEBOUNCE_SCANS   5U      /* Stable readings to accept a change */
+#define KEYPAD_HOLD_MS          1000U   /* Held this long: KEYPAD_EVENT_HOLD */
+#define KEYPAD_CHORD_MS         60U     /* Both keys of a chord pressed within */
+#define KEYPAD_MAX_CHORDS       4U
+
+/* Events queued (oldest first) until read by Keypad_GetEvent */
+#define KEYPAD_QUEUE_SIZE       16U
+
+/* Event types */
+#define KEYPAD_EVENT_PRESS      0U
+#define KEYPAD_EVENT_RELEASE    1U
+#define KEYPAD_EVENT_HOLD       2U      /* Once per press, after KEYPAD_HOLD_MS */
+#define KEYPAD_EVENT_REPEAT     3U      /* See Keypad_SetRepeat */
+#define KEYPAD_EVENT_CHORD      4U      /* key is the chord's code */
+
+typedef struct {
+    char key;                   /* Character from keypad_codes, or chord code */
+    uint8_t type;               /* KEYPAD_EVENT_* */
+    uint32_t timeMs;            /* Time_NowMs() of the scan that saw it */
+} Keypad_Event;
+
 /*
- * Initializes the keypad GPIO pins.
- * Must be called before using Keypad_GetKey.
+ * Initializes the keypad GPIO pins and starts the Timer1A scanner.
+ * Must be called before using the other functions.
  */
 void Keypad_Init(void);
 
 /*
- * Scans the keypad and returns the character of the pressed key.
- * Returns 0 if no key is pressed.
+ * Takes the oldest event from the queue.
+ * Returns false if there is none.
+ */
+bool Keypad_GetEvent(Keypad_Event *event);
+
+/*
+ * Auto-repeat for all keys: KEYPAD_EVENT_REPEAT delayMs after the press,
+ * then every periodMs while the key stays down. A delay of 0 (the
+ * default) turns it off.
+ */
+void Keypad_SetRepeat(uint16_t delayMs, uint16_t periodMs);
+
+/*
+ * Reports first and second pressed together (either order, within
+ * KEYPAD_CHORD_MS) as one KEYPAD_EVENT_CHORD with key = code.
+ * Returns false if the keys are unknown or KEYPAD_MAX_CHORDS are set.
+ */
+bool Keypad_AddChord(char first, char second, char code);
+
+/*
+ * Returns the character of a debounced key that is down, or 0 if no key
+ * is pressed. Does not touch the event queue.
  */
 char Keypad_GetKey(void);
 
+/*
+ * Number of events dropped because the queue was full.
+ */
+uint32_t Keypad_Overflows(void);
+
+/*
+ * Number of scans ignored because of ghosting.
+ */
+uint32_t Keypad_GhostScans(void);
+
 #endif // KEYPAD_H
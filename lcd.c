@@ -9,11 +9,23 @@
  *   D5  -> PB3 (Data bit 5)
  *   D6  -> PB4 (Data bit 6)
  *   D7  -> PB5 (Data bit 7)
+ *
+ * Bytes for the LCD go through a queue. Timer0A, in one-shot mode, is
+ * re-armed by its ISR for each step of the bus cycle: present a nibble and
+ * raise EN, lower EN after the pulse width, and wait the instruction's
+ * execution time after the second nibble. The CPU is only busy for the
+ * few register writes of each step.
  *****************************************************************************/
 
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 #include "lcd.h"
 #include "dio.h"
 #include "systick.h"
+#include "tm4c123gh6pm.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
 
 /******************************************************************************
  *                            Pin Definitions                                  *
@@ -27,34 +39,297 @@
 #define LCD_D6          PIN4
 #define LCD_D7          PIN5
 
+/* RS and D4-D7 change together; D4-D7 are adjacent, D4 lowest */
+#define LCD_EN_MASK     (1U << LCD_EN)
+#define LCD_BUS_MASK    ((1U << LCD_RS) | (0x0FU << LCD_D4))
+
+/* HD44780 timing (270 kHz oscillator) with some margin */
+#define LCD_PULSE_US    1U      /* EN high >= 450 ns, cycle >= 1 us */
+#define LCD_EXEC_US     50U     /* Most instructions: 37 us */
+#define LCD_CLEAR_US    2000U   /* Clear and home: 1.52 ms */
+
+/* Unchanged cells worth resending to avoid a cursor command */
+#define LCD_MAX_BRIDGE  1
+
+/* Byte queue: entries are the byte plus LCD_ENTRY_DATA for RS = 1 */
+#define LCD_QUEUE_SIZE  64U     /* Power of two; a full repaint is 34 */
+#define LCD_QUEUE_MASK  (LCD_QUEUE_SIZE - 1U)
+#define LCD_ENTRY_DATA  0x100U
+
+/* Writer steps, run by the Timer0A ISR */
+#define LCD_STEP_UPPER  0U      /* Present the upper nibble, EN high */
+#define LCD_STEP_LOWER  1U      /* Latch it, present the lower nibble */
+#define LCD_STEP_LATCH  2U      /* Latch the byte, wait for it to execute */
+
+#define LCD_TIMER_VECTOR    35U     /* INT_TIMER0A */
+
+/* CGRAM: slot n is shown by character 8 + n (character 0 would end a
+ * string) and its rows are written from address 0x40 + 8n */
+#define LCD_SET_CGRAM       0x40U
+#define LCD_FULL_BLOCK      ((char)0xFF)    /* All dots lit, in character ROM */
+#define LCD_CELL_DOTS       5U              /* Columns per character cell */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static char g_shadow[LCD_ROWS][LCD_COLS];   /* What the application drew */
+static char g_shown[LCD_ROWS][LCD_COLS];    /* What the LCD displays */
+static uint8_t g_row;                       /* Shadow cursor */
+static uint8_t g_col;
+static bool g_dirty;
+
+static volatile uint16_t g_queue[LCD_QUEUE_SIZE];
+static volatile uint8_t g_head;             /* Free-running; LCD_QUEUE_SIZE divides 256 */
+static volatile uint8_t g_tail;
+static volatile bool g_writing;             /* Timer0A is clocking out the queue */
+static uint8_t g_step;
+static bool g_async;
+static LCD_IdleCallback g_onIdle;
+
+typedef struct {
+    uint8_t pattern[LCD_GLYPH_ROWS];
+    uint32_t lastUse;                       /* g_glyphClock at the last hit */
+    bool loaded;
+} LCD_GlyphSlot;
+
+static LCD_GlyphSlot g_glyphs[LCD_GLYPH_SLOTS];
+static uint32_t g_glyphClock;
+
 /******************************************************************************
  *                          Private Functions                                  *
  ******************************************************************************/
 
 /*
- * LCD_EnablePulse
- * Generates a high-to-low pulse on the EN pin to latch data/command.
+ * LCD_SetBus
+ * Sets RS and D4-D7 in one store, so no partial nibble ever appears on the
+ * pins.
+ * Parameters: rs     - LOW for a command, HIGH for data
+ *             nibble - 4-bit value to send (bits 0-3 used)
  */
-static void LCD_EnablePulse(void)
+static void LCD_SetBus(uint8_t rs, uint8_t nibble)
 {
-    DIO_WritePin(LCD_PORT, LCD_EN, HIGH);
-    DelayMs(1);  /* Enable pulse width */
-    DIO_WritePin(LCD_PORT, LCD_EN, LOW);
-    DelayMs(1);  /* Wait for command to execute */
+    DIO_WritePort(LCD_PORT, LCD_BUS_MASK,
+                  (uint8_t)((rs << LCD_RS) | ((nibble & 0x0FU) << LCD_D4)));
+}
+
+static void LCD_SetEnable(uint8_t level)
+{
+    DIO_WritePort(LCD_PORT, LCD_EN_MASK, (level == HIGH) ? LCD_EN_MASK : 0U);
 }
 
 /*
  * LCD_Send4Bits
- * Sends 4 bits of data to the LCD via D4-D7 pins.
- * Parameters: nibble - 4-bit value to send (bits 0-3 used)
+ * Presents a nibble and latches it with a pulse on EN.
+ */
+static void LCD_Send4Bits(uint8_t rs, uint8_t nibble)
+{
+    LCD_SetBus(rs, nibble);
+    LCD_SetEnable(HIGH);
+    DelayUs(LCD_PULSE_US);  /* Enable pulse width */
+    LCD_SetEnable(LOW);
+    DelayUs(LCD_PULSE_US);  /* Enable cycle time before the next nibble */
+}
+
+/*
+ * LCD_ExecUs
+ * Time the LCD needs to execute a queue entry.
+ */
+static uint32_t LCD_ExecUs(uint16_t entry)
+{
+    if (entry == LCD_CLEAR || entry == LCD_HOME) {
+        return LCD_CLEAR_US;  /* Clear and home commands take longer */
+    }
+    return LCD_EXEC_US;
+}
+
+/*
+ * LCD_WriteSync
+ * Sends a queue entry from the caller, busy-waiting the LCD timing.
+ */
+static void LCD_WriteSync(uint16_t entry)
+{
+    uint8_t rs = ((entry & LCD_ENTRY_DATA) != 0U) ? HIGH : LOW;
+    
+    LCD_Send4Bits(rs, (uint8_t)(entry >> 4));
+    LCD_Send4Bits(rs, (uint8_t)entry);
+    DelayUs(LCD_ExecUs(entry));
+}
+
+/*
+ * LCD_ArmTimer
+ * Starts Timer0A to time out once after us microseconds.
+ */
+static void LCD_ArmTimer(uint32_t us)
+{
+    TIMER0_TAILR_R = (us * SYSTICK_CLOCK_MHZ) - 1U;
+    TIMER0_CTL_R = TIMER_CTL_TAEN;
+}
+
+/*
+ * LCD_WriterHandler
+ * Timer0A ISR: one step of the bus cycle for the entry at the queue tail.
+ */
+static void LCD_WriterHandler(void)
+{
+    uint16_t entry = g_queue[g_tail & LCD_QUEUE_MASK];
+    uint8_t rs = ((entry & LCD_ENTRY_DATA) != 0U) ? HIGH : LOW;
+    
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    (void)TIMER0_ICR_R;     /* Clear lands before return: no re-entry */
+    
+    if (g_step == LCD_STEP_UPPER) {
+        /* The previous entry has executed */
+        if (g_head == g_tail) {
+            g_writing = false;
+            if (g_onIdle != NULL) {
+                g_onIdle();
+            }
+            return;
+        }
+        LCD_SetBus(rs, (uint8_t)(entry >> 4));
+        LCD_SetEnable(HIGH);
+        g_step = LCD_STEP_LOWER;
+        LCD_ArmTimer(LCD_PULSE_US);
+    } else if (g_step == LCD_STEP_LOWER) {
+        LCD_SetEnable(LOW);
+        LCD_SetBus(rs, (uint8_t)entry);
+        LCD_SetEnable(HIGH);
+        g_step = LCD_STEP_LATCH;
+        LCD_ArmTimer(LCD_PULSE_US);
+    } else {
+        LCD_SetEnable(LOW);
+        g_tail++;
+        g_step = LCD_STEP_UPPER;
+        LCD_ArmTimer(LCD_ExecUs(entry));
+    }
+}
+
+/*
+ * LCD_WaitWhile
+ * Sleeps until the writer has changed the condition. The check runs
+ * masked; WFI still wakes on the pending Timer0A interrupt.
+ */
+static void LCD_WaitWhile(bool (*condition)(void))
+{
+    while (condition()) {
+        bool wasMasked = IntMasterDisable();
+        
+        if (condition()) {
+            SysCtlSleep();
+        }
+        if (!wasMasked) {
+            IntMasterEnable();
+        }
+    }
+}
+
+static bool LCD_QueueFull(void)
+{
+    return (uint8_t)(g_head - g_tail) == LCD_QUEUE_SIZE;
+}
+
+static bool LCD_Busy(void)
+{
+    return g_writing;
+}
+
+/*
+ * LCD_Write
+ * Queues an entry for the writer, or sends it now in synchronous mode.
+ */
+static void LCD_Write(uint16_t entry)
+{
+    bool wasMasked;
+    
+    if (!g_async) {
+        LCD_WriteSync(entry);
+        return;
+    }
+    
+    LCD_WaitWhile(LCD_QueueFull);
+    wasMasked = IntMasterDisable();
+    g_queue[g_head & LCD_QUEUE_MASK] = entry;
+    g_head++;
+    if (!g_writing) {
+        g_writing = true;
+        g_step = LCD_STEP_UPPER;
+        LCD_ArmTimer(LCD_PULSE_US);
+    }
+    if (!wasMasked) {
+        IntMasterEnable();
+    }
+}
+
+/*
+ * LCD_Put
+ * Writes one character into the shadow display at the cursor.
+ */
+static void LCD_Put(char c)
+{
+    if (g_col < LCD_COLS) {
+        if (g_shadow[g_row][g_col] != c) {
+            g_shadow[g_row][g_col] = c;
+            g_dirty = true;
+        }
+        g_col++;
+    }
+}
+
+/*
+ * LCD_FlushRow
+ * Sends the changed cells of one row, one cursor command per run.
+ */
+static void LCD_FlushRow(uint8_t row)
+{
+    uint8_t col = 0;
+    uint8_t end;
+    uint8_t same;
+    
+    while (col < LCD_COLS) {
+        if (g_shadow[row][col] == g_shown[row][col]) {
+            col++;
+            continue;
+        }
+        
+        /* Extend the run over changed cells and short unchanged gaps */
+        end = col + 1;
+        same = 0;
+        while (end + same < LCD_COLS && same <= LCD_MAX_BRIDGE) {
+            if (g_shadow[row][end + same] != g_shown[row][end + same]) {
+                end += same + 1;
+                same = 0;
+            } else {
+                same++;
+            }
+        }
+        
+        LCD_Write((uint16_t)((row == 0 ? LCD_LINE1 : LCD_LINE2) + col));
+        for (; col < end; col++) {
+            LCD_Write(LCD_ENTRY_DATA | (uint8_t)g_shadow[row][col]);
+            g_shown[row][col] = g_shadow[row][col];
+        }
+    }
+}
+
+/*
+ * LCD_GlyphOnScreen
+ * True if a glyph character is drawn or still shown anywhere, so its slot
+ * must not be reloaded.
  */
-static void LCD_Send4Bits(uint8_t nibble)
+static bool LCD_GlyphOnScreen(char code)
 {
-    DIO_WritePin(LCD_PORT, LCD_D4, (nibble >> 0) & 0x01);
-    DIO_WritePin(LCD_PORT, LCD_D5, (nibble >> 1) & 0x01);
-    DIO_WritePin(LCD_PORT, LCD_D6, (nibble >> 2) & 0x01);
-    DIO_WritePin(LCD_PORT, LCD_D7, (nibble >> 3) & 0x01);
-    LCD_EnablePulse();
+    uint8_t row;
+    uint8_t col;
+    
+    for (row = 0; row < LCD_ROWS; row++) {
+        for (col = 0; col < LCD_COLS; col++) {
+            if (g_shadow[row][col] == code || g_shown[row][col] == code) {
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 /******************************************************************************
@@ -67,6 +342,9 @@ static void LCD_Send4Bits(uint8_t nibble)
  */
 void LCD_Init(void)
 {
+    uint8_t row;
+    uint8_t col;
+    
     /* Initialize GPIO pins as outputs */
     DIO_Init(LCD_PORT, LCD_RS, OUTPUT);
     DIO_Init(LCD_PORT, LCD_EN, OUTPUT);
@@ -84,120 +362,285 @@ void LCD_Init(void)
     
     /* Initialization sequence for 4-bit mode */
     /* Send 0x03 three times to ensure 8-bit mode is cleared */
-    DIO_WritePin(LCD_PORT, LCD_RS, LOW);  /* Command mode */
-    
-    LCD_Send4Bits(0x03);
-    DelayMs(5);
+    LCD_Send4Bits(LOW, 0x03);
+    DelayUs(4500);  /* > 4.1 ms */
     
-    LCD_Send4Bits(0x03);
-    DelayMs(1);
+    LCD_Send4Bits(LOW, 0x03);
+    DelayUs(150);   /* > 100 us */
     
-    LCD_Send4Bits(0x03);
-    DelayMs(1);
+    LCD_Send4Bits(LOW, 0x03);
+    DelayUs(LCD_EXEC_US);
     
     /* Set to 4-bit mode */
-    LCD_Send4Bits(0x02);
-    DelayMs(1);
+    LCD_Send4Bits(LOW, 0x02);
+    DelayUs(LCD_EXEC_US);
     
     /* Function set: 4-bit mode, 2 lines, 5x8 font */
-    LCD_SendCommand(LCD_4BIT_MODE);
+    LCD_WriteSync(LCD_4BIT_MODE);
     
-    /* Display ON, cursor ON, blink OFF */
-    LCD_SendCommand(LCD_CURSOR_ON);
+    /* Display ON, cursor OFF: writes come from LCD_Flush, so the hardware
+     * cursor does not mark where the application writes next */
+    LCD_WriteSync(LCD_DISPLAY_ON);
     
     /* Clear display */
-    LCD_Clear();
+    LCD_WriteSync(LCD_CLEAR);
     
     /* Entry mode: increment cursor, no display shift */
-    LCD_SendCommand(LCD_ENTRY_MODE);
+    LCD_WriteSync(LCD_ENTRY_MODE);
+    
+    /* Timer0A: 32-bit one-shot, drives the queued writer */
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
+    while ((SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R0) == 0) {
+    }
+    TIMER0_CTL_R = 0;
+    TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;
+    TIMER0_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;
+    TIMER0_IMR_R = TIMER_IMR_TATOIM;
+    IntRegister(LCD_TIMER_VECTOR, LCD_WriterHandler);
+    IntEnable(LCD_TIMER_VECTOR);
+    g_head = 0;
+    g_tail = 0;
+    g_writing = false;
+    g_async = true;
+    
+    /* CGRAM contents are unknown after power-up */
+    memset(g_glyphs, 0, sizeof(g_glyphs));
+    g_glyphClock = 0;
+    
+    /* Shadow and LCD both blank */
+    LCD_Clear();
+    for (row = 0; row < LCD_ROWS; row++) {
+        for (col = 0; col < LCD_COLS; col++) {
+            g_shown[row][col] = ' ';
+        }
+    }
+    g_dirty = false;
 }
 
 /*
  * LCD_SendCommand
- * Sends a command to the LCD (RS = 0).
+ * Sends a command to the LCD (RS = 0), after any queued bytes.
  */
 void LCD_SendCommand(uint8_t command)
 {
-    DIO_WritePin(LCD_PORT, LCD_RS, LOW);  /* Command mode */
-    
-    /* Send upper nibble */
-    LCD_Send4Bits(command >> 4);
-    
-    /* Send lower nibble */
-    LCD_Send4Bits(command & 0x0F);
-    
-    /* Wait for command to execute */
-    if (command == LCD_CLEAR || command == LCD_HOME) {
-        DelayMs(2);  /* Clear and home commands take longer */
-    } else {
-        DelayMs(1);
-    }
+    LCD_Write(command);
 }
 
 /*
  * LCD_SendData
- * Sends a data byte to the LCD (RS = 1).
+ * Sends a data byte to the LCD (RS = 1), after any queued bytes.
  */
 void LCD_SendData(uint8_t data)
 {
-    DIO_WritePin(LCD_PORT, LCD_RS, HIGH);  /* Data mode */
-    
-    /* Send upper nibble */
-    LCD_Send4Bits(data >> 4);
-    
-    /* Send lower nibble */
-    LCD_Send4Bits(data & 0x0F);
-    
-    DelayMs(1);  /* Wait for data to be written */
+    LCD_Write(LCD_ENTRY_DATA | data);
 }
 
 /*
  * LCD_Clear
- * Clears the LCD display and returns cursor to home position.
+ * Blanks the shadow display and returns cursor to home position.
  */
 void LCD_Clear(void)
 {
-    LCD_SendCommand(LCD_CLEAR);
-    DelayMs(2);  /* Clear command takes longer to execute */
+    uint8_t row;
+    
+    for (row = 0; row < LCD_ROWS; row++) {
+        LCD_SetCursor(row, 0);
+        while (g_col < LCD_COLS) {
+            LCD_Put(' ');
+        }
+    }
+    LCD_SetCursor(0, 0);
 }
 
 /*
  * LCD_SetCursor
- * Sets the cursor position on the LCD.
+ * Sets the position of the next shadow display write.
  * Parameters: 
  *   row - Row number (0 or 1)
  *   col - Column number (0 to 15)
  */
 void LCD_SetCursor(uint8_t row, uint8_t col)
 {
-    uint8_t address;
-    
-    if (row == 0) {
-        address = LCD_LINE1 + col;
-    } else {
-        address = LCD_LINE2 + col;
-    }
-    
-    LCD_SendCommand(address);
+    g_row = (row == 0) ? 0 : 1;
+    g_col = col;
 }
 
 /*
  * LCD_WriteString
- * Writes a string to the LCD at the current cursor position.
+ * Writes a string at the current cursor position.
  */
 void LCD_WriteString(const char *str)
 {
     while (*str != '\0') {
-        LCD_SendData(*str);
+        LCD_Put(*str);
         str++;
     }
 }
 
 /*
  * LCD_WriteChar
- * Writes a single character to the LCD at the current cursor position.
+ * Writes a single character at the current cursor position.
  */
 void LCD_WriteChar(char c)
 {
-    LCD_SendData(c);
+    LCD_Put(c);
+}
+
+/*
+ * LCD_Printf
+ * Formats text into the shadow display at row, col.
+ */
+void LCD_Printf(uint8_t row, uint8_t col, const char *format, ...)
+{
+    char text[LCD_COLS + 1];
+    va_list args;
+    
+    va_start(args, format);
+    (void)vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    
+    LCD_SetCursor(row, col);
+    LCD_WriteString(text);
+}
+
+/*
+ * LCD_IsDirty
+ * Returns true if the shadow display has unsent changes.
+ */
+bool LCD_IsDirty(void)
+{
+    return g_dirty;
+}
+
+/*
+ * LCD_Flush
+ * Sends the changed cells to the LCD.
+ */
+void LCD_Flush(void)
+{
+    uint8_t row;
+    
+    if (!g_dirty) {
+        return;
+    }
+    g_dirty = false;
+    for (row = 0; row < LCD_ROWS; row++) {
+        LCD_FlushRow(row);
+    }
+}
+
+/*
+ * LCD_IsIdle
+ * Returns true once every queued byte has been written and executed.
+ */
+bool LCD_IsIdle(void)
+{
+    return !g_writing;
+}
+
+/*
+ * LCD_SetIdleCallback
+ * Sets the function the writer calls when the queue runs empty.
+ */
+void LCD_SetIdleCallback(LCD_IdleCallback callback)
+{
+    g_onIdle = callback;
+}
+
+/*
+ * LCD_SetAsync
+ * Chooses between the queued writer and synchronous writes.
+ */
+void LCD_SetAsync(bool enable)
+{
+    if (!enable) {
+        LCD_WaitWhile(LCD_Busy);
+    }
+    g_async = enable;
+}
+
+/*
+ * LCD_Glyph
+ * Returns the character for a custom 5x8 pattern. A hit costs nothing; a
+ * miss queues the pattern into a free CGRAM slot, or into the least
+ * recently used one that is not on screen.
+ */
+char LCD_Glyph(const uint8_t pattern[LCD_GLYPH_ROWS])
+{
+    LCD_GlyphSlot *victim = NULL;
+    uint8_t slot;
+    uint8_t i;
+    
+    g_glyphClock++;
+    for (slot = 0; slot < LCD_GLYPH_SLOTS; slot++) {
+        if (g_glyphs[slot].loaded &&
+            memcmp(g_glyphs[slot].pattern, pattern, LCD_GLYPH_ROWS) == 0) {
+            g_glyphs[slot].lastUse = g_glyphClock;
+            return (char)(LCD_GLYPH_FIRST + slot);
+        }
+    }
+    
+    for (slot = 0; slot < LCD_GLYPH_SLOTS; slot++) {
+        LCD_GlyphSlot *candidate = &g_glyphs[slot];
+        
+        if (!candidate->loaded) {
+            victim = candidate;
+            break;
+        }
+        if (!LCD_GlyphOnScreen((char)(LCD_GLYPH_FIRST + slot)) &&
+            (victim == NULL || candidate->lastUse < victim->lastUse)) {
+            victim = candidate;
+        }
+    }
+    if (victim == NULL) {
+        return LCD_NO_GLYPH;
+    }
+    
+    /* Upload; the next flush run starts with a cursor command, which
+     * switches writes back to the display */
+    slot = (uint8_t)(victim - g_glyphs);
+    LCD_Write((uint16_t)(LCD_SET_CGRAM | (slot * LCD_GLYPH_ROWS)));
+    for (i = 0; i < LCD_GLYPH_ROWS; i++) {
+        victim->pattern[i] = pattern[i] & 0x1FU;
+        LCD_Write(LCD_ENTRY_DATA | victim->pattern[i]);
+    }
+    victim->loaded = true;
+    victim->lastUse = g_glyphClock;
+    return (char)(LCD_GLYPH_FIRST + slot);
+}
+
+/*
+ * LCD_Bar
+ * Draws a horizontal bar graph into the shadow display.
+ */
+void LCD_Bar(uint8_t row, uint8_t col, uint8_t width, uint32_t value, uint32_t max)
+{
+    uint8_t pattern[LCD_GLYPH_ROWS];
+    uint32_t lit = 0;
+    uint32_t dots;
+    uint8_t i;
+    char c;
+    
+    if (max > 0U) {
+        lit = (uint32_t)(((uint64_t)((value < max) ? value : max) * width * LCD_CELL_DOTS) / max);
+    }
+    
+    LCD_SetCursor(row, col);
+    for (i = 0; i < width; i++) {
+        dots = (lit > i * LCD_CELL_DOTS) ? (lit - (i * LCD_CELL_DOTS)) : 0U;
+        if (dots >= LCD_CELL_DOTS) {
+            c = LCD_FULL_BLOCK;
+        } else if (dots == 0U) {
+            c = ' ';
+        } else {
+            /* Leftmost dots of every row lit */
+            memset(pattern, (0x1F << (LCD_CELL_DOTS - dots)) & 0x1F, sizeof(pattern));
+            c = LCD_Glyph(pattern);
+            if (c == LCD_NO_GLYPH) {
+                c = ' ';
+            }
+        }
+        LCD_Put(c);
+    }
 }
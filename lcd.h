@@ -9,12 +9,25 @@
  *   D5  -> PB3 (Data bit 5)
  *   D6  -> PB4 (Data bit 6)
  *   D7  -> PB5 (Data bit 7)
+ *
+ * Screen writes (LCD_Clear, LCD_SetCursor, LCD_WriteString, LCD_WriteChar,
+ * LCD_Printf) go to a shadow copy of the display in RAM. LCD_Flush sends
+ * only the cells that differ from what the LCD shows, so redrawing a
+ * screen with mostly the same text costs a few bytes and does not
+ * flicker.
+ *
+ * LCD_Flush, LCD_SendCommand and LCD_SendData queue their bytes and return;
+ * a Timer0A interrupt clocks them out one nibble at a time, so screen
+ * updates overlap with keypad scanning and UART handling. Bytes reach the
+ * LCD in the order they were queued. LCD_SetAsync(false) writes from the
+ * caller instead, e.g. with interrupts masked.
  *****************************************************************************/
 
 #ifndef LCD_H
 #define LCD_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /******************************************************************************
  *                              LCD Commands                                   *
@@ -36,6 +49,19 @@
 #define LCD_LINE1           0x80    /* First line address */
 #define LCD_LINE2           0xC0    /* Second line address */
 
+/* Display size */
+#define LCD_ROWS            2
+#define LCD_COLS            16
+
+/* Custom characters: 8 CGRAM slots of 5x8 dots, one byte per row */
+#define LCD_GLYPH_SLOTS     8
+#define LCD_GLYPH_ROWS      8
+#define LCD_GLYPH_FIRST     0x08    /* Character code of slot 0 */
+#define LCD_NO_GLYPH        '\0'    /* Every slot is on screen */
+
+/* Called from the Timer0A interrupt when the queued writer goes idle */
+typedef void (*LCD_IdleCallback)(void);
+
 /******************************************************************************
  *                          Function Prototypes                                *
  ******************************************************************************/
@@ -49,27 +75,27 @@ void LCD_Init(void);
 
 /*
  * LCD_SendCommand
- * Sends a command to the LCD (RS = 0).
+ * Queues a command for the LCD (RS = 0).
  * Parameters: command - LCD command byte
  */
 void LCD_SendCommand(uint8_t command);
 
 /*
  * LCD_SendData
- * Sends a data byte to the LCD (RS = 1).
+ * Queues a data byte for the LCD (RS = 1).
  * Parameters: data - Character to display
  */
 void LCD_SendData(uint8_t data);
 
 /*
  * LCD_Clear
- * Clears the LCD display and returns cursor to home position.
+ * Blanks the shadow display and returns the cursor to home position.
  */
 void LCD_Clear(void);
 
 /*
  * LCD_SetCursor
- * Sets the cursor position on the LCD.
+ * Sets the position of the next shadow display write.
  * Parameters: 
  *   row - Row number (0 or 1)
  *   col - Column number (0 to 15)
@@ -78,16 +104,77 @@ void LCD_SetCursor(uint8_t row, uint8_t col);
 
 /*
  * LCD_WriteString
- * Writes a string to the LCD at the current cursor position.
+ * Writes a string at the current cursor position. Characters past the
+ * end of the row are dropped, as on the LCD.
  * Parameters: str - Pointer to null-terminated string
  */
 void LCD_WriteString(const char *str);
 
 /*
  * LCD_WriteChar
- * Writes a single character to the LCD at the current cursor position.
+ * Writes a single character at the current cursor position.
  * Parameters: c - Character to display
  */
 void LCD_WriteChar(char c);
 
+/*
+ * LCD_Printf
+ * Formats text (printf-style) into the shadow display at row, col and
+ * leaves the cursor after it. Clipped at the end of the row.
+ */
+void LCD_Printf(uint8_t row, uint8_t col, const char *format, ...);
+
+/*
+ * LCD_IsDirty
+ * Returns true if the shadow display has changes LCD_Flush has not sent.
+ */
+bool LCD_IsDirty(void);
+
+/*
+ * LCD_Flush
+ * Sends the changed cells to the LCD. Each run of changed cells costs one
+ * cursor command plus its characters; a single unchanged cell inside a
+ * run is resent rather than paying for a second cursor command.
+ */
+void LCD_Flush(void);
+
+/*
+ * LCD_IsIdle
+ * Returns true once every queued byte has been written and executed.
+ */
+bool LCD_IsIdle(void);
+
+/*
+ * LCD_SetIdleCallback
+ * Sets a function called (from the Timer0A interrupt) each time the queue
+ * has been written out. NULL removes it.
+ */
+void LCD_SetIdleCallback(LCD_IdleCallback callback);
+
+/*
+ * LCD_SetAsync
+ * true (the default after LCD_Init): bytes are queued and written by the
+ * Timer0A interrupt. false: each byte is written before the call returns,
+ * busy-waiting the LCD timing; waits for queued bytes first.
+ */
+void LCD_SetAsync(bool enable);
+
+/*
+ * LCD_Glyph
+ * Returns the character code (LCD_GLYPH_FIRST + slot) that shows a custom
+ * pattern (bits 4-0 of each row, top row first), for use with
+ * LCD_WriteChar. Patterns stay loaded until evicted: a miss queues an
+ * upload into a free slot or the least recently used slot that is not on
+ * screen. Returns LCD_NO_GLYPH if all slots are on screen.
+ */
+char LCD_Glyph(const uint8_t pattern[LCD_GLYPH_ROWS]);
+
+/*
+ * LCD_Bar
+ * Draws a horizontal bar graph width cells wide at row, col, filled to
+ * value / max with single-dot resolution (5 dots per cell). Full cells
+ * come from character ROM; the partly lit cell uses one glyph.
+ */
+void LCD_Bar(uint8_t row, uint8_t col, uint8_t width, uint32_t value, uint32_t max);
+
 #endif /* LCD_H */
@@ -8,47 +8,26 @@
  *   - Main menu: Open Door / Change Password / Set Auto-Lock Timeout
  *   - Password verification with 3 attempts
  *   - Potentiometer-based timeout adjustment (5-30 seconds)
- *   - Communication with Control ECU via UART5
+ *   - Communication with Control ECU via UART5 (framed, see protocol.h)
  ******************************************************************************/
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <stddef.h>
 #include "lcd.h"
 #include "keypad.h"
 #include "potentiometer.h"
 #include "uart.h"
 #include "systick.h"
+#include "sched.h"
+#include "protocol.h"
+#include "comm.h"
 
 /******************************************************************************
  *                              Definitions                                    *
  ******************************************************************************/
 
-/* UART Communication Commands */
-#define CMD_SETUP_PASSWORD      0x01
-#define CMD_VERIFY_PASSWORD     0x02
-#define CMD_CHANGE_PASSWORD     0x03
-#define CMD_SET_TIMEOUT         0x04
-#define CMD_OPEN_DOOR           0x05
-#define CMD_ERASE_EEPROM        0x06
-#define CMD_CHECK_PASSWORD      0x07
-#define CMD_TRIGGER_LOCKOUT     0x08
-
-/* UART Response Codes */
-#define RESP_PASSWORD_MATCH     0x10
-#define RESP_PASSWORD_MISMATCH  0x11
-#define RESP_TIMEOUT_SAVED      0x12
-#define RESP_DOOR_UNLOCKING     0x13
-#define RESP_DOOR_LOCKING       0x14
-#define RESP_DOOR_LOCKED        0x15
-#define RESP_SYSTEM_LOCKED      0x16
-#define RESP_EEPROM_ERASED      0x17
-#define RESP_PASSWORD_EXISTS    0x18
-#define RESP_NO_PASSWORD        0x19
-#define RESP_COUNTDOWN_START    0x1A
-
 /* Password Configuration */
-#define PASSWORD_LENGTH         5
 #define MAX_ATTEMPTS            3
 
 /* Menu Keys */
@@ -57,19 +36,109 @@
 #define KEY_SET_TIMEOUT         'C'
 #define KEY_ERASE_EEPROM        'D'
 #define KEY_SAVE                '*'
+#define KEY_STATUS              '#'     /* Door status while the door is open */
+#define KEY_LOCK_NOW            '*'     /* Lock at once while the door is open */
+#define KEY_BACKSPACE           'D'     /* Deletes a digit; repeats while held */
+#define KEY_BACK                '\x1B'  /* '*' and '#' together: back to the menu */
 
 #define UART_RESPONSE_TIMEOUT_MS   (5000U)
+#define PASSWORD_CHECK_TIMEOUT_MS  (2000U)
+#define STATUS_HOLD_MS             (2000U)
+#define DOOR_POLL_MS               (10U)
+#define KEY_POLL_MS                (1U)     /* Key events are queued: no debounce wait */
+#define KEY_REPEAT_DELAY_MS        (500U)
+#define KEY_REPEAT_PERIOD_MS       (150U)
+#define POT_POLL_MS                (20U)    /* POT_ReadFiltered never waits for the ADC */
 #define LOCKOUT_DURATION_MS        (10000U)
 #define TIMEOUT_MIN_SECONDS        (5U)
 #define TIMEOUT_MAX_SECONDS        (30U)
 #define RESP_TIMEOUT   (0xFFU)
+
+/* Tasks, by priority (highest first). The menus run in the background
+ * and let the tasks run whenever they wait (Sched_RunFor). */
+#define TASK_LINK               1   /* Hands responses to their requests */
+#define TASK_LCD                0   /* Sends screen changes to the LCD */
+
+/* Task events */
+#define EVENT_RX                0x01U   /* UART5 received bytes */
+#define EVENT_TICK              0x02U   /* Periodic timer */
+#define EVENT_LCD_IDLE          0x04U   /* LCD writer sent everything */
+
+#define LINK_TICK_MS               (1U)     /* Request timeout resolution */
+#define LCD_REFRESH_MS             (10U)
+
+/* Outcome of a single-response request; a save also gets RESP_STORED */
+typedef struct {
+    bool done;
+    uint8_t type;                   /* RESP_* or RESP_TIMEOUT */
+    uint8_t stored;                 /* STORED_*, or one of the two below */
+} Reply;
+
+#define STORED_PENDING          0xFEU   /* RESP_STORED not received yet */
+#define STORED_UNKNOWN          0xFFU   /* Timed out waiting for RESP_STORED */
+
+/* Progress of an open-door request, updated as responses arrive */
+typedef struct {
+    bool granted;                   /* RESP_PASSWORD_MATCH received */
+    bool done;
+    uint8_t phase;                  /* Last RESP_* other than a countdown */
+    uint8_t secondsLeft;
+} DoorProgress;
+
+/* What the HMI knows about the stored password (CMD_CHECK_PASSWORD) */
+#define PASSWORD_UNKNOWN        0U  /* Not asked, or the query timed out */
+#define PASSWORD_ASKING         1U
+#define PASSWORD_SET            2U
+#define PASSWORD_NONE           3U
+
+/* Outcome of SetupPassword() */
+#define SETUP_SAVED             0U
+#define SETUP_RETRY             1U  /* Mismatch or failed save: ask again */
+#define SETUP_BACKED_OUT        2U  /* KEY_BACK: nothing was sent */
+
+/* Answer to a status query */
+typedef struct {
+    bool valid;
+    uint8_t status[STATUS_LENGTH];
+} StatusReply;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Reply g_reply;
+static char g_unreadKey;                /* Returned by the next ReadKey() */
+static uint32_t g_linkPolledMs;
+static uint8_t g_passwordState = PASSWORD_UNKNOWN;
+
 /******************************************************************************
  *                          Function Prototypes                                *
  ******************************************************************************/
 
-static void GetPassword(char *password);
-void SendPassword(const char *password);
-bool SetupPassword(void);
+static bool GetPassword(char *password);
+static uint8_t SendRequest(uint8_t command, const char *password,
+                           const uint8_t *extra, uint8_t extraLength,
+                           uint32_t timeoutMs, Comm_Handler handler, void *context);
+static void SendCommand(uint8_t command, const char *password,
+                        const uint8_t *extra, uint8_t extraLength);
+static bool OnReply(const Proto_Frame *response, void *context);
+static void SendSave(uint8_t command, const char *password,
+                     const uint8_t *extra, uint8_t extraLength);
+static bool OnSaveReply(const Proto_Frame *response, void *context);
+static uint8_t WaitForStored(void);
+static bool OnDoorProgress(const Proto_Frame *response, void *context);
+static bool OnStatus(const Proto_Frame *response, void *context);
+static bool OnStatusHoldEnd(void *context);
+static bool OnPasswordState(const Proto_Frame *response, void *context);
+static void AskPasswordExists(void);
+static void OnUartRx(void);
+static void OnLcdIdle(void);
+static bool OnTick(void *context);
+static void LinkTask(uint32_t events);
+static void LcdTask(uint32_t events);
+static char ReadKey(void);
+static void ShowDoorCycle(DoorProgress *door);
+uint8_t SetupPassword(void);
 void DisplayMainMenu(void);
 void HandleOpenDoor(void);
 void HandleChangePassword(void);
@@ -88,38 +157,57 @@ int main(void)
     bool passwordSet = false;
     
     /* Initialize all peripherals */
-    SysTick_Init(16000, SYSTICK_NOINT); /* 1ms tick */
+    SysTick_Init(16000, SYSTICK_INT);   /* 1ms tick interrupt */
     UART5_Init();
+    Comm_Init();
     Keypad_Init();
+    Keypad_SetRepeat(KEY_REPEAT_DELAY_MS, KEY_REPEAT_PERIOD_MS);
+    (void)Keypad_AddChord('*', '#', KEY_BACK);
     POT_Init();
     LCD_Init();
     
+    /* Tasks: the link wakes on received bytes and every tick, screen
+     * changes are sent periodically. The keypad scans itself (Timer1A). */
+    Sched_Init();
+    (void)Sched_AddTask(TASK_LINK, LinkTask);
+    (void)Sched_AddTask(TASK_LCD, LcdTask);
+    UART5_SetRxCallback(OnUartRx);
+    LCD_SetIdleCallback(OnLcdIdle);
+    g_linkPolledMs = (uint32_t)Time_NowMs();
+    (void)Timer_Start(LINK_TICK_MS, OnTick, (void *)(uintptr_t)TASK_LINK);
+    (void)Timer_Start(LCD_REFRESH_MS, OnTick, (void *)(uintptr_t)TASK_LCD);
+    
+    /* Ask whether a password exists now; the answer arrives while the
+     * welcome message is shown */
+    AskPasswordExists();
+    
     /* Display welcome message */
     LCD_Clear();
     LCD_SetCursor(0, 0);
     LCD_WriteString("Smart Door Lock");
     LCD_SetCursor(1, 0);
     LCD_WriteString("System Ready");
-    DelayMs(2000);
+    Sched_RunFor(2000);
     
     /* Check if password already exists in EEPROM */
-    LCD_Clear();
-    LCD_SetCursor(0, 0);
-    LCD_WriteString("Checking...");
-    DelayMs(500);
+    if (g_passwordState != PASSWORD_SET && g_passwordState != PASSWORD_NONE) {
+        LCD_Clear();
+        LCD_SetCursor(0, 0);
+        LCD_WriteString("Checking...");
+    }
     
     passwordSet = CheckPasswordExists();
     
     /* Step 1: Initial Password Setup (only if no password exists) */
     if (!passwordSet) {
-        while (!passwordSet) {
-            passwordSet = SetupPassword();
+        /* No password to fall back on: backing out only asks again */
+        while (SetupPassword() != SETUP_SAVED) {
         }
     } else {
         LCD_Clear();
         LCD_SetCursor(0, 0);
         LCD_WriteString("Password Found");
-        DelayMs(1500);
+        Sched_RunFor(1500);
     }
     
     /* Main loop */
@@ -130,8 +218,15 @@ int main(void)
         /* Wait for user input */
         key = 0;
         while (key == 0) {
-            key = Keypad_GetKey();
-            DelayMs(10); /* Debounce delay */
+            key = ReadKey();
+            Sched_RunFor(KEY_POLL_MS);
+        }
+        
+        /* Shortcut: typing the password at the menu opens the door, the
+         * first digit already entered */
+        if (key >= '0' && key <= '9') {
+            g_unreadKey = key;
+            key = KEY_OPEN_DOOR;
         }
         
         /* Handle menu selection */
@@ -152,11 +247,14 @@ int main(void)
                 HandleEraseEEPROM();
                 break;
                 
+            case KEY_BACK:
+                break;      /* Already at the menu */
+                
             default:
                 LCD_Clear();
                 LCD_SetCursor(0, 0);
                 LCD_WriteString("Invalid Choice");
-                DelayMs(1000);
+                Sched_RunFor(1000);
                 break;
         }
     }
@@ -169,73 +267,353 @@ int main(void)
 /*
  * GetPassword
  * Prompts user to enter a 5-digit password via keypad
- * Displays asterisks (*) for each digit entered
+ * Displays asterisks (*) for each digit entered; KEY_BACKSPACE deletes
+ * the last one
+ * Returns false if the user backed out with KEY_BACK
  */
-static void GetPassword(char *password)
-{ 
-  if (password == NULL) {
-        return; /* or handle error */
-    } uint8_t i = 0;
+static bool GetPassword(char *password)
+{
+    uint8_t i = 0;
     char key;
+    
+    if (password == NULL) {
+        return false;
+    }
     while (i < PASSWORD_LENGTH) {
-        key = Keypad_GetKey();
+        key = ReadKey();
         if (key >= '0' && key <= '9') {
             password[i] = key;
             LCD_WriteChar('*');
             i++;
-            DelayMs(200);
+        } else if (key == KEY_BACKSPACE && i > 0U) {
+            i--;
+            LCD_Printf(1, i, " ");
+            LCD_SetCursor(1, i);
+        } else if (key == KEY_BACK) {
+            return false;
+        } else if (key == 0) {
+            Sched_RunFor(KEY_POLL_MS);
+        }
+    }
+    password[PASSWORD_LENGTH] = '\0';
+    return true;
+}
+
+/*
+ * SendRequest
+ * Sends a command with an optional 5-digit password and extra bytes to
+ * the Control ECU as one protocol frame and returns while it is on the
+ * wire (uDMA). Responses go to handler from the link task.
+ * If the request cannot be sent the handler sees a timeout at once.
+ * Returns the request ID
+ */
+static uint8_t SendRequest(uint8_t command, const char *password,
+                           const uint8_t *extra, uint8_t extraLength,
+                           uint32_t timeoutMs, Comm_Handler handler, void *context)
+{
+    uint8_t payload[PROTO_MAX_PAYLOAD];
+    uint8_t length = 0;
+    uint8_t id;
+    uint8_t i;
+
+    if (password != NULL) {
+        for (i = 0; i < PASSWORD_LENGTH; i++) {
+            payload[length++] = (uint8_t)password[i];
+        }
+    }
+    for (i = 0; i < extraLength && length < PROTO_MAX_PAYLOAD; i++) {
+        payload[length++] = extra[i];
+    }
+
+    id = Comm_Send(command, payload, length, timeoutMs, handler, context);
+    if (id == COMM_NO_REQUEST) {
+        (void)handler(NULL, context);
+    }
+    return id;
+}
+
+/*
+ * SendCommand
+ * Sends a request with a single response, collected by WaitForResponse()
+ */
+static void SendCommand(uint8_t command, const char *password,
+                        const uint8_t *extra, uint8_t extraLength)
+{
+    g_reply.done = false;
+    (void)SendRequest(command, password, extra, extraLength,
+                      UART_RESPONSE_TIMEOUT_MS, OnReply, &g_reply);
+}
+
+/*
+ * OnReply
+ * Response handler of SendCommand()
+ */
+static bool OnReply(const Proto_Frame *response, void *context)
+{
+    Reply *reply = (Reply *)context;
+
+    reply->type = (response != NULL) ? response->type : RESP_TIMEOUT;
+    reply->done = true;
+    return true;
+}
+
+/*
+ * SendSave
+ * Sends a request that changes the stored settings. Its first response,
+ * collected by WaitForResponse(), comes as soon as the Control ECU has
+ * queued the change; WaitForStored() then collects the RESP_STORED that
+ * follows once the change is in EEPROM.
+ */
+static void SendSave(uint8_t command, const char *password,
+                     const uint8_t *extra, uint8_t extraLength)
+{
+    g_reply.done = false;
+    g_reply.stored = STORED_PENDING;
+    (void)SendRequest(command, password, extra, extraLength,
+                      UART_RESPONSE_TIMEOUT_MS, OnSaveReply, &g_reply);
+}
+
+/*
+ * OnSaveReply
+ * Response handler of SendSave(). The request stays open after an answer
+ * that accepted the change, until RESP_STORED or a timeout.
+ */
+static bool OnSaveReply(const Proto_Frame *response, void *context)
+{
+    Reply *reply = (Reply *)context;
+
+    if (response == NULL) {
+        if (!reply->done) {
+            reply->type = RESP_TIMEOUT;
+            reply->done = true;
+        }
+        reply->stored = STORED_UNKNOWN;
+        return true;
+    }
+    if (response->type == RESP_STORED) {
+        reply->stored = (response->length > 0U) ? response->payload[0] : STORED_FAILED;
+        return true;
+    }
+
+    reply->type = response->type;
+    reply->done = true;
+    if (response->type != RESP_PASSWORD_MATCH &&
+        response->type != RESP_TIMEOUT_SAVED &&
+        response->type != RESP_EEPROM_ERASED) {
+        reply->stored = STORED_UNKNOWN;     /* Nothing was saved */
+        return true;
+    }
+    return false;
+}
+
+/*
+ * OnDoorProgress
+ * Response handler of the open door request: records each step of the
+ * door cycle until the door is locked again (or the password is wrong)
+ */
+static bool OnDoorProgress(const Proto_Frame *response, void *context)
+{
+    DoorProgress *door = (DoorProgress *)context;
+
+    if (response == NULL) {
+        door->phase = RESP_TIMEOUT;
+        door->done = true;
+        return true;
+    }
+
+    if (response->type == RESP_COUNTDOWN) {
+        if (response->length == 1U) {
+            door->secondsLeft = response->payload[0];
         }
-        DelayMs(10);
-    }  password[PASSWORD_LENGTH] = '\0';
+        return false;
+    }
+
+    door->phase = response->type;
+    if (response->type == RESP_PASSWORD_MATCH) {
+        door->granted = true;
+    }
+    door->done = (response->type != RESP_PASSWORD_MATCH &&
+                  response->type != RESP_DOOR_UNLOCKING &&
+                  response->type != RESP_COUNTDOWN_START &&
+                  response->type != RESP_DOOR_LOCKING);
+    return door->done;
 }
 
 /*
- * SendPassword
- * Sends a 5-digit password to Control ECU via UART
+ * OnStatus
+ * Response handler of a status query
  */
-void SendPassword(const char *password)
+static bool OnStatus(const Proto_Frame *response, void *context)
 {
+    StatusReply *reply = (StatusReply *)context;
     uint8_t i;
-    for (i = 0; i < PASSWORD_LENGTH; i++) {
-        UART5_SendChar(password[i]);
-        DelayMs(10);
+
+    if (response != NULL && response->type == RESP_STATUS &&
+        response->length >= STATUS_LENGTH) {
+        for (i = 0; i < STATUS_LENGTH; i++) {
+            reply->status[i] = response->payload[i];
+        }
+        reply->valid = true;
+    }
+    return true;
+}
+
+/*
+ * OnStatusHoldEnd
+ * Timer callback: the status reply has been shown long enough
+ */
+static bool OnStatusHoldEnd(void *context)
+{
+    *(bool *)context = false;
+    return false;
+}
+
+/*
+ * OnPasswordState
+ * Response handler of CMD_CHECK_PASSWORD: caches the answer. A timeout
+ * or any other reply leaves it unknown, to be asked again.
+ */
+static bool OnPasswordState(const Proto_Frame *response, void *context)
+{
+    (void)context;
+
+    if (response != NULL && response->type == RESP_PASSWORD_EXISTS) {
+        g_passwordState = PASSWORD_SET;
+    } else if (response != NULL && response->type == RESP_NO_PASSWORD) {
+        g_passwordState = PASSWORD_NONE;
+    } else {
+        g_passwordState = PASSWORD_UNKNOWN;
+    }
+    return true;
+}
+
+/*
+ * AskPasswordExists
+ * Sends CMD_CHECK_PASSWORD without waiting; OnPasswordState() records
+ * the answer.
+ */
+static void AskPasswordExists(void)
+{
+    g_passwordState = PASSWORD_ASKING;
+    (void)SendRequest(CMD_CHECK_PASSWORD, NULL, NULL, 0,
+                      PASSWORD_CHECK_TIMEOUT_MS, OnPasswordState, NULL);
+}
+
+/*
+ * OnUartRx
+ * UART5 ISR callback: wakes the link task
+ */
+static void OnUartRx(void)
+{
+    Sched_Post(TASK_LINK, EVENT_RX);
+}
+
+/*
+ * OnLcdIdle
+ * LCD writer callback: changes drawn meanwhile can go out now
+ */
+static void OnLcdIdle(void)
+{
+    Sched_Post(TASK_LCD, EVENT_LCD_IDLE);
+}
+
+/*
+ * OnTick
+ * Timer callback: posts a tick to the task given as context
+ */
+static bool OnTick(void *context)
+{
+    Sched_Post((uint8_t)(uintptr_t)context, EVENT_TICK);
+    return true;
+}
+
+/*
+ * LinkTask
+ * Hands received responses to their requests and ages their timeouts
+ */
+static void LinkTask(uint32_t events)
+{
+    uint32_t now = (uint32_t)Time_NowMs();
+    
+    (void)events;
+    Comm_Poll(now - g_linkPolledMs);
+    g_linkPolledMs = now;
+}
+
+/*
+ * LcdTask
+ * Queues whatever changed on screen since the last refresh. While the
+ * writer is still busy, changes accumulate and go out as one flush when
+ * it reports idle.
+ */
+static void LcdTask(uint32_t events)
+{
+    (void)events;
+    if (LCD_IsIdle()) {
+        LCD_Flush();
+    }
+}
+
+/*
+ * ReadKey
+ * Next key pressed, in the order typed (keys typed ahead are kept), or 0.
+ * Auto-repeats count as presses of KEY_BACKSPACE only; the '*' + '#'
+ * chord reads as KEY_BACK.
+ */
+static char ReadKey(void)
+{
+    Keypad_Event event;
+    char key = g_unreadKey;
+    
+    if (key != 0) {
+        g_unreadKey = 0;
+        return key;
+    }
+    while (Keypad_GetEvent(&event)) {
+        if (event.type == KEYPAD_EVENT_PRESS || event.type == KEYPAD_EVENT_CHORD ||
+            (event.type == KEYPAD_EVENT_REPEAT && event.key == KEY_BACKSPACE)) {
+            return event.key;
+        }
     }
+    return 0;
 }
 
 /*
  * SetupPassword
  * Step 1: Initial password setup
  * User enters password twice for confirmation
- * Returns true if passwords match, false otherwise
+ * Returns SETUP_SAVED, SETUP_RETRY or SETUP_BACKED_OUT
  */
-bool SetupPassword(void)
+uint8_t SetupPassword(void)
 {
     char password1[PASSWORD_LENGTH + 1];
     char password2[PASSWORD_LENGTH + 1];
     uint8_t response;
+    uint8_t stored;
     
     /* Get first password */
     LCD_Clear();
     LCD_SetCursor(0, 0);
     LCD_WriteString("Enter Password:");
     LCD_SetCursor(1, 0);
-    GetPassword(password1);
+    if (!GetPassword(password1)) {
+        return SETUP_BACKED_OUT;
+    }
     
-    DelayMs(500);
+    Sched_RunFor(500);
     
     /* Get confirmation password */
     LCD_Clear();
     LCD_SetCursor(0, 0);
     LCD_WriteString("Confirm Pass:");
     LCD_SetCursor(1, 0);
-    GetPassword(password2);
+    if (!GetPassword(password2)) {
+        return SETUP_BACKED_OUT;
+    }
     
     /* Send setup command to Control ECU */
-    UART5_SendChar(CMD_SETUP_PASSWORD);
-    DelayMs(50);
-    SendPassword(password1);
-    DelayMs(50);
-    SendPassword(password2);
+    SendSave(CMD_SETUP_PASSWORD, password1,
+             (const uint8_t *)password2, PASSWORD_LENGTH);
     
     /* Wait for response */
     response = WaitForResponse();
@@ -244,16 +622,27 @@ bool SetupPassword(void)
         LCD_Clear();
         LCD_SetCursor(0, 0);
         LCD_WriteString("Password Saved!");
-        DelayMs(2000);
-        return true;
+        Sched_RunFor(2000);
+        
+        /* The EEPROM write confirms while the message is shown */
+        stored = WaitForStored();
+        if (stored == STORED_FAILED) {
+            LCD_Clear();
+            LCD_SetCursor(0, 0);
+            LCD_WriteString("Save Failed!");
+            Sched_RunFor(2000);
+            return SETUP_RETRY;
+        }
+        g_passwordState = (stored == STORED_OK) ? PASSWORD_SET : PASSWORD_UNKNOWN;
+        return SETUP_SAVED;
     } else {
         LCD_Clear();
         LCD_SetCursor(0, 0);
         LCD_WriteString("Passwords Don't");
         LCD_SetCursor(1, 0);
         LCD_WriteString("Match! Try Again");
-        DelayMs(2000);
-        return false;
+        Sched_RunFor(2000);
+        return SETUP_RETRY;
     }
 }
 
@@ -279,9 +668,7 @@ void HandleOpenDoor(void)
 {
     char password[PASSWORD_LENGTH + 1];
     uint8_t attempts = 0;
-    uint8_t response;
-    uint8_t countdown;
-    char buffer[16];
+    DoorProgress door;
     
     while (attempts < MAX_ATTEMPTS) {
         /* Prompt for password */
@@ -289,77 +676,26 @@ void HandleOpenDoor(void)
         LCD_SetCursor(0, 0);
         LCD_WriteString("Enter Password:");
         LCD_SetCursor(1, 0);
-        GetPassword(password);
+        if (!GetPassword(password)) {
+            return;     /* Backed out: no attempt used */
+        }
         
-        /* Send open door command */
-        UART5_SendChar(CMD_OPEN_DOOR);
-        DelayMs(50);
-        SendPassword(password);
+        /* Send open door command; progress arrives through OnDoorProgress */
+        door.granted = false;
+        door.done = false;
+        door.phase = 0;
+        door.secondsLeft = 0;
+        (void)SendRequest(CMD_OPEN_DOOR, password, NULL, 0,
+                          UART_RESPONSE_TIMEOUT_MS, OnDoorProgress, &door);
         
-        /* Wait for response */
-        response = WaitForResponse();
+        /* Wait for the verdict */
+        while (!door.granted && !door.done) {
+            Sched_RunFor(1);
+        }
         
-        if (response == RESP_PASSWORD_MATCH) {
-            /* Correct password - wait for door operation */
-            LCD_Clear();
-            LCD_SetCursor(0, 0);
-            LCD_WriteString("Access Granted");
-            DelayMs(1500);
-            
-            /* Wait for unlocking message */
-            response = WaitForResponse();
-            if (response == RESP_DOOR_UNLOCKING) {
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("Door Unlocking..");
-                DelayMs(2000);
-            }
-            
-            /* Wait for countdown start signal */
-            response = WaitForResponse();
-            if (response == RESP_COUNTDOWN_START) {
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("Door Open");
-                
-                /* Receive countdown values */
-                bool countingDown = true;
-                while (countingDown) {
-                    if (UART5_IsDataAvailable()) {
-                        countdown = UART5_ReceiveChar();
-                        
-                        if (countdown == RESP_DOOR_LOCKING) {
-                            /* Countdown finished, door is locking */
-                            countingDown = false;
-                            response = RESP_DOOR_LOCKING;
-                        } else if (countdown <= 30) {
-                            /* Valid countdown value */
-                            LCD_SetCursor(1, 0);
-                            snprintf(buffer, sizeof(buffer), "Closing in:%2u s", (unsigned)countdown);
-                            LCD_WriteString(buffer);
-                        }
-                    }
-                    DelayMs(10);
-                }
-            }
-            
-            /* Display locking message */
-            if (response == RESP_DOOR_LOCKING) {
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("Door Locking...");
-                DelayMs(2000);
-            }
-            
-            /* Wait for locked message */
-            response = WaitForResponse();
-            if (response == RESP_DOOR_LOCKED) {
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("Door Locked");
-                DelayMs(1500);
-            }
-            
+        if (door.granted) {
+            /* Correct password - follow the door operation */
+            ShowDoorCycle(&door);
             return; /* Exit function */
             
         } else {
@@ -370,10 +706,8 @@ void HandleOpenDoor(void)
                 LCD_Clear();
                 LCD_SetCursor(0, 0);
                 LCD_WriteString("Wrong Password!");
-                LCD_SetCursor(1, 0);
-                sprintf(buffer, "Attempt %d/%d", attempts, MAX_ATTEMPTS);
-                LCD_WriteString(buffer);
-                DelayMs(1500);
+                LCD_Printf(1, 0, "Attempt %d/%d", attempts, MAX_ATTEMPTS);
+                Sched_RunFor(1500);
             }
         }
     }
@@ -386,10 +720,95 @@ void HandleOpenDoor(void)
     LCD_WriteString("Please Wait...");
     
     /* Send lockout trigger to Control ECU to sound buzzer */
-    UART5_SendChar(CMD_TRIGGER_LOCKOUT);
+    SendCommand(CMD_TRIGGER_LOCKOUT, NULL, NULL, 0);
     
     /* Wait 10 seconds - lockout duration */
-    DelayMs(LOCKOUT_DURATION_MS);
+    Sched_RunFor(LOCKOUT_DURATION_MS);
+}
+
+/*
+ * ShowDoorCycle
+ * Displays the door operation as its progress messages arrive. The
+ * keypad stays live: KEY_STATUS sends a status query and KEY_LOCK_NOW an
+ * emergency lock, both answered by the Control ECU while the door request
+ * is still open.
+ */
+static void ShowDoorCycle(DoorProgress *door)
+{
+    StatusReply status;
+    Reply lockReply;
+    uint8_t statusId = COMM_NO_REQUEST;
+    uint8_t lockId = COMM_NO_REQUEST;
+    char key;
+    Timer_Id statusHold = TIMER_NONE;
+    bool statusHeld = false;
+    uint8_t shownPhase = 0;
+    uint8_t shownSeconds = 0;
+    uint8_t countdownTotal = 0;     /* Full length of the bar */
+    
+    LCD_Clear();
+    LCD_SetCursor(0, 0);
+    LCD_WriteString("Access Granted");
+    Sched_RunFor(1500);
+    
+    status.valid = false;
+    while (!door->done) {
+        if (door->phase != shownPhase) {
+            shownPhase = door->phase;
+            LCD_Clear();
+            LCD_SetCursor(0, 0);
+            if (shownPhase == RESP_DOOR_UNLOCKING) {
+                LCD_WriteString("Door Unlocking..");
+            } else if (shownPhase == RESP_COUNTDOWN_START) {
+                LCD_WriteString("Door Open");
+            } else if (shownPhase == RESP_DOOR_LOCKING) {
+                LCD_WriteString("Door Locking...");
+            }
+            shownSeconds = 0;
+        }
+        
+        if (status.valid) {
+            /* Status reply: hold it on row 1 for a moment */
+            status.valid = false;
+            (void)Timer_Cancel(statusHold);
+            statusHold = Timer_Start(STATUS_HOLD_MS, OnStatusHoldEnd, &statusHeld);
+            statusHeld = (statusHold != TIMER_NONE);
+            shownSeconds = 0;       /* Redraw the countdown afterwards */
+            LCD_Printf(1, 0, "Auto-lock:%3u s ", (unsigned)status.status[STATUS_AUTO_LOCK]);
+        } else if (!statusHeld && shownPhase == RESP_COUNTDOWN_START &&
+                   door->secondsLeft != shownSeconds) {
+            shownSeconds = door->secondsLeft;
+            if (shownSeconds > countdownTotal) {
+                countdownTotal = shownSeconds;
+            }
+            LCD_Printf(0, 11, "%3u s", (unsigned)shownSeconds);
+            LCD_Bar(1, 0, LCD_COLS, shownSeconds, countdownTotal);
+        }
+        
+        key = ReadKey();
+        if (key == KEY_STATUS && !Comm_IsPending(statusId)) {
+            statusId = SendRequest(CMD_GET_STATUS, NULL, NULL, 0,
+                                   UART_RESPONSE_TIMEOUT_MS, OnStatus, &status);
+        } else if (key == KEY_LOCK_NOW && !Comm_IsPending(lockId)) {
+            /* The door request reports the locking itself */
+            lockId = SendRequest(CMD_LOCK_NOW, NULL, NULL, 0,
+                                 UART_RESPONSE_TIMEOUT_MS, OnReply, &lockReply);
+        }
+        
+        Sched_RunFor(DOOR_POLL_MS);
+    }
+    
+    /* Their contexts are on this stack */
+    (void)Timer_Cancel(statusHold);
+    Comm_Cancel(statusId);
+    Comm_Cancel(lockId);
+    
+    if (door->phase == RESP_DOOR_LOCKED) {
+        LCD_Clear();
+        LCD_SetCursor(0, 0);
+        LCD_WriteString("Door Locked");
+        Sched_RunFor(1500);
+    }
 }
 
 /*
@@ -402,8 +821,7 @@ void HandleChangePassword(void)
     char password[PASSWORD_LENGTH + 1];
     uint8_t attempts = 0;
     uint8_t response;
-    bool success;
-    char buffer[16];
+    uint8_t result;
     
     while (attempts < MAX_ATTEMPTS) {
         /* Prompt for old password */
@@ -411,12 +829,12 @@ void HandleChangePassword(void)
         LCD_SetCursor(0, 0);
         LCD_WriteString("Enter Old Pass:");
         LCD_SetCursor(1, 0);
-        GetPassword(password);
+        if (!GetPassword(password)) {
+            return;     /* Backed out: no attempt used */
+        }
         
         /* Send change password command */
-        UART5_SendChar(CMD_CHANGE_PASSWORD);
-        DelayMs(50);
-        SendPassword(password);
+        SendCommand(CMD_CHANGE_PASSWORD, password, NULL, 0);
         
         /* Wait for response */
         response = WaitForResponse();
@@ -426,14 +844,20 @@ void HandleChangePassword(void)
             LCD_Clear();
             LCD_SetCursor(0, 0);
             LCD_WriteString("Password Correct");
-            DelayMs(1000);
+            Sched_RunFor(1000);
             
-            /* Repeat initial password setup until successful */
-            success = false;
-            while (!success) {
-                success = SetupPassword();
-            }
+            /* Repeat password setup until saved, or backed out with the
+             * old password still in force */
+            do {
+                result = SetupPassword();
+            } while (result == SETUP_RETRY);
             
+            if (result == SETUP_BACKED_OUT) {
+                LCD_Clear();
+                LCD_SetCursor(0, 0);
+                LCD_WriteString("Pass Unchanged");
+                Sched_RunFor(1000);
+            }
             return; /* Exit function */
             
         } else {
@@ -444,10 +868,8 @@ void HandleChangePassword(void)
                 LCD_Clear();
                 LCD_SetCursor(0, 0);
                 LCD_WriteString("Wrong Password!");
-                LCD_SetCursor(1, 0);
-                sprintf(buffer, "Attempt %d/%d", attempts, MAX_ATTEMPTS);
-                LCD_WriteString(buffer);
-                DelayMs(1500);
+                LCD_Printf(1, 0, "Attempt %d/%d", attempts, MAX_ATTEMPTS);
+                Sched_RunFor(1500);
             }
         }
     }
@@ -460,10 +882,10 @@ void HandleChangePassword(void)
     LCD_WriteString("Please Wait...");
     
     /* Send lockout trigger to Control ECU to sound buzzer */
-    UART5_SendChar(CMD_TRIGGER_LOCKOUT);
+    SendCommand(CMD_TRIGGER_LOCKOUT, NULL, NULL, 0);
     
     /* Wait 10 seconds - lockout duration */
-    DelayMs(LOCKOUT_DURATION_MS);
+    Sched_RunFor(LOCKOUT_DURATION_MS);
 }
 
 /*
@@ -474,31 +896,35 @@ void HandleChangePassword(void)
 void HandleSetTimeout(void)
 {
     char password[PASSWORD_LENGTH + 1];
-    uint8_t timeout;
+    POT_Filter potFilter;
+    uint8_t timeout = TIMEOUT_MIN_SECONDS;
     uint8_t response;
-    char buffer[16];
     char key = 0;
     
     /* Display timeout adjustment screen */
     LCD_Clear();
     LCD_SetCursor(0, 0);
     LCD_WriteString("Adjust Timeout");
+    LCD_Printf(1, 13, "# =");
     
-    /* Let user adjust timeout with potentiometer */
+    /* Let user adjust timeout with potentiometer (5-30 seconds) */
+    POT_FilterInit(&potFilter, TIMEOUT_MIN_SECONDS, TIMEOUT_MAX_SECONDS,
+                   POT_DEFAULT_SMOOTHING, POT_DEFAULT_HYSTERESIS);
     while (key != KEY_SAVE) {
-        /* Read potentiometer and map to 5-30 seconds */
-        timeout = (uint8_t)POT_ReadMapped(TIMEOUT_MIN_SECONDS, TIMEOUT_MAX_SECONDS);
-        
-        /* Display current value */
-        LCD_SetCursor(1, 0);
-        sprintf(buffer, "Time: %2d sec   ", timeout);
-        LCD_WriteString(buffer);
-        LCD_SetCursor(1, 13);
-        LCD_WriteString("# =");
+        /* Redraw only when the filtered, mapped value moves to another step */
+        if (POT_ReadStable(&potFilter)) {
+            timeout = (uint8_t)POT_FilterValue(&potFilter);
+            LCD_Printf(1, 0, "%2us", timeout);
+            LCD_Bar(1, 4, 8, timeout - TIMEOUT_MIN_SECONDS,
+                    TIMEOUT_MAX_SECONDS - TIMEOUT_MIN_SECONDS);
+        }
         
-        /* Check if user pressed save */
-        key = Keypad_GetKey();
-        DelayMs(100);
+        /* Check if user pressed save (or backed out) */
+        key = ReadKey();
+        if (key == KEY_BACK) {
+            return;
+        }
+        Sched_RunFor(POT_POLL_MS);
     }
     
     /* Prompt for password confirmation */
@@ -506,14 +932,12 @@ void HandleSetTimeout(void)
     LCD_SetCursor(0, 0);
     LCD_WriteString("Enter Password:");
     LCD_SetCursor(1, 0);
-    GetPassword(password);
+    if (!GetPassword(password)) {
+        return;
+    }
     
     /* Send set timeout command */
-    UART5_SendChar(CMD_SET_TIMEOUT);
-    DelayMs(50);
-    SendPassword(password);
-    DelayMs(50);
-    UART5_SendChar(timeout);
+    SendSave(CMD_SET_TIMEOUT, password, &timeout, 1);
     
     /* Wait for response */
     response = WaitForResponse();
@@ -522,37 +946,48 @@ void HandleSetTimeout(void)
         LCD_Clear();
         LCD_SetCursor(0, 0);
         LCD_WriteString("Timeout Saved!");
-        sprintf(buffer, "%d seconds", timeout);
-        LCD_SetCursor(1, 0);
-        LCD_WriteString(buffer);
-        DelayMs(2000);
+        LCD_Printf(1, 0, "%d seconds", timeout);
+        Sched_RunFor(2000);
+        if (WaitForStored() == STORED_FAILED) {
+            LCD_Clear();
+            LCD_SetCursor(0, 0);
+            LCD_WriteString("Save Failed!");
+            Sched_RunFor(2000);
+        }
     } else {
         LCD_Clear();
         LCD_SetCursor(0, 0);
         LCD_WriteString("Wrong Password!");
-        DelayMs(1500);
+        Sched_RunFor(1500);
     }
 }
 
 /*
  * WaitForResponse
- * Waits for a response byte from Control ECU via UART
- * Timeout: ~5 seconds
+ * Waits for the response code to the last SendCommand() request
+ * Timeout: ~5 seconds without a response
  */
 uint8_t WaitForResponse(void)
 {
-    uint16_t timeout = 0;
-    
-    while (!UART5_IsDataAvailable() && timeout < UART_RESPONSE_TIMEOUT_MS)  {
-        DelayMs(1);
-        timeout++;
+    while (!g_reply.done) {
+        Sched_RunFor(1);
     }
     
-    if (UART5_IsDataAvailable()) {
-        return UART5_ReceiveChar();
+    return g_reply.type;
+}
+
+/*
+ * WaitForStored
+ * Waits for the RESP_STORED that follows an accepted SendSave() request
+ * Returns STORED_OK, STORED_FAILED or STORED_UNKNOWN (no confirmation)
+ */
+static uint8_t WaitForStored(void)
+{
+    while (g_reply.stored == STORED_PENDING) {
+        Sched_RunFor(1);
     }
     
-    return RESP_TIMEOUT; /* Timeout */
+    return g_reply.stored;
 }
 
 /*
@@ -571,35 +1006,44 @@ void HandleEraseEEPROM(void)
     LCD_WriteString("Erase EEPROM?");
     LCD_SetCursor(1, 0);
     LCD_WriteString("Enter Password:");
-    DelayMs(2000);
+    Sched_RunFor(2000);
     
     /* Prompt for password */
     LCD_Clear();
     LCD_SetCursor(0, 0);
     LCD_WriteString("Enter Password:");
     LCD_SetCursor(1, 0);
-    GetPassword(password);
+    if (!GetPassword(password)) {
+        return;
+    }
     
     /* Send erase EEPROM command */
-    UART5_SendChar(CMD_ERASE_EEPROM);
-    DelayMs(50);
-    SendPassword(password);
+    SendSave(CMD_ERASE_EEPROM, password, NULL, 0);
     
     /* Wait for response */
     response = WaitForResponse();
     
     if (response == RESP_EEPROM_ERASED) {
+        g_passwordState = PASSWORD_NONE;
         LCD_Clear();
         LCD_SetCursor(0, 0);
         LCD_WriteString("EEPROM Erased!");
         LCD_SetCursor(1, 0);
         LCD_WriteString("Restarting...");
-        DelayMs(2000);
+        Sched_RunFor(2000);
         
-        /* System will restart - setup new password */
-        bool passwordSet = false;
-        while (!passwordSet) {
-            passwordSet = SetupPassword();
+        /* The Control ECU has reset its settings either way; a failed
+         * erase only means old records may still be in EEPROM */
+        if (WaitForStored() == STORED_FAILED) {
+            LCD_Clear();
+            LCD_SetCursor(0, 0);
+            LCD_WriteString("Erase Failed!");
+            Sched_RunFor(2000);
+        }
+        
+        /* System will restart - setup new password; there is none to
+         * fall back on, so backing out only asks again */
+        while (SetupPassword() != SETUP_SAVED) {
         }
     } else {
         LCD_Clear();
@@ -607,34 +1051,27 @@ void HandleEraseEEPROM(void)
         LCD_WriteString("Wrong Password!");
         LCD_SetCursor(1, 0);
         LCD_WriteString("Erase Cancelled");
-        DelayMs(1500);
+        Sched_RunFor(1500);
     }
 }
 
 /*
  * CheckPasswordExists
  * Checks if a password already exists in Control ECU EEPROM
+ * Answers from the cached state: the query sent at boot, then what this
+ * HMI saw saved or erased since. Asks again only if the state is unknown
+ * and waits only while a query is out.
  * Returns true if password exists, false otherwise
  */
 bool CheckPasswordExists(void)
 {
-    uint8_t response;
-    uint16_t timeout = 0;
-    
-    /* Send check password command */
-    UART5_SendChar(CMD_CHECK_PASSWORD);
-    
-    /* Wait for response */
-    while (!UART5_IsDataAvailable() && timeout < 2000) {
-        DelayMs(1);
-        timeout++;
+    if (g_passwordState == PASSWORD_UNKNOWN) {
+        AskPasswordExists();
     }
-    
-    if (UART5_IsDataAvailable()) {
-        response = UART5_ReceiveChar();
-        return (response == RESP_PASSWORD_EXISTS);
+    while (g_passwordState == PASSWORD_ASKING) {
+        Sched_RunFor(1);
     }
     
-    return false; /* Timeout - assume no password */
+    /* A timeout means no password */
+    return (g_passwordState == PASSWORD_SET);
 }
-
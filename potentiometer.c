@@ -12,7 +12,8 @@
  ******************************************************************************/
 
 /*
- * Description: Initializes the potentiometer (ADC on PE3)
+ * Description: Initializes the potentiometer (ADC on PE3) and starts
+ *              continuous sampling for POT_ReadFiltered
  * Parameters: None
  * Returns: None
  */
@@ -20,6 +21,7 @@ void POT_Init(void)
 {
     /* Initialize ADC with channel 0 (PE3 = AIN0) */
     ADC_Init(POT_ADC_CHANNEL);
+    ADC_StartContinuous(POT_ADC_CHANNEL);
 }
 
 /*
@@ -64,9 +66,148 @@ uint8_t POT_ReadPercentage(void)
  */
 uint32_t POT_ReadMapped(uint32_t min, uint32_t max)
 {
-    uint16_t rawValue = ADC_Read();
-    
+    return POT_Map(ADC_Read(), min, max);
+}
+
+/*
+ * Description: Reads the filtered potentiometer value without waiting
+ * Parameters: None
+ * Returns: 12-bit value (0-4095), averaged over the last
+ *          ADC_BUFFER_SIZE * ADC_SAMPLE_PERIOD_MS
+ */
+uint16_t POT_ReadFiltered(void)
+{
+    return ADC_ReadLatest();
+}
+
+/*
+ * Description: Maps a raw reading to a custom range
+ * Parameters:
+ *   - rawValue: 12-bit ADC value (0-4095)
+ *   - min: Minimum value of output range
+ *   - max: Maximum value of output range
+ * Returns: Mapped value within the specified range
+ */
+uint32_t POT_Map(uint16_t rawValue, uint32_t min, uint32_t max)
+{
     /* Map from 0-4095 to min-max range */
     /* Formula: min + (rawValue * (max - min)) / 4095 */
     return min + ((rawValue * (max - min)) / 4095UL);
 }
+
+/*
+ * Description: Step of a filter's range that an ADC code falls in
+ * Parameters:
+ *   - code: 12-bit ADC value (0-4095)
+ *   - steps: max - min + 1
+ * Returns: Step index, 0 for min
+ */
+static uint32_t POT_Step(uint32_t code, uint32_t steps)
+{
+    return (code * steps) / (ADC_MAX_VALUE + 1UL);
+}
+
+/*
+ * Description: First ADC code of a step
+ * Parameters:
+ *   - step: Step index, 0 for min
+ *   - steps: max - min + 1
+ * Returns: Lowest code with POT_Step(code) >= step
+ */
+static uint32_t POT_StepStart(uint32_t step, uint32_t steps)
+{
+    return ((step * (ADC_MAX_VALUE + 1UL)) + steps - 1U) / steps;
+}
+
+/*
+ * Description: Sets up a mapped-value filter for the range [min, max]
+ * Parameters:
+ *   - filter: Filter state, owned by the caller
+ *   - min: Minimum value of output range
+ *   - max: Maximum value of output range
+ *   - smoothingShift: Average weight 1/2^smoothingShift (0: no smoothing)
+ *   - hysteresis: Dead band past each step edge, in ADC codes
+ * Returns: None
+ */
+void POT_FilterInit(POT_Filter *filter, uint32_t min, uint32_t max,
+                    uint8_t smoothingShift, uint16_t hysteresis)
+{
+    filter->min = min;
+    filter->max = max;
+    filter->smoothingShift = smoothingShift;
+    filter->hysteresis = hysteresis;
+    filter->smoothed = 0;
+    filter->value = min;
+    filter->primed = false;
+}
+
+/*
+ * Description: Feeds one reading to a filter
+ * Parameters:
+ *   - filter: Filter state
+ *   - rawValue: 12-bit ADC value (0-4095)
+ * Returns: true if the output changed (always for the first reading)
+ */
+bool POT_FilterUpdate(POT_Filter *filter, uint16_t rawValue)
+{
+    uint32_t steps = filter->max - filter->min + 1U;
+    uint32_t target = (uint32_t)rawValue << POT_SMOOTH_FRACTION;
+    uint32_t code;
+    uint32_t step;
+    uint32_t value;
+    
+    /* Exponential moving average: smoothed += (target - smoothed) / 2^shift */
+    if (!filter->primed || filter->smoothingShift == 0U) {
+        filter->smoothed = target;
+    } else if (target >= filter->smoothed) {
+        filter->smoothed += (target - filter->smoothed) >> filter->smoothingShift;
+    } else {
+        filter->smoothed -= (filter->smoothed - target) >> filter->smoothingShift;
+    }
+    code = (filter->smoothed + (1UL << (POT_SMOOTH_FRACTION - 1U))) >> POT_SMOOTH_FRACTION;
+    value = filter->min + POT_Step(code, steps);
+    
+    if (!filter->primed) {
+        filter->primed = true;
+        filter->value = value;
+        return true;
+    }
+    if (value == filter->value) {
+        return false;
+    }
+    
+    /* Leave the current step only once past the dead band around its edges */
+    step = filter->value - filter->min;
+    if (value > filter->value &&
+        code < POT_StepStart(step + 1U, steps) + filter->hysteresis) {
+        return false;
+    }
+    if (value < filter->value &&
+        code + filter->hysteresis >= POT_StepStart(step, steps)) {
+        return false;
+    }
+    filter->value = value;
+    return true;
+}
+
+/*
+ * Description: Current output of a filter
+ * Parameters:
+ *   - filter: Filter state
+ * Returns: Value within [min, max]
+ */
+uint32_t POT_FilterValue(const POT_Filter *filter)
+{
+    return filter->value;
+}
+
+/*
+ * Description: Feeds POT_ReadFiltered to a filter; never waits for the ADC
+ * Parameters:
+ *   - filter: Filter state
+ * Returns: true if the output changed, see POT_FilterValue
+ */
+bool POT_ReadStable(POT_Filter *filter)
+{
+    return POT_FilterUpdate(filter, POT_ReadFiltered());
+}
@@ -8,6 +8,7 @@
 #define POTENTIOMETER_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /******************************************************************************
  *                              Definitions                                    *
@@ -20,12 +21,38 @@
 #define POT_PIN             3       /* PE3 */
 #define POT_ADC_CHANNEL     0       /* AIN0 */
 
+/*
+ * Mapped-value filter (POT_Filter*)
+ * Turns readings into a value in [min, max] that only changes when the
+ * knob is really moved. Each reading first goes through an exponential
+ * moving average with weight 1/2^smoothingShift (0 turns it off). The
+ * ADC range is split into max - min + 1 equal steps, so both ends get a
+ * full step (POT_Map gives max only at full scale). The output keeps its
+ * step until the average is more than hysteresis codes past one of the
+ * step's edges. Keep hysteresis below half a step
+ * (4096 / (max - min + 1) codes).
+ */
+#define POT_DEFAULT_SMOOTHING   2U      /* Weight 1/4 */
+#define POT_DEFAULT_HYSTERESIS  40U     /* Codes, a quarter of a 5-30 s step */
+#define POT_SMOOTH_FRACTION     4U      /* Fraction bits of the average */
+
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint8_t smoothingShift;
+    uint16_t hysteresis;
+    uint32_t smoothed;          /* Average, in 1/2^POT_SMOOTH_FRACTION codes */
+    uint32_t value;             /* Current output */
+    bool primed;                /* False until the first reading */
+} POT_Filter;
+
 /******************************************************************************
  *                         Function Prototypes                                 *
  ******************************************************************************/
 
 /*
- * Description: Initializes the potentiometer (ADC on PE3)
+ * Description: Initializes the potentiometer (ADC on PE3) and starts
+ *              continuous sampling for POT_ReadFiltered
  * Parameters: None
  * Returns: None
  */
@@ -61,4 +88,60 @@ uint8_t POT_ReadPercentage(void);
  */
 uint32_t POT_ReadMapped(uint32_t min, uint32_t max);
 
+/*
+ * Description: Reads the filtered potentiometer value without waiting
+ * Parameters: None
+ * Returns: 12-bit value (0-4095), averaged over the last
+ *          ADC_BUFFER_SIZE * ADC_SAMPLE_PERIOD_MS
+ */
+uint16_t POT_ReadFiltered(void);
+
+/*
+ * Description: Maps a raw reading to a custom range
+ * Parameters:
+ *   - rawValue: 12-bit ADC value (0-4095)
+ *   - min: Minimum value of output range
+ *   - max: Maximum value of output range
+ * Returns: Mapped value within the specified range
+ */
+uint32_t POT_Map(uint16_t rawValue, uint32_t min, uint32_t max);
+
+/*
+ * Description: Sets up a mapped-value filter for the range [min, max]
+ * Parameters:
+ *   - filter: Filter state, owned by the caller
+ *   - min: Minimum value of output range
+ *   - max: Maximum value of output range
+ *   - smoothingShift: Average weight 1/2^smoothingShift (0: no smoothing)
+ *   - hysteresis: Dead band past each step edge, in ADC codes
+ * Returns: None
+ */
+void POT_FilterInit(POT_Filter *filter, uint32_t min, uint32_t max,
+                    uint8_t smoothingShift, uint16_t hysteresis);
+
+/*
+ * Description: Feeds one reading to a filter
+ * Parameters:
+ *   - filter: Filter state
+ *   - rawValue: 12-bit ADC value (0-4095)
+ * Returns: true if the output changed (always for the first reading)
+ */
+bool POT_FilterUpdate(POT_Filter *filter, uint16_t rawValue);
+
+/*
+ * Description: Current output of a filter
+ * Parameters:
+ *   - filter: Filter state
+ * Returns: Value within [min, max]
+ */
+uint32_t POT_FilterValue(const POT_Filter *filter);
+
+/*
+ * Description: Feeds POT_ReadFiltered to a filter; never waits for the ADC
+ * Parameters:
+ *   - filter: Filter state
+ * Returns: true if the output changed, see POT_FilterValue
+ */
+bool POT_ReadStable(POT_Filter *filter);
+
 #endif /* POTENTIOMETER_H_ */
@@ -0,0 +1,526 @@
+/******************************************************************************
+ * File: sim.c
+ * Module: SIM (Host Simulation Core)
+ * Description: Virtual clock, event queue, register file and firmware
+ *              context switching for the host simulation
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include "sim.h"
+#include "sim_systick.h"
+#include "sim_timer.h"
+#include "sim_sysctl.h"
+#include "sim_gpio.h"
+#include "sim_uart.h"
+#include "sim_adc.h"
+#include "sim_eeprom.h"
+#include "sim_lcd.h"
+#include "sim_keypad.h"
+#include "sim_nvic.h"
+#include "sim_udma.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Register file: APB/AHB peripherals and the private peripheral bus page */
+#define PERIPH_BASE             0x40000000U
+#define PERIPH_SIZE             0x00100000U
+#define PPB_BASE                0xE000E000U
+#define PPB_SIZE                0x00001000U
+
+#define PAGE_SHIFT              12U
+#define PERIPH_PAGES            (PERIPH_SIZE >> PAGE_SHIFT)
+#define PPB_PAGE_INDEX          PERIPH_PAGES
+#define REGIONS_PER_PAGE        16U
+
+#define EVENT_QUEUE_INITIAL     256U
+#define FIRMWARE_STACK_SIZE     (1024U * 1024U)
+
+typedef struct {
+    uint32_t base;
+    uint32_t size;
+    SimAccessFn onAccess;
+    SimWriteFn onWrite;
+} SimRegion;
+
+typedef struct {
+    SimRegion regions[REGIONS_PER_PAGE];
+    uint8_t count;
+} SimPage;
+
+typedef struct {
+    uint64_t cycle;
+    uint64_t seq;
+    SimEventFn fn;
+    void *ctx;
+} SimEvent;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint64_t s_now;
+
+static SimEvent *s_events;
+static uint32_t s_eventCount;
+static uint32_t s_eventCapacity;
+static uint64_t s_eventSeq;
+
+static SimPage s_pages[PERIPH_PAGES + 1U];
+
+/* Last register handed to the firmware, committed on the next access */
+static uint32_t s_pendingAddr;
+static const SimRegion *s_pendingRegion;
+static uint32_t s_pendingValue;
+static uint32_t s_spinCount;
+
+/* Firmware / scenario contexts */
+static ucontext_t s_scenarioCtx;
+static ucontext_t s_firmwareCtx;
+static SimEntryFn s_entry;
+static bool s_onFirmware;
+static bool s_firmwareExited;
+static bool s_wakeRequested;
+static uint64_t s_wakeAt = SIM_FOREVER;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Sim_EventBefore
+ * Heap ordering: earliest cycle first, then scheduling order.
+ */
+static bool Sim_EventBefore(const SimEvent *a, const SimEvent *b)
+{
+    return (a->cycle < b->cycle) || (a->cycle == b->cycle && a->seq < b->seq);
+}
+
+/*
+ * Sim_PopEvent
+ * Removes the earliest event from the heap.
+ */
+static SimEvent Sim_PopEvent(void)
+{
+    SimEvent top = s_events[0];
+    SimEvent last = s_events[--s_eventCount];
+    uint32_t i = 0;
+
+    for (;;) {
+        uint32_t child = (2U * i) + 1U;
+        if (child >= s_eventCount) {
+            break;
+        }
+        if (child + 1U < s_eventCount && Sim_EventBefore(&s_events[child + 1U], &s_events[child])) {
+            child++;
+        }
+        if (!Sim_EventBefore(&s_events[child], &last)) {
+            break;
+        }
+        s_events[i] = s_events[child];
+        i = child;
+    }
+    if (s_eventCount > 0U) {
+        s_events[i] = last;
+    }
+    return top;
+}
+
+/*
+ * Sim_FindRegion
+ * Looks up the peripheral model for a register address.
+ */
+static const SimRegion *Sim_FindRegion(uint32_t addr)
+{
+    const SimPage *page;
+    uint8_t i;
+
+    if (addr - PERIPH_BASE < PERIPH_SIZE) {
+        page = &s_pages[(addr - PERIPH_BASE) >> PAGE_SHIFT];
+    } else if (addr - PPB_BASE < PPB_SIZE) {
+        page = &s_pages[PPB_PAGE_INDEX];
+    } else {
+        return NULL;
+    }
+
+    for (i = 0; i < page->count; i++) {
+        if (addr - page->regions[i].base < page->regions[i].size) {
+            return &page->regions[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Sim_Commit
+ * Hands the value the firmware left in the last accessed register to its
+ * model. Returns true if the firmware changed it.
+ */
+static bool Sim_Commit(void)
+{
+    uint32_t value;
+
+    if (s_pendingAddr == 0U) {
+        return false;
+    }
+
+    value = *Sim_Reg(s_pendingAddr);
+    if (value == s_pendingValue) {
+        return false;
+    }
+
+    if (s_pendingRegion != NULL && s_pendingRegion->onWrite != NULL) {
+        s_pendingRegion->onWrite(s_pendingAddr, value);
+    }
+    s_pendingValue = *Sim_Reg(s_pendingAddr);
+    return true;
+}
+
+/*
+ * Sim_YieldToScenario
+ * Switches from the firmware back to the scenario if it asked to be woken.
+ */
+static void Sim_YieldToScenario(void)
+{
+    if (s_onFirmware && (s_wakeRequested || s_now >= s_wakeAt)) {
+        s_onFirmware = false;
+        swapcontext(&s_firmwareCtx, &s_scenarioCtx);
+    }
+}
+
+/*
+ * Sim_AdvanceTo
+ * Moves the clock forward, running every event that falls due on the way.
+ */
+static void Sim_AdvanceTo(uint64_t target)
+{
+    while (s_eventCount > 0U && s_events[0].cycle <= target) {
+        SimEvent ev = Sim_PopEvent();
+        if (ev.cycle > s_now) {
+            s_now = ev.cycle;
+        }
+        ev.fn(ev.ctx);
+    }
+    if (target > s_now) {
+        s_now = target;
+    }
+    Sim_YieldToScenario();
+}
+
+/*
+ * Sim_TakeInterrupts
+ * Runs pending handlers between two firmware register accesses. The last
+ * write a handler made is committed before the interrupted code resumes.
+ * Returns: true if any handler ran
+ */
+static bool Sim_TakeInterrupts(void)
+{
+    if (!SimNvic_Dispatch()) {
+        return false;
+    }
+    (void)Sim_Commit();
+    s_pendingAddr = 0U;
+    s_spinCount = 0U;
+    return true;
+}
+
+/*
+ * Sim_FirmwareEntry
+ * Bottom of the firmware stack.
+ */
+static void Sim_FirmwareEntry(void)
+{
+    (void)s_entry();
+    s_firmwareExited = true;
+    s_onFirmware = false;
+}
+
+/*
+ * Sim_MapFixed
+ * Maps zero-filled memory at a fixed peripheral address.
+ */
+static void Sim_MapFixed(uint32_t base, uint32_t size)
+{
+    void *p = mmap((void *)(uintptr_t)base, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p != (void *)(uintptr_t)base) {
+        fprintf(stderr, "sim: cannot map register file at 0x%08X\n", (unsigned)base);
+        exit(2);
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+/*
+ * Sim_Init
+ * Maps the register file and resets the clock, event queue and all models.
+ */
+void Sim_Init(void)
+{
+    Sim_MapFixed(PERIPH_BASE, PERIPH_SIZE);
+    Sim_MapFixed(PPB_BASE, PPB_SIZE);
+
+    s_eventCapacity = EVENT_QUEUE_INITIAL;
+    s_events = malloc(s_eventCapacity * sizeof(SimEvent));
+    if (s_events == NULL) {
+        fprintf(stderr, "sim: out of memory\n");
+        exit(2);
+    }
+
+    SimNvic_Init();
+    SimUdma_Init();
+    SimSysTick_Init();
+    SimTimer_Init();
+    SimSysCtl_Init();
+    SimGpio_Init();
+    SimUart_Init();
+    SimAdc_Init();
+    SimEeprom_Init();
+    SimLcd_Init();
+    SimKeypad_Init();
+}
+
+uint64_t Sim_Cycles(void)
+{
+    return s_now;
+}
+
+uint64_t Sim_NowUs(void)
+{
+    return s_now / SIM_CYCLES_PER_US;
+}
+
+/*
+ * Sim_Schedule
+ * Inserts an event into the heap.
+ */
+void Sim_Schedule(uint64_t cycle, SimEventFn fn, void *ctx)
+{
+    SimEvent ev;
+    uint32_t i;
+
+    if (s_eventCount == s_eventCapacity) {
+        s_eventCapacity *= 2U;
+        s_events = realloc(s_events, s_eventCapacity * sizeof(SimEvent));
+        if (s_events == NULL) {
+            fprintf(stderr, "sim: out of memory\n");
+            exit(2);
+        }
+    }
+
+    ev.cycle = cycle;
+    ev.seq = s_eventSeq++;
+    ev.fn = fn;
+    ev.ctx = ctx;
+
+    i = s_eventCount++;
+    while (i > 0U) {
+        uint32_t parent = (i - 1U) / 2U;
+        if (!Sim_EventBefore(&ev, &s_events[parent])) {
+            break;
+        }
+        s_events[i] = s_events[parent];
+        i = parent;
+    }
+    s_events[i] = ev;
+}
+
+void Sim_Charge(uint32_t cycles)
+{
+    Sim_AdvanceTo(s_now + cycles);
+}
+
+/*
+ * Sim_Idle
+ * Jumps to the next event, or to the scenario's wake-up time if earlier.
+ */
+void Sim_Idle(void)
+{
+    uint64_t target = s_wakeAt;
+
+    (void)Sim_Commit();
+
+    if (s_eventCount > 0U && s_events[0].cycle < target) {
+        target = s_events[0].cycle;
+    }
+    if (target == SIM_FOREVER) {
+        fprintf(stderr, "sim: firmware idle with nothing scheduled at %llu us\n",
+                (unsigned long long)Sim_NowUs());
+        exit(2);
+    }
+    Sim_AdvanceTo(target);
+}
+
+/*
+ * Sim_MapRegion
+ * Registers a model for an address range, split over the pages it covers.
+ */
+void Sim_MapRegion(uint32_t base, uint32_t size, SimAccessFn onAccess, SimWriteFn onWrite)
+{
+    uint32_t addr = base;
+
+    while (addr < base + size) {
+        uint32_t pageEnd = (addr | ((1U << PAGE_SHIFT) - 1U)) + 1U;
+        uint32_t end = (base + size < pageEnd) ? (base + size) : pageEnd;
+        SimPage *page;
+
+        if (addr - PERIPH_BASE < PERIPH_SIZE) {
+            page = &s_pages[(addr - PERIPH_BASE) >> PAGE_SHIFT];
+        } else if (addr - PPB_BASE < PPB_SIZE) {
+            page = &s_pages[PPB_PAGE_INDEX];
+        } else {
+            fprintf(stderr, "sim: region 0x%08X outside register file\n", (unsigned)addr);
+            exit(2);
+        }
+        if (page->count == REGIONS_PER_PAGE) {
+            fprintf(stderr, "sim: too many regions in page 0x%08X\n", (unsigned)addr);
+            exit(2);
+        }
+
+        page->regions[page->count].base = addr;
+        page->regions[page->count].size = end - addr;
+        page->regions[page->count].onAccess = onAccess;
+        page->regions[page->count].onWrite = onWrite;
+        page->count++;
+        addr = end;
+    }
+}
+
+/*
+ * Sim_RegAccess
+ * 1. Commit the previous register write to its model.
+ * 2. Charge the bus access and run due events.
+ * 3. Take any interrupt that became pending.
+ * 4. Let the model refresh the register the firmware is about to touch.
+ * 5. If the firmware keeps polling an unchanging register, fast-forward.
+ */
+volatile uint32_t *Sim_RegAccess(uint32_t addr)
+{
+    const SimRegion *region;
+    volatile uint32_t *reg = Sim_Reg(addr);
+    bool wrote = Sim_Commit();
+    bool same = (addr == s_pendingAddr);
+    uint32_t value;
+
+    s_pendingAddr = 0U;
+    Sim_AdvanceTo(s_now + SIM_CYCLES_PER_ACCESS);
+    if (Sim_TakeInterrupts()) {
+        same = false;
+    }
+
+    region = Sim_FindRegion(addr);
+    if (region != NULL && region->onAccess != NULL) {
+        region->onAccess(addr);
+    }
+    value = *reg;
+
+    if (same && !wrote && value == s_pendingValue) {
+        if (++s_spinCount >= SIM_SPIN_THRESHOLD) {
+            s_spinCount = 0U;
+            Sim_Idle();
+            (void)Sim_TakeInterrupts();
+            if (region != NULL && region->onAccess != NULL) {
+                region->onAccess(addr);
+            }
+            value = *reg;
+        }
+    } else {
+        s_spinCount = 0U;
+    }
+
+    s_pendingAddr = addr;
+    s_pendingRegion = region;
+    s_pendingValue = value;
+    return reg;
+}
+
+volatile uint32_t *Sim_Reg(uint32_t addr)
+{
+    return (volatile uint32_t *)(uintptr_t)addr;
+}
+
+/*
+ * Sim_Sync
+ * Commits the last register write and charges a TivaWare call.
+ */
+void Sim_Sync(uint32_t cycles)
+{
+    (void)Sim_Commit();
+    s_pendingAddr = 0U;
+    s_spinCount = 0U;
+    Sim_AdvanceTo(s_now + cycles);
+    (void)Sim_TakeInterrupts();
+}
+
+/*
+ * Sim_Boot
+ * Prepares the firmware context on its own stack.
+ */
+void Sim_Boot(SimEntryFn entry)
+{
+    void *stack = malloc(FIRMWARE_STACK_SIZE);
+
+    if (stack == NULL) {
+        fprintf(stderr, "sim: out of memory\n");
+        exit(2);
+    }
+
+    s_entry = entry;
+    getcontext(&s_firmwareCtx);
+    s_firmwareCtx.uc_stack.ss_sp = stack;
+    s_firmwareCtx.uc_stack.ss_size = FIRMWARE_STACK_SIZE;
+    s_firmwareCtx.uc_link = &s_scenarioCtx;
+    makecontext(&s_firmwareCtx, Sim_FirmwareEntry, 0);
+}
+
+/*
+ * Sim_WaitUntil
+ * Runs the firmware until the clock reaches cycle.
+ */
+void Sim_WaitUntil(uint64_t cycle)
+{
+    while (s_now < cycle && !s_firmwareExited) {
+        s_wakeAt = cycle;
+        s_wakeRequested = false;
+        s_onFirmware = true;
+        swapcontext(&s_scenarioCtx, &s_firmwareCtx);
+    }
+    s_wakeAt = SIM_FOREVER;
+}
+
+/*
+ * Sim_WaitFor
+ * Runs the firmware until cond(ctx) holds or the timeout expires.
+ */
+bool Sim_WaitFor(SimCondFn cond, void *ctx, uint64_t timeout)
+{
+    uint64_t deadline = (timeout == SIM_FOREVER) ? SIM_FOREVER : s_now + timeout;
+
+    while (!cond(ctx)) {
+        if (s_now >= deadline || s_firmwareExited) {
+            s_wakeAt = SIM_FOREVER;
+            return false;
+        }
+        s_wakeAt = deadline;
+        s_wakeRequested = false;
+        s_onFirmware = true;
+        swapcontext(&s_scenarioCtx, &s_firmwareCtx);
+    }
+    s_wakeAt = SIM_FOREVER;
+    return true;
+}
+
+void Sim_Wake(void)
+{
+    s_wakeRequested = true;
+}
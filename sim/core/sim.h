@@ -0,0 +1,158 @@
+/******************************************************************************
+ * File: sim.h
+ * Module: SIM (Host Simulation Core)
+ * Description: Virtual clock, event queue and register file used to run the
+ *              TM4C123GH6PM firmware natively on a Linux host
+ *
+ * How the firmware is hosted:
+ *   - Every driver is compiled unmodified. A generated copy of
+ *     tm4c123gh6pm.h is force-included first, in which every register
+ *     macro expands to (*SIM_REG(address)) instead of a raw pointer.
+ *   - SIM_REG() calls Sim_RegAccess(), which charges bus cycles to the
+ *     virtual clock, commits the side effect of the previous register write,
+ *     fires due events and returns a pointer into the register file. The
+ *     register file is mapped at the real peripheral addresses so raw
+ *     pointer casts in the drivers keep working.
+ *   - TivaWare calls are served by stubs in sim/tivaware which talk to the
+ *     same peripheral models.
+ *
+ * Timing model (cycle-approximate):
+ *   - Register accesses and TivaWare calls cost a fixed number of cycles.
+ *   - Pure computation between accesses costs nothing.
+ *   - When the firmware polls the same register without anything changing,
+ *     the clock jumps straight to the next scheduled event, so busy-wait
+ *     delays cost no host time.
+ ******************************************************************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_CPU_HZ              16000000ULL     /* 16 MHz system clock */
+#define SIM_CYCLES_PER_US       (SIM_CPU_HZ / 1000000ULL)
+#define SIM_CYCLES_PER_MS       (SIM_CPU_HZ / 1000ULL)
+
+#define SIM_US(us)              ((uint64_t)(us) * SIM_CYCLES_PER_US)
+#define SIM_MS(ms)              ((uint64_t)(ms) * SIM_CYCLES_PER_MS)
+
+#define SIM_CYCLES_PER_ACCESS   4U      /* Load/store plus surrounding ALU work */
+#define SIM_CYCLES_PER_CALL     20U     /* Default cost of a TivaWare call */
+#define SIM_SPIN_THRESHOLD      8U      /* Identical polls before fast-forward
+                                           (above the 4-read keypad row scan) */
+
+#define SIM_FOREVER             UINT64_MAX
+
+/* Event callback, run on the firmware context when the clock reaches it */
+typedef void (*SimEventFn)(void *ctx);
+
+/* Register hooks: refresh a register before the firmware reads it, and
+ * commit a value the firmware wrote */
+typedef void (*SimAccessFn)(uint32_t addr);
+typedef void (*SimWriteFn)(uint32_t addr, uint32_t value);
+
+/* Firmware entry point (the ECU's main, renamed by the build) */
+typedef int (*SimEntryFn)(void);
+
+/* Scenario wait condition */
+typedef bool (*SimCondFn)(void *ctx);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * Sim_Init
+ * Maps the register file and resets the clock, event queue and all models.
+ * Must be called once before Sim_Boot.
+ */
+void Sim_Init(void);
+
+/*
+ * Sim_Cycles / Sim_NowUs
+ * Current virtual time.
+ */
+uint64_t Sim_Cycles(void);
+uint64_t Sim_NowUs(void);
+
+/*
+ * Sim_Schedule
+ * Runs fn(ctx) on the firmware context once the clock reaches cycle.
+ */
+void Sim_Schedule(uint64_t cycle, SimEventFn fn, void *ctx);
+
+/*
+ * Sim_Charge
+ * Advances the clock by the given amount of CPU work.
+ */
+void Sim_Charge(uint32_t cycles);
+
+/*
+ * Sim_Idle
+ * The firmware is waiting on something only an event can change: jump the
+ * clock to the next scheduled event.
+ */
+void Sim_Idle(void);
+
+/*
+ * Sim_MapRegion
+ * Attaches a peripheral model to [base, base + size). Regions must not
+ * straddle more than 16 per 4 KB page.
+ */
+void Sim_MapRegion(uint32_t base, uint32_t size, SimAccessFn onAccess, SimWriteFn onWrite);
+
+/*
+ * Sim_RegAccess
+ * Entry point for every register macro in the generated register header.
+ */
+volatile uint32_t *Sim_RegAccess(uint32_t addr);
+
+/*
+ * Sim_Reg
+ * Raw pointer into the register file, for peripheral models. Does not
+ * charge cycles or run hooks.
+ */
+volatile uint32_t *Sim_Reg(uint32_t addr);
+
+/*
+ * Sim_Sync
+ * Called by TivaWare stubs: commits the last register write and charges
+ * the cost of the call.
+ */
+void Sim_Sync(uint32_t cycles);
+
+/*
+ * Sim_Boot
+ * Creates the firmware context; the firmware starts running on the first
+ * Sim_WaitUntil / Sim_WaitFor.
+ */
+void Sim_Boot(SimEntryFn entry);
+
+/*
+ * Sim_WaitUntil
+ * Scenario side: lets the firmware run until the clock reaches cycle.
+ */
+void Sim_WaitUntil(uint64_t cycle);
+
+/*
+ * Sim_WaitFor
+ * Scenario side: lets the firmware run until cond(ctx) holds or timeout
+ * cycles pass. Models call Sim_Wake() when something the scenario may be
+ * waiting on has changed.
+ * Returns: true if the condition was met, false on timeout
+ */
+bool Sim_WaitFor(SimCondFn cond, void *ctx, uint64_t timeout);
+
+/*
+ * Sim_Wake
+ * Asks the firmware context to hand control back to the scenario at the
+ * next opportunity so it can re-check its wait condition.
+ */
+void Sim_Wake(void);
+
+#endif /* SIM_H_ */
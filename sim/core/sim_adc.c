@@ -0,0 +1,308 @@
+/******************************************************************************
+ * File: sim_adc.c
+ * Module: SIM ADC Model
+ * Description: ADC0 sample sequencers 0 and 3
+ *
+ * A PSSI write starts a conversion that completes SIM_ADC_SAMPLE_CYCLES
+ * later (times the hardware averaging factor), pushes the result into the
+ * SS3 FIFO and raises RIS bit 3.
+ *
+ * SS0 runs its steps up to the one marked END in SSCTL0, each on the
+ * channel in its SSMUX0 nibble, started by PSSI or, with EMUX set to the
+ * timer trigger, by a GPTM time-out. Results go into an 8-entry FIFO;
+ * results that find it full are dropped. RIS bit 0 is raised when the
+ * whole sequence is done if any step has IE set (the hardware raises it
+ * after that step). A trigger while the sequence is running is missed.
+ * The two sequencers convert independently; SSPRI is not modelled. ISC
+ * reads as 0 so that every write to it is seen.
+ ******************************************************************************/
+
+#include "sim_adc.h"
+#include "sim.h"
+#include "sim_nvic.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define ADC0_BASE           0x40038000U
+#define ADC_O_ACTSS         0x000U
+#define ADC_O_RIS           0x004U
+#define ADC_O_IM            0x008U
+#define ADC_O_ISC           0x00CU
+#define ADC_O_EMUX          0x014U
+#define ADC_O_PSSI          0x028U
+#define ADC_O_SAC           0x030U
+#define ADC_O_SSMUX0        0x040U
+#define ADC_O_SSCTL0        0x044U
+#define ADC_O_SSFIFO0       0x048U
+#define ADC_O_SSFSTAT0      0x04CU
+#define ADC_O_SSMUX3        0x0A0U
+#define ADC_O_SSFIFO3       0x0A8U
+#define ADC_O_SSFSTAT3      0x0ACU
+
+#define ADC_SS0             0x01U
+#define ADC_SS3             0x08U
+#define ADC_SSFSTAT_EMPTY   0x00000100U
+#define ADC_SSFSTAT_FULL    0x00001000U
+#define ADC_EMUX_EM0_M      0x0000000FU
+#define ADC_EMUX_EM0_TIMER  0x00000005U
+#define ADC_SSCTL_END       0x2U        /* Per-step nibble bits */
+#define ADC_SSCTL_IE        0x4U
+#define ADC_SS0_STEPS       8U
+#define ADC_CODE_MASK       0x0FFFU
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint16_t s_inputs[SIM_ADC_CHANNELS];
+static SimAdcSourceFn s_source;
+static uint32_t s_ris;
+static uint16_t s_fifo3;
+static uint8_t s_fifo3Count;
+static uint8_t s_busy3;
+static uint16_t s_fifo0[ADC_SS0_STEPS];
+static uint8_t s_fifo0Head;
+static uint8_t s_fifo0Count;
+static uint8_t s_busy0;
+static uint32_t s_conversions;
+static uint32_t s_overflows;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint32_t SimAdc_Reg(uint32_t offset)
+{
+    return *Sim_Reg(ADC0_BASE + offset);
+}
+
+static uint16_t SimAdc_Sample(uint8_t channel, uint64_t cycle)
+{
+    if (channel >= SIM_ADC_CHANNELS) {
+        return 0U;
+    }
+    if (s_source != NULL) {
+        return (uint16_t)(s_source(channel, cycle) & ADC_CODE_MASK);
+    }
+    return s_inputs[channel];
+}
+
+static uint32_t SimAdc_Averaging(void)
+{
+    return 1U << (SimAdc_Reg(ADC_O_SAC) & 0x7U);
+}
+
+/*
+ * SimAdc_Convert
+ * One result: the average of the samples taken over its conversion window.
+ */
+static uint16_t SimAdc_Convert(uint8_t channel, uint64_t start)
+{
+    uint32_t averaging = SimAdc_Averaging();
+    uint32_t sum = 0U;
+    uint32_t i;
+
+    for (i = 0; i < averaging; i++) {
+        sum += SimAdc_Sample(channel, start + ((uint64_t)i * SIM_ADC_SAMPLE_CYCLES));
+    }
+    return (uint16_t)(sum / averaging);
+}
+
+/*
+ * SimAdc_Ss3Done
+ * Conversion finished.
+ */
+static void SimAdc_Ss3Done(void *ctx)
+{
+    uint8_t channel = (uint8_t)(SimAdc_Reg(ADC_O_SSMUX3) & 0x0FU);
+    uint64_t start = Sim_Cycles() - ((uint64_t)SimAdc_Averaging() * SIM_ADC_SAMPLE_CYCLES);
+
+    (void)ctx;
+    s_fifo3 = SimAdc_Convert(channel, start);
+    s_fifo3Count = 1U;
+    s_busy3 = 0U;
+    s_ris |= ADC_SS3;
+    s_conversions++;
+}
+
+/*
+ * SimAdc_Ss0Steps
+ * Steps in the SS0 sequence: up to and including the first END step.
+ */
+static uint32_t SimAdc_Ss0Steps(void)
+{
+    uint32_t ctl = SimAdc_Reg(ADC_O_SSCTL0);
+    uint32_t step;
+
+    for (step = 0; step < ADC_SS0_STEPS - 1U; step++) {
+        if (((ctl >> (step * 4U)) & ADC_SSCTL_END) != 0U) {
+            break;
+        }
+    }
+    return step + 1U;
+}
+
+/*
+ * SimAdc_Ss0Done
+ * Sequence finished: convert every step into the FIFO.
+ */
+static void SimAdc_Ss0Done(void *ctx)
+{
+    uint32_t steps = SimAdc_Ss0Steps();
+    uint64_t window = (uint64_t)SimAdc_Averaging() * SIM_ADC_SAMPLE_CYCLES;
+    uint64_t start = Sim_Cycles() - (steps * window);
+    uint32_t mux = SimAdc_Reg(ADC_O_SSMUX0);
+    uint32_t ctl = SimAdc_Reg(ADC_O_SSCTL0);
+    bool interrupt = false;
+    uint32_t step;
+
+    (void)ctx;
+    for (step = 0; step < steps; step++) {
+        uint8_t channel = (uint8_t)((mux >> (step * 4U)) & 0x0FU);
+        uint16_t code = SimAdc_Convert(channel, start + (step * window));
+
+        if (s_fifo0Count == ADC_SS0_STEPS) {
+            s_overflows++;
+        } else {
+            s_fifo0[(s_fifo0Head + s_fifo0Count) % ADC_SS0_STEPS] = code;
+            s_fifo0Count++;
+        }
+        if (((ctl >> (step * 4U)) & ADC_SSCTL_IE) != 0U) {
+            interrupt = true;
+        }
+        s_conversions++;
+    }
+    s_busy0 = 0U;
+    if (interrupt) {
+        s_ris |= ADC_SS0;
+    }
+}
+
+static void SimAdc_Ss0Start(void)
+{
+    if ((SimAdc_Reg(ADC_O_ACTSS) & ADC_SS0) == 0U || s_busy0) {
+        return;
+    }
+    s_busy0 = 1U;
+    Sim_Schedule(Sim_Cycles() + ((uint64_t)SimAdc_Ss0Steps() * SimAdc_Averaging() *
+                                 SIM_ADC_SAMPLE_CYCLES),
+                 SimAdc_Ss0Done, NULL);
+}
+
+static bool SimAdc_Line0(void)
+{
+    return (s_ris & SimAdc_Reg(ADC_O_IM) & ADC_SS0) != 0U;
+}
+
+static void SimAdc_Access(uint32_t addr)
+{
+    uint32_t offset = addr - ADC0_BASE;
+
+    switch (offset) {
+        case ADC_O_RIS:
+            *Sim_Reg(addr) = s_ris;
+            break;
+
+        case ADC_O_ISC:
+            *Sim_Reg(addr) = 0U;
+            break;
+
+        case ADC_O_SSFIFO0:
+            if (s_fifo0Count == 0U) {
+                *Sim_Reg(addr) = 0U;
+                break;
+            }
+            *Sim_Reg(addr) = s_fifo0[s_fifo0Head];
+            s_fifo0Head = (uint8_t)((s_fifo0Head + 1U) % ADC_SS0_STEPS);
+            s_fifo0Count--;
+            break;
+
+        case ADC_O_SSFSTAT0:
+            *Sim_Reg(addr) = (s_fifo0Count == 0U) ? ADC_SSFSTAT_EMPTY :
+                             (s_fifo0Count == ADC_SS0_STEPS) ? ADC_SSFSTAT_FULL : 0U;
+            break;
+
+        case ADC_O_SSFIFO3:
+            *Sim_Reg(addr) = s_fifo3;
+            s_fifo3Count = 0U;
+            break;
+
+        case ADC_O_SSFSTAT3:
+            *Sim_Reg(addr) = (s_fifo3Count == 0U) ? ADC_SSFSTAT_EMPTY : 1U;
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void SimAdc_Write(uint32_t addr, uint32_t value)
+{
+    uint32_t offset = addr - ADC0_BASE;
+
+    switch (offset) {
+        case ADC_O_ISC:
+            s_ris &= ~value;
+            *Sim_Reg(addr) = 0U;
+            break;
+
+        case ADC_O_PSSI:
+            if ((value & ADC_SS0) != 0U) {
+                SimAdc_Ss0Start();
+            }
+            if ((value & ADC_SS3) != 0U && (SimAdc_Reg(ADC_O_ACTSS) & ADC_SS3) != 0U && !s_busy3) {
+                s_busy3 = 1U;
+                Sim_Schedule(Sim_Cycles() + ((uint64_t)SimAdc_Averaging() * SIM_ADC_SAMPLE_CYCLES),
+                             SimAdc_Ss3Done, NULL);
+            }
+            *Sim_Reg(addr) = 0U;    /* Write-only trigger */
+            break;
+
+        default:
+            break;
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimAdc_Init(void)
+{
+    Sim_MapRegion(ADC0_BASE, 0x1000U, SimAdc_Access, SimAdc_Write);
+    SimNvic_SetLine(SIM_VECTOR_ADC0SS0, SimAdc_Line0);
+}
+
+void SimAdc_TimerTrigger(void)
+{
+    if ((SimAdc_Reg(ADC_O_EMUX) & ADC_EMUX_EM0_M) == ADC_EMUX_EM0_TIMER) {
+        SimAdc_Ss0Start();
+    }
+}
+
+void SimAdc_SetInput(uint8_t channel, uint16_t value)
+{
+    if (channel < SIM_ADC_CHANNELS) {
+        s_inputs[channel] = value & ADC_CODE_MASK;
+    }
+}
+
+void SimAdc_SetSource(SimAdcSourceFn fn)
+{
+    s_source = fn;
+}
+
+uint32_t SimAdc_Conversions(void)
+{
+    return s_conversions;
+}
+
+uint32_t SimAdc_Overflows(void)
+{
+    return s_overflows;
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+ * File: sim_adc.h
+ * Module: SIM ADC Model
+ * Description: ADC0 sample sequencers 0 and 3
+ ******************************************************************************/
+
+#ifndef SIM_ADC_H_
+#define SIM_ADC_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_ADC_CHANNELS        12U
+#define SIM_ADC_SAMPLE_CYCLES   16U     /* 1 Msps at 16 MHz */
+
+/* Vector number (TivaWare hw_ints.h) */
+#define SIM_VECTOR_ADC0SS0      30U
+
+/* Analog source: returns the 12-bit code for a channel at a given cycle */
+typedef uint16_t (*SimAdcSourceFn)(uint8_t channel, uint64_t cycle);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+void SimAdc_Init(void);
+
+/*
+ * SimAdc_SetInput
+ * Holds a channel at a constant 12-bit code.
+ */
+void SimAdc_SetInput(uint8_t channel, uint16_t value);
+
+/*
+ * SimAdc_SetSource
+ * Replaces constant inputs with a time-varying source (NULL restores them).
+ */
+void SimAdc_SetSource(SimAdcSourceFn fn);
+
+/*
+ * SimAdc_TimerTrigger
+ * A GPTM time-out with TAOTE set: starts SS0 if EMUX selects the timer.
+ */
+void SimAdc_TimerTrigger(void);
+
+/*
+ * SimAdc_Conversions
+ * Number of results converted so far, all sequencers.
+ */
+uint32_t SimAdc_Conversions(void);
+
+/*
+ * SimAdc_Overflows
+ * Number of SS0 results dropped because the FIFO was full.
+ */
+uint32_t SimAdc_Overflows(void);
+
+#endif /* SIM_ADC_H_ */
@@ -0,0 +1,198 @@
+/******************************************************************************
+ * File: sim_eeprom.c
+ * Module: SIM EEPROM Model
+ * Description: 2 KB EEPROM array (512 words) with per-word write counters
+ ******************************************************************************/
+
+#include "sim_eeprom.h"
+#include "sim_nvic.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_words[SIM_EEPROM_WORDS];
+static uint32_t s_writeCounts[SIM_EEPROM_WORDS];
+static uint32_t s_cutAfter = SIM_EEPROM_NO_CUT;    /* Programs left before the cut */
+static uint32_t s_failAfter = SIM_EEPROM_NO_CUT;   /* Background programs left before failing */
+static bool s_failed;                               /* Last background program failed */
+
+/* Background program (EEPROMProgramNonBlocking) */
+static bool s_busy;
+static uint32_t s_startWord;
+static uint32_t s_startValue;
+static bool s_intEnabled;
+static bool s_intDone;                              /* Raw done interrupt */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static void SimEeprom_StartDone(void *ctx)
+{
+    (void)ctx;
+    if (s_failAfter == 0U) {
+        s_failed = true;
+    } else {
+        if (s_failAfter != SIM_EEPROM_NO_CUT) {
+            s_failAfter--;
+        }
+        SimEeprom_Program(s_startWord, s_startValue);
+    }
+    s_busy = false;
+    s_intDone = true;
+}
+
+static bool SimEeprom_Line(void)
+{
+    return s_intDone && s_intEnabled;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimEeprom_Init(void)
+{
+    memset(s_words, 0xFF, sizeof(s_words));
+    memset(s_writeCounts, 0, sizeof(s_writeCounts));
+    s_cutAfter = SIM_EEPROM_NO_CUT;
+    s_failAfter = SIM_EEPROM_NO_CUT;
+    s_failed = false;
+    s_busy = false;
+    s_intEnabled = false;
+    s_intDone = false;
+    SimNvic_SetLine(SIM_VECTOR_FLASH, SimEeprom_Line);
+}
+
+uint32_t SimEeprom_Read(uint32_t word)
+{
+    return (word < SIM_EEPROM_WORDS) ? s_words[word] : 0xFFFFFFFFU;
+}
+
+void SimEeprom_Program(uint32_t word, uint32_t value)
+{
+    if (s_cutAfter == 0U) {
+        return;
+    }
+    if (s_cutAfter != SIM_EEPROM_NO_CUT) {
+        s_cutAfter--;
+    }
+    if (word < SIM_EEPROM_WORDS) {
+        s_words[word] = value;
+        s_writeCounts[word]++;
+    }
+}
+
+void SimEeprom_Erase(void)
+{
+    uint32_t i;
+
+    if (s_cutAfter == 0U) {
+        return;
+    }
+
+    for (i = 0; i < SIM_EEPROM_WORDS; i++) {
+        s_words[i] = 0xFFFFFFFFU;
+        s_writeCounts[i]++;
+    }
+}
+
+bool SimEeprom_Start(uint32_t word, uint32_t value)
+{
+    if (s_busy) {
+        return false;
+    }
+    s_busy = true;
+    s_failed = false;
+    s_startWord = word;
+    s_startValue = value;
+    Sim_Schedule(Sim_Cycles() + SIM_EEPROM_PROGRAM_CYCLES, SimEeprom_StartDone, NULL);
+    return true;
+}
+
+bool SimEeprom_Busy(void)
+{
+    return s_busy;
+}
+
+bool SimEeprom_Failed(void)
+{
+    return s_failed;
+}
+
+void SimEeprom_WaitIdle(void)
+{
+    while (s_busy) {
+        Sim_Idle();
+    }
+}
+
+void SimEeprom_IntEnable(bool enable)
+{
+    s_intEnabled = enable;
+}
+
+bool SimEeprom_IntStatus(bool masked)
+{
+    return s_intDone && (s_intEnabled || !masked);
+}
+
+void SimEeprom_IntClear(void)
+{
+    s_intDone = false;
+}
+
+void SimEeprom_CutPowerAfter(uint32_t words)
+{
+    s_cutAfter = words;
+}
+
+void SimEeprom_RestorePower(void)
+{
+    s_cutAfter = SIM_EEPROM_NO_CUT;
+}
+
+void SimEeprom_FailAfter(uint32_t words)
+{
+    s_failAfter = words;
+}
+
+void SimEeprom_StopFailing(void)
+{
+    s_failAfter = SIM_EEPROM_NO_CUT;
+}
+
+uint32_t SimEeprom_WriteCount(uint32_t word)
+{
+    return (word < SIM_EEPROM_WORDS) ? s_writeCounts[word] : 0U;
+}
+
+bool SimEeprom_Load(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    size_t count;
+
+    if (file == NULL) {
+        return false;
+    }
+    count = fread(s_words, sizeof(uint32_t), SIM_EEPROM_WORDS, file);
+    fclose(file);
+    return count == SIM_EEPROM_WORDS;
+}
+
+bool SimEeprom_Save(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    size_t count;
+
+    if (file == NULL) {
+        return false;
+    }
+    count = fwrite(s_words, sizeof(uint32_t), SIM_EEPROM_WORDS, file);
+    fclose(file);
+    return count == SIM_EEPROM_WORDS;
+}
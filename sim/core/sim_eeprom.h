@@ -0,0 +1,117 @@
+/******************************************************************************
+ * File: sim_eeprom.h
+ * Module: SIM EEPROM Model
+ * Description: 2 KB EEPROM array (512 words) with per-word write counters
+ *
+ * Program and erase times are approximations of the TM4C123 figures; they
+ * are charged by the TivaWare stubs, which block the CPU like the real
+ * EEPROMProgram() while the rest of the system keeps running.
+ *
+ * SimEeprom_Start() models EEPROMProgramNonBlocking(): the word is
+ * programmed SIM_EEPROM_PROGRAM_CYCLES later, then the EEPROM raises its
+ * done interrupt (on the flash controller vector) if it is enabled.
+ ******************************************************************************/
+
+#ifndef SIM_EEPROM_H_
+#define SIM_EEPROM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_EEPROM_WORDS            512U
+#define SIM_EEPROM_PROGRAM_CYCLES   SIM_US(110)     /* Per word */
+#define SIM_EEPROM_ERASE_CYCLES     SIM_MS(8)       /* Mass erase */
+#define SIM_EEPROM_READ_CYCLES      4U              /* Per word */
+#define SIM_EEPROM_NO_CUT           0xFFFFFFFFU
+
+/* Vector number (TivaWare hw_ints.h): flash controller and EEPROM */
+#define SIM_VECTOR_FLASH            45U
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimEeprom_Init
+ * Starts with an erased array (all ones) and zeroed write counters.
+ */
+void SimEeprom_Init(void);
+
+uint32_t SimEeprom_Read(uint32_t word);
+void SimEeprom_Program(uint32_t word, uint32_t value);
+void SimEeprom_Erase(void);
+
+/*
+ * SimEeprom_Start
+ * Starts programming one word in the background.
+ * Returns: false if a program is already in progress
+ */
+bool SimEeprom_Start(uint32_t word, uint32_t value);
+
+/*
+ * SimEeprom_Busy
+ * True while a word started with SimEeprom_Start() is being programmed.
+ */
+bool SimEeprom_Busy(void);
+
+/*
+ * SimEeprom_Failed
+ * True if the last word started with SimEeprom_Start() failed to program
+ * (see SimEeprom_FailAfter()); cleared by the next start.
+ */
+bool SimEeprom_Failed(void);
+
+/*
+ * SimEeprom_WaitIdle
+ * Firmware side: lets simulated time pass until no program is in
+ * progress, as TivaWare does before starting another operation.
+ */
+void SimEeprom_WaitIdle(void);
+
+/*
+ * SimEeprom_IntEnable / SimEeprom_IntStatus / SimEeprom_IntClear
+ * The done interrupt: enable, raw or masked status, acknowledge.
+ */
+void SimEeprom_IntEnable(bool enable);
+bool SimEeprom_IntStatus(bool masked);
+void SimEeprom_IntClear(void);
+
+/*
+ * SimEeprom_WriteCount
+ * Program cycles a word has seen (erases count as a cycle for every word).
+ */
+uint32_t SimEeprom_WriteCount(uint32_t word);
+
+/*
+ * SimEeprom_CutPowerAfter
+ * Fault injection: the next `words` word programs complete, then power is
+ * lost. Later programs and erases leave the array unchanged (and are not
+ * counted) until SimEeprom_RestorePower(). A word is either programmed
+ * or not; the cut falls between words.
+ */
+void SimEeprom_CutPowerAfter(uint32_t words);
+void SimEeprom_RestorePower(void);
+
+/*
+ * SimEeprom_FailAfter
+ * Fault injection: the next `words` background programs complete, then
+ * every one fails, leaving its word unchanged and the error reported by
+ * EEPROMStatusGet(), until SimEeprom_StopFailing().
+ */
+void SimEeprom_FailAfter(uint32_t words);
+void SimEeprom_StopFailing(void);
+
+/*
+ * SimEeprom_Load / SimEeprom_Save
+ * Persist the array between runs so a simulated reboot sees old data.
+ * Returns: false if the file could not be read or written
+ */
+bool SimEeprom_Load(const char *path);
+bool SimEeprom_Save(const char *path);
+
+#endif /* SIM_EEPROM_H_ */
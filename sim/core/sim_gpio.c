@@ -0,0 +1,153 @@
+/******************************************************************************
+ * File: sim_gpio.c
+ * Module: SIM GPIO Model
+ * Description: GPIO ports A-F (APB aperture) with masked DATA aliases,
+ *              external pin drivers and pin-change listeners
+ *
+ * GPIODATA is mirrored over 0x000-0x3FC; address bits [9:2] select which
+ * pins an access reads or modifies. The output latch is kept here and the
+ * alias the firmware touches is refreshed on every access.
+ ******************************************************************************/
+
+#include "sim_gpio.h"
+#include "sim.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define GPIO_PORT_SIZE      0x1000U
+#define GPIO_DATA_END       0x400U
+#define GPIO_O_DIR          0x400U
+#define GPIO_O_PUR          0x510U
+
+#define MAX_LISTENERS       4U
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static const uint32_t s_portBase[SIM_GPIO_PORTS] = {
+    0x40004000U,    /* Port A */
+    0x40005000U,    /* Port B */
+    0x40006000U,    /* Port C */
+    0x40007000U,    /* Port D */
+    0x40024000U,    /* Port E */
+    0x40025000U     /* Port F */
+};
+
+static uint8_t s_outLatch[SIM_GPIO_PORTS];
+static uint8_t s_dir[SIM_GPIO_PORTS];
+static SimGpioInputFn s_inputFn[SIM_GPIO_PORTS];
+static SimGpioListenerFn s_listeners[SIM_GPIO_PORTS][MAX_LISTENERS];
+static uint8_t s_listenerCount[SIM_GPIO_PORTS];
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * SimGpio_PortOf
+ * Maps a register address back to its port index.
+ */
+static uint8_t SimGpio_PortOf(uint32_t addr)
+{
+    uint8_t port;
+
+    for (port = 0; port < SIM_GPIO_PORTS; port++) {
+        if (addr - s_portBase[port] < GPIO_PORT_SIZE) {
+            break;
+        }
+    }
+    return port;
+}
+
+static void SimGpio_Notify(uint8_t port, uint8_t oldLevels, uint8_t newLevels)
+{
+    uint8_t i;
+
+    if (oldLevels == newLevels) {
+        return;
+    }
+    for (i = 0; i < s_listenerCount[port]; i++) {
+        s_listeners[port][i](port, oldLevels, newLevels);
+    }
+}
+
+static void SimGpio_Access(uint32_t addr)
+{
+    uint8_t port = SimGpio_PortOf(addr);
+    uint32_t offset = addr - s_portBase[port];
+
+    if (offset < GPIO_DATA_END) {
+        uint8_t mask = (uint8_t)(offset >> 2);
+        *Sim_Reg(addr) = SimGpio_GetLevels(port) & mask;
+    }
+}
+
+static void SimGpio_Write(uint32_t addr, uint32_t value)
+{
+    uint8_t port = SimGpio_PortOf(addr);
+    uint32_t offset = addr - s_portBase[port];
+    uint8_t before = SimGpio_GetLevels(port);
+
+    if (offset < GPIO_DATA_END) {
+        uint8_t mask = (uint8_t)(offset >> 2);
+        s_outLatch[port] = (uint8_t)((s_outLatch[port] & ~mask) | (value & mask));
+        *Sim_Reg(addr) = SimGpio_GetLevels(port) & mask;
+    } else if (offset == GPIO_O_DIR) {
+        s_dir[port] = (uint8_t)value;
+    }
+
+    SimGpio_Notify(port, before, SimGpio_GetLevels(port));
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimGpio_Init(void)
+{
+    uint8_t port;
+
+    for (port = 0; port < SIM_GPIO_PORTS; port++) {
+        Sim_MapRegion(s_portBase[port], GPIO_PORT_SIZE, SimGpio_Access, SimGpio_Write);
+    }
+}
+
+void SimGpio_SetInputFn(uint8_t port, SimGpioInputFn fn)
+{
+    s_inputFn[port] = fn;
+}
+
+void SimGpio_AddListener(uint8_t port, SimGpioListenerFn fn)
+{
+    if (s_listenerCount[port] < MAX_LISTENERS) {
+        s_listeners[port][s_listenerCount[port]++] = fn;
+    }
+}
+
+uint8_t SimGpio_GetDir(uint8_t port)
+{
+    return s_dir[port];
+}
+
+uint8_t SimGpio_GetOutputs(uint8_t port)
+{
+    return s_outLatch[port] & SimGpio_GetDir(port);
+}
+
+uint8_t SimGpio_GetLevels(uint8_t port)
+{
+    uint8_t dir = SimGpio_GetDir(port);
+    uint8_t inputs;
+
+    if (s_inputFn[port] != NULL) {
+        inputs = s_inputFn[port](port);
+    } else {
+        inputs = (uint8_t)*Sim_Reg(s_portBase[port] + GPIO_O_PUR);
+    }
+    return (uint8_t)((s_outLatch[port] & dir) | (inputs & ~dir));
+}
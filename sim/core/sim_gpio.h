@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File: sim_gpio.h
+ * Module: SIM GPIO Model
+ * Description: GPIO ports A-F (APB aperture) with masked DATA aliases,
+ *              external pin drivers and pin-change listeners
+ ******************************************************************************/
+
+#ifndef SIM_GPIO_H_
+#define SIM_GPIO_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+/* Port indices, same numbering as dio.h */
+#define SIM_GPIO_PORTA      0U
+#define SIM_GPIO_PORTB      1U
+#define SIM_GPIO_PORTC      2U
+#define SIM_GPIO_PORTD      3U
+#define SIM_GPIO_PORTE      4U
+#define SIM_GPIO_PORTF      5U
+#define SIM_GPIO_PORTS      6U
+
+/* Levels driven onto a port's input pins by external hardware */
+typedef uint8_t (*SimGpioInputFn)(uint8_t port);
+
+/* Called whenever the pin levels of a port change */
+typedef void (*SimGpioListenerFn)(uint8_t port, uint8_t oldLevels, uint8_t newLevels);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimGpio_Init
+ * Attaches the model to the six APB GPIO ports.
+ */
+void SimGpio_Init(void);
+
+/*
+ * SimGpio_SetInputFn
+ * Installs the external driver for a port's input pins. Without one,
+ * input pins read their pull-up configuration.
+ */
+void SimGpio_SetInputFn(uint8_t port, SimGpioInputFn fn);
+
+/*
+ * SimGpio_AddListener
+ * Registers a callback for pin level changes on a port.
+ */
+void SimGpio_AddListener(uint8_t port, SimGpioListenerFn fn);
+
+/*
+ * SimGpio_GetLevels
+ * Returns the levels on a port's pins: output latch for outputs, external
+ * driver or pull-ups for inputs.
+ */
+uint8_t SimGpio_GetLevels(uint8_t port);
+
+/*
+ * SimGpio_GetOutputs
+ * Returns the pins a port actively drives high.
+ */
+uint8_t SimGpio_GetOutputs(uint8_t port);
+
+/*
+ * SimGpio_GetDir
+ * Returns a port's direction register (1 = output).
+ */
+uint8_t SimGpio_GetDir(uint8_t port);
+
+#endif /* SIM_GPIO_H_ */
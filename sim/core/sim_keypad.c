@@ -0,0 +1,141 @@
+/******************************************************************************
+ * File: sim_keypad.c
+ * Module: SIM Keypad Model
+ * Description: 4x4 membrane keypad wired as in keypad.c
+ ******************************************************************************/
+
+#include "sim_keypad.h"
+#include "sim_gpio.h"
+#include "sim.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define KEYPAD_SIZE         4U
+#define ROW_SHIFT           2U      /* Rows on PA2-PA5 */
+#define COL_SHIFT           4U      /* Columns on PC4-PC7 */
+#define ROW_MASK            (0x0FU << ROW_SHIFT)
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static const char s_layout[KEYPAD_SIZE][KEYPAD_SIZE] = {
+    {'1', '2', '3', 'A'},
+    {'4', '5', '6', 'B'},
+    {'7', '8', '9', 'C'},
+    {'*', '0', '#', 'D'}
+};
+
+static uint16_t s_pressed;     /* Bit (row * 4 + col) */
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * SimKeypad_Bit
+ * Returns the key's bit in s_pressed, or 0 for an unknown key.
+ */
+static uint16_t SimKeypad_Bit(char key)
+{
+    uint8_t row;
+    uint8_t col;
+
+    for (row = 0; row < KEYPAD_SIZE; row++) {
+        for (col = 0; col < KEYPAD_SIZE; col++) {
+            if (s_layout[row][col] == key) {
+                return (uint16_t)(1U << ((row * KEYPAD_SIZE) + col));
+            }
+        }
+    }
+    return 0U;
+}
+
+/*
+ * SimKeypad_RowLevels
+ * Input driver for port A: pulled-up rows, pulled low through any chain
+ * of pressed keys that reaches a column driven low. The keys have no
+ * diodes and the low side is taken to win over a column driven high, so
+ * with three corners of a rectangle pressed the fourth reads as pressed
+ * too (ghosting).
+ */
+static uint8_t SimKeypad_RowLevels(uint8_t port)
+{
+    uint8_t colDir = SimGpio_GetDir(SIM_GPIO_PORTC);
+    uint8_t colOut = SimGpio_GetOutputs(SIM_GPIO_PORTC);
+    uint8_t lowCols = 0U;           /* Bit col */
+    uint8_t lowRows = 0U;           /* Bit row */
+    uint8_t levels = ROW_MASK;
+    bool spread = true;
+    uint8_t row;
+    uint8_t col;
+
+    (void)port;
+    for (col = 0; col < KEYPAD_SIZE; col++) {
+        uint8_t colPin = (uint8_t)(1U << (col + COL_SHIFT));
+        if ((colDir & colPin) != 0U && (colOut & colPin) == 0U) {
+            lowCols |= (uint8_t)(1U << col);
+        }
+    }
+
+    /* Spread the low level across pressed keys until nothing changes */
+    while (spread) {
+        spread = false;
+        for (row = 0; row < KEYPAD_SIZE; row++) {
+            for (col = 0; col < KEYPAD_SIZE; col++) {
+                bool rowLow = (lowRows & (1U << row)) != 0U;
+                bool colLow = (lowCols & (1U << col)) != 0U;
+                if ((s_pressed & (1U << ((row * KEYPAD_SIZE) + col))) != 0U && rowLow != colLow) {
+                    lowRows |= (uint8_t)(1U << row);
+                    lowCols |= (uint8_t)(1U << col);
+                    spread = true;
+                }
+            }
+        }
+    }
+
+    for (row = 0; row < KEYPAD_SIZE; row++) {
+        if ((lowRows & (1U << row)) != 0U) {
+            levels &= (uint8_t)~(1U << (row + ROW_SHIFT));
+        }
+    }
+    return levels;
+}
+
+static void SimKeypad_ReleaseEvent(void *ctx)
+{
+    SimKeypad_Release((char)(uintptr_t)ctx);
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimKeypad_Init(void)
+{
+    SimGpio_SetInputFn(SIM_GPIO_PORTA, SimKeypad_RowLevels);
+}
+
+void SimKeypad_Press(char key)
+{
+    s_pressed |= SimKeypad_Bit(key);
+}
+
+void SimKeypad_Release(char key)
+{
+    s_pressed &= (uint16_t)~SimKeypad_Bit(key);
+}
+
+void SimKeypad_Tap(char key, uint64_t holdCycles)
+{
+    SimKeypad_Press(key);
+    Sim_Schedule(Sim_Cycles() + holdCycles, SimKeypad_ReleaseEvent, (void *)(uintptr_t)(uint8_t)key);
+}
+
+bool SimKeypad_IsPressed(char key)
+{
+    uint16_t bit = SimKeypad_Bit(key);
+    return bit != 0U && (s_pressed & bit) != 0U;
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * File: sim_keypad.h
+ * Module: SIM Keypad Model
+ * Description: 4x4 membrane keypad wired as in keypad.c
+ *              (columns PC4-PC7 driven, rows PA2-PA5 with pull-ups)
+ *
+ * A pressed key shorts its row to its column, so a row reads low while the
+ * firmware drives that key's column low. There are no diodes: a chain of
+ * pressed keys carries the low level on, so three pressed corners of a
+ * rectangle make the fourth read as pressed (ghosting).
+ ******************************************************************************/
+
+#ifndef SIM_KEYPAD_H_
+#define SIM_KEYPAD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimKeypad_Init
+ * Installs the matrix as the input driver of port A.
+ */
+void SimKeypad_Init(void);
+
+/*
+ * SimKeypad_Press / SimKeypad_Release
+ * Changes the state of one key ('0'-'9', 'A'-'D', '*', '#').
+ */
+void SimKeypad_Press(char key);
+void SimKeypad_Release(char key);
+
+/*
+ * SimKeypad_Tap
+ * Presses a key now and schedules its release after holdCycles.
+ */
+void SimKeypad_Tap(char key, uint64_t holdCycles);
+
+/*
+ * SimKeypad_IsPressed
+ * Returns true while a key is held down.
+ */
+bool SimKeypad_IsPressed(char key);
+
+#endif /* SIM_KEYPAD_H_ */
@@ -0,0 +1,248 @@
+/******************************************************************************
+ * File: sim_lcd.c
+ * Module: SIM LCD Model
+ * Description: HD44780-compatible 16x2 character LCD wired as in lcd.h
+ ******************************************************************************/
+
+#include "sim_lcd.h"
+#include "sim_gpio.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define PIN_RS              0x01U   /* PB0 */
+#define PIN_EN              0x02U   /* PB1 */
+#define DATA_SHIFT          2U      /* D4-D7 on PB2-PB5 */
+
+#define DDRAM_SIZE          0x80U
+#define CGRAM_SIZE          0x40U
+#define LINE2_ADDR          0x40U
+#define LINE_LENGTH         0x28U
+
+#define CMD_CLEAR           0x01U
+#define CMD_HOME            0x02U
+#define CMD_ENTRY_MODE      0x04U
+#define CMD_FUNCTION_SET    0x20U
+#define CMD_SET_CGRAM       0x40U
+#define CMD_SET_DDRAM       0x80U
+#define ENTRY_INCREMENT     0x02U
+#define FUNCTION_8BIT       0x10U
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint8_t s_ddram[DDRAM_SIZE];
+static uint8_t s_cgram[CGRAM_SIZE];
+static uint8_t s_addr;
+static bool s_cgramSelected;
+static bool s_increment = true;
+static bool s_fourBit;
+static bool s_highNibblePending;
+static uint8_t s_highNibble;
+static uint64_t s_busyUntil = SIM_LCD_POWERUP_CYCLES;
+
+static uint32_t s_dataBytes;
+static uint32_t s_commandBytes;
+static uint32_t s_busyViolations;
+static SimLcdByteFn s_byteLog;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * SimLcd_StepAddress
+ * Moves the address counter after a data access, wrapping like a 2-line
+ * display (0x27 -> 0x40, 0x67 -> 0x00).
+ */
+static void SimLcd_StepAddress(void)
+{
+    if (s_cgramSelected) {
+        s_addr = (uint8_t)((s_addr + (s_increment ? 1U : CGRAM_SIZE - 1U)) % CGRAM_SIZE);
+        return;
+    }
+
+    if (s_increment) {
+        s_addr++;
+        if (s_addr == LINE_LENGTH) {
+            s_addr = LINE2_ADDR;
+        } else if (s_addr == LINE2_ADDR + LINE_LENGTH) {
+            s_addr = 0U;
+        }
+    } else {
+        if (s_addr == 0U) {
+            s_addr = LINE2_ADDR + LINE_LENGTH - 1U;
+        } else if (s_addr == LINE2_ADDR) {
+            s_addr = LINE_LENGTH - 1U;
+        } else {
+            s_addr--;
+        }
+    }
+}
+
+static void SimLcd_Command(uint8_t command)
+{
+    uint64_t exec = SIM_LCD_EXEC_CYCLES;
+
+    if (command >= CMD_SET_DDRAM) {
+        s_addr = command & 0x7FU;
+        s_cgramSelected = false;
+    } else if (command >= CMD_SET_CGRAM) {
+        s_addr = command & 0x3FU;
+        s_cgramSelected = true;
+    } else if (command >= CMD_FUNCTION_SET) {
+        s_fourBit = ((command & FUNCTION_8BIT) == 0U);
+    } else if (command >= CMD_ENTRY_MODE && command < 0x08U) {
+        s_increment = ((command & ENTRY_INCREMENT) != 0U);
+    } else if (command == CMD_CLEAR) {
+        memset(s_ddram, ' ', sizeof(s_ddram));
+        s_addr = 0U;
+        s_cgramSelected = false;
+        s_increment = true;
+        exec = SIM_LCD_CLEAR_CYCLES;
+    } else if ((command & 0xFEU) == CMD_HOME) {
+        s_addr = 0U;
+        s_cgramSelected = false;
+        exec = SIM_LCD_CLEAR_CYCLES;
+    } else {
+        /* Display control and shifts do not change the text */
+    }
+
+    s_busyUntil = Sim_Cycles() + exec;
+}
+
+static void SimLcd_Data(uint8_t data)
+{
+    if (s_cgramSelected) {
+        s_cgram[s_addr % CGRAM_SIZE] = data & 0x1FU;
+    } else {
+        s_ddram[s_addr % DDRAM_SIZE] = data;
+    }
+    SimLcd_StepAddress();
+    s_busyUntil = Sim_Cycles() + SIM_LCD_EXEC_CYCLES;
+}
+
+/*
+ * SimLcd_Latch
+ * A complete byte reached the controller.
+ */
+static void SimLcd_Latch(bool isData, uint8_t value)
+{
+    if (Sim_Cycles() < s_busyUntil) {
+        s_busyViolations++;
+    }
+
+    if (isData) {
+        s_dataBytes++;
+        SimLcd_Data(value);
+    } else {
+        s_commandBytes++;
+        SimLcd_Command(value);
+    }
+
+    if (s_byteLog != NULL) {
+        s_byteLog(isData, value, Sim_Cycles());
+    }
+    Sim_Wake();
+}
+
+/*
+ * SimLcd_PinChange
+ * Latches D4-D7 on the falling edge of EN.
+ */
+static void SimLcd_PinChange(uint8_t port, uint8_t oldLevels, uint8_t newLevels)
+{
+    uint8_t nibble;
+    bool isData;
+
+    (void)port;
+    if ((oldLevels & PIN_EN) == 0U || (newLevels & PIN_EN) != 0U) {
+        return;
+    }
+
+    nibble = (uint8_t)((newLevels >> DATA_SHIFT) & 0x0FU);
+    isData = ((newLevels & PIN_RS) != 0U);
+
+    if (!s_fourBit) {
+        /* 8-bit interface: D0-D3 are not wired and read as zero */
+        SimLcd_Latch(isData, (uint8_t)(nibble << 4));
+        s_highNibblePending = false;
+    } else if (!s_highNibblePending) {
+        s_highNibble = nibble;
+        s_highNibblePending = true;
+    } else {
+        s_highNibblePending = false;
+        SimLcd_Latch(isData, (uint8_t)((s_highNibble << 4) | nibble));
+    }
+}
+
+typedef struct {
+    uint8_t row;
+    const char *prefix;
+} SimLcdTextWait;
+
+static bool SimLcd_RowStartsWith(void *ctx)
+{
+    const SimLcdTextWait *wait = ctx;
+    char text[SIM_LCD_COLS + 1U];
+
+    SimLcd_GetRow(wait->row, text);
+    return strncmp(text, wait->prefix, strlen(wait->prefix)) == 0;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimLcd_Init(void)
+{
+    memset(s_ddram, ' ', sizeof(s_ddram));
+    SimGpio_AddListener(SIM_GPIO_PORTB, SimLcd_PinChange);
+}
+
+void SimLcd_GetRow(uint8_t row, char *text)
+{
+    uint8_t base = (row == 0U) ? 0U : LINE2_ADDR;
+
+    memcpy(text, &s_ddram[base], SIM_LCD_COLS);
+    text[SIM_LCD_COLS] = '\0';
+}
+
+void SimLcd_GetGlyph(uint8_t code, uint8_t *pattern)
+{
+    memcpy(pattern, &s_cgram[(code & 0x07U) * 8U], 8U);
+}
+
+bool SimLcd_WaitForText(uint8_t row, const char *prefix, uint64_t timeout)
+{
+    SimLcdTextWait wait;
+
+    wait.row = row;
+    wait.prefix = prefix;
+    return Sim_WaitFor(SimLcd_RowStartsWith, &wait, timeout);
+}
+
+void SimLcd_SetByteLog(SimLcdByteFn fn)
+{
+    s_byteLog = fn;
+}
+
+uint32_t SimLcd_DataBytes(void)
+{
+    return s_dataBytes;
+}
+
+uint32_t SimLcd_CommandBytes(void)
+{
+    return s_commandBytes;
+}
+
+uint32_t SimLcd_BusyViolations(void)
+{
+    return s_busyViolations;
+}
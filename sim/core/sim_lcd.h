@@ -0,0 +1,72 @@
+/******************************************************************************
+ * File: sim_lcd.h
+ * Module: SIM LCD Model
+ * Description: HD44780-compatible 16x2 character LCD wired as in lcd.h
+ *              (RS PB0, EN PB1, D4-D7 PB2-PB5)
+ *
+ * Decodes the 4-bit bus on each falling edge of EN, keeps DDRAM/CGRAM, and
+ * counts instructions issued while the controller was still busy with the
+ * previous one (these are silently lost on real hardware).
+ ******************************************************************************/
+
+#ifndef SIM_LCD_H_
+#define SIM_LCD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_LCD_ROWS            2U
+#define SIM_LCD_COLS            16U
+
+#define SIM_LCD_EXEC_CYCLES     SIM_US(37)      /* Most instructions, data write */
+#define SIM_LCD_CLEAR_CYCLES    SIM_US(1520)    /* Clear display, return home */
+#define SIM_LCD_POWERUP_CYCLES  SIM_MS(15)      /* Before the first instruction */
+
+/* Called for every byte the controller latches */
+typedef void (*SimLcdByteFn)(bool isData, uint8_t value, uint64_t cycle);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimLcd_Init
+ * Attaches the controller to port B.
+ */
+void SimLcd_Init(void);
+
+/*
+ * SimLcd_GetRow
+ * Copies the visible characters of a row into text (SIM_LCD_COLS + 1 bytes).
+ */
+void SimLcd_GetRow(uint8_t row, char *text);
+
+/*
+ * SimLcd_GetGlyph
+ * Copies the 8 CGRAM rows shown by a character code below 0x10.
+ */
+void SimLcd_GetGlyph(uint8_t code, uint8_t *pattern);
+
+/*
+ * SimLcd_WaitForText
+ * Scenario side: waits until a row starts with the given text.
+ * Returns: false on timeout
+ */
+bool SimLcd_WaitForText(uint8_t row, const char *prefix, uint64_t timeout);
+
+/*
+ * SimLcd_SetByteLog
+ * Installs a callback for every latched byte (NULL to remove).
+ */
+void SimLcd_SetByteLog(SimLcdByteFn fn);
+
+uint32_t SimLcd_DataBytes(void);
+uint32_t SimLcd_CommandBytes(void);
+uint32_t SimLcd_BusyViolations(void);
+
+#endif /* SIM_LCD_H_ */
@@ -0,0 +1,235 @@
+/******************************************************************************
+ * File: sim_link.c
+ * Module: SIM UART Link
+ * Description: UART5 wire between two simulator processes (HMI and Control)
+ ******************************************************************************/
+
+#include "sim_link.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define LINK_MSG_BYTE       1U      /* A byte started shifting out */
+#define LINK_MSG_SYNC       2U      /* Sender finished the window ending at cycle */
+#define LINK_MSG_QUIT       3U      /* Sender is shutting down */
+
+#define LINK_PENDING_MAX    8U      /* At most ~1 byte starts per window */
+#define LINK_MAX_ARGS       16U
+
+typedef struct {
+    uint64_t cycle;
+    uint32_t kind;
+    uint32_t byte;
+} SimLinkMsg;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static int s_fd = -1;
+static pid_t s_child = -1;
+static bool s_closed;
+static uint64_t s_syncs;
+static SimLinkMsg s_pending[LINK_PENDING_MAX + 1U];
+static uint32_t s_pendingCount;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static bool SimLink_WriteAll(const void *data, size_t length)
+{
+    const uint8_t *p = data;
+
+    while (length > 0U) {
+        ssize_t n = send(s_fd, p, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool SimLink_ReadAll(void *data, size_t length)
+{
+    uint8_t *p = data;
+
+    while (length > 0U) {
+        ssize_t n = read(s_fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+/*
+ * SimLink_Wire
+ * UART wire callback: queue the byte for the end of the window.
+ */
+static void SimLink_Wire(uint8_t byte, uint64_t arrival)
+{
+    if (s_pendingCount == LINK_PENDING_MAX) {
+        fprintf(stderr, "sim: link window overflow at %llu\n", (unsigned long long)Sim_Cycles());
+        exit(2);
+    }
+    s_pending[s_pendingCount].cycle = arrival;
+    s_pending[s_pendingCount].kind = LINK_MSG_BYTE;
+    s_pending[s_pendingCount].byte = byte;
+    s_pendingCount++;
+}
+
+static void SimLink_Shutdown(void)
+{
+    s_closed = true;
+    if (s_fd >= 0) {
+        (void)close(s_fd);
+        s_fd = -1;
+    }
+    Sim_Wake();
+}
+
+/*
+ * SimLink_Barrier
+ * End of a lockstep window: exchange bytes with the peer and wait for it.
+ */
+static void SimLink_Barrier(void *ctx)
+{
+    uint64_t now = Sim_Cycles();
+    SimLinkMsg msg;
+
+    (void)ctx;
+    if (s_closed) {
+        return;
+    }
+
+    s_pending[s_pendingCount].cycle = now;
+    s_pending[s_pendingCount].kind = LINK_MSG_SYNC;
+    s_pending[s_pendingCount].byte = 0U;
+    if (!SimLink_WriteAll(s_pending, (s_pendingCount + 1U) * sizeof(SimLinkMsg))) {
+        SimLink_Shutdown();
+        return;
+    }
+    s_pendingCount = 0U;
+
+    for (;;) {
+        if (!SimLink_ReadAll(&msg, sizeof(msg)) || msg.kind == LINK_MSG_QUIT) {
+            SimLink_Shutdown();
+            return;
+        }
+        if (msg.kind == LINK_MSG_SYNC) {
+            break;
+        }
+        SimUart_Deliver((uint8_t)msg.byte, (msg.cycle > now) ? msg.cycle : now);
+    }
+
+    s_syncs++;
+    Sim_Schedule(now + SIM_LINK_QUANTUM, SimLink_Barrier, NULL);
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+pid_t SimLink_Spawn(const char *path, const char *const *args)
+{
+    const char *argv[LINK_MAX_ARGS + 4U];
+    char fdText[16];
+    int fds[2];
+    size_t argc = 0U;
+    pid_t pid;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        (void)close(fds[0]);
+        (void)close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        (void)close(fds[0]);
+        (void)snprintf(fdText, sizeof(fdText), "%d", fds[1]);
+        argv[argc++] = path;
+        argv[argc++] = SIM_LINK_FD_OPTION;
+        argv[argc++] = fdText;
+        while (args != NULL && *args != NULL && argc < LINK_MAX_ARGS + 3U) {
+            argv[argc++] = *args++;
+        }
+        argv[argc] = NULL;
+        execv(path, (char *const *)argv);
+        fprintf(stderr, "sim: cannot run %s: %s\n", path, strerror(errno));
+        _exit(127);
+    }
+
+    (void)close(fds[1]);
+    s_child = pid;
+    SimLink_Attach(fds[0]);
+    return pid;
+}
+
+void SimLink_Attach(int fd)
+{
+    s_fd = fd;
+    s_closed = false;
+    SimUart_SetWire(SimLink_Wire);
+    Sim_Schedule(SIM_LINK_QUANTUM, SimLink_Barrier, NULL);
+}
+
+bool SimLink_Closed(void *ctx)
+{
+    (void)ctx;
+    return s_closed;
+}
+
+int SimLink_Close(void)
+{
+    SimLinkMsg msg;
+    int status = 0;
+
+    if (s_fd >= 0) {
+        msg.cycle = Sim_Cycles();
+        msg.kind = LINK_MSG_QUIT;
+        msg.byte = 0U;
+        (void)SimLink_WriteAll(&msg, sizeof(msg));
+        (void)close(s_fd);
+        s_fd = -1;
+    }
+    s_closed = true;
+
+    if (s_child > 0) {
+        if (waitpid(s_child, &status, 0) != s_child) {
+            return -1;
+        }
+        s_child = -1;
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+    return 0;
+}
+
+uint64_t SimLink_Syncs(void)
+{
+    return s_syncs;
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+ * File: sim_link.h
+ * Module: SIM UART Link
+ * Description: UART5 wire between two simulator processes (HMI and Control)
+ *
+ * Each ECU runs in its own process with its own clock. The processes run
+ * in lockstep windows of SIM_LINK_QUANTUM cycles: at the end of every
+ * window each side sends the bytes that started shifting out during it,
+ * then waits for the other side to reach the same point. A byte needs a
+ * full byte time on the wire, so anything sent in window k lands in
+ * window k + 1 at the earliest and is never delivered late.
+ ******************************************************************************/
+
+#ifndef SIM_LINK_H_
+#define SIM_LINK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "sim.h"
+#include "sim_uart.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_LINK_QUANTUM        SIM_UART_BYTE_CYCLES
+#define SIM_LINK_FD_OPTION      "--link"
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimLink_Spawn
+ * Starts the peer simulator as "path --link FD [args...]" with one end of
+ * a socket pair and attaches this process to the other end.
+ * Returns: child pid, or -1 on failure
+ */
+pid_t SimLink_Spawn(const char *path, const char *const *args);
+
+/*
+ * SimLink_Attach
+ * Connects this process to the link on fd (the child side of a spawn).
+ * Call after Sim_Init and before Sim_Boot.
+ */
+void SimLink_Attach(int fd);
+
+/*
+ * SimLink_Closed
+ * True once the other side has shut the link down.
+ */
+bool SimLink_Closed(void *ctx);
+
+/*
+ * SimLink_Close
+ * Tells the peer to stop and waits for a spawned child to exit.
+ * Returns: the child's exit status (0 if there is no child)
+ */
+int SimLink_Close(void);
+
+/*
+ * SimLink_Syncs
+ * Number of lockstep windows completed so far.
+ */
+uint64_t SimLink_Syncs(void);
+
+#endif /* SIM_LINK_H_ */
@@ -0,0 +1,211 @@
+/******************************************************************************
+ * File: sim_nvic.c
+ * Module: SIM Interrupt Controller
+ * Description: NVIC vector table, enables, PRIMASK and ISR dispatch
+ ******************************************************************************/
+
+#include "sim_nvic.h"
+#include "sim.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define MAX_SOURCES         16U
+#define ICSR                0xE000ED04U     /* SCB interrupt control and state */
+#define ICSR_PENDSTCLR      0x02000000U
+#define ICSR_PENDSTSET      0x04000000U
+#define ISR_ENTRY_CYCLES    12U     /* Exception entry (stacking) */
+#define ISR_EXIT_CYCLES     10U     /* Exception return (unstacking) */
+
+typedef struct {
+    uint32_t vector;
+    SimIrqLineFn line;              /* NULL for edge-only sources */
+} SimIrqSource;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static SimIsrFn s_handlers[SIM_NVIC_VECTORS];
+static bool s_enabled[SIM_NVIC_VECTORS];
+static bool s_pended[SIM_NVIC_VECTORS];
+static uint32_t s_taken[SIM_NVIC_VECTORS];
+static uint64_t s_cycles[SIM_NVIC_VECTORS];
+static SimIrqSource s_sources[MAX_SOURCES];
+static uint32_t s_sourceCount;
+static bool s_primask;
+static bool s_inHandler;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static SimIrqSource *SimNvic_Source(uint32_t vector)
+{
+    uint32_t i;
+
+    for (i = 0; i < s_sourceCount; i++) {
+        if (s_sources[i].vector == vector) {
+            return &s_sources[i];
+        }
+    }
+    if (s_sourceCount == MAX_SOURCES) {
+        return NULL;
+    }
+    s_sources[s_sourceCount].vector = vector;
+    s_sources[s_sourceCount].line = NULL;
+    return &s_sources[s_sourceCount++];
+}
+
+static bool SimNvic_Asserted(const SimIrqSource *source)
+{
+    return s_pended[source->vector] || (source->line != NULL && source->line());
+}
+
+/*
+ * SimNvic_AccessIcsr
+ * Only the SysTick pending bit is modelled.
+ */
+static void SimNvic_AccessIcsr(uint32_t addr)
+{
+    *Sim_Reg(addr) = s_pended[SIM_VECTOR_SYSTICK] ? ICSR_PENDSTSET : 0U;
+}
+
+static void SimNvic_WriteIcsr(uint32_t addr, uint32_t value)
+{
+    (void)addr;
+    if ((value & ICSR_PENDSTCLR) != 0U) {
+        s_pended[SIM_VECTOR_SYSTICK] = false;
+    }
+    if ((value & ICSR_PENDSTSET) != 0U) {
+        SimNvic_Pend(SIM_VECTOR_SYSTICK);
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimNvic_Init(void)
+{
+    memset(s_handlers, 0, sizeof(s_handlers));
+    memset(s_enabled, 0, sizeof(s_enabled));
+    memset(s_pended, 0, sizeof(s_pended));
+    memset(s_taken, 0, sizeof(s_taken));
+    memset(s_cycles, 0, sizeof(s_cycles));
+    s_sourceCount = 0U;
+    s_primask = false;
+    s_inHandler = false;
+    Sim_MapRegion(ICSR, 4U, SimNvic_AccessIcsr, SimNvic_WriteIcsr);
+}
+
+void SimNvic_Register(uint32_t vector, SimIsrFn handler)
+{
+    if (vector < SIM_NVIC_VECTORS) {
+        s_handlers[vector] = handler;
+    }
+}
+
+void SimNvic_Enable(uint32_t vector, bool enable)
+{
+    if (vector < SIM_NVIC_VECTORS) {
+        s_enabled[vector] = enable;
+        (void)SimNvic_Source(vector);
+    }
+}
+
+bool SimNvic_IsEnabled(uint32_t vector)
+{
+    return vector < SIM_NVIC_VECTORS && s_enabled[vector];
+}
+
+bool SimNvic_SetMasked(bool masked)
+{
+    bool previous = s_primask;
+
+    s_primask = masked;
+    return previous;
+}
+
+void SimNvic_SetLine(uint32_t vector, SimIrqLineFn line)
+{
+    SimIrqSource *source;
+
+    if (vector >= SIM_NVIC_VECTORS) {
+        return;
+    }
+    source = SimNvic_Source(vector);
+    if (source != NULL) {
+        source->line = line;
+    }
+}
+
+void SimNvic_Pend(uint32_t vector)
+{
+    if (vector < SIM_NVIC_VECTORS && SimNvic_Source(vector) != NULL) {
+        s_pended[vector] = true;
+    }
+}
+
+bool SimNvic_Pending(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < s_sourceCount; i++) {
+        if (s_enabled[s_sources[i].vector] && SimNvic_Asserted(&s_sources[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SimNvic_Dispatch(void)
+{
+    bool ran = false;
+    bool again = true;
+    uint32_t i;
+
+    if (s_primask || s_inHandler) {
+        return false;
+    }
+
+    /* Tail-chain until no enabled line is asserted */
+    while (again && !s_primask) {
+        again = false;
+        for (i = 0; i < s_sourceCount; i++) {
+            uint32_t vector = s_sources[i].vector;
+            uint64_t entered;
+
+            if (!s_enabled[vector] || s_handlers[vector] == NULL ||
+                !SimNvic_Asserted(&s_sources[i])) {
+                continue;
+            }
+            s_pended[vector] = false;
+            s_taken[vector]++;
+            s_inHandler = true;
+            entered = Sim_Cycles();
+            Sim_Charge(ISR_ENTRY_CYCLES);
+            s_handlers[vector]();
+            Sim_Charge(ISR_EXIT_CYCLES);
+            s_cycles[vector] += Sim_Cycles() - entered;
+            s_inHandler = false;
+            ran = true;
+            again = true;
+        }
+    }
+    return ran;
+}
+
+uint32_t SimNvic_Taken(uint32_t vector)
+{
+    return (vector < SIM_NVIC_VECTORS) ? s_taken[vector] : 0U;
+}
+
+uint64_t SimNvic_Cycles(uint32_t vector)
+{
+    return (vector < SIM_NVIC_VECTORS) ? s_cycles[vector] : 0U;
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * File: sim_nvic.h
+ * Module: SIM Interrupt Controller
+ * Description: NVIC vector table, enables, PRIMASK and ISR dispatch
+ *
+ * Peripheral models describe each interrupt as a level (a function that
+ * says whether the line is asserted) or pend it as an edge. Pending,
+ * enabled interrupts are taken between firmware register accesses, which
+ * is where the simulated CPU can observe them. Handlers do not nest. Of
+ * the SCB, only the SysTick pending bits of ICSR are modelled.
+ ******************************************************************************/
+
+#ifndef SIM_NVIC_H_
+#define SIM_NVIC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_NVIC_VECTORS        155U
+
+/* Vector numbers (TivaWare hw_ints.h) */
+#define SIM_VECTOR_SYSTICK      15U
+#define SIM_VECTOR_UART5        77U
+
+typedef void (*SimIsrFn)(void);
+
+/* Interrupt line level of a peripheral */
+typedef bool (*SimIrqLineFn)(void);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+void SimNvic_Init(void);
+
+/* Firmware side, used by the TivaWare stubs */
+void SimNvic_Register(uint32_t vector, SimIsrFn handler);
+void SimNvic_Enable(uint32_t vector, bool enable);
+bool SimNvic_IsEnabled(uint32_t vector);
+bool SimNvic_SetMasked(bool masked);     /* Returns the previous PRIMASK */
+
+/*
+ * SimNvic_SetLine
+ * Connects a peripheral's level-sensitive interrupt line to a vector.
+ */
+void SimNvic_SetLine(uint32_t vector, SimIrqLineFn line);
+
+/*
+ * SimNvic_Pend
+ * Edge-triggered request (e.g. the SysTick exception).
+ */
+void SimNvic_Pend(uint32_t vector);
+
+/*
+ * SimNvic_Pending
+ * True if an enabled interrupt is waiting, regardless of PRIMASK (the
+ * condition that wakes the CPU from WFI).
+ */
+bool SimNvic_Pending(void);
+
+/*
+ * SimNvic_Dispatch
+ * Runs every pending, enabled handler. Called by the core between
+ * register accesses.
+ * Returns: true if any handler ran
+ */
+bool SimNvic_Dispatch(void);
+
+/*
+ * SimNvic_Taken
+ * Number of times a vector's handler has been entered.
+ */
+uint32_t SimNvic_Taken(uint32_t vector);
+
+/*
+ * SimNvic_Cycles
+ * Cycles spent in a vector's handler so far, exception entry and return
+ * included.
+ */
+uint64_t SimNvic_Cycles(uint32_t vector);
+
+#endif /* SIM_NVIC_H_ */
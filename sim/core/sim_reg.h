@@ -0,0 +1,25 @@
+/******************************************************************************
+ * File: sim_reg.h
+ * Module: SIM (Host Simulation Core)
+ * Description: Register access hook used by the generated register header
+ *
+ * The build generates tm4c123gh6pm_sim.h from tm4c123gh6pm.h, replacing
+ *     (*((volatile unsigned long *)0x400043FC))
+ * with
+ *     (*SIM_REG(0x400043FC))
+ * and force-includes it ahead of every firmware source. Its include guard
+ * matches the original header, so the drivers' own #include becomes a no-op.
+ * This also fixes the register width on LP64 hosts, where unsigned long is
+ * 64 bits.
+ ******************************************************************************/
+
+#ifndef SIM_REG_H_
+#define SIM_REG_H_
+
+#include <stdint.h>
+
+volatile uint32_t *Sim_RegAccess(uint32_t addr);
+
+#define SIM_REG(addr)   (Sim_RegAccess((uint32_t)(addr)))
+
+#endif /* SIM_REG_H_ */
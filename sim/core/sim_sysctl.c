@@ -0,0 +1,57 @@
+/******************************************************************************
+ * File: sim_sysctl.c
+ * Module: SIM System Control Model
+ * Description: Clock gating (RCGCx) and peripheral-ready (PRx) registers
+ *
+ * Peripherals become ready as soon as their clock is enabled.
+ ******************************************************************************/
+
+#include "sim_sysctl.h"
+#include "sim.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SYSCTL_RCGC_BASE    0x400FE600U     /* RCGCWD .. RCGCWTIMER */
+#define SYSCTL_PR_BASE      0x400FEA00U     /* PRWD .. PRWTIMER */
+#define SYSCTL_PR_SIZE      0x00000060U
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint64_t s_firstSleep = SIM_FOREVER;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static void SimSysCtl_AccessPR(uint32_t addr)
+{
+    *Sim_Reg(addr) = *Sim_Reg(SYSCTL_RCGC_BASE + (addr - SYSCTL_PR_BASE));
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimSysCtl_Init(void)
+{
+    Sim_MapRegion(SYSCTL_PR_BASE, SYSCTL_PR_SIZE, SimSysCtl_AccessPR, NULL);
+    s_firstSleep = SIM_FOREVER;
+}
+
+void SimSysCtl_NoteSleep(void)
+{
+    if (s_firstSleep == SIM_FOREVER) {
+        s_firstSleep = Sim_Cycles();
+    }
+}
+
+uint64_t SimSysCtl_FirstSleep(void)
+{
+    return s_firstSleep;
+}
@@ -0,0 +1,32 @@
+/******************************************************************************
+ * File: sim_sysctl.h
+ * Module: SIM System Control Model
+ * Description: Clock gating (RCGCx) and peripheral-ready (PRx) registers
+ ******************************************************************************/
+
+#ifndef SIM_SYSCTL_H_
+#define SIM_SYSCTL_H_
+
+#include <stdint.h>
+
+/*
+ * SimSysCtl_Init
+ * Attaches the model so every PRx register reads back its RCGCx twin.
+ */
+void SimSysCtl_Init(void);
+
+/*
+ * SimSysCtl_NoteSleep
+ * Called by the SysCtlSleep() stub each time the firmware executes WFI.
+ */
+void SimSysCtl_NoteSleep(void);
+
+/*
+ * SimSysCtl_FirstSleep
+ * Cycle of the first WFI since Sim_Init, or SIM_FOREVER if none yet. For
+ * firmware whose start-up never sleeps, the moment its main loop first
+ * runs out of work: boot-to-ready time.
+ */
+uint64_t SimSysCtl_FirstSleep(void);
+
+#endif /* SIM_SYSCTL_H_ */
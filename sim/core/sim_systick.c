@@ -0,0 +1,128 @@
+/******************************************************************************
+ * File: sim_systick.c
+ * Module: SIM SysTick Model
+ * Description: Cortex-M4 SysTick timer (NVIC_ST_CTRL/RELOAD/CURRENT)
+ *
+ * The counter is not stepped cycle by cycle. Its value is derived from the
+ * clock and the cycle at which it was last reloaded, and one event per wrap
+ * raises the COUNT flag and, with TICKINT set, pends the SysTick exception.
+ * TICKINT doubles as the exception's enable, as on the Cortex-M4.
+ ******************************************************************************/
+
+#include "sim_systick.h"
+#include "sim.h"
+#include "sim_nvic.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define ST_CTRL             0xE000E010U
+#define ST_RELOAD           0xE000E014U
+#define ST_CURRENT          0xE000E018U
+
+#define ST_CTRL_ENABLE      0x00000001U
+#define ST_CTRL_INTEN       0x00000002U
+#define ST_CTRL_CLK_SRC     0x00000004U
+#define ST_CTRL_COUNT       0x00010000U
+#define ST_RELOAD_MASK      0x00FFFFFFU
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_ctrl;
+static uint32_t s_reload;
+static uint64_t s_loadCycle;    /* Cycle at which the counter was last loaded */
+static uint32_t s_generation;   /* Invalidates stale wrap events */
+static uint8_t s_countFlag;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint64_t SimSysTick_Period(void)
+{
+    return (uint64_t)s_reload + 1U;
+}
+
+static void SimSysTick_Wrap(void *ctx);
+
+/*
+ * SimSysTick_Restart
+ * Reloads the counter now and schedules the next wrap.
+ */
+static void SimSysTick_Restart(void)
+{
+    s_generation++;
+    s_loadCycle = Sim_Cycles();
+    if ((s_ctrl & ST_CTRL_ENABLE) != 0U && s_reload != 0U) {
+        Sim_Schedule(s_loadCycle + SimSysTick_Period(), SimSysTick_Wrap,
+                     (void *)(uintptr_t)s_generation);
+    }
+}
+
+/*
+ * SimSysTick_Wrap
+ * Counter reached zero: set COUNT, request the exception and reload.
+ */
+static void SimSysTick_Wrap(void *ctx)
+{
+    if ((uint32_t)(uintptr_t)ctx != s_generation) {
+        return;
+    }
+    s_countFlag = 1U;
+    if ((s_ctrl & ST_CTRL_INTEN) != 0U) {
+        SimNvic_Pend(SIM_VECTOR_SYSTICK);
+    }
+    s_loadCycle = Sim_Cycles();
+    Sim_Schedule(s_loadCycle + SimSysTick_Period(), SimSysTick_Wrap, ctx);
+}
+
+static void SimSysTick_Access(uint32_t addr)
+{
+    if (addr == ST_CTRL) {
+        /* Reading CTRL returns and clears COUNT */
+        *Sim_Reg(ST_CTRL) = s_ctrl | (s_countFlag ? ST_CTRL_COUNT : 0U);
+        s_countFlag = 0U;
+    } else if (addr == ST_CURRENT) {
+        uint32_t current = 0U;
+        if ((s_ctrl & ST_CTRL_ENABLE) != 0U) {
+            current = s_reload - (uint32_t)((Sim_Cycles() - s_loadCycle) % SimSysTick_Period());
+        }
+        *Sim_Reg(ST_CURRENT) = current;
+    } else {
+        /* RELOAD and CALIB read back as written */
+    }
+}
+
+static void SimSysTick_Write(uint32_t addr, uint32_t value)
+{
+    if (addr == ST_CTRL) {
+        uint32_t wasEnabled = s_ctrl & ST_CTRL_ENABLE;
+        s_ctrl = value & (ST_CTRL_ENABLE | ST_CTRL_INTEN | ST_CTRL_CLK_SRC);
+        *Sim_Reg(ST_CTRL) = s_ctrl;
+        SimNvic_Enable(SIM_VECTOR_SYSTICK, (s_ctrl & ST_CTRL_INTEN) != 0U);
+        if (wasEnabled != (s_ctrl & ST_CTRL_ENABLE)) {
+            SimSysTick_Restart();
+        }
+    } else if (addr == ST_RELOAD) {
+        s_reload = value & ST_RELOAD_MASK;
+        *Sim_Reg(ST_RELOAD) = s_reload;
+    } else if (addr == ST_CURRENT) {
+        /* Any write clears the counter and COUNT */
+        s_countFlag = 0U;
+        SimSysTick_Restart();
+    } else {
+        /* CALIB is read-only */
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimSysTick_Init(void)
+{
+    Sim_MapRegion(ST_CTRL, 0x10U, SimSysTick_Access, SimSysTick_Write);
+}
@@ -0,0 +1,18 @@
+/******************************************************************************
+ * File: sim_systick.h
+ * Module: SIM SysTick Model
+ * Description: Cortex-M4 SysTick timer (NVIC_ST_CTRL/RELOAD/CURRENT)
+ ******************************************************************************/
+
+#ifndef SIM_SYSTICK_H_
+#define SIM_SYSTICK_H_
+
+#include <stdint.h>
+
+/*
+ * SimSysTick_Init
+ * Attaches the SysTick model to 0xE000E010-0xE000E01F.
+ */
+void SimSysTick_Init(void);
+
+#endif /* SIM_SYSTICK_H_ */
@@ -0,0 +1,225 @@
+/******************************************************************************
+ * File: sim_timer.c
+ * Module: SIM General-Purpose Timer Model
+ * Description: 16/32-bit GPTM Timer0 to Timer2, Timer A in 32-bit
+ *              one-shot and periodic down-count modes
+ *
+ * Like the SysTick model, the counter is derived from the clock and the
+ * cycle at which it was last loaded, with one event per time-out. A
+ * time-out happens TAILR + 1 cycles after TAEN is set or the counter last
+ * reloaded; it raises RIS.TATORIS and, in one-shot mode, clears TAEN. A
+ * new TAILR takes effect at the next load. With CTL.TAOTE set, each
+ * time-out also triggers the ADC sequencers set to the timer trigger.
+ * Timer B, the 16-bit split modes, count-up, capture and PWM are not
+ * modelled.
+ ******************************************************************************/
+
+#include "sim_timer.h"
+#include "sim.h"
+#include "sim_nvic.h"
+#include "sim_adc.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TIMER0_BASE         0x40030000U
+#define TIMER_STRIDE        0x1000U
+#define TIMER_SIZE          0x100U
+
+#define TIMER_O_CFG         0x000U
+#define TIMER_O_TAMR        0x004U
+#define TIMER_O_CTL         0x00CU
+#define TIMER_O_IMR         0x018U
+#define TIMER_O_RIS         0x01CU
+#define TIMER_O_MIS         0x020U
+#define TIMER_O_ICR         0x024U
+#define TIMER_O_TAILR       0x028U
+#define TIMER_O_TAR         0x048U
+#define TIMER_O_TAV         0x050U
+
+#define TIMER_TAMR_MODE     0x3U
+#define TIMER_TAMR_ONE_SHOT 0x1U
+#define TIMER_CTL_TAEN      0x1U
+#define TIMER_CTL_TAOTE     0x20U       /* ADC trigger on time-out */
+#define TIMER_TATO          0x1U        /* Time-out bit in IMR/RIS/MIS/ICR */
+#define TIMER_INDEX_BITS    2U          /* Timer number in a time-out event */
+#define TIMER_INDEX_MASK    ((1U << TIMER_INDEX_BITS) - 1U)
+
+typedef struct {
+    uint32_t ctl;
+    uint32_t imr;
+    uint32_t ris;
+    uint32_t tailr;
+    uint32_t load;                      /* TAILR in use since the last load */
+    uint64_t loadCycle;
+    uint32_t generation;                /* Invalidates stale time-out events */
+    uint32_t timeouts;
+} SimTimer;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static SimTimer s_timers[SIM_TIMER_COUNT];
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint32_t SimTimer_Base(uint8_t timer)
+{
+    return TIMER0_BASE + ((uint32_t)timer * TIMER_STRIDE);
+}
+
+static uint8_t SimTimer_Index(uint32_t addr)
+{
+    return (uint8_t)((addr - TIMER0_BASE) / TIMER_STRIDE);
+}
+
+static bool SimTimer_OneShot(uint8_t timer)
+{
+    return (*Sim_Reg(SimTimer_Base(timer) + TIMER_O_TAMR) & TIMER_TAMR_MODE) == TIMER_TAMR_ONE_SHOT;
+}
+
+static void SimTimer_Timeout(void *ctx);
+
+/*
+ * SimTimer_Load
+ * Loads the counter from TAILR now and schedules the next time-out.
+ */
+static void SimTimer_Load(uint8_t timer)
+{
+    SimTimer *t = &s_timers[timer];
+
+    t->generation++;
+    t->load = t->tailr;
+    t->loadCycle = Sim_Cycles();
+    if ((t->ctl & TIMER_CTL_TAEN) != 0U) {
+        Sim_Schedule(t->loadCycle + (uint64_t)t->load + 1U, SimTimer_Timeout,
+                     (void *)(uintptr_t)((t->generation << TIMER_INDEX_BITS) | timer));
+    }
+}
+
+/*
+ * SimTimer_Timeout
+ * Counter reached zero: raise the time-out and reload or stop.
+ */
+static void SimTimer_Timeout(void *ctx)
+{
+    uint8_t timer = (uint8_t)((uintptr_t)ctx & TIMER_INDEX_MASK);
+    SimTimer *t = &s_timers[timer];
+
+    if (((uint32_t)(uintptr_t)ctx >> TIMER_INDEX_BITS) !=
+        (t->generation & (0xFFFFFFFFU >> TIMER_INDEX_BITS))) {
+        return;
+    }
+    t->ris |= TIMER_TATO;
+    t->timeouts++;
+    if ((t->ctl & TIMER_CTL_TAOTE) != 0U) {
+        SimAdc_TimerTrigger();
+    }
+    if (SimTimer_OneShot(timer)) {
+        t->ctl &= ~TIMER_CTL_TAEN;
+        t->generation++;
+    } else {
+        SimTimer_Load(timer);
+    }
+}
+
+static bool SimTimer_Line(uint8_t timer)
+{
+    return (s_timers[timer].ris & s_timers[timer].imr) != 0U;
+}
+
+static bool SimTimer_Line0(void)
+{
+    return SimTimer_Line(0U);
+}
+
+static bool SimTimer_Line1(void)
+{
+    return SimTimer_Line(1U);
+}
+
+static bool SimTimer_Line2(void)
+{
+    return SimTimer_Line(2U);
+}
+
+static void SimTimer_Access(uint32_t addr)
+{
+    uint8_t timer = SimTimer_Index(addr);
+    SimTimer *t = &s_timers[timer];
+    uint32_t offset = addr - SimTimer_Base(timer);
+    volatile uint32_t *reg = Sim_Reg(addr);
+
+    if (offset == TIMER_O_CTL) {
+        *reg = t->ctl;
+    } else if (offset == TIMER_O_RIS) {
+        *reg = t->ris;
+    } else if (offset == TIMER_O_MIS) {
+        *reg = t->ris & t->imr;
+    } else if (offset == TIMER_O_ICR) {
+        *reg = 0U;                      /* Write-only: every write is seen */
+    } else if (offset == TIMER_O_TAR || offset == TIMER_O_TAV) {
+        uint64_t elapsed = Sim_Cycles() - t->loadCycle;
+
+        *reg = ((t->ctl & TIMER_CTL_TAEN) != 0U && elapsed <= t->load) ?
+               (uint32_t)(t->load - elapsed) : t->tailr;
+    } else {
+        /* CFG, TAMR, IMR and TAILR read back as written */
+    }
+}
+
+static void SimTimer_Write(uint32_t addr, uint32_t value)
+{
+    uint8_t timer = SimTimer_Index(addr);
+    SimTimer *t = &s_timers[timer];
+    uint32_t offset = addr - SimTimer_Base(timer);
+
+    if (offset == TIMER_O_CTL) {
+        uint32_t wasEnabled = t->ctl & TIMER_CTL_TAEN;
+
+        t->ctl = value;
+        if ((value & TIMER_CTL_TAEN) == 0U) {
+            t->generation++;
+        } else if (wasEnabled == 0U) {
+            SimTimer_Load(timer);
+        }
+    } else if (offset == TIMER_O_IMR) {
+        t->imr = value;
+    } else if (offset == TIMER_O_ICR) {
+        t->ris &= ~value;
+    } else if (offset == TIMER_O_TAILR) {
+        t->tailr = value;
+    } else {
+        /* CFG and TAMR are read from the register file */
+    }
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimTimer_Init(void)
+{
+    uint8_t timer;
+
+    memset(s_timers, 0, sizeof(s_timers));
+    for (timer = 0; timer < SIM_TIMER_COUNT; timer++) {
+        Sim_MapRegion(SimTimer_Base(timer), TIMER_SIZE, SimTimer_Access, SimTimer_Write);
+        s_timers[timer].tailr = 0xFFFFFFFFU;
+    }
+    SimNvic_SetLine(SIM_VECTOR_TIMER0A, SimTimer_Line0);
+    SimNvic_SetLine(SIM_VECTOR_TIMER1A, SimTimer_Line1);
+    SimNvic_SetLine(SIM_VECTOR_TIMER2A, SimTimer_Line2);
+}
+
+uint32_t SimTimer_Timeouts(uint8_t timer)
+{
+    return (timer < SIM_TIMER_COUNT) ? s_timers[timer].timeouts : 0U;
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * File: sim_timer.h
+ * Module: SIM General-Purpose Timer Model
+ * Description: 16/32-bit GPTM Timer0 to Timer2, Timer A in 32-bit
+ *              one-shot and periodic down-count modes
+ ******************************************************************************/
+
+#ifndef SIM_TIMER_H_
+#define SIM_TIMER_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_TIMER_COUNT         3U
+
+/* Vector numbers (TivaWare hw_ints.h) */
+#define SIM_VECTOR_TIMER0A      35U
+#define SIM_VECTOR_TIMER1A      37U
+#define SIM_VECTOR_TIMER2A      39U
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimTimer_Init
+ * Attaches the model to the Timer0 to Timer2 register blocks and their
+ * Timer A interrupt lines.
+ */
+void SimTimer_Init(void);
+
+/*
+ * SimTimer_Timeouts
+ * Number of Timer A time-outs of a timer so far.
+ */
+uint32_t SimTimer_Timeouts(uint8_t timer);
+
+#endif /* SIM_TIMER_H_ */
@@ -0,0 +1,356 @@
+/******************************************************************************
+ * File: sim_uart.c
+ * Module: SIM UART Model
+ * Description: UART5 line model (115200 8N1, 16-byte FIFOs) and a scripted
+ *              peer on the far end of the wire
+ ******************************************************************************/
+
+#include "sim_uart.h"
+#include "sim.h"
+#include "sim_nvic.h"
+#include "sim_udma.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define PEER_LOG_SIZE       1024U
+
+/* Reset value of UARTIFLS: both triggers at half full */
+#define DEFAULT_FIFO_LEVEL  (SIM_UART_FIFO_DEPTH / 2U)
+
+typedef struct {
+    uint8_t data[SIM_UART_FIFO_DEPTH];
+    uint8_t head;
+    uint8_t count;
+} SimFifo;
+
+typedef struct {
+    uint8_t byte;
+    uint64_t arrival;
+} SimPeerByte;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static bool s_enabled;
+static SimFifo s_txFifo;
+static SimFifo s_rxFifo;
+static bool s_txShifting;
+static uint32_t s_rxOverruns;
+static SimUartWireFn s_wire;
+static SimUartWireFn s_rxTrace;
+
+/* Interrupts */
+static uint32_t s_ris;
+static uint32_t s_im;
+static uint32_t s_txLevel = DEFAULT_FIFO_LEVEL;
+static uint32_t s_rxLevel = DEFAULT_FIFO_LEVEL;
+static bool s_txEot;
+static uint32_t s_rxGeneration;
+
+/* uDMA */
+static bool s_dmaTx;
+
+/* Scripted peer */
+static SimPeerByte s_peerLog[PEER_LOG_SIZE];
+static uint32_t s_peerHead;
+static uint32_t s_peerCount;
+static uint64_t s_peerLineFree;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static bool SimFifo_Push(SimFifo *fifo, uint8_t byte)
+{
+    if (fifo->count == SIM_UART_FIFO_DEPTH) {
+        return false;
+    }
+    fifo->data[(fifo->head + fifo->count) % SIM_UART_FIFO_DEPTH] = byte;
+    fifo->count++;
+    return true;
+}
+
+static uint8_t SimFifo_Pop(SimFifo *fifo)
+{
+    uint8_t byte = fifo->data[fifo->head];
+    fifo->head = (uint8_t)((fifo->head + 1U) % SIM_UART_FIFO_DEPTH);
+    fifo->count--;
+    return byte;
+}
+
+static void SimUart_TxDone(void *ctx);
+
+/*
+ * SimUart_DmaTxService
+ * TX DMA request: asserted while the TX FIFO has room. Pulls bytes from
+ * the channel until the FIFO is full or the transfer ends.
+ */
+static void SimUart_DmaTxService(void)
+{
+    uint8_t byte;
+
+    /* One item at a time: pushing may start the shifter, which re-enters */
+    while (s_dmaTx && !SimUart_TxFull() &&
+           SimUdma_Request(SIM_UDMA_UART5_TX, &byte, 1U) == 1U) {
+        SimUart_TxPush(byte);
+    }
+}
+
+/*
+ * SimUart_StartTx
+ * Moves the next byte from the TX FIFO into the shift register.
+ */
+static void SimUart_StartTx(void)
+{
+    uint8_t byte;
+    uint64_t done;
+
+    if (s_txShifting || s_txFifo.count == 0U) {
+        return;
+    }
+    byte = SimFifo_Pop(&s_txFifo);
+    if (!s_txEot && s_txFifo.count == s_txLevel) {
+        s_ris |= SIM_UART_INT_TX;   /* FIFO drained through the trigger level */
+    }
+    done = Sim_Cycles() + SIM_UART_BYTE_CYCLES;
+    s_txShifting = true;
+    s_wire(byte, done);
+    Sim_Schedule(done, SimUart_TxDone, NULL);
+    SimUart_DmaTxService();
+}
+
+static void SimUart_TxDone(void *ctx)
+{
+    (void)ctx;
+    s_txShifting = false;
+    SimUart_StartTx();
+    if (s_txEot && !SimUart_TxBusy()) {
+        s_ris |= SIM_UART_INT_TX;
+    }
+}
+
+/*
+ * SimUart_RxTimeout
+ * No byte arrived for 32 bit periods and the FIFO still holds data.
+ */
+static void SimUart_RxTimeout(void *ctx)
+{
+    if ((uint32_t)(uintptr_t)ctx == s_rxGeneration && s_rxFifo.count > 0U) {
+        s_ris |= SIM_UART_INT_RT;
+    }
+}
+
+static bool SimUart_IrqLine(void)
+{
+    return (s_ris & s_im) != 0U;
+}
+
+/*
+ * SimUart_RxArrive
+ * Stop bit of an incoming byte completed.
+ */
+static void SimUart_RxArrive(void *ctx)
+{
+    uint8_t byte = (uint8_t)(uintptr_t)ctx;
+
+    if (!s_enabled) {
+        return;
+    }
+    if (!SimFifo_Push(&s_rxFifo, byte)) {
+        s_rxOverruns++;
+        s_ris |= SIM_UART_INT_OE;
+    }
+    if (s_rxFifo.count >= s_rxLevel) {
+        s_ris |= SIM_UART_INT_RX;
+    }
+    s_rxGeneration++;
+    Sim_Schedule(Sim_Cycles() + SIM_UART_RT_CYCLES, SimUart_RxTimeout,
+                 (void *)(uintptr_t)s_rxGeneration);
+    if (s_rxTrace != NULL) {
+        s_rxTrace(byte, Sim_Cycles());
+    }
+    Sim_Wake();
+}
+
+static void SimUart_PeerArrive(void *ctx)
+{
+    (void)ctx;
+    Sim_Wake();
+}
+
+/*
+ * SimUart_PeerWire
+ * Default wire: log bytes for the scripted peer.
+ */
+static void SimUart_PeerWire(uint8_t byte, uint64_t arrival)
+{
+    if (s_peerCount < PEER_LOG_SIZE) {
+        SimPeerByte *slot = &s_peerLog[(s_peerHead + s_peerCount) % PEER_LOG_SIZE];
+        slot->byte = byte;
+        slot->arrival = arrival;
+        s_peerCount++;
+    }
+    Sim_Schedule(arrival, SimUart_PeerArrive, NULL);
+}
+
+static bool SimUart_PeerHasByte(void *ctx)
+{
+    (void)ctx;
+    return s_peerCount > 0U && s_peerLog[s_peerHead].arrival <= Sim_Cycles();
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimUart_Init(void)
+{
+    s_wire = SimUart_PeerWire;
+    SimNvic_SetLine(SIM_VECTOR_UART5, SimUart_IrqLine);
+    SimUdma_Attach(SIM_UDMA_UART5_TX, SIM_UDMA_UART5_TX_ENC, SimUart_DmaTxService,
+                   SIM_VECTOR_UART5);
+}
+
+void SimUart_Enable(bool enable)
+{
+    s_enabled = enable;
+    if (enable) {
+        SimUart_StartTx();
+    }
+}
+
+bool SimUart_TxFull(void)
+{
+    return s_txFifo.count == SIM_UART_FIFO_DEPTH;
+}
+
+void SimUart_TxPush(uint8_t byte)
+{
+    (void)SimFifo_Push(&s_txFifo, byte);
+    if (s_txFifo.count > s_txLevel || s_txEot) {
+        s_ris &= ~SIM_UART_INT_TX;
+    }
+    if (s_enabled) {
+        SimUart_StartTx();
+    }
+}
+
+bool SimUart_TxBusy(void)
+{
+    return s_txShifting || s_txFifo.count > 0U;
+}
+
+uint32_t SimUart_RxCount(void)
+{
+    return s_rxFifo.count;
+}
+
+uint8_t SimUart_RxPop(void)
+{
+    uint8_t byte = (s_rxFifo.count > 0U) ? SimFifo_Pop(&s_rxFifo) : 0U;
+
+    if (s_rxFifo.count < s_rxLevel) {
+        s_ris &= ~SIM_UART_INT_RX;
+    }
+    if (s_rxFifo.count == 0U) {
+        s_ris &= ~SIM_UART_INT_RT;
+    }
+    return byte;
+}
+
+void SimUart_SetFifoLevels(uint32_t txBytes, uint32_t rxBytes)
+{
+    s_txLevel = txBytes;
+    s_rxLevel = rxBytes;
+}
+
+void SimUart_SetTxEot(bool eot)
+{
+    s_txEot = eot;
+}
+
+void SimUart_IntEnable(uint32_t flags, bool enable)
+{
+    if (enable) {
+        s_im |= flags;
+    } else {
+        s_im &= ~flags;
+    }
+}
+
+uint32_t SimUart_IntStatus(bool masked)
+{
+    return masked ? (s_ris & s_im) : s_ris;
+}
+
+void SimUart_IntClear(uint32_t flags)
+{
+    s_ris &= ~flags;
+}
+
+void SimUart_DmaEnable(bool tx)
+{
+    s_dmaTx = tx;
+    SimUart_DmaTxService();
+}
+
+void SimUart_SetWire(SimUartWireFn fn)
+{
+    s_wire = (fn != NULL) ? fn : SimUart_PeerWire;
+}
+
+void SimUart_SetRxTrace(SimUartWireFn fn)
+{
+    s_rxTrace = fn;
+}
+
+void SimUart_Deliver(uint8_t byte, uint64_t arrival)
+{
+    Sim_Schedule(arrival, SimUart_RxArrive, (void *)(uintptr_t)byte);
+}
+
+uint32_t SimUart_RxOverruns(void)
+{
+    return s_rxOverruns;
+}
+
+uint64_t SimUart_PeerSend(const uint8_t *data, uint32_t length)
+{
+    uint32_t i;
+
+    if (s_peerLineFree < Sim_Cycles()) {
+        s_peerLineFree = Sim_Cycles();
+    }
+    for (i = 0; i < length; i++) {
+        s_peerLineFree += SIM_UART_BYTE_CYCLES;
+        SimUart_Deliver(data[i], s_peerLineFree);
+    }
+    return s_peerLineFree;
+}
+
+bool SimUart_PeerReceive(uint8_t *byte, uint64_t *arrival, uint64_t timeout)
+{
+    if (!Sim_WaitFor(SimUart_PeerHasByte, NULL, timeout)) {
+        return false;
+    }
+    if (byte != NULL) {
+        *byte = s_peerLog[s_peerHead].byte;
+    }
+    if (arrival != NULL) {
+        *arrival = s_peerLog[s_peerHead].arrival;
+    }
+    s_peerHead = (s_peerHead + 1U) % PEER_LOG_SIZE;
+    s_peerCount--;
+    return true;
+}
+
+void SimUart_PeerFlush(void)
+{
+    s_peerHead = 0U;
+    s_peerCount = 0U;
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+ * File: sim_uart.h
+ * Module: SIM UART Model
+ * Description: UART5 line model (115200 8N1, 16-byte FIFOs) and a scripted
+ *              peer on the far end of the wire
+ *
+ * Each byte occupies the line for 10 bit times (~1389 cycles). The wire
+ * callback is told about a byte when it starts shifting out, together with
+ * the cycle at which its stop bit completes on the receiver.
+ *
+ * RX, RX-timeout, TX (FIFO level or end-of-transmission) and overrun
+ * interrupts drive the UART5 line of the NVIC model. With TX DMA enabled
+ * the FIFO is also fed from uDMA channel 7 (see sim_udma.h).
+ ******************************************************************************/
+
+#ifndef SIM_UART_H_
+#define SIM_UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_UART_BAUD           115200U
+#define SIM_UART_FIFO_DEPTH     16U
+#define SIM_UART_BYTE_CYCLES    ((SIM_CPU_HZ * 10U + (SIM_UART_BAUD / 2U)) / SIM_UART_BAUD)
+
+/* Receive timeout: 32 bit periods without a new byte */
+#define SIM_UART_RT_CYCLES      ((SIM_UART_BYTE_CYCLES * 32U) / 10U)
+
+/* Interrupt flags, same encoding as TivaWare UART_INT_* */
+#define SIM_UART_INT_OE         0x400U
+#define SIM_UART_INT_RT         0x040U
+#define SIM_UART_INT_TX         0x020U
+#define SIM_UART_INT_RX         0x010U
+
+/* Receives every byte the firmware transmits */
+typedef void (*SimUartWireFn)(uint8_t byte, uint64_t arrival);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+void SimUart_Init(void);
+
+/* Firmware side, used by the TivaWare stubs */
+void SimUart_Enable(bool enable);
+bool SimUart_TxFull(void);
+void SimUart_TxPush(uint8_t byte);
+bool SimUart_TxBusy(void);
+uint32_t SimUart_RxCount(void);
+uint8_t SimUart_RxPop(void);
+void SimUart_SetFifoLevels(uint32_t txBytes, uint32_t rxBytes);
+void SimUart_SetTxEot(bool eot);
+void SimUart_IntEnable(uint32_t flags, bool enable);
+uint32_t SimUart_IntStatus(bool masked);
+void SimUart_IntClear(uint32_t flags);
+void SimUart_DmaEnable(bool tx);
+
+/*
+ * SimUart_SetWire
+ * Routes transmitted bytes somewhere other than the scripted peer.
+ */
+void SimUart_SetWire(SimUartWireFn fn);
+
+/*
+ * SimUart_SetRxTrace
+ * Observes every byte as it lands in the receive FIFO.
+ */
+void SimUart_SetRxTrace(SimUartWireFn fn);
+
+/*
+ * SimUart_Deliver
+ * Schedules a byte to land in the receive FIFO at the given cycle.
+ */
+void SimUart_Deliver(uint8_t byte, uint64_t arrival);
+
+/*
+ * SimUart_RxOverruns
+ * Bytes lost because the receive FIFO was full when they arrived (the
+ * hardware overrun error).
+ */
+uint32_t SimUart_RxOverruns(void);
+
+/*
+ * SimUart_PeerSend
+ * Scripted peer transmits bytes back to back at line rate.
+ * Returns: cycle at which the last byte lands in the receive FIFO
+ */
+uint64_t SimUart_PeerSend(const uint8_t *data, uint32_t length);
+
+/*
+ * SimUart_PeerReceive
+ * Waits for the next byte the firmware sent to the scripted peer.
+ * Returns: false on timeout
+ */
+bool SimUart_PeerReceive(uint8_t *byte, uint64_t *arrival, uint64_t timeout);
+
+/*
+ * SimUart_PeerFlush
+ * Discards bytes the scripted peer has received but not read.
+ */
+void SimUart_PeerFlush(void);
+
+#endif /* SIM_UART_H_ */
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * File: sim_udma.c
+ * Module: SIM uDMA Model
+ * Description: Micro DMA controller: channel mapping, basic-mode transfers
+ *              and completion interrupts on the peripheral's vector
+ ******************************************************************************/
+
+#include "sim_udma.h"
+#include "sim_nvic.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define MODE_STOP           0U      /* UDMA_MODE_STOP */
+
+typedef struct {
+    uint32_t encoding;              /* Peripheral currently mapped */
+    uint32_t mode;
+    const uint8_t *src;
+    uint32_t remaining;
+    bool enabled;
+
+    /* Peripheral attached to the request line */
+    uint32_t attachedEncoding;
+    SimUdmaKickFn kick;
+    uint32_t vector;
+} SimUdmaChannel;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static bool s_enabled;
+static void *s_controlBase;
+static SimUdmaChannel s_channels[SIM_UDMA_CHANNELS];
+static uint32_t s_transfers;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * SimUdma_Connected
+ * The channel's request line reaches an attached peripheral only when the
+ * controller is running and the channel is mapped to that peripheral.
+ */
+static bool SimUdma_Connected(const SimUdmaChannel *ch)
+{
+    return s_enabled && s_controlBase != NULL && ch->kick != NULL &&
+           ch->encoding == ch->attachedEncoding;
+}
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+void SimUdma_Init(void)
+{
+    memset(s_channels, 0, sizeof(s_channels));
+    s_enabled = false;
+    s_controlBase = NULL;
+    s_transfers = 0U;
+}
+
+void SimUdma_Enable(bool enable)
+{
+    s_enabled = enable;
+}
+
+void SimUdma_SetControlBase(void *table)
+{
+    s_controlBase = table;
+}
+
+void SimUdma_Assign(uint32_t channel, uint32_t encoding)
+{
+    s_channels[SIM_UDMA_CHANNEL(channel)].encoding = encoding;
+}
+
+void SimUdma_SetTransfer(uint32_t channel, uint32_t mode, const void *src, uint32_t size)
+{
+    SimUdmaChannel *ch = &s_channels[SIM_UDMA_CHANNEL(channel)];
+
+    ch->mode = mode;
+    ch->src = (const uint8_t *)src;
+    ch->remaining = size;
+}
+
+void SimUdma_ChannelEnable(uint32_t channel, bool enable)
+{
+    SimUdmaChannel *ch = &s_channels[SIM_UDMA_CHANNEL(channel)];
+
+    ch->enabled = enable;
+    if (enable && SimUdma_Connected(ch)) {
+        ch->kick();
+    }
+}
+
+bool SimUdma_ChannelIsEnabled(uint32_t channel)
+{
+    return s_channels[SIM_UDMA_CHANNEL(channel)].enabled;
+}
+
+uint32_t SimUdma_ChannelMode(uint32_t channel)
+{
+    return s_channels[SIM_UDMA_CHANNEL(channel)].mode;
+}
+
+uint32_t SimUdma_ChannelSize(uint32_t channel)
+{
+    return s_channels[SIM_UDMA_CHANNEL(channel)].remaining;
+}
+
+void SimUdma_Attach(uint32_t channel, uint32_t encoding, SimUdmaKickFn kick, uint32_t vector)
+{
+    SimUdmaChannel *ch = &s_channels[SIM_UDMA_CHANNEL(channel)];
+
+    ch->attachedEncoding = encoding;
+    ch->kick = kick;
+    ch->vector = vector;
+}
+
+uint32_t SimUdma_Request(uint32_t channel, uint8_t *out, uint32_t max)
+{
+    SimUdmaChannel *ch = &s_channels[SIM_UDMA_CHANNEL(channel)];
+    uint32_t count = 0U;
+
+    if (!ch->enabled || ch->mode == MODE_STOP || !SimUdma_Connected(ch)) {
+        return 0U;
+    }
+    while (count < max && ch->remaining > 0U) {
+        out[count++] = *ch->src++;
+        ch->remaining--;
+    }
+    if (ch->remaining == 0U) {
+        ch->mode = MODE_STOP;
+        ch->enabled = false;
+        s_transfers++;
+        SimNvic_Pend(ch->vector);
+    }
+    return count;
+}
+
+uint32_t SimUdma_Transfers(void)
+{
+    return s_transfers;
+}
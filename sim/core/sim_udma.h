@@ -0,0 +1,76 @@
+/******************************************************************************
+ * File: sim_udma.h
+ * Module: SIM uDMA Model
+ * Description: Micro DMA controller: channel mapping, basic-mode transfers
+ *              and completion interrupts on the peripheral's vector
+ *
+ * Only basic-mode, 8-bit, memory-to-peripheral transfers are modelled,
+ * which is what a UART TX channel uses. A peripheral model attaches to a
+ * channel with a kick function; the controller calls it whenever the
+ * channel becomes ready, and the peripheral pulls bytes with
+ * SimUdma_Request() as its FIFO frees up. When the last item moves the
+ * channel disables itself and the peripheral's vector is pended, as on
+ * the TM4C where uDMA completion for a peripheral channel is signalled on
+ * that peripheral's interrupt.
+ ******************************************************************************/
+
+#ifndef SIM_UDMA_H_
+#define SIM_UDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SIM_UDMA_CHANNELS       32U
+
+/* Channel number of a TivaWare UDMA_CHn_xxx mapping or structure index */
+#define SIM_UDMA_CHANNEL(x)     ((x) & 0x1FU)
+#define SIM_UDMA_ENCODING(x)    (((x) >> 16) & 0xFU)
+
+/* UART5 TX is channel 7, encoding 2 (UDMA_CH7_UART5TX) */
+#define SIM_UDMA_UART5_TX       7U
+#define SIM_UDMA_UART5_TX_ENC   2U
+
+/* Called when a channel may have data for its peripheral */
+typedef void (*SimUdmaKickFn)(void);
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+void SimUdma_Init(void);
+
+/* Firmware side, used by the TivaWare stubs */
+void SimUdma_Enable(bool enable);
+void SimUdma_SetControlBase(void *table);
+void SimUdma_Assign(uint32_t channel, uint32_t encoding);
+void SimUdma_SetTransfer(uint32_t channel, uint32_t mode, const void *src, uint32_t size);
+void SimUdma_ChannelEnable(uint32_t channel, bool enable);
+bool SimUdma_ChannelIsEnabled(uint32_t channel);
+uint32_t SimUdma_ChannelMode(uint32_t channel);
+uint32_t SimUdma_ChannelSize(uint32_t channel);
+
+/*
+ * SimUdma_Attach
+ * Connects a peripheral request line: kick is called whenever the channel
+ * is enabled, and vector is pended when a transfer completes.
+ */
+void SimUdma_Attach(uint32_t channel, uint32_t encoding, SimUdmaKickFn kick, uint32_t vector);
+
+/*
+ * SimUdma_Request
+ * Peripheral side: moves up to max bytes from an enabled channel.
+ * Returns: number of bytes written to out
+ */
+uint32_t SimUdma_Request(uint32_t channel, uint8_t *out, uint32_t max);
+
+/*
+ * SimUdma_Transfers
+ * Number of transfers that ran to completion.
+ */
+uint32_t SimUdma_Transfers(void);
+
+#endif /* SIM_UDMA_H_ */
@@ -0,0 +1,359 @@
+/******************************************************************************
+ * File: control_sim.c
+ * Module: Control_ECU host harness
+ * Description: Runs the Control ECU firmware against a scripted HMI and
+ *              reports the round-trip time of every command
+ *
+ * Usage: control_sim [--eeprom FILE] [--link FD]
+ *   --eeprom FILE   Load the EEPROM image from FILE (if present) before boot
+ *                   and save it on exit.
+ *   --link FD       Run as the Control half of a co-simulation: UART5 is
+ *                   wired to the HMI process on FD instead of the script
+ *                   (see cosim.c).
+ *
+ * The scripted HMI sends each request as one protocol frame at line rate.
+ * Latencies are measured from the moment the last request byte lands in
+ * the Control ECU's receive FIFO. One request is preceded by a frame with
+ * a broken CRC, which the Control ECU must drop without answering.
+ *
+ * While the door is open the script also sends a status query and a
+ * second open-door request under their own request IDs: the Control ECU
+ * must answer both (RESP_STATUS, RESP_BUSY) without waiting for the door
+ * cycle to finish. A later cycle is cut short by an emergency lock.
+ *
+ * Settings changes are answered as soon as the EEPROM write is queued
+ * and confirmed with RESP_STORED (STORED_OK) once it is programmed: the
+ * "first reply" column is the answer, "last reply" the confirmation.
+ *
+ * The script ends with a lockout. Over the first second of its alarm the
+ * harness counts the tone's edges on PF1, checks the 200ms of silence,
+ * and sends a status query mid-tone, which must not wait for the tone.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_uart.h"
+#include "sim_eeprom.h"
+#include "sim_link.h"
+#include "sim_sysctl.h"
+#include "sim_gpio.h"
+#include "sim_nvic.h"
+#include "sim_proto.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TEST_TIMEOUT_SECONDS    5
+#define RESPONSE_TIMEOUT        SIM_MS(30000)
+#define MAX_RESPONSE            16U
+#define MAX_QUERIES             2U
+#define NO_QUERY                0xFFU
+
+/* Lockout alarm: ~4kHz tone for 800ms of every second, from Timer0A */
+#define ALARM_VECTOR            35U     /* INT_TIMER0A */
+#define ALARM_PIN_MASK          0x02U   /* PF1 */
+#define ALARM_TONE              SIM_MS(800)
+#define ALARM_SILENCE_END       SIM_MS(990)
+#define ALARM_MIN_EDGES         6000U   /* 8 edges per ms of tone, less slack */
+#define ALARM_QUERY_AT          SIM_MS(400)
+#define ALARM_QUERY_LIMIT       SIM_MS(2)
+
+/* A request sent while an earlier one is still being answered */
+typedef struct {
+    uint8_t command;
+    uint8_t payload[PROTO_MAX_PAYLOAD];
+    uint8_t payloadLength;
+    uint8_t response;
+} Query;
+
+typedef struct {
+    const char *name;
+    uint8_t command;
+    uint8_t payload[PROTO_MAX_PAYLOAD];
+    uint8_t payloadLength;
+    uint8_t response[MAX_RESPONSE];     /* Expected RESP_* types in order */
+    uint8_t responseLength;
+    bool corruptFirst;                  /* Precede with a bad-CRC copy */
+    uint8_t queryAfter;                 /* Response index, or NO_QUERY */
+    Query queries[MAX_QUERIES];
+} RoundTrip;
+
+extern int Control_Main(void);
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static const RoundTrip s_script[] = {
+    { "CHECK_PASSWORD (blank)", CMD_CHECK_PASSWORD, { 0 }, 0,
+      { RESP_NO_PASSWORD }, 1, false, NO_QUERY, { { 0 } } },
+    { "SETUP_PASSWORD", CMD_SETUP_PASSWORD, { '1', '2', '3', '4', '5', '1', '2', '3', '4', '5' }, 10,
+      { RESP_PASSWORD_MATCH, RESP_STORED }, 2, false, NO_QUERY, { { 0 } } },
+    { "CHECK_PASSWORD", CMD_CHECK_PASSWORD, { 0 }, 0,
+      { RESP_PASSWORD_EXISTS }, 1, false, NO_QUERY, { { 0 } } },
+    { "CHANGE_PASSWORD", CMD_CHANGE_PASSWORD, { '1', '2', '3', '4', '5' }, 5,
+      { RESP_PASSWORD_MATCH }, 1, false, NO_QUERY, { { 0 } } },
+    { "SET_TIMEOUT", CMD_SET_TIMEOUT, { '1', '2', '3', '4', '5', TEST_TIMEOUT_SECONDS }, 6,
+      { RESP_TIMEOUT_SAVED, RESP_STORED }, 2, false, NO_QUERY, { { 0 } } },
+    { "OPEN_DOOR (wrong)", CMD_OPEN_DOOR, { '0', '0', '0', '0', '0' }, 5,
+      { RESP_PASSWORD_MISMATCH }, 1, false, NO_QUERY, { { 0 } } },
+    { "OPEN_DOOR (after bad CRC)", CMD_OPEN_DOOR, { '1', '2', '3', '4', '5' }, 5,
+      { RESP_PASSWORD_MATCH, RESP_DOOR_UNLOCKING, RESP_COUNTDOWN_START,
+        RESP_COUNTDOWN, RESP_COUNTDOWN, RESP_COUNTDOWN, RESP_COUNTDOWN, RESP_COUNTDOWN,
+        RESP_DOOR_LOCKING, RESP_DOOR_LOCKED }, 10, true,
+      4U, { { CMD_GET_STATUS, { 0 }, 0, RESP_STATUS },
+            { CMD_OPEN_DOOR, { '1', '2', '3', '4', '5' }, 5, RESP_BUSY } } },
+    { "OPEN_DOOR (lock now)", CMD_OPEN_DOOR, { '1', '2', '3', '4', '5' }, 5,
+      { RESP_PASSWORD_MATCH, RESP_DOOR_UNLOCKING, RESP_COUNTDOWN_START,
+        RESP_COUNTDOWN, RESP_COUNTDOWN, RESP_DOOR_LOCKING, RESP_DOOR_LOCKED }, 7, false,
+      4U, { { CMD_LOCK_NOW, { 0 }, 0, RESP_DOOR_LOCKING } } },
+    { "ERASE_EEPROM", CMD_ERASE_EEPROM, { '1', '2', '3', '4', '5' }, 5,
+      { RESP_EEPROM_ERASED, RESP_STORED }, 2, false, NO_QUERY, { { 0 } } },
+    { "TRIGGER_LOCKOUT", CMD_TRIGGER_LOCKOUT, { 0 }, 0,
+      { RESP_SYSTEM_LOCKED }, 1, false, NO_QUERY, { { 0 } } },
+};
+
+static uint32_t s_alarmEdges;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static double CyclesToMs(uint64_t cycles)
+{
+    return (double)cycles / (double)SIM_CYCLES_PER_MS;
+}
+
+/*
+ * SendCorrupt
+ * Sends a copy of the request with one CRC bit flipped.
+ */
+static void SendCorrupt(const RoundTrip *step, uint8_t seq)
+{
+    uint8_t frame[PROTO_MAX_FRAME];
+    uint8_t size = Proto_Encode(frame, seq, step->command, step->payload, step->payloadLength);
+
+    frame[size - 1U] ^= 0x01U;
+    (void)SimUart_PeerSend(frame, size);
+}
+
+/*
+ * RunQueries
+ * Sends the step's queries back to back under IDs seq+1, seq+2... and
+ * collects their answers, which must come before the next door message.
+ * Returns: true if every query was answered
+ */
+static bool RunQueries(const RoundTrip *step, uint8_t seq)
+{
+    uint64_t sent[MAX_QUERIES];
+    uint64_t arrival;
+    uint8_t i;
+
+    for (i = 0; i < MAX_QUERIES && step->queries[i].command != 0U; i++) {
+        sent[i] = SimProto_Send((uint8_t)(seq + 1U + i), step->queries[i].command,
+                             step->queries[i].payload, step->queries[i].payloadLength);
+    }
+
+    for (i = 0; i < MAX_QUERIES && step->queries[i].command != 0U; i++) {
+        Proto_Frame frame;
+
+        if (!SimProto_Receive(&frame, &arrival, RESPONSE_TIMEOUT)) {
+            printf("%-26s  query %u unanswered\n", step->name, (unsigned)i);
+            return false;
+        }
+        if (frame.type != step->queries[i].response || frame.seq != (uint8_t)(seq + 1U + i)) {
+            printf("%-26s  query got 0x%02X seq %u, expected 0x%02X seq %u\n", step->name,
+                   frame.type, (unsigned)frame.seq, step->queries[i].response,
+                   (unsigned)(seq + 1U + i));
+            return false;
+        }
+        if (frame.type == RESP_STATUS &&
+            (frame.length != STATUS_LENGTH || frame.payload[STATUS_DOOR_STATE] != DOOR_OPEN ||
+             frame.payload[STATUS_AUTO_LOCK] != TEST_TIMEOUT_SECONDS)) {
+            printf("%-26s  unexpected status\n", step->name);
+            return false;
+        }
+        printf("  mid-cycle request 0x%02X %-10s %12.3f ms\n", step->queries[i].command,
+               "answered", CyclesToMs(arrival - sent[i]));
+    }
+    return true;
+}
+
+/*
+ * RunRoundTrip
+ * Sends one request and checks the full response sequence.
+ * Returns: true if every expected frame arrived in order
+ */
+static bool RunRoundTrip(const RoundTrip *step, uint8_t seq)
+{
+    uint64_t requestDone;
+    uint64_t firstArrival = 0U;
+    uint64_t arrival = 0U;
+    uint8_t i;
+
+    if (step->corruptFirst) {
+        SendCorrupt(step, (uint8_t)(seq - 1U));
+    }
+    requestDone = SimProto_Send(seq, step->command, step->payload, step->payloadLength);
+
+    for (i = 0; i < step->responseLength; i++) {
+        Proto_Frame frame;
+
+        if (!SimProto_Receive(&frame, &arrival, RESPONSE_TIMEOUT)) {
+            printf("%-26s  no response (expected 0x%02X)\n", step->name, step->response[i]);
+            return false;
+        }
+        if (frame.type != step->response[i] || frame.seq != seq) {
+            printf("%-26s  got 0x%02X seq %u, expected 0x%02X seq %u\n", step->name,
+                   frame.type, (unsigned)frame.seq, step->response[i], (unsigned)seq);
+            return false;
+        }
+        if (frame.type == RESP_STORED && (frame.length != 1U || frame.payload[0] != STORED_OK)) {
+            printf("%-26s  not stored\n", step->name);
+            return false;
+        }
+        if (i == 0U) {
+            firstArrival = arrival;
+        }
+        if (i == step->queryAfter && !RunQueries(step, seq)) {
+            return false;
+        }
+    }
+
+    printf("%-26s %7u B %12.3f ms %12.3f ms\n", step->name,
+           (unsigned)(PROTO_HEADER_SIZE + step->payloadLength + PROTO_CRC_SIZE),
+           CyclesToMs(firstArrival - requestDone), CyclesToMs(arrival - requestDone));
+    return true;
+}
+
+/*
+ * OnPortF
+ * GPIO listener: counts buzzer pin edges.
+ */
+static void OnPortF(uint8_t port, uint8_t oldLevels, uint8_t newLevels)
+{
+    (void)port;
+    if (((oldLevels ^ newLevels) & ALARM_PIN_MASK) != 0U) {
+        s_alarmEdges++;
+    }
+}
+
+/*
+ * RunAlarm
+ * Follows the first second of the lockout alarm the script ends with.
+ * Returns: true if the tone played, then went silent, and a status query
+ *          sent mid-tone was answered promptly
+ */
+static bool RunAlarm(uint8_t seq)
+{
+    uint64_t start = Sim_Cycles();
+    uint64_t sent;
+    uint64_t arrival;
+    uint64_t isrCycles = SimNvic_Cycles(ALARM_VECTOR);
+    uint32_t toneEdges;
+    Proto_Frame frame;
+
+    s_alarmEdges = 0U;
+    SimGpio_AddListener(SIM_GPIO_PORTF, OnPortF);
+
+    Sim_WaitUntil(start + ALARM_QUERY_AT);
+    sent = SimProto_Send(seq, CMD_GET_STATUS, NULL, 0U);
+    if (!SimProto_Receive(&frame, &arrival, RESPONSE_TIMEOUT) ||
+        frame.type != RESP_STATUS || frame.seq != seq) {
+        printf("lockout alarm: status query unanswered\n");
+        return false;
+    }
+
+    Sim_WaitUntil(start + ALARM_TONE);
+    toneEdges = s_alarmEdges;
+    isrCycles = SimNvic_Cycles(ALARM_VECTOR) - isrCycles;
+    Sim_WaitUntil(start + ALARM_SILENCE_END);
+
+    printf("lockout alarm: %u tone edges, tone ISR %.1f%% CPU, status answered in %.3f ms\n",
+           (unsigned)toneEdges, 100.0 * (double)isrCycles / (double)ALARM_TONE,
+           CyclesToMs(arrival - sent));
+    if (toneEdges < ALARM_MIN_EDGES) {
+        printf("lockout alarm: tone too short\n");
+        return false;
+    }
+    /* The tone stops at 800ms, give or take the task's latency */
+    if (s_alarmEdges - toneEdges > 8U ||
+        (SimGpio_GetLevels(SIM_GPIO_PORTF) & ALARM_PIN_MASK) != 0U) {
+        printf("lockout alarm: not silent after the tone\n");
+        return false;
+    }
+    if (arrival - sent > ALARM_QUERY_LIMIT) {
+        printf("lockout alarm: status query waited for the tone\n");
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    const char *eepromFile = NULL;
+    int linkFd = -1;
+    bool ok = true;
+    size_t i;
+
+    for (i = 1; i < (size_t)argc; i++) {
+        if (strcmp(argv[i], "--eeprom") == 0 && i + 1U < (size_t)argc) {
+            eepromFile = argv[++i];
+        } else if (strcmp(argv[i], SIM_LINK_FD_OPTION) == 0 && i + 1U < (size_t)argc) {
+            linkFd = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--eeprom FILE] [--link FD]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Sim_Init();
+    if (eepromFile != NULL) {
+        (void)SimEeprom_Load(eepromFile);
+    }
+    if (linkFd >= 0) {
+        SimLink_Attach(linkFd);
+    }
+    Sim_Boot(Control_Main);
+
+    if (linkFd >= 0) {
+        /* Co-simulation: run until the HMI process hangs up */
+        (void)Sim_WaitFor(SimLink_Closed, NULL, SIM_FOREVER);
+        if (eepromFile != NULL) {
+            (void)SimEeprom_Save(eepromFile);
+        }
+        return 0;
+    }
+
+    /* Let the firmware finish initialisation */
+    Sim_WaitUntil(SIM_MS(10));
+
+    printf("Control ECU boot to ready (first WFI): %.3f ms\n",
+           CyclesToMs(SimSysCtl_FirstSleep()));
+    printf("Control ECU command round trip (scripted HMI at %u baud)\n", SIM_UART_BAUD);
+    printf("%-26s %9s %15s %15s\n", "command", "request", "first reply", "last reply");
+    for (i = 0; i < sizeof(s_script) / sizeof(s_script[0]) && ok; i++) {
+        ok = RunRoundTrip(&s_script[i], (uint8_t)(4U * i + 1U));
+    }
+    if (ok) {
+        ok = RunAlarm((uint8_t)(4U * i + 1U));
+    }
+    printf("simulated time %.3f ms, RX overruns %u, bad reply frames %u\n",
+           CyclesToMs(Sim_Cycles()), (unsigned)SimUart_RxOverruns(),
+           (unsigned)SimProto_Errors());
+
+    if (eepromFile != NULL) {
+        (void)SimEeprom_Save(eepromFile);
+    }
+    return ok ? 0 : 1;
+}
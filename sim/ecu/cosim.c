@@ -0,0 +1,271 @@
+/******************************************************************************
+ * File: cosim.c
+ * Module: HMI + Control co-simulation
+ * Description: Runs both ECU firmwares joined by a simulated UART5 wire and
+ *              benchmarks the end-to-end latency of every menu command
+ *
+ * Usage: cosim [--control PATH] [--eeprom FILE]
+ *   --control PATH  control_sim binary to run as the Control ECU
+ *   --eeprom FILE   Control ECU EEPROM image (loaded at boot, saved on exit)
+ *
+ * The HMI firmware runs in this process with a scripted keypad; the Control
+ * firmware runs in a child control_sim process (see sim_link.h). Every
+ * command is timed from the press of the last key the user types (the
+ * HMI acts on the debounced press):
+ *   key->reply   first byte from the Control ECU lands in the HMI FIFO
+ *   key->result  the HMI shows the outcome of the command
+ *   menu->menu   from the menu key until the main menu is back
+ * For HandleOpenDoor the last key is '#' while the door is open, so
+ * key->reply is the round trip of a status query made mid door cycle.
+ * Before the table it prints the time from power-on until the HMI shows
+ * its first prompt (the welcome message and the password check).
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+#include "sim_uart.h"
+#include "sim_link.h"
+#include "sim_lcd.h"
+#include "sim_keypad.h"
+#include "sim_adc.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#ifndef CONTROL_SIM_PATH
+#define CONTROL_SIM_PATH        "control_sim"
+#endif
+
+#define KEY_HOLD                SIM_MS(200)   /* Outlasts one Adjust Timeout loop */
+#define KEY_GAP                 SIM_MS(300)
+#define STEP_TIMEOUT            SIM_MS(30000)
+#define MAX_ENTRIES             3U
+
+/* Potentiometer on AIN0: 820/4095 of full scale maps to 10 s */
+#define POT_CHANNEL             0U
+#define POT_RAW_10_SECONDS      820U
+
+#define MENU_ROW1               "C:Time D:Erase"
+
+/* Wait for a prompt on row 0, then type keys */
+typedef struct {
+    const char *prompt;
+    const char *keys;
+} Entry;
+
+typedef struct {
+    const char *name;
+    char menuKey;                   /* 0: no menu key, continues previous step */
+    Entry entries[MAX_ENTRIES];
+    const char *result;             /* Row 0 once the command completed */
+    bool backToMenu;
+} Step;
+
+extern int HMI_Main(void);
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static const Step s_steps[] = {
+    { "SetupPassword (boot)", 0,
+      { { "Enter Password:", "12345" }, { "Confirm Pass:", "12345" } },
+      "Password Saved!", true },
+    { "HandleOpenDoor", 'A',
+      { { "Enter Password:", "12345" }, { "Door Open", "#" } },
+      "Door Locked", true },
+    { "OpenDoor (menu shortcut)", 0,
+      { { "A:Open B:Pass", "12345" }, { "Door Open", "#" } },
+      "Door Locked", true },
+    { "HandleChangePassword", 'B',
+      { { "Enter Old Pass:", "12345" }, { "Enter Password:", "54321" }, { "Confirm Pass:", "54321" } },
+      "Password Saved!", true },
+    { "HandleSetTimeout", 'C',
+      { { "Adjust Timeout", "*" }, { "Enter Password:", "54321" } },
+      "Timeout Saved!", true },
+    { "HandleEraseEEPROM", 'D',
+      { { "Enter Password:", "54321" } },
+      "EEPROM Erased!", false },
+    { "SetupPassword (erase)", 0,
+      { { "Enter Password:", "12345" }, { "Confirm Pass:", "12345" } },
+      "Password Saved!", true },
+};
+
+static uint64_t s_replyAfter;       /* Record the first byte landing after this */
+static uint64_t s_nextKeyAt;        /* Previous key released plus the gap */
+static uint64_t s_replyAt;
+static uint32_t s_rxBytes;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static double CyclesToMs(uint64_t cycles)
+{
+    return (double)cycles / (double)SIM_CYCLES_PER_MS;
+}
+
+static void OnHmiRx(uint8_t byte, uint64_t cycle)
+{
+    (void)byte;
+    s_rxBytes++;
+    if (s_replyAt == 0U && cycle >= s_replyAfter) {
+        s_replyAt = cycle;
+    }
+}
+
+static void PrintLcd(void)
+{
+    char row[SIM_LCD_COLS + 1U];
+    uint8_t r;
+
+    for (r = 0; r < SIM_LCD_ROWS; r++) {
+        SimLcd_GetRow(r, row);
+        printf("    |%s|\n", row);
+    }
+}
+
+static bool Fail(const char *step, const char *what)
+{
+    printf("FAILED: %s: %s at %.3f ms\n", step, what, CyclesToMs(Sim_Cycles()));
+    PrintLcd();
+    return false;
+}
+
+/*
+ * TypeKeys
+ * Taps each key with a human-like hold time and gap. Returns as soon as
+ * the last key is pressed, since the reply may come back while it is
+ * still held; the next call keeps the gap after its release.
+ * Returns: cycle at which the last key was pressed
+ */
+static uint64_t TypeKeys(const char *keys)
+{
+    uint64_t pressed = Sim_Cycles();
+
+    while (*keys != '\0') {
+        Sim_WaitUntil(s_nextKeyAt);
+        pressed = Sim_Cycles();
+        if (keys[1] == '\0') {
+            s_replyAfter = pressed;
+        }
+        SimKeypad_Tap(*keys++, KEY_HOLD);
+        s_nextKeyAt = pressed + KEY_HOLD + KEY_GAP;
+    }
+    return pressed;
+}
+
+/*
+ * RunStep
+ * Drives one command from the main menu and prints its timings.
+ */
+static bool RunStep(const Step *step)
+{
+    uint64_t start = Sim_Cycles();
+    uint64_t pressed = start;
+    uint64_t resultAt;
+    uint8_t i;
+
+    if (step->menuKey != 0) {
+        pressed = TypeKeys((char[]){ step->menuKey, '\0' });
+    }
+
+    for (i = 0; i < MAX_ENTRIES && step->entries[i].prompt != NULL; i++) {
+        if (!SimLcd_WaitForText(0U, step->entries[i].prompt, STEP_TIMEOUT)) {
+            return Fail(step->name, step->entries[i].prompt);
+        }
+        s_replyAt = 0U;
+        s_replyAfter = SIM_FOREVER;
+        pressed = TypeKeys(step->entries[i].keys);
+    }
+
+    if (!SimLcd_WaitForText(0U, step->result, STEP_TIMEOUT)) {
+        return Fail(step->name, step->result);
+    }
+    resultAt = Sim_Cycles();
+
+    if (step->backToMenu && !SimLcd_WaitForText(1U, MENU_ROW1, STEP_TIMEOUT)) {
+        return Fail(step->name, "main menu");
+    }
+
+    if (s_replyAt != 0U) {
+        printf("%-24s %12.3f", step->name, CyclesToMs(s_replyAt - pressed));
+    } else {
+        printf("%-24s %12s", step->name, "-");
+    }
+    printf(" %12.3f", CyclesToMs(resultAt - pressed));
+    if (step->backToMenu) {
+        printf(" %12.3f\n", CyclesToMs(Sim_Cycles() - start));
+    } else {
+        printf(" %12s\n", "-");
+    }
+    return true;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    const char *controlPath = CONTROL_SIM_PATH;
+    const char *controlArgs[3] = { NULL, NULL, NULL };
+    struct timespec wallStart;
+    struct timespec wallEnd;
+    bool ok = true;
+    int controlStatus;
+    size_t i;
+
+    for (i = 1; i < (size_t)argc; i++) {
+        if (strcmp(argv[i], "--control") == 0 && i + 1U < (size_t)argc) {
+            controlPath = argv[++i];
+        } else if (strcmp(argv[i], "--eeprom") == 0 && i + 1U < (size_t)argc) {
+            controlArgs[0] = "--eeprom";
+            controlArgs[1] = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--control PATH] [--eeprom FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    Sim_Init();
+    if (SimLink_Spawn(controlPath, controlArgs) < 0) {
+        fprintf(stderr, "cosim: cannot start %s\n", controlPath);
+        return 2;
+    }
+    SimUart_SetRxTrace(OnHmiRx);
+    SimAdc_SetInput(POT_CHANNEL, POT_RAW_10_SECONDS);
+    Sim_Boot(HMI_Main);
+
+    printf("HMI <-> Control co-simulation, UART5 at %u baud\n", SIM_UART_BAUD);
+    if (SimLcd_WaitForText(0U, s_steps[0].entries[0].prompt, STEP_TIMEOUT)) {
+        printf("HMI boot to first prompt: %.3f ms\n", CyclesToMs(Sim_Cycles()));
+    }
+    printf("%-24s %12s %12s %12s\n", "command (ms)", "key->reply", "key->result", "menu->menu");
+    for (i = 0; i < sizeof(s_steps) / sizeof(s_steps[0]) && ok; i++) {
+        ok = RunStep(&s_steps[i]);
+    }
+
+    controlStatus = SimLink_Close();
+    (void)clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+
+    printf("simulated %.3f s in %.3f s wall, %llu sync windows, %u bytes to HMI, %u HMI overruns\n",
+           CyclesToMs(Sim_Cycles()) / 1000.0,
+           (double)(wallEnd.tv_sec - wallStart.tv_sec) +
+               ((double)(wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9),
+           (unsigned long long)SimLink_Syncs(), (unsigned)s_rxBytes,
+           (unsigned)SimUart_RxOverruns());
+
+    if (controlStatus != 0) {
+        printf("FAILED: Control ECU exited with status %d\n", controlStatus);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/******************************************************************************
+ * File: hmi_sim.c
+ * Module: HMI_ECU host harness
+ * Description: Runs the HMI firmware with a scripted keypad and a scripted
+ *              Control ECU, and reports user-visible latencies
+ *
+ * Usage: hmi_sim
+ *
+ * Scenario: boot with a stored password, open the menu, select "Open Door",
+ * type a password and get it rejected. Then type it again, get the door
+ * opened, and ask for the status and an emergency lock that the scripted
+ * Control ECU answers only after the door cycle has ended: the late
+ * answers must find their requests closed (Comm_Unmatched()), not
+ * written to the finished screen's stack.
+ *
+ * Last, select "Change Password", get the old password accepted, and back
+ * out of the new-password prompt with the '*'+'#' chord: the HMI must
+ * return to the menu without sending a new password.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_uart.h"
+#include "sim_lcd.h"
+#include "sim_keypad.h"
+#include "sim_proto.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define KEY_HOLD                SIM_MS(60)
+#define KEY_GAP                 SIM_MS(300)
+#define STEP_TIMEOUT            SIM_MS(10000)
+#define LATE_REPLY_WAIT         SIM_MS(50)
+
+extern int HMI_Main(void);
+extern uint32_t Comm_Unmatched(void);
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static double CyclesToMs(uint64_t cycles)
+{
+    return (double)cycles / (double)SIM_CYCLES_PER_MS;
+}
+
+static void PrintLcd(void)
+{
+    char row[SIM_LCD_COLS + 1U];
+    uint8_t r;
+
+    for (r = 0; r < SIM_LCD_ROWS; r++) {
+        SimLcd_GetRow(r, row);
+        printf("    |%s|\n", row);
+    }
+}
+
+static bool Fail(const char *what)
+{
+    printf("FAILED: %s at %.3f ms\n", what, CyclesToMs(Sim_Cycles()));
+    PrintLcd();
+    return false;
+}
+
+/*
+ * TapKey
+ * Presses a key, holds it, and leaves a gap before the next one.
+ * Returns: cycle at which the key was pressed (the firmware acts on the
+ * debounced press, not the release)
+ */
+static uint64_t TapKey(char key)
+{
+    uint64_t pressed = Sim_Cycles();
+
+    SimKeypad_Tap(key, KEY_HOLD);
+    Sim_WaitUntil(pressed + KEY_HOLD + KEY_GAP);
+    return pressed;
+}
+
+/*
+ * RunDoorCycle
+ * Second attempt: the door opens, a status query and an emergency lock
+ * stay unanswered until the door request has finished.
+ */
+static bool RunDoorCycle(void)
+{
+    const uint8_t status[STATUS_LENGTH] = { 0U, 0U, 5U };
+    const uint8_t seconds = 5U;
+    Proto_Frame request;
+    Proto_Frame statusRequest;
+    Proto_Frame lockRequest;
+    uint32_t unmatched;
+    uint8_t doorSeq;
+    uint8_t i;
+
+    if (!SimLcd_WaitForText(0U, "Enter Password:", STEP_TIMEOUT)) {
+        return Fail("second prompt not shown");
+    }
+    for (i = 0; i < PASSWORD_LENGTH; i++) {
+        (void)TapKey((char)('1' + i));
+    }
+    if (!SimProto_Receive(&request, NULL, STEP_TIMEOUT) || request.type != CMD_OPEN_DOOR) {
+        return Fail("second open-door request missing");
+    }
+    doorSeq = request.seq;
+    (void)SimProto_Send(doorSeq, RESP_PASSWORD_MATCH, NULL, 0U);
+    (void)SimProto_Send(doorSeq, RESP_DOOR_UNLOCKING, NULL, 0U);
+    (void)SimProto_Send(doorSeq, RESP_COUNTDOWN_START, NULL, 0U);
+    (void)SimProto_Send(doorSeq, RESP_COUNTDOWN, &seconds, 1U);
+    if (!SimLcd_WaitForText(0U, "Door Open", STEP_TIMEOUT)) {
+        return Fail("open door not shown");
+    }
+
+    /* Both stay unanswered for now */
+    (void)TapKey('#');
+    if (!SimProto_Receive(&statusRequest, NULL, STEP_TIMEOUT) ||
+        statusRequest.type != CMD_GET_STATUS) {
+        return Fail("no status query");
+    }
+    (void)TapKey('*');
+    if (!SimProto_Receive(&lockRequest, NULL, STEP_TIMEOUT) || lockRequest.type != CMD_LOCK_NOW) {
+        return Fail("no emergency lock");
+    }
+
+    (void)SimProto_Send(doorSeq, RESP_DOOR_LOCKING, NULL, 0U);
+    (void)SimProto_Send(doorSeq, RESP_DOOR_LOCKED, NULL, 0U);
+    if (!SimLcd_WaitForText(1U, "C:Time D:Erase", STEP_TIMEOUT)) {
+        return Fail("main menu not shown after the door cycle");
+    }
+
+    /* Late answers to requests of a screen that has returned */
+    unmatched = Comm_Unmatched();
+    (void)SimProto_Send(statusRequest.seq, RESP_STATUS, status, STATUS_LENGTH);
+    (void)SimProto_Send(lockRequest.seq, RESP_DOOR_LOCKING, NULL, 0U);
+    Sim_WaitUntil(Sim_Cycles() + LATE_REPLY_WAIT);
+    printf("%-34s %10u\n", "late replies left unmatched", (unsigned)(Comm_Unmatched() - unmatched));
+    if (Comm_Unmatched() - unmatched != 2U) {
+        return Fail("late replies reached a closed screen's requests");
+    }
+    if (!SimLcd_WaitForText(1U, "C:Time D:Erase", STEP_TIMEOUT)) {
+        return Fail("main menu lost after the late replies");
+    }
+    return true;
+}
+
+/*
+ * RunChangeBackOut
+ * Old password accepted, then the new-password prompt is backed out of.
+ */
+static bool RunChangeBackOut(void)
+{
+    Proto_Frame request;
+    uint64_t pressed;
+    uint8_t i;
+
+    (void)TapKey('B');
+    if (!SimLcd_WaitForText(0U, "Enter Old Pass:", STEP_TIMEOUT)) {
+        return Fail("old password prompt not shown");
+    }
+    for (i = 0; i < PASSWORD_LENGTH; i++) {
+        (void)TapKey((char)('1' + i));
+    }
+    if (!SimProto_Receive(&request, NULL, STEP_TIMEOUT) || request.type != CMD_CHANGE_PASSWORD) {
+        return Fail("change-password request missing");
+    }
+    (void)SimProto_Send(request.seq, RESP_PASSWORD_MATCH, NULL, 0U);
+    if (!SimLcd_WaitForText(0U, "Enter Password:", STEP_TIMEOUT)) {
+        return Fail("new password prompt not shown");
+    }
+
+    /* The '*'+'#' chord */
+    pressed = Sim_Cycles();
+    SimKeypad_Press('*');
+    SimKeypad_Press('#');
+    Sim_WaitUntil(pressed + KEY_HOLD);
+    SimKeypad_Release('#');
+    SimKeypad_Release('*');
+    if (!SimLcd_WaitForText(1U, "C:Time D:Erase", STEP_TIMEOUT)) {
+        return Fail("new password prompt could not be left");
+    }
+    printf("%-34s %10.3f ms\n", "back out of new password -> menu",
+           CyclesToMs(Sim_Cycles() - pressed));
+    if (SimProto_Receive(&request, NULL, LATE_REPLY_WAIT)) {
+        return Fail("request sent after backing out");
+    }
+
+    printf("LCD at %.3f ms:\n", CyclesToMs(Sim_Cycles()));
+    PrintLcd();
+    printf("LCD bytes: %u data, %u command, %u sent while busy\n",
+           (unsigned)SimLcd_DataBytes(), (unsigned)SimLcd_CommandBytes(),
+           (unsigned)SimLcd_BusyViolations());
+    return true;
+}
+
+static bool RunScenario(void)
+{
+    Proto_Frame request;
+    uint64_t arrival;
+    uint64_t mark;
+    uint64_t pressed = 0U;
+    uint8_t i;
+
+    /* Boot: HMI asks whether a password exists */
+    if (!SimProto_Receive(&request, &arrival, STEP_TIMEOUT) || request.type != CMD_CHECK_PASSWORD) {
+        return Fail("no CHECK_PASSWORD at boot");
+    }
+    printf("%-34s %10.3f ms\n", "boot -> CHECK_PASSWORD sent", CyclesToMs(arrival));
+
+    mark = SimProto_Send(request.seq, RESP_PASSWORD_EXISTS, NULL, 0U);
+    if (!SimLcd_WaitForText(1U, "C:Time D:Erase", STEP_TIMEOUT)) {
+        return Fail("main menu not shown");
+    }
+    printf("%-34s %10.3f ms\n", "reply -> main menu", CyclesToMs(Sim_Cycles() - mark));
+    printf("%-34s %10.3f ms\n", "boot -> main menu", CyclesToMs(Sim_Cycles()));
+
+    /* Select Open Door */
+    mark = Sim_Cycles();
+    SimKeypad_Tap('A', KEY_HOLD);
+    if (!SimLcd_WaitForText(0U, "Enter Password:", STEP_TIMEOUT)) {
+        return Fail("password prompt not shown");
+    }
+    printf("%-34s %10.3f ms\n", "key 'A' press -> prompt", CyclesToMs(Sim_Cycles() - mark));
+    Sim_WaitUntil(mark + KEY_HOLD + KEY_GAP);
+
+    /* Type the password */
+    for (i = 0; i < PASSWORD_LENGTH; i++) {
+        pressed = TapKey((char)('1' + i));
+    }
+
+    /* One frame: command plus five digits */
+    if (!SimProto_Receive(&request, &arrival, STEP_TIMEOUT)) {
+        return Fail("open-door request incomplete");
+    }
+    if (request.type != CMD_OPEN_DOOR || request.length != PASSWORD_LENGTH ||
+        memcmp(request.payload, "12345", PASSWORD_LENGTH) != 0) {
+        return Fail("unexpected command");
+    }
+    printf("%-34s %10.3f ms\n", "last key press -> request sent", CyclesToMs(arrival - pressed));
+
+    mark = SimProto_Send(request.seq, RESP_PASSWORD_MISMATCH, NULL, 0U);
+    if (!SimLcd_WaitForText(0U, "Wrong Password!", STEP_TIMEOUT)) {
+        return Fail("rejection not shown");
+    }
+    printf("%-34s %10.3f ms\n", "reply -> \"Wrong Password!\"", CyclesToMs(Sim_Cycles() - mark));
+
+    return RunDoorCycle() && RunChangeBackOut();
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(HMI_Main);
+
+    printf("HMI ECU latencies (scripted keypad and Control ECU)\n");
+    return RunScenario() ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+ * File: sim_proto.c
+ * Module: SIM protocol peer
+ * Description: Scripted far end of the UART5 link speaking the framed
+ *              protocol (Common/protocol.h)
+ ******************************************************************************/
+
+#include "sim_proto.h"
+#include "sim.h"
+#include "sim_uart.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Proto_Parser s_parser;
+static uint64_t s_lastArrival;          /* Of the last byte received */
+
+/******************************************************************************
+ *                          Public Functions                                   *
+ ******************************************************************************/
+
+uint64_t SimProto_Send(uint8_t seq, uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    uint8_t frame[PROTO_MAX_FRAME];
+    uint8_t size = Proto_Encode(frame, seq, type, payload, length);
+
+    return SimUart_PeerSend(frame, size);
+}
+
+bool SimProto_Receive(Proto_Frame *frame, uint64_t *arrival, uint64_t timeout)
+{
+    uint64_t deadline = (timeout == SIM_FOREVER) ? SIM_FOREVER : Sim_Cycles() + timeout;
+    uint8_t byte;
+
+    /* A resync may have left a complete frame behind the last one */
+    if (Proto_ParsePending(&s_parser)) {
+        *frame = s_parser.frame;
+        if (arrival != NULL) {
+            *arrival = s_lastArrival;
+        }
+        return true;
+    }
+
+    for (;;) {
+        uint64_t now = Sim_Cycles();
+        uint64_t left = (deadline == SIM_FOREVER) ? SIM_FOREVER :
+                        (now < deadline) ? deadline - now : 0U;
+
+        if (!SimUart_PeerReceive(&byte, &s_lastArrival, left)) {
+            return false;
+        }
+        if (Proto_Parse(&s_parser, byte)) {
+            *frame = s_parser.frame;
+            if (arrival != NULL) {
+                *arrival = s_lastArrival;
+            }
+            return true;
+        }
+    }
+}
+
+uint32_t SimProto_Errors(void)
+{
+    return s_parser.errors;
+}
@@ -0,0 +1,40 @@
+/******************************************************************************
+ * File: sim_proto.h
+ * Module: SIM protocol peer
+ * Description: Scripted far end of the UART5 link speaking the framed
+ *              protocol (Common/protocol.h)
+ ******************************************************************************/
+
+#ifndef SIM_PROTO_H_
+#define SIM_PROTO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "protocol.h"
+
+/******************************************************************************
+ *                          Function Prototypes                                *
+ ******************************************************************************/
+
+/*
+ * SimProto_Send
+ * The scripted peer sends one frame at line rate.
+ * Returns: cycle at which its last byte lands in the firmware's RX FIFO
+ */
+uint64_t SimProto_Send(uint8_t seq, uint8_t type, const uint8_t *payload, uint8_t length);
+
+/*
+ * SimProto_Receive
+ * Waits for the next valid frame the firmware sent to the scripted peer.
+ * arrival (may be NULL) receives the cycle its last byte landed.
+ * Returns: false on timeout
+ */
+bool SimProto_Receive(Proto_Frame *frame, uint64_t *arrival, uint64_t timeout);
+
+/*
+ * SimProto_Errors
+ * Frames from the firmware dropped for a bad length or CRC.
+ */
+uint32_t SimProto_Errors(void);
+
+#endif /* SIM_PROTO_H_ */
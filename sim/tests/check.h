@@ -0,0 +1,29 @@
+/******************************************************************************
+ * File: check.h
+ * Module: Host tests
+ * Description: Failure counter and CHECK macro shared by the host tests
+ *
+ * Each test is a single source file that includes this header once. A
+ * failed CHECK prints its location and message and counts the failure;
+ * the test keeps running, and main() returns 1 if s_failures is non-zero.
+ ******************************************************************************/
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+static uint32_t s_failures;
+
+#define CHECK(cond, ...)                                        \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            s_failures++;                                       \
+        }                                                       \
+    } while (0)
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,351 @@
+/******************************************************************************
+ * File: config_test.c
+ * Module: Config store host test
+ * Description: RAM-cached settings written back to EEPROM in one burst
+ *
+ * Checks:
+ *   1. A blank EEPROM loads as no password and the default timeout.
+ *      Settings saved by earlier firmware in block 0 load as they were
+ *      saved and are moved into the record log without touching the old
+ *      words; a reboot then finds them in the log.
+ *   2. Setting a password appends one record (one slot) in about the
+ *      EEPROM program time, with no fixed sleeps.
+ *   3. A timeout change appends one record. Setting values the store
+ *      already has marks nothing dirty and a flush then writes nothing.
+ *   4. A password and a timeout changed together go out in one flush as
+ *      one record, each word programmed once.
+ *   5. Reads after boot cost no EEPROM access and no time.
+ *   6. A reload (reboot) sees what was flushed; an erase resets to blank.
+ *   7. A record logged before the schema version byte, or by a newer
+ *      version, loads with its settings and without a write; the next
+ *      flush logs the current version. Loading takes well under 1 ms.
+ *   8. A flush whose record fails to program leaves the settings dirty,
+ *      waited for or not; the next flush logs them and a reboot finds
+ *      them. An erase that fails still leaves no password in RAM, dirty,
+ *      and the next flush makes a reboot find none either.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_eeprom.h"
+#include "systick.h"
+#include "eeprom.h"
+#include "config.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define LEGACY_WORDS        4U          /* Block 0 words 0-3 */
+#define SLOT_WORDS          EEPROM_LOG_SLOT_WORDS
+#define OLD_SLEEPS_MS       130U        /* DelayMs() the old save path used */
+#define MAX_FLUSH_CYCLES    SIM_MS(1)
+#define MAX_LOAD_CYCLES     SIM_MS(1)
+#define VERSION_SHIFT       16U         /* Settings record word 1 */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_counts[EEPROM_TOTAL_SIZE / EEPROM_WORD_SIZE];
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * Programmed
+ * Number of EEPROM words programmed since the last call; none twice.
+ */
+static uint32_t Programmed(void)
+{
+    uint32_t words = 0U;
+    uint32_t i;
+
+    for (i = 0; i < (EEPROM_TOTAL_SIZE / EEPROM_WORD_SIZE); i++) {
+        uint32_t count = SimEeprom_WriteCount(i);
+
+        if (count != s_counts[i]) {
+            CHECK(count == s_counts[i] + 1U, "word %u programmed %u times", (unsigned)i,
+                  (unsigned)(count - s_counts[i]));
+            words++;
+        }
+        s_counts[i] = count;
+    }
+    return words;
+}
+
+/*
+ * LegacyUntouched
+ * True if block 0 words 0-3 were not programmed since the last
+ * Programmed() call.
+ */
+static bool LegacyUntouched(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < LEGACY_WORDS; i++) {
+        if (SimEeprom_WriteCount(i) != s_counts[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestLoad(void)
+{
+    Config_Load();
+    CHECK(!Config_HasPassword() && Config_GetPassword()[0] == '\0', "blank EEPROM has a password");
+    CHECK(Config_GetTimeout() == CONFIG_TIMEOUT_DEFAULT, "blank timeout %u",
+          (unsigned)Config_GetTimeout());
+    CHECK(!Config_IsDirty(), "dirty after load");
+
+    /* As SavePassword("24680")/SaveTimeout(12) left it */
+    SimEeprom_Program(0U, ((uint32_t)'2' << 24) | ((uint32_t)'4' << 16) |
+                          ((uint32_t)'6' << 8) | (uint32_t)'8');
+    SimEeprom_Program(1U, (uint32_t)'0' << 24);
+    SimEeprom_Program(2U, 12U);
+    SimEeprom_Program(3U, CONFIG_VALID_MARKER);
+    (void)Programmed();
+    Config_Load();
+    CHECK(Config_HasPassword() && strcmp(Config_GetPassword(), "24680") == 0,
+          "old image loaded as \"%s\"", Config_GetPassword());
+    CHECK(Config_GetTimeout() == 12U, "old image timeout %u", (unsigned)Config_GetTimeout());
+    CHECK(!Config_IsDirty(), "old image not logged");
+    CHECK(LegacyUntouched(), "old image overwritten while moving it");
+    CHECK(Programmed() == SLOT_WORDS, "old image not logged as one record");
+
+    Config_Load();
+    CHECK(Config_HasPassword() && strcmp(Config_GetPassword(), "24680") == 0 &&
+          Config_GetTimeout() == 12U, "reboot lost the moved settings");
+    CHECK(Programmed() == 0U, "reboot wrote");
+
+    SimEeprom_Erase();
+    Config_Load();
+    (void)Programmed();
+}
+
+static void TestSetPassword(void)
+{
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t written;
+
+    Config_SetPassword("13579");
+    CHECK(Config_IsDirty(), "new password not dirty");
+    start = Sim_Cycles();
+    CHECK(Config_Flush() == EEPROM_SUCCESS, "flush failed");
+    cycles = Sim_Cycles() - start;
+    written = Programmed();
+
+    printf("password save: %.3f ms (old path slept %u ms)\n",
+           (double)cycles / SIM_CYCLES_PER_MS, (unsigned)OLD_SLEEPS_MS);
+    CHECK(written == SLOT_WORDS, "programmed %u words", (unsigned)written);
+    CHECK(cycles >= SLOT_WORDS * SIM_EEPROM_PROGRAM_CYCLES && cycles < MAX_FLUSH_CYCLES,
+          "flush took %u cycles", (unsigned)cycles);
+    CHECK(!Config_IsDirty(), "dirty after flush");
+}
+
+static void TestNoChange(void)
+{
+    Config_SetTimeout(20U);
+    CHECK(Config_Flush() == EEPROM_SUCCESS, "flush failed");
+    CHECK(Programmed() == SLOT_WORDS, "timeout change not one record");
+
+    Config_SetPassword("13579");
+    Config_SetTimeout(20U);
+    CHECK(!Config_IsDirty(), "unchanged values marked dirty");
+    CHECK(Config_Flush() == EEPROM_SUCCESS && Programmed() == 0U, "clean flush wrote");
+}
+
+static void TestCoalesce(void)
+{
+    Config_SetPassword("11111");
+    Config_SetTimeout(25U);
+    Config_SetPassword("22222");
+    Config_SetTimeout(30U);
+    CHECK(Config_Flush() == EEPROM_SUCCESS, "flush failed");
+    CHECK(Programmed() == SLOT_WORDS, "coalesced flush not one record");
+}
+
+static void TestReads(void)
+{
+    uint64_t start = Sim_Cycles();
+    bool has = Config_HasPassword();
+    uint8_t timeout = Config_GetTimeout();
+    const char *password = Config_GetPassword();
+
+    CHECK(Sim_Cycles() == start, "reads took %u cycles", (unsigned)(Sim_Cycles() - start));
+    CHECK(has && timeout == 30U && strcmp(password, "22222") == 0, "read back %d %u \"%s\"",
+          (int)has, (unsigned)timeout, password);
+}
+
+static void OnFlushed(uint8_t result, void *context)
+{
+    *(uint8_t *)context = result;
+}
+
+static void TestFailedFlush(void)
+{
+    uint8_t result = EEPROM_SUCCESS;
+
+    Config_SetTimeout(9U);
+    SimEeprom_FailAfter(0U);
+    CHECK(Config_Flush() == EEPROM_ERROR, "failed flush reported success");
+    CHECK(Config_IsDirty(), "failed flush left the settings clean");
+    SimEeprom_StopFailing();
+    CHECK(Config_Flush() == EEPROM_SUCCESS && !Config_IsDirty(), "retry failed");
+    (void)Programmed();
+
+    /* Only the CRC word fails, after the caller has moved on */
+    Config_SetTimeout(10U);
+    SimEeprom_FailAfter(SLOT_WORDS - 1U);
+    CHECK(Config_FlushAsync(OnFlushed, &result) == EEPROM_SUCCESS, "flush not queued");
+    CHECK(Config_IsDirty(), "clean before the record was programmed");
+    (void)EEPROM_Sync();
+    SimEeprom_StopFailing();
+    CHECK(result == EEPROM_ERROR, "failed write reported success");
+    CHECK(Config_IsDirty(), "failed write left the settings clean");
+    CHECK(Config_Flush() == EEPROM_SUCCESS && !Config_IsDirty(), "retry failed");
+
+    Config_Load();
+    CHECK(Config_GetTimeout() == 10U, "reboot found timeout %u", (unsigned)Config_GetTimeout());
+
+    SimEeprom_FailAfter(0U);
+    CHECK(Config_Erase() == EEPROM_ERROR, "failed erase reported success");
+    SimEeprom_StopFailing();
+    CHECK(!Config_HasPassword() && Config_IsDirty(), "failed erase left %s settings",
+          Config_HasPassword() ? "a password in the" : "clean");
+    CHECK(Config_Flush() == EEPROM_SUCCESS && !Config_IsDirty(), "retry failed");
+    Config_Load();
+    CHECK(!Config_HasPassword() && Config_GetTimeout() == CONFIG_TIMEOUT_DEFAULT,
+          "reboot after a failed erase found \"%s\" %u", Config_GetPassword(),
+          (unsigned)Config_GetTimeout());
+
+    Config_SetPassword("22222");
+    Config_SetTimeout(30U);
+    CHECK(Config_Flush() == EEPROM_SUCCESS, "flush failed");
+    (void)Programmed();
+}
+
+static void TestReloadAndErase(void)
+{
+    Config_Load();
+    CHECK(Config_HasPassword() && strcmp(Config_GetPassword(), "22222") == 0,
+          "reloaded \"%s\"", Config_GetPassword());
+    CHECK(Config_GetTimeout() == 30U, "reloaded timeout %u", (unsigned)Config_GetTimeout());
+
+    CHECK(Config_Erase() == EEPROM_SUCCESS, "erase failed");
+    CHECK(!Config_HasPassword() && Config_GetTimeout() == CONFIG_TIMEOUT_DEFAULT,
+          "settings survived the erase");
+    Config_Load();
+    CHECK(!Config_HasPassword() && Config_GetTimeout() == CONFIG_TIMEOUT_DEFAULT,
+          "erased EEPROM reloaded with settings");
+}
+
+/*
+ * LoadRecord
+ * Logs a settings record as other firmware would have, then reboots.
+ * Returns: cycles Config_Load() took
+ */
+static uint64_t LoadRecord(uint32_t password, uint32_t settings)
+{
+    uint32_t record[2];
+    uint64_t start;
+
+    record[0] = password;
+    record[1] = settings;
+    CHECK(EEPROM_LogPut(CONFIG_KEY_SETTINGS, record, 2U) == EEPROM_SUCCESS, "log put failed");
+    (void)Programmed();
+
+    start = Sim_Cycles();
+    Config_Load();
+    return Sim_Cycles() - start;
+}
+
+static void TestSchema(void)
+{
+    const uint32_t password = ((uint32_t)'9' << 24) | ((uint32_t)'7' << 16) |
+                              ((uint32_t)'5' << 8) | (uint32_t)'3';
+    const uint32_t flags = (uint32_t)CONFIG_FLAG_PASSWORD << 8;
+    uint32_t record[2];
+    uint64_t cycles;
+
+    (void)Programmed();                 /* The erase before */
+
+    /* Version 0: the version byte is zero */
+    cycles = LoadRecord(password, ((uint32_t)'1' << 24) | flags | 17U);
+    printf("boot load: %.3f ms\n", (double)cycles / SIM_CYCLES_PER_MS);
+    CHECK(cycles < MAX_LOAD_CYCLES, "load took %u cycles", (unsigned)cycles);
+    CHECK(Config_HasPassword() && strcmp(Config_GetPassword(), "97531") == 0 &&
+          Config_GetTimeout() == 17U, "version 0 loaded as %d \"%s\" %u",
+          (int)Config_HasPassword(), Config_GetPassword(), (unsigned)Config_GetTimeout());
+    CHECK(!Config_IsDirty() && Programmed() == 0U, "version 0 rewritten at boot");
+
+    Config_SetTimeout(18U);
+    CHECK(Config_Flush() == EEPROM_SUCCESS, "flush failed");
+    CHECK(EEPROM_LogGet(CONFIG_KEY_SETTINGS, record, 2U) == 2U &&
+          ((record[1] >> VERSION_SHIFT) & 0xFFU) == CONFIG_RECORD_VERSION,
+          "flush logged version %u", (unsigned)((record[1] >> VERSION_SHIFT) & 0xFFU));
+
+    /* A later version keeps the fields this one knows */
+    (void)LoadRecord(password, ((uint32_t)'1' << 24) |
+                               ((uint32_t)(CONFIG_RECORD_VERSION + 1U) << VERSION_SHIFT) |
+                               flags | 22U);
+    CHECK(Config_HasPassword() && strcmp(Config_GetPassword(), "97531") == 0 &&
+          Config_GetTimeout() == 22U, "newer version loaded as \"%s\" %u",
+          Config_GetPassword(), (unsigned)Config_GetTimeout());
+
+    CHECK(Config_Erase() == EEPROM_SUCCESS, "erase failed");
+}
+
+static int ConfigApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    EEPROM_Init();
+
+    TestLoad();
+    TestSetPassword();
+    TestNoChange();
+    TestCoalesce();
+    TestReads();
+    TestFailedFlush();
+    TestReloadAndErase();
+    TestSchema();
+
+    s_done = true;
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(ConfigApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(10000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,282 @@
+/******************************************************************************
+ * File: door_test.c
+ * Module: Door state machine host test
+ * Description: Door cycle timing and motor pin levels in virtual time
+ *
+ * A stand-in Control main loop runs Door_Update() from the 1 ms SysTick
+ * interrupt timebase while the harness requests door cycles and samples
+ * the state and the motor pins (PF0 = IN1, PF4 = IN2). Checks:
+ *   1. A full cycle passes UNLOCKING -> OPEN -> LOCKING -> LOCKED at the
+ *      expected times, with the motor driven CW, stopped, CCW, stopped.
+ *   2. The countdown is reported once per second, from the timeout down
+ *      to 1, and the cycle does not drift over its length.
+ *   3. A second open request is refused while a cycle is running.
+ *   4. An emergency lock while open starts locking at once; while
+ *      unlocking it drives back only as long as the unlock ran.
+ *   5. The main loop never stalls: the longest gap between two passes is
+ *      about one tick.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_gpio.h"
+#include "systick.h"
+#include "motor.h"
+#include "door.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define AUTO_LOCK_SECONDS   3U
+#define MOTOR_PINS          0x11U       /* PF0 (IN1) and PF4 (IN2) */
+#define MOTOR_CW            0x01U
+#define MOTOR_CCW           0x10U
+#define MOTOR_STOPPED       0x00U
+#define TOLERANCE_MS        1U          /* Transitions are due on whole ticks */
+#define MAX_EVENTS          32U
+#define MAX_LOOP_GAP        SIM_MS(2)
+
+typedef enum {
+    REQUEST_NONE,
+    REQUEST_OPEN,
+    REQUEST_LOCK
+} Request;
+
+typedef struct {
+    Door_Event event;
+    uint8_t secondsLeft;
+    uint64_t cycle;
+} LoggedEvent;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/* Harness -> firmware */
+static volatile Request s_request;
+
+/* Firmware -> harness */
+static volatile bool s_accepted;
+static uint64_t s_handledAt;
+static LoggedEvent s_events[MAX_EVENTS];
+static uint32_t s_eventCount;
+static uint64_t s_lastLoop;
+static uint64_t s_maxLoopGap;
+
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static void OnDoorEvent(Door_Event event, uint8_t secondsLeft)
+{
+    if (s_eventCount < MAX_EVENTS) {
+        s_events[s_eventCount].event = event;
+        s_events[s_eventCount].secondsLeft = secondsLeft;
+        s_events[s_eventCount].cycle = Sim_Cycles();
+        s_eventCount++;
+    }
+}
+
+/*
+ * DoorApp_Main
+ * Firmware side: the Control ECU main loop without the UART.
+ */
+static int DoorApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    Motor_Init();
+    Door_Init(OnDoorEvent);
+
+    for (;;) {
+        uint64_t now = Sim_Cycles();
+
+        if (s_lastLoop != 0U && now - s_lastLoop > s_maxLoopGap) {
+            s_maxLoopGap = now - s_lastLoop;
+        }
+        s_lastLoop = now;
+
+        if (s_request == REQUEST_OPEN) {
+            s_accepted = Door_Open(AUTO_LOCK_SECONDS, (uint32_t)Time_NowMs());
+        } else if (s_request == REQUEST_LOCK) {
+            s_accepted = Door_Lock((uint32_t)Time_NowMs());
+        }
+        if (s_request != REQUEST_NONE) {
+            s_handledAt = now;
+        }
+        s_request = REQUEST_NONE;
+
+        Door_Update((uint32_t)Time_NowMs());
+        DelayMs(1);
+    }
+    return 0;
+}
+
+static uint8_t MotorPins(void)
+{
+    return SimGpio_GetOutputs(SIM_GPIO_PORTF) & MOTOR_PINS;
+}
+
+/*
+ * Post
+ * Hands a request to the firmware loop and waits until it was taken.
+ * Returns: cycle at which the firmware handled it
+ */
+static uint64_t Post(Request request)
+{
+    s_request = request;
+    while (s_request != REQUEST_NONE) {
+        Sim_WaitUntil(Sim_Cycles() + SIM_MS(1) / 4U);
+    }
+    return s_handledAt;
+}
+
+/*
+ * ExpectAt
+ * Checks state and motor pins at start + ms.
+ */
+static void ExpectAt(uint64_t start, uint32_t ms, uint8_t state, uint8_t pins)
+{
+    Sim_WaitUntil(start + SIM_MS(ms));
+    CHECK(Door_GetState() == state, "t=%u ms: state %u, expected %u",
+          (unsigned)ms, (unsigned)Door_GetState(), (unsigned)state);
+    CHECK(MotorPins() == pins, "t=%u ms: motor pins 0x%02X, expected 0x%02X",
+          (unsigned)ms, MotorPins(), pins);
+}
+
+/*
+ * ExpectEvent
+ * Checks logged event i against its nominal time after start.
+ */
+static void ExpectEvent(uint32_t i, uint64_t start, Door_Event event,
+                        uint8_t secondsLeft, uint32_t ms)
+{
+    double at;
+
+    if (i >= s_eventCount) {
+        CHECK(false, "event %u missing (expected %u)", (unsigned)i, (unsigned)event);
+        return;
+    }
+    at = (double)(s_events[i].cycle - start) / (double)SIM_CYCLES_PER_MS;
+    CHECK(s_events[i].event == event, "event %u is %u, expected %u",
+          (unsigned)i, (unsigned)s_events[i].event, (unsigned)event);
+    if (event == DOOR_EVENT_COUNTDOWN) {
+        CHECK(s_events[i].secondsLeft == secondsLeft, "event %u: %u s left, expected %u",
+              (unsigned)i, (unsigned)s_events[i].secondsLeft, (unsigned)secondsLeft);
+    }
+    CHECK(at >= (double)ms - TOLERANCE_MS && at <= (double)(ms + TOLERANCE_MS),
+          "event %u at %.3f ms, expected %u ms", (unsigned)i, at, (unsigned)ms);
+}
+
+static void TestFullCycle(void)
+{
+    const uint32_t open = DOOR_MOTOR_MS;
+    const uint32_t locking = open + AUTO_LOCK_SECONDS * DOOR_TICK_MS;
+    const uint32_t locked = locking + DOOR_MOTOR_MS;
+    uint64_t start;
+
+    s_eventCount = 0U;
+    start = Post(REQUEST_OPEN);
+    CHECK(s_accepted, "open refused while locked");
+
+    ExpectAt(start, open / 2U, DOOR_UNLOCKING, MOTOR_CW);
+    CHECK(Post(REQUEST_OPEN) != 0U && !s_accepted, "second open accepted mid cycle");
+    ExpectAt(start, open + DOOR_TICK_MS / 2U, DOOR_OPEN, MOTOR_STOPPED);
+    CHECK(Door_GetSecondsLeft() == AUTO_LOCK_SECONDS, "%u s left after opening",
+          (unsigned)Door_GetSecondsLeft());
+    ExpectAt(start, locking + DOOR_MOTOR_MS / 2U, DOOR_LOCKING, MOTOR_CCW);
+    ExpectAt(start, locked + DOOR_TICK_MS / 2U, DOOR_LOCKED, MOTOR_STOPPED);
+
+    ExpectEvent(0U, start, DOOR_EVENT_UNLOCKING, 0U, 0U);
+    ExpectEvent(1U, start, DOOR_EVENT_OPEN, 0U, open);
+    ExpectEvent(2U, start, DOOR_EVENT_COUNTDOWN, 3U, open);
+    ExpectEvent(3U, start, DOOR_EVENT_COUNTDOWN, 2U, open + DOOR_TICK_MS);
+    ExpectEvent(4U, start, DOOR_EVENT_COUNTDOWN, 1U, open + 2U * DOOR_TICK_MS);
+    ExpectEvent(5U, start, DOOR_EVENT_LOCKING, 0U, locking);
+    ExpectEvent(6U, start, DOOR_EVENT_LOCKED, 0U, locked);
+    CHECK(s_eventCount == 7U, "%u events, expected 7", (unsigned)s_eventCount);
+
+    printf("full cycle: locked after %.3f ms (nominal %u ms), %u events\n",
+           (double)(s_events[s_eventCount - 1U].cycle - start) / (double)SIM_CYCLES_PER_MS,
+           (unsigned)locked, (unsigned)s_eventCount);
+}
+
+static void TestLockWhileOpen(void)
+{
+    uint64_t start;
+    uint64_t lockAt;
+
+    s_eventCount = 0U;
+    start = Post(REQUEST_OPEN);
+    Sim_WaitUntil(start + SIM_MS(DOOR_MOTOR_MS + DOOR_TICK_MS + 300U));
+    lockAt = Post(REQUEST_LOCK);
+    CHECK(s_accepted, "emergency lock refused while open");
+
+    ExpectAt(lockAt, 1U, DOOR_LOCKING, MOTOR_CCW);
+    ExpectAt(lockAt, DOOR_MOTOR_MS + 10U, DOOR_LOCKED, MOTOR_STOPPED);
+    ExpectEvent(s_eventCount - 2U, lockAt, DOOR_EVENT_LOCKING, 0U, 0U);
+    ExpectEvent(s_eventCount - 1U, lockAt, DOOR_EVENT_LOCKED, 0U, DOOR_MOTOR_MS);
+
+    (void)Post(REQUEST_LOCK);
+    CHECK(!s_accepted, "emergency lock accepted while locked");
+
+    printf("lock while open: locked %.3f ms after the request\n",
+           (double)(s_events[s_eventCount - 1U].cycle - lockAt) / (double)SIM_CYCLES_PER_MS);
+}
+
+static void TestLockWhileUnlocking(void)
+{
+    const uint32_t unlockMs = 500U;
+    uint64_t start;
+    uint64_t lockAt;
+    uint32_t ranMs;
+
+    s_eventCount = 0U;
+    start = Post(REQUEST_OPEN);
+    Sim_WaitUntil(start + SIM_MS(unlockMs));
+    lockAt = Post(REQUEST_LOCK);
+    CHECK(s_accepted, "emergency lock refused while unlocking");
+    ranMs = (uint32_t)((lockAt - start + SIM_MS(1) / 2U) / SIM_CYCLES_PER_MS);
+
+    ExpectAt(lockAt, 1U, DOOR_LOCKING, MOTOR_CCW);
+    ExpectAt(lockAt, ranMs + 10U, DOOR_LOCKED, MOTOR_STOPPED);
+    ExpectEvent(s_eventCount - 1U, lockAt, DOOR_EVENT_LOCKED, 0U, ranMs);
+    CHECK(s_eventCount == 3U, "%u events, expected UNLOCKING, LOCKING, LOCKED",
+          (unsigned)s_eventCount);
+
+    printf("lock while unlocking: drove CW for %u ms, CCW for %.3f ms\n", (unsigned)ranMs,
+           (double)(s_events[s_eventCount - 1U].cycle - lockAt) / (double)SIM_CYCLES_PER_MS);
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(DoorApp_Main);
+    Sim_WaitUntil(SIM_MS(5));
+
+    TestFullCycle();
+    TestLockWhileOpen();
+    TestLockWhileUnlocking();
+
+    CHECK(s_maxLoopGap <= MAX_LOOP_GAP, "main loop stalled for %.3f ms",
+          (double)s_maxLoopGap / (double)SIM_CYCLES_PER_MS);
+    printf("longest main loop gap %.3f ms over %.3f s\n",
+           (double)s_maxLoopGap / (double)SIM_CYCLES_PER_MS,
+           (double)Sim_Cycles() / (double)SIM_CYCLES_PER_MS / 1000.0);
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
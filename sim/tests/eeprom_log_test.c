@@ -0,0 +1,341 @@
+/******************************************************************************
+ * File: eeprom_log_test.c
+ * Module: EEPROM record log host test
+ * Description: Versioned records, crash recovery and wear over 1M changes
+ *
+ * Checks:
+ *   1. The newest record of each key wins, across a remount (reboot), and
+ *      lookups cost no EEPROM access and no time.
+ *   2. A record cut off by a reset is ignored at mount: the previous value
+ *      stands and the next append reuses the slot.
+ *   3. Appends never overwrite a key's newest record, even with no
+ *      compaction: a key written once survives many laps of the log. With
+ *      compaction run after each append, the key is moved ahead of the
+ *      write position instead, and appends land on consecutive slots.
+ *   4. An append whose CRC word fails to program leaves the key's previous
+ *      record in force, and that record keeps its slot: a lap of appends
+ *      of another key does not overwrite it. The key's next append wins.
+ *   5. Wear: one million setting changes through config.c (the timeout
+ *      every time, the password as well every PASSWORD_EVERY changes),
+ *      next to a record of another key written once, draining the
+ *      compaction steps after each change like the Control ECU's store
+ *      task. Every EEPROM word sees about the same number of program
+ *      cycles, well under 1% of the changes, where the block 0 layout put
+ *      all of them on the timeout word. Compaction adds under 2% writes.
+ *
+ * Usage: eeprom_log_test [changes]
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_eeprom.h"
+#include "systick.h"
+#include "eeprom.h"
+#include "config.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TOTAL_WORDS         (EEPROM_TOTAL_SIZE / EEPROM_WORD_SIZE)
+#define KEY_A               5U
+#define KEY_B               6U
+#define LAPS                4U
+#define DEFAULT_CHANGES     1000000UL
+#define PASSWORD_EVERY      1000UL
+#define MAX_SPREAD          1.02        /* Busiest word over the mean */
+#define MAX_OVERHEAD        0.02        /* Compaction writes per change */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_changes = DEFAULT_CHANGES;
+static uint32_t s_start[TOTAL_WORDS];
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * WrittenSlot
+ * The slot whose first word was programmed most recently, found by
+ * comparing write counts against a snapshot.
+ */
+static int32_t WrittenSlot(const uint32_t *before)
+{
+    uint32_t slot;
+
+    for (slot = 0; slot < EEPROM_LOG_SLOTS; slot++) {
+        if (SimEeprom_WriteCount(slot * EEPROM_LOG_SLOT_WORDS) != before[slot]) {
+            return (int32_t)slot;
+        }
+    }
+    return -1;
+}
+
+static void Snapshot(uint32_t *counts)
+{
+    uint32_t slot;
+
+    for (slot = 0; slot < EEPROM_LOG_SLOTS; slot++) {
+        counts[slot] = SimEeprom_WriteCount(slot * EEPROM_LOG_SLOT_WORDS);
+    }
+}
+
+static void TestNewestWins(void)
+{
+    uint32_t value[EEPROM_LOG_MAX_WORDS];
+    uint32_t pair[2] = { 0x11111111U, 0x22222222U };
+    uint64_t start;
+    uint8_t words;
+
+    CHECK(EEPROM_LogMount() == EEPROM_SUCCESS, "mount failed");
+    CHECK(EEPROM_LogGet(KEY_A, value, 1U) == 0U, "blank log has key A");
+
+    value[0] = 1U;
+    CHECK(EEPROM_LogPut(KEY_A, value, 1U) == EEPROM_SUCCESS, "put failed");
+    value[0] = 2U;
+    CHECK(EEPROM_LogPut(KEY_A, value, 1U) == EEPROM_SUCCESS, "put failed");
+    CHECK(EEPROM_LogPut(KEY_B, pair, 2U) == EEPROM_SUCCESS, "put failed");
+    value[0] = 3U;
+    CHECK(EEPROM_LogPut(KEY_A, value, 1U) == EEPROM_SUCCESS, "put failed");
+
+    CHECK(EEPROM_LogMount() == EEPROM_SUCCESS, "remount failed");
+    start = Sim_Cycles();
+    words = EEPROM_LogGet(KEY_A, value, EEPROM_LOG_MAX_WORDS);
+    CHECK(Sim_Cycles() == start, "lookup took %u cycles", (unsigned)(Sim_Cycles() - start));
+    CHECK(words == 1U && value[0] == 3U, "key A after remount: %u words, %u",
+          (unsigned)words, (unsigned)value[0]);
+    words = EEPROM_LogGet(KEY_B, value, EEPROM_LOG_MAX_WORDS);
+    CHECK(words == 2U && value[0] == pair[0] && value[1] == pair[1], "key B after remount");
+}
+
+static void TestTornRecord(void)
+{
+    uint32_t before[EEPROM_LOG_SLOTS];
+    uint32_t value = 4U;
+    int32_t slot;
+    int32_t torn;
+
+    Snapshot(before);
+    CHECK(EEPROM_LogPut(KEY_A, &value, 1U) == EEPROM_SUCCESS, "put failed");
+    slot = WrittenSlot(before);
+    CHECK(slot >= 0, "put wrote no slot");
+    torn = (slot + 1) % EEPROM_LOG_SLOTS;
+
+    /* Reset after the tag (key A, one word, a newer sequence number) and
+     * the value of the next record, before its CRC word */
+    SimEeprom_Program((uint32_t)torn * EEPROM_LOG_SLOT_WORDS, ((uint32_t)KEY_A << 29) | 0x0FFFFFF0U);
+    SimEeprom_Program(((uint32_t)torn * EEPROM_LOG_SLOT_WORDS) + 1U, 99U);
+
+    CHECK(EEPROM_LogMount() == EEPROM_SUCCESS, "remount failed");
+    value = 0U;
+    CHECK(EEPROM_LogGet(KEY_A, &value, 1U) == 1U && value == 4U, "torn record won: %u",
+          (unsigned)value);
+
+    Snapshot(before);
+    value = 5U;
+    CHECK(EEPROM_LogPut(KEY_A, &value, 1U) == EEPROM_SUCCESS, "put failed");
+    CHECK(WrittenSlot(before) == torn, "append went to slot %d, not the torn slot %d",
+          (int)WrittenSlot(before), (int)torn);
+}
+
+static void TestLiveSkipped(void)
+{
+    uint32_t pair[2] = { 0xCAFEF00DU, 0x0BADBEEFU };
+    uint32_t value[2];
+    uint32_t i;
+
+    CHECK(EEPROM_LogPut(KEY_B, pair, 2U) == EEPROM_SUCCESS, "put failed");
+    for (i = 0; i < (LAPS * EEPROM_LOG_SLOTS); i++) {
+        CHECK(EEPROM_LogPut(KEY_A, &i, 1U) == EEPROM_SUCCESS, "put %u failed", (unsigned)i);
+    }
+    CHECK(EEPROM_LogMount() == EEPROM_SUCCESS, "remount failed");
+    CHECK(EEPROM_LogGet(KEY_B, value, 2U) == 2U && value[0] == pair[0] && value[1] == pair[1],
+          "key B lost after %u laps", (unsigned)LAPS);
+    CHECK(EEPROM_LogGet(KEY_A, value, 1U) == 1U && value[0] == (i - 1U), "key A %u",
+          (unsigned)value[0]);
+}
+
+static void TestCompacted(void)
+{
+    uint32_t before[EEPROM_LOG_SLOTS];
+    uint32_t pair[2] = { 0x600DF00DU, 0x12345678U };
+    uint32_t value[2];
+    int32_t last;
+    int32_t slot;
+    uint32_t i;
+
+    Snapshot(before);
+    CHECK(EEPROM_LogPut(KEY_B, pair, 2U) == EEPROM_SUCCESS, "put failed");
+    last = WrittenSlot(before);
+    for (i = 0; i < (LAPS * EEPROM_LOG_SLOTS); i++) {
+        Snapshot(before);
+        CHECK(EEPROM_LogPut(KEY_A, &i, 1U) == EEPROM_SUCCESS, "put %u failed", (unsigned)i);
+        slot = WrittenSlot(before);
+        CHECK(slot == ((last + 1) % EEPROM_LOG_SLOTS), "append %u skipped to slot %d after %d",
+              (unsigned)i, (int)slot, (int)last);
+        last = slot;
+
+        Snapshot(before);
+        while (EEPROM_LogCompact()) {
+        }
+        CHECK(EEPROM_Sync() == EEPROM_SUCCESS, "compaction failed");
+        slot = WrittenSlot(before);
+        if (slot >= 0) {
+            last = slot;
+        }
+    }
+    CHECK(EEPROM_LogGet(KEY_B, value, 2U) == 2U && value[0] == pair[0] && value[1] == pair[1],
+          "key B lost while compacting");
+}
+
+static void TestFailedAppend(void)
+{
+    uint32_t pair[2] = { 0x0DDBA11U, 0x5CA1AB1EU };
+    uint32_t failed[2] = { 0xDEADBEEFU, 0xFEEDFACEU };
+    uint32_t value[2];
+    uint32_t i;
+
+    CHECK(EEPROM_LogPut(KEY_B, pair, 2U) == EEPROM_SUCCESS, "put failed");
+    SimEeprom_FailAfter(EEPROM_LOG_SLOT_WORDS - 1U);
+    CHECK(EEPROM_LogPut(KEY_B, failed, 2U) == EEPROM_ERROR, "failed append reported success");
+    SimEeprom_StopFailing();
+    CHECK(EEPROM_LogGet(KEY_B, value, 2U) == 2U && value[0] == pair[0] && value[1] == pair[1],
+          "failed append replaced key B");
+
+    for (i = 0; i < EEPROM_LOG_SLOTS; i++) {
+        CHECK(EEPROM_LogPut(KEY_A, &i, 1U) == EEPROM_SUCCESS, "put %u failed", (unsigned)i);
+    }
+    CHECK(EEPROM_LogMount() == EEPROM_SUCCESS, "remount failed");
+    CHECK(EEPROM_LogGet(KEY_B, value, 2U) == 2U && value[0] == pair[0] && value[1] == pair[1],
+          "key B lost after a failed append");
+
+    CHECK(EEPROM_LogPut(KEY_B, failed, 2U) == EEPROM_SUCCESS, "retry failed");
+    CHECK(EEPROM_LogMount() == EEPROM_SUCCESS, "remount failed");
+    CHECK(EEPROM_LogGet(KEY_B, value, 2U) == 2U && value[0] == failed[0] &&
+          value[1] == failed[1], "retried append lost");
+}
+
+static void TestWear(void)
+{
+    uint64_t startCycles = Sim_Cycles();
+    uint64_t logged = 0U;
+    uint64_t total = 0U;
+    uint32_t maxCount = 0U;
+    uint32_t minCount = UINT32_MAX;
+    double mean;
+    uint32_t n;
+    uint32_t i;
+    uint32_t value = 0x5EEDU;
+    char password[PASSWORD_LENGTH + 1];
+
+    CHECK(Config_Erase() == EEPROM_SUCCESS, "erase failed");
+    CHECK(EEPROM_LogPut(KEY_B, &value, 1U) == EEPROM_SUCCESS, "put failed");
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        s_start[i] = SimEeprom_WriteCount(i);
+    }
+
+    for (n = 0; n < s_changes; n++) {
+        if ((n % PASSWORD_EVERY) == 0U) {
+            (void)snprintf(password, sizeof(password), "%05u", (unsigned)((n / PASSWORD_EVERY) % 100000U));
+            Config_SetPassword(password);
+        }
+        Config_SetTimeout((uint8_t)(CONFIG_TIMEOUT_MIN + (n % 2U)));
+        logged++;
+        CHECK(Config_Flush() == EEPROM_SUCCESS, "flush %u failed", (unsigned)n);
+        while (Config_Compact()) {
+        }
+    }
+    CHECK(EEPROM_Sync() == EEPROM_SUCCESS, "compaction failed");
+
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        uint32_t count = SimEeprom_WriteCount(i) - s_start[i];
+
+        total += count;
+        if (count > maxCount) {
+            maxCount = count;
+        }
+        if (count < minCount) {
+            minCount = count;
+        }
+    }
+    mean = (double)total / TOTAL_WORDS;
+
+    printf("%u changes, %llu records (%llu moved by compaction), %.1f s simulated\n",
+           (unsigned)s_changes, (unsigned long long)(total / EEPROM_LOG_SLOT_WORDS),
+           (unsigned long long)((total / EEPROM_LOG_SLOT_WORDS) - logged),
+           (double)(Sim_Cycles() - startCycles) / (SIM_CYCLES_PER_MS * 1000U));
+    printf("program cycles per word: min %u, max %u, mean %.1f (block 0 layout: %u on one word)\n",
+           (unsigned)minCount, (unsigned)maxCount, mean, (unsigned)s_changes);
+
+    CHECK((double)maxCount <= (mean * MAX_SPREAD) + 1.0, "uneven wear: max %u, mean %.1f",
+          (unsigned)maxCount, mean);
+    CHECK(maxCount < (s_changes / 100U), "busiest word %u cycles", (unsigned)maxCount);
+    CHECK((double)(total / EEPROM_LOG_SLOT_WORDS) <= (double)logged * (1.0 + MAX_OVERHEAD),
+          "compaction overhead %llu records", (unsigned long long)((total / EEPROM_LOG_SLOT_WORDS) - logged));
+
+    Config_Load();
+    (void)snprintf(password, sizeof(password), "%05u",
+                   (unsigned)(((s_changes - 1U) / PASSWORD_EVERY) % 100000U));
+    CHECK(strcmp(Config_GetPassword(), password) == 0 &&
+          Config_GetTimeout() == (CONFIG_TIMEOUT_MIN + ((s_changes - 1U) % 2U)),
+          "reloaded \"%s\" %u", Config_GetPassword(), (unsigned)Config_GetTimeout());
+    CHECK(EEPROM_LogGet(KEY_B, &value, 1U) == 1U && value == 0x5EEDU, "key B lost");
+}
+
+static int LogApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    EEPROM_Init();
+
+    TestNewestWins();
+    TestTornRecord();
+    TestLiveSkipped();
+    TestCompacted();
+    TestFailedAppend();
+    TestWear();
+
+    s_done = true;
+    Sim_Wake();
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        s_changes = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    Sim_Init();
+    Sim_Boot(LogApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(3600000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,293 @@
+/******************************************************************************
+ * File: eeprom_queue_test.c
+ * Module: EEPROM write queue host test
+ * Description: Background EEPROM writes finished by the EEPROM interrupt
+ *
+ * Checks:
+ *   1. A queued write returns in well under one word's program time; its
+ *      callback runs later, from the EEPROM done interrupt (INT_FLASH),
+ *      with the words in EEPROM.
+ *   2. Jobs finish in the order they were queued, each with its own
+ *      callback and context, and the idle callback runs once the queue
+ *      drains. Queueing into a full queue waits for a free entry.
+ *   3. A callback can queue the next job, also when its own job was the
+ *      last one: every word is started once (the EEPROM refuses a word
+ *      started while another is in progress). A callback that finds the
+ *      queue full gets EEPROM_ERROR instead of waiting in the interrupt.
+ *   4. A blocking read issued while jobs are queued waits for them and
+ *      sees their words.
+ *   5. Erasing the whole EEPROM returns at once and lets the CPU keep
+ *      its 1 ms tick; erased words are skipped, so an erase of a blank
+ *      EEPROM programs nothing and calls back before it returns.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_eeprom.h"
+#include "sim_nvic.h"
+#include "systick.h"
+#include "eeprom.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TOTAL_WORDS         (EEPROM_TOTAL_SIZE / EEPROM_WORD_SIZE)
+#define JOBS                (EEPROM_QUEUE_JOBS + 2U)
+#define MAX_QUEUE_CYCLES    (SIM_EEPROM_PROGRAM_CYCLES / 4U)
+#define ERASED              0xFFFFFFFFU
+#define CHAIN_JOBS          3U
+#define CHAIN_BLOCK         4U
+
+/* One finished job, as its callback saw it */
+typedef struct {
+    uintptr_t context;
+    uint8_t result;
+    uint32_t interrupts;                /* INT_FLASH handler entries so far */
+} Completion;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Completion s_completions[JOBS];
+static volatile uint32_t s_calls;
+static volatile uint32_t s_idles;
+static uint8_t s_floodResults[2];
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static void OnDone(uint8_t result, void *context)
+{
+    if (s_calls < JOBS) {
+        s_completions[s_calls].context = (uintptr_t)context;
+        s_completions[s_calls].result = result;
+        s_completions[s_calls].interrupts = SimNvic_Taken(SIM_VECTOR_FLASH);
+    }
+    s_calls++;
+}
+
+static void OnIdle(void)
+{
+    s_idles++;
+}
+
+/*
+ * OnChain
+ * Queues the next write of the chain from the callback of the last one.
+ */
+static void OnChain(uint8_t result, void *context)
+{
+    uint32_t n = (uint32_t)(uintptr_t)context;
+    uint32_t word = 0xC0000000U | (n + 1U);
+
+    OnDone(result, context);
+    if (n + 1U < CHAIN_JOBS) {
+        CHECK(EEPROM_QueueWrite(CHAIN_BLOCK, n + 1U, &word, 1U, OnChain,
+                                (void *)(uintptr_t)(n + 1U)) == EEPROM_SUCCESS,
+              "queue from callback failed");
+    }
+}
+
+/*
+ * OnFlood
+ * Queues two jobs from a callback while the rest of the queue is full.
+ */
+static void OnFlood(uint8_t result, void *context)
+{
+    uint32_t word = 0xD0000000U;
+
+    OnDone(result, context);
+    s_floodResults[0] = EEPROM_QueueWrite(CHAIN_BLOCK, 8U, &word, 1U, OnDone, (void *)8U);
+    s_floodResults[1] = EEPROM_QueueWrite(CHAIN_BLOCK, 9U, &word, 1U, OnDone, (void *)9U);
+}
+
+static void Reset(void)
+{
+    s_calls = 0U;
+    s_idles = 0U;
+}
+
+static void TestBackground(void)
+{
+    const uint32_t data[EEPROM_JOB_MAX_WORDS] = { 0x11111111U, 0x22222222U, 0x33333333U, 0x44444444U };
+    uint32_t taken = SimNvic_Taken(SIM_VECTOR_FLASH);
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t i;
+
+    Reset();
+    start = Sim_Cycles();
+    CHECK(EEPROM_QueueWrite(2U, 4U, data, EEPROM_JOB_MAX_WORDS, OnDone, (void *)7U) ==
+          EEPROM_SUCCESS, "queue failed");
+    cycles = Sim_Cycles() - start;
+    printf("queue 4 words: %.3f ms (programming takes %.3f ms)\n",
+           (double)cycles / SIM_CYCLES_PER_MS,
+           (double)(EEPROM_JOB_MAX_WORDS * SIM_EEPROM_PROGRAM_CYCLES) / SIM_CYCLES_PER_MS);
+    CHECK(cycles < MAX_QUEUE_CYCLES, "queueing took %u cycles", (unsigned)cycles);
+    CHECK(s_calls == 0U && EEPROM_IsBusy(), "write finished before the queue returned");
+
+    CHECK(EEPROM_Sync() == EEPROM_SUCCESS, "sync failed");
+    CHECK(s_calls == 1U && s_completions[0].context == 7U &&
+          s_completions[0].result == EEPROM_SUCCESS, "callback %u calls", (unsigned)s_calls);
+    CHECK(s_completions[0].interrupts == taken + EEPROM_JOB_MAX_WORDS,
+          "callback after %u interrupts", (unsigned)(s_completions[0].interrupts - taken));
+    CHECK(s_idles == 1U, "idle callback ran %u times", (unsigned)s_idles);
+    for (i = 0; i < EEPROM_JOB_MAX_WORDS; i++) {
+        CHECK(SimEeprom_Read((2U * EEPROM_BLOCK_SIZE) + 4U + i) == data[i], "word %u not written",
+              (unsigned)i);
+    }
+}
+
+static void TestOrder(void)
+{
+    uint32_t word;
+    uint32_t i;
+
+    Reset();
+    for (i = 0; i < JOBS; i++) {
+        word = 0xA0000000U | i;
+        CHECK(EEPROM_QueueWrite(3U, i, &word, 1U, OnDone, (void *)(uintptr_t)(100U + i)) ==
+              EEPROM_SUCCESS, "queue %u failed", (unsigned)i);
+    }
+    /* The last two had to wait for an entry */
+    CHECK(s_calls >= (JOBS - EEPROM_QUEUE_JOBS), "full queue did not wait");
+
+    /* A blocking read waits for the writes ahead of it */
+    CHECK(EEPROM_ReadWord(3U, JOBS - 1U, &word) == EEPROM_SUCCESS && word == (0xA0000000U | (JOBS - 1U)),
+          "read 0x%08X before the queued write", (unsigned)word);
+    CHECK(s_calls == JOBS && !EEPROM_IsBusy(), "read returned with jobs queued");
+    for (i = 0; i < JOBS; i++) {
+        CHECK(s_completions[i].context == 100U + i, "job %u finished as number %u",
+              (unsigned)(s_completions[i].context - 100U), (unsigned)i);
+    }
+    CHECK(s_idles >= 1U, "idle callback not run");
+}
+
+static void TestFromCallback(void)
+{
+    uint32_t word = 0xC0000000U;
+    uint32_t i;
+
+    /* Each job is the only one queued when its callback queues the next */
+    Reset();
+    CHECK(EEPROM_QueueWrite(CHAIN_BLOCK, 0U, &word, 1U, OnChain, (void *)0U) == EEPROM_SUCCESS,
+          "queue failed");
+    CHECK(EEPROM_Sync() == EEPROM_SUCCESS, "a chained job failed");
+    CHECK(s_calls == CHAIN_JOBS, "%u of %u chained jobs finished", (unsigned)s_calls,
+          (unsigned)CHAIN_JOBS);
+    for (i = 0; i < CHAIN_JOBS; i++) {
+        CHECK(s_completions[i].context == i && s_completions[i].result == EEPROM_SUCCESS,
+              "chained job %u: context %u result %u", (unsigned)i,
+              (unsigned)s_completions[i].context, (unsigned)s_completions[i].result);
+        CHECK(SimEeprom_Read((CHAIN_BLOCK * EEPROM_BLOCK_SIZE) + i) == (0xC0000000U | i),
+              "chained word %u not written", (unsigned)i);
+    }
+
+    /* The first job's callback finds one free entry */
+    Reset();
+    CHECK(EEPROM_QueueWrite(CHAIN_BLOCK, 4U, &word, 1U, OnFlood, (void *)4U) == EEPROM_SUCCESS,
+          "queue failed");
+    for (i = 1; i < EEPROM_QUEUE_JOBS; i++) {
+        CHECK(EEPROM_QueueWrite(CHAIN_BLOCK, 4U + i, &word, 1U, OnDone,
+                                (void *)(uintptr_t)(4U + i)) == EEPROM_SUCCESS, "queue failed");
+    }
+    CHECK(EEPROM_Sync() == EEPROM_SUCCESS, "sync failed");
+    CHECK(s_floodResults[0] == EEPROM_SUCCESS && s_floodResults[1] == EEPROM_ERROR,
+          "queueing from a callback into a full queue returned %u, %u",
+          (unsigned)s_floodResults[0], (unsigned)s_floodResults[1]);
+    CHECK(s_calls == EEPROM_QUEUE_JOBS + 1U && s_completions[EEPROM_QUEUE_JOBS].context == 8U,
+          "%u jobs finished", (unsigned)s_calls);
+}
+
+static void TestErase(void)
+{
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t ticks = 0U;
+    uint32_t i;
+
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        SimEeprom_Program(i, i);
+    }
+    Reset();
+    start = Sim_Cycles();
+    CHECK(EEPROM_QueueErase(0U, 0U, TOTAL_WORDS, OnDone, 0) == EEPROM_SUCCESS, "erase failed");
+    cycles = Sim_Cycles() - start;
+    CHECK(cycles < MAX_QUEUE_CYCLES, "queueing the erase took %u cycles", (unsigned)cycles);
+
+    /* The CPU keeps running while the words are erased */
+    while (EEPROM_IsBusy()) {
+        DelayMs(1);
+        ticks++;
+    }
+    cycles = Sim_Cycles() - start;
+    printf("erase 2 KB: %.3f ms, %u ms of it free for the CPU (mass erase blocks %.3f ms)\n",
+           (double)cycles / SIM_CYCLES_PER_MS, (unsigned)ticks,
+           (double)SIM_EEPROM_ERASE_CYCLES / SIM_CYCLES_PER_MS);
+    CHECK(ticks + 2U >= (uint32_t)(cycles / SIM_CYCLES_PER_MS), "CPU held up during the erase");
+    CHECK(s_calls == 1U && s_completions[0].result == EEPROM_SUCCESS, "erase not called back");
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        if (SimEeprom_Read(i) != ERASED) {
+            CHECK(false, "word %u not erased", (unsigned)i);
+            break;
+        }
+    }
+
+    /* Nothing left to erase: no program cycles, done before it returns */
+    Reset();
+    start = (uint64_t)SimEeprom_WriteCount(0U);
+    CHECK(EEPROM_QueueErase(0U, 0U, TOTAL_WORDS, OnDone, 0) == EEPROM_SUCCESS, "erase failed");
+    CHECK(s_calls == 1U && !EEPROM_IsBusy(), "blank erase not done at once");
+    CHECK(SimEeprom_WriteCount(0U) == start, "blank word programmed");
+}
+
+static int QueueApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    EEPROM_Init();
+    EEPROM_SetIdleCallback(OnIdle);
+
+    TestBackground();
+    TestOrder();
+    TestFromCallback();
+    TestErase();
+
+    s_done = true;
+    Sim_Wake();
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(QueueApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(10000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,519 @@
+/******************************************************************************
+ * File: keypad_test.c
+ * Module: Keypad scanner host test
+ * Description: The Timer1A scanner debounces every key and queues press,
+ *              hold and release events without ever blocking the caller
+ *
+ * Checks:
+ *   1. A clean tap gives one press and one release, each reported
+ *      KEYPAD_DEBOUNCE_SCANS scans after the contact changed.
+ *   2. Contact bounce on press and release still gives exactly one press
+ *      and one release; a pulse shorter than the debounce time gives none.
+ *   3. A key held past KEYPAD_HOLD_MS adds one hold event. While it is
+ *      down Keypad_GetKey returns it at once instead of waiting for the
+ *      release.
+ *   4. Keys typed faster than they are read are queued in order; once the
+ *      queue is full further events are dropped and counted.
+ *   5. Three keys on the corners of a rectangle (the fourth reads pressed
+ *      too) are ignored until the matrix is unambiguous again; the ghost
+ *      key is never reported.
+ *   6. Events carry the time the scan accepted them. Auto-repeat starts
+ *      after its delay and keeps its period.
+ *   7. '*' and '#' pressed together, in either order, give one chord
+ *      event and nothing else; pressed alone or too far apart they give
+ *      their own events, each press held back by KEYPAD_CHORD_MS.
+ *   8. Scan cost benchmark: the scanner interrupt, idle and with a key
+ *      down, against a reference scan that reads pin by pin through
+ *      DIO_WritePin/DIO_ReadPin.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_nvic.h"
+#include "sim_keypad.h"
+#include "systick.h"
+#include "dio.h"
+#include "keypad.h"
+#include "driverlib/interrupt.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define DEBOUNCE_US         (KEYPAD_DEBOUNCE_SCANS * KEYPAD_SCAN_MS * 1000U)
+#define SCAN_US             (KEYPAD_SCAN_MS * 1000U)
+#define BOUNCE_EDGES        9U          /* Odd: ends in the new state */
+#define BOUNCE_GAP_US       400U        /* Edges seen by several scans */
+#define TYPE_HOLD_MS        20U
+#define TYPE_GAP_MS         20U
+#define SCAN_VECTOR         37U         /* INT_TIMER1A */
+#define BENCH_MS            1000U
+#define CYCLES_PER_SCAN     (KEYPAD_SCAN_MS * 16000U)
+#define REPEAT_DELAY_MS     300U
+#define REPEAT_PERIOD_MS    100U
+#define REPEAT_HOLD_MS      950U
+#define KEY_BACK            '\x1B'      /* Chord code for '*' + '#' */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * ExpectEvent
+ * Takes the next queued event and checks it.
+ */
+static void ExpectEvent(char key, uint8_t type, const char *when)
+{
+    Keypad_Event event;
+
+    if (!Keypad_GetEvent(&event)) {
+        CHECK(false, "%s: no event, expected '%c' type %u", when, key, (unsigned)type);
+        return;
+    }
+    CHECK(event.key == key && event.type == type, "%s: got '%c' type %u, expected '%c' type %u",
+          when, event.key, (unsigned)event.type, key, (unsigned)type);
+}
+
+static void ExpectNoEvent(const char *when)
+{
+    Keypad_Event event;
+
+    CHECK(!Keypad_GetEvent(&event), "%s: unexpected event '%c' type %u",
+          when, event.key, (unsigned)event.type);
+}
+
+/*
+ * WaitForKey
+ * Polls until Keypad_GetKey() returns want.
+ * Returns: microseconds waited
+ */
+static uint32_t WaitForKey(char want)
+{
+    uint64_t start = Time_NowUs();
+
+    while (Keypad_GetKey() != want && Time_NowUs() - start < 100000U) {
+        DelayUs(50);
+    }
+    return (uint32_t)(Time_NowUs() - start);
+}
+
+/*
+ * Bounce
+ * Toggles a key BOUNCE_EDGES times, ending in the opposite state.
+ */
+static void Bounce(char key, bool press)
+{
+    uint8_t i;
+
+    for (i = 0; i < BOUNCE_EDGES; i++) {
+        if ((i % 2U == 0U) == press) {
+            SimKeypad_Press(key);
+        } else {
+            SimKeypad_Release(key);
+        }
+        DelayUs(BOUNCE_GAP_US);
+    }
+}
+
+static void TestTap(void)
+{
+    uint32_t waited;
+
+    SimKeypad_Press('5');
+    waited = WaitForKey('5');
+    CHECK(waited >= DEBOUNCE_US - SCAN_US && waited <= DEBOUNCE_US + SCAN_US,
+          "press reported after %u us, debounce is %u us", (unsigned)waited, (unsigned)DEBOUNCE_US);
+    DelayMs(50);
+    SimKeypad_Release('5');
+    waited = WaitForKey(0);
+    CHECK(waited >= DEBOUNCE_US - SCAN_US && waited <= DEBOUNCE_US + SCAN_US,
+          "release reported after %u us, debounce is %u us", (unsigned)waited, (unsigned)DEBOUNCE_US);
+
+    ExpectEvent('5', KEYPAD_EVENT_PRESS, "tap");
+    ExpectEvent('5', KEYPAD_EVENT_RELEASE, "tap");
+    ExpectNoEvent("tap");
+}
+
+static void TestBounce(void)
+{
+    Bounce('#', true);
+    DelayMs(50);
+    Bounce('#', false);
+    DelayMs(20);
+    ExpectEvent('#', KEYPAD_EVENT_PRESS, "bounce");
+    ExpectEvent('#', KEYPAD_EVENT_RELEASE, "bounce");
+    ExpectNoEvent("bounce");
+
+    /* Shorter than the debounce time: ignored */
+    SimKeypad_Press('D');
+    DelayUs(DEBOUNCE_US - (2U * SCAN_US));
+    SimKeypad_Release('D');
+    DelayMs(20);
+    ExpectNoEvent("glitch");
+}
+
+static void TestHold(void)
+{
+    uint64_t start;
+    uint32_t callUs;
+    Keypad_Event event;
+
+    SimKeypad_Press('A');
+    (void)WaitForKey('A');
+    ExpectEvent('A', KEYPAD_EVENT_PRESS, "hold");
+    DelayMs(KEYPAD_HOLD_MS - 100U);
+    CHECK(!Keypad_GetEvent(&event), "hold reported before %u ms", (unsigned)KEYPAD_HOLD_MS);
+    DelayMs(200);
+    ExpectEvent('A', KEYPAD_EVENT_HOLD, "hold");
+
+    /* A stuck key never blocks the caller */
+    start = Time_NowUs();
+    CHECK(Keypad_GetKey() == 'A', "held key not reported");
+    callUs = (uint32_t)(Time_NowUs() - start);
+    CHECK(callUs < 50U, "Keypad_GetKey took %u us with a key down", (unsigned)callUs);
+    DelayMs(1000);
+    ExpectNoEvent("hold (one hold event per press)");
+
+    SimKeypad_Release('A');
+    DelayMs(20);
+    ExpectEvent('A', KEYPAD_EVENT_RELEASE, "hold");
+}
+
+static void TestTypeAhead(void)
+{
+    static const char keys[] = "1234567890BC";
+    uint8_t typed = (uint8_t)(KEYPAD_QUEUE_SIZE / 2U);
+    Keypad_Event event;
+    uint8_t i;
+
+    /* Fills the queue exactly: a press and a release per key */
+    for (i = 0; i < typed; i++) {
+        SimKeypad_Press(keys[i]);
+        DelayMs(TYPE_HOLD_MS);
+        SimKeypad_Release(keys[i]);
+        DelayMs(TYPE_GAP_MS);
+    }
+    CHECK(Keypad_Overflows() == 0U, "%u events dropped", (unsigned)Keypad_Overflows());
+
+    /* Two more keys while nothing is read */
+    for (i = typed; i < typed + 2U; i++) {
+        SimKeypad_Press(keys[i]);
+        DelayMs(TYPE_HOLD_MS);
+        SimKeypad_Release(keys[i]);
+        DelayMs(TYPE_GAP_MS);
+    }
+    CHECK(Keypad_Overflows() == 4U, "%u events dropped, expected 4", (unsigned)Keypad_Overflows());
+
+    for (i = 0; i < typed; i++) {
+        ExpectEvent(keys[i], KEYPAD_EVENT_PRESS, "type-ahead");
+        ExpectEvent(keys[i], KEYPAD_EVENT_RELEASE, "type-ahead");
+    }
+    CHECK(!Keypad_GetEvent(&event), "dropped event '%c' came through", event.key);
+
+    printf("type-ahead: %u keys at %u ms per key queued in order\n",
+           (unsigned)typed, (unsigned)(TYPE_HOLD_MS + TYPE_GAP_MS));
+}
+
+static void TestGhosting(void)
+{
+    Keypad_Event event;
+    bool released2 = false;
+    bool pressed4 = false;
+    uint32_t ghostScans = Keypad_GhostScans();
+
+    /* '1' and '2' share row 0, '4' is under '1': '5' would be the ghost */
+    SimKeypad_Press('1');
+    DelayMs(20);
+    SimKeypad_Press('2');
+    DelayMs(20);
+    ExpectEvent('1', KEYPAD_EVENT_PRESS, "ghosting");
+    ExpectEvent('2', KEYPAD_EVENT_PRESS, "ghosting");
+    SimKeypad_Press('4');
+    DelayMs(50);
+    ExpectNoEvent("ghosting (ambiguous matrix)");
+    CHECK(Keypad_GhostScans() - ghostScans >= 45U, "%u ghosted scans in 50 ms",
+          (unsigned)(Keypad_GhostScans() - ghostScans));
+
+    /* Without '2' the matrix is unambiguous again */
+    SimKeypad_Release('2');
+    DelayMs(20);
+    while (Keypad_GetEvent(&event)) {
+        if (event.key == '2' && event.type == KEYPAD_EVENT_RELEASE) {
+            released2 = true;
+        } else if (event.key == '4' && event.type == KEYPAD_EVENT_PRESS) {
+            pressed4 = true;
+        } else {
+            CHECK(false, "ghosting: unexpected event '%c' type %u", event.key, (unsigned)event.type);
+        }
+    }
+    CHECK(released2 && pressed4, "ghosting: release of '2' %s, press of '4' %s",
+          released2 ? "seen" : "missing", pressed4 ? "seen" : "missing");
+
+    SimKeypad_Release('1');
+    SimKeypad_Release('4');
+    DelayMs(20);
+    ExpectEvent('4', KEYPAD_EVENT_RELEASE, "ghosting");
+    ExpectEvent('1', KEYPAD_EVENT_RELEASE, "ghosting");
+    ExpectNoEvent("ghosting");
+}
+
+/*
+ * NextEvent
+ * Returns: the next queued event; type 0xFF if there is none
+ */
+static Keypad_Event NextEvent(void)
+{
+    Keypad_Event event;
+
+    if (!Keypad_GetEvent(&event)) {
+        event.key = 0;
+        event.type = 0xFFU;
+        event.timeMs = 0U;
+    }
+    return event;
+}
+
+static void TestRepeat(void)
+{
+    Keypad_Event event;
+    uint32_t pressedAt;
+    uint32_t repeats = 0U;
+    uint32_t expectedRepeats = ((REPEAT_HOLD_MS - REPEAT_DELAY_MS) / REPEAT_PERIOD_MS) + 1U;
+    uint32_t lastAt;
+
+    Keypad_SetRepeat(REPEAT_DELAY_MS, REPEAT_PERIOD_MS);
+    pressedAt = (uint32_t)Time_NowMs();
+    SimKeypad_Press('2');
+    DelayMs(REPEAT_HOLD_MS + KEYPAD_DEBOUNCE_SCANS);
+    SimKeypad_Release('2');
+    DelayMs(20);
+    Keypad_SetRepeat(0, 0);
+
+    event = NextEvent();
+    CHECK(event.key == '2' && event.type == KEYPAD_EVENT_PRESS, "repeat: no press first");
+    CHECK(event.timeMs - pressedAt <= KEYPAD_DEBOUNCE_SCANS + 1U,
+          "press stamped %u ms after the contact closed", (unsigned)(event.timeMs - pressedAt));
+    lastAt = event.timeMs;
+    for (event = NextEvent(); event.type == KEYPAD_EVENT_REPEAT; event = NextEvent()) {
+        uint32_t gap = event.timeMs - lastAt;
+        uint32_t want = (repeats == 0U) ? REPEAT_DELAY_MS : REPEAT_PERIOD_MS;
+        CHECK(event.key == '2' && gap == want, "repeat %u: '%c' %u ms after the previous event, expected %u",
+              (unsigned)repeats, event.key, (unsigned)gap, (unsigned)want);
+        lastAt = event.timeMs;
+        repeats++;
+    }
+    CHECK(repeats == expectedRepeats, "%u repeats, expected %u", (unsigned)repeats, (unsigned)expectedRepeats);
+    CHECK(event.key == '2' && event.type == KEYPAD_EVENT_RELEASE, "repeat: no release last");
+    ExpectNoEvent("repeat");
+    printf("auto-repeat: %u repeats in %u ms (delay %u ms, period %u ms)\n", (unsigned)repeats,
+           (unsigned)REPEAT_HOLD_MS, (unsigned)REPEAT_DELAY_MS, (unsigned)REPEAT_PERIOD_MS);
+}
+
+/*
+ * Chord
+ * Presses first, then second gapMs later, holds both, releases both.
+ */
+static void Chord(char first, char second, uint32_t gapMs)
+{
+    SimKeypad_Press(first);
+    DelayMs(gapMs);
+    SimKeypad_Press(second);
+    DelayMs(200);
+    SimKeypad_Release(first);
+    SimKeypad_Release(second);
+    DelayMs(20);
+}
+
+static void TestChord(void)
+{
+    Keypad_Event event;
+    uint32_t pressedAt;
+    uint32_t waited;
+
+    CHECK(Keypad_AddChord('*', '#', KEY_BACK), "chord not accepted");
+    CHECK(!Keypad_AddChord('*', '*', KEY_BACK), "chord of one key accepted");
+    CHECK(!Keypad_AddChord('*', 'x', KEY_BACK), "chord of an unknown key accepted");
+
+    Chord('*', '#', 30);
+    ExpectEvent(KEY_BACK, KEYPAD_EVENT_CHORD, "chord '*' then '#'");
+    ExpectNoEvent("chord '*' then '#'");
+    Chord('#', '*', 10);
+    ExpectEvent(KEY_BACK, KEYPAD_EVENT_CHORD, "chord '#' then '*'");
+    ExpectNoEvent("chord '#' then '*'");
+
+    /* Too far apart: two separate keys */
+    Chord('*', '#', KEYPAD_CHORD_MS + 40U);
+    ExpectEvent('*', KEYPAD_EVENT_PRESS, "no chord");
+    ExpectEvent('#', KEYPAD_EVENT_PRESS, "no chord");
+    event = NextEvent();
+    CHECK(event.type == KEYPAD_EVENT_RELEASE, "no chord: release expected");
+    event = NextEvent();
+    CHECK(event.type == KEYPAD_EVENT_RELEASE, "no chord: release expected");
+    ExpectNoEvent("no chord");
+
+    /* Alone: the press is held back for the chord window, stamped when
+     * it was accepted */
+    pressedAt = (uint32_t)Time_NowMs();
+    SimKeypad_Press('#');
+    waited = 0U;
+    while (!Keypad_GetEvent(&event) && waited < 200U) {
+        DelayMs(1);
+        waited++;
+    }
+    CHECK(event.key == '#' && event.type == KEYPAD_EVENT_PRESS, "chord key alone: no press");
+    CHECK(waited >= KEYPAD_CHORD_MS && waited <= KEYPAD_CHORD_MS + KEYPAD_DEBOUNCE_SCANS + 2U,
+          "chord key alone: press queued after %u ms", (unsigned)waited);
+    CHECK(event.timeMs - pressedAt <= KEYPAD_DEBOUNCE_SCANS + 1U,
+          "chord key alone: press stamped %u ms after the contact closed",
+          (unsigned)(event.timeMs - pressedAt));
+    SimKeypad_Release('#');
+    DelayMs(20);
+    ExpectEvent('#', KEYPAD_EVENT_RELEASE, "chord key alone");
+
+    /* A tap shorter than the window still gives press and release */
+    SimKeypad_Press('*');
+    DelayMs(30);
+    SimKeypad_Release('*');
+    DelayMs(20);
+    ExpectEvent('*', KEYPAD_EVENT_PRESS, "chord key tap");
+    ExpectEvent('*', KEYPAD_EVENT_RELEASE, "chord key tap");
+    ExpectNoEvent("chord key tap");
+}
+
+/*
+ * ReferenceScan
+ * The matrix scan done pin by pin, for comparison: each column set with
+ * DIO_WritePin and each row read with DIO_ReadPin.
+ * Returns: cycles taken
+ */
+static uint32_t ReferenceScan(void)
+{
+    static const uint8_t colPins[KEYPAD_COLS] = { PIN4, PIN5, PIN6, PIN7 };
+    static const uint8_t rowPins[KEYPAD_ROWS] = { PIN2, PIN3, PIN4, PIN5 };
+    volatile uint16_t down = 0;
+    uint64_t start;
+    uint8_t col;
+    uint8_t row;
+    uint8_t c;
+    bool wasMasked = IntMasterDisable();
+
+    start = Sim_Cycles();
+    for (col = 0; col < KEYPAD_COLS; col++) {
+        for (c = 0; c < KEYPAD_COLS; c++) {
+            DIO_WritePin(PORTC, colPins[c], HIGH);
+        }
+        DIO_WritePin(PORTC, colPins[col], LOW);
+        DelayUs(1);
+        for (row = 0; row < KEYPAD_ROWS; row++) {
+            if (DIO_ReadPin(PORTA, rowPins[row]) == LOW) {
+                down |= (uint16_t)(1U << ((row * KEYPAD_COLS) + col));
+            }
+        }
+    }
+    start = Sim_Cycles() - start;
+    DIO_WritePort(PORTC, 0xF0U, 0U);     /* Columns back low, as the scanner leaves them */
+    if (!wasMasked) {
+        IntMasterEnable();
+    }
+    return (uint32_t)start;
+}
+
+/*
+ * ScanCycles
+ * Runs for BENCH_MS and measures the scanner interrupt.
+ * Returns: average cycles per scan, exception entry and return included
+ */
+static uint32_t ScanCycles(void)
+{
+    uint64_t cycles = SimNvic_Cycles(SCAN_VECTOR);
+    uint32_t scans = SimNvic_Taken(SCAN_VECTOR);
+
+    DelayMs(BENCH_MS);
+    scans = SimNvic_Taken(SCAN_VECTOR) - scans;
+    cycles = SimNvic_Cycles(SCAN_VECTOR) - cycles;
+    return (scans != 0U) ? (uint32_t)(cycles / scans) : 0U;
+}
+
+static void TestScanCost(void)
+{
+    uint32_t reference = ReferenceScan();
+    uint32_t idle;
+    uint32_t held;
+
+    idle = ScanCycles();
+    SimKeypad_Press('5');
+    DelayMs(20);
+    held = ScanCycles();
+    SimKeypad_Release('5');
+    DelayMs(20);
+    while (Keypad_GetKey() != 0) {
+        DelayMs(1);
+    }
+    {
+        Keypad_Event event;
+        while (Keypad_GetEvent(&event)) {
+        }
+    }
+
+    printf("scan cost (cycles): pin-by-pin reference %u, interrupt idle %u (%.2f%% CPU), "
+           "with a key down %u (%.2f%% CPU)\n",
+           (unsigned)reference, (unsigned)idle, 100.0 * idle / CYCLES_PER_SCAN,
+           (unsigned)held, 100.0 * held / CYCLES_PER_SCAN);
+    CHECK(held < reference, "full scan costs %u cycles, reference %u", (unsigned)held, (unsigned)reference);
+    CHECK(idle * 4U < held, "idle scan costs %u cycles, full scan %u", (unsigned)idle, (unsigned)held);
+}
+
+static int KeypadApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    Keypad_Init();
+
+    TestTap();
+    TestBounce();
+    TestHold();
+    TestTypeAhead();
+    TestGhosting();
+    TestRepeat();
+    TestChord();
+    TestScanCost();
+
+    s_done = true;
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(KeypadApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(60000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
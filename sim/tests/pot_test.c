@@ -0,0 +1,399 @@
+/******************************************************************************
+ * File: pot_test.c
+ * Module: Potentiometer sampling host test
+ * Description: Timer-triggered, hardware-averaged SS0 sampling behind
+ *              POT_ReadFiltered, and the mapped-value filter on top of it
+ *
+ * Checks:
+ *   1. Timer2A starts one SS0 sequence every ADC_SAMPLE_PERIOD_MS and the
+ *      interrupt stores every one of them; the FIFO never overflows.
+ *   2. POT_ReadFiltered returns the buffered value without touching the
+ *      ADC, while POT_ReadRaw waits for a conversion.
+ *   3. With a noisy input centred in one timeout step, the filtered value
+ *      stays close to the centre and the mapped timeout never changes.
+ *   4. After a step change the filtered value settles within
+ *      ADC_BUFFER_SIZE + 1 sample periods and never overshoots.
+ *   5. Cost of the SS0 interrupt, as a share of the CPU.
+ *   6. Filter edges: the output moves to the next step exactly hysteresis
+ *      codes past the edge, in both directions; the average moves by
+ *      1/2^smoothingShift of the distance per reading.
+ *   7. Recorded traces (pot_traces.h), against the same quantiser with no
+ *      smoothing and no dead band:
+ *      - knob resting on a step edge: no change after the first reading;
+ *      - knob turned from 10 s to 20 s: one change per step, never back;
+ *      - full sweep up and down: every value once each way, in order.
+ *   8. POT_ReadStable on a live noisy input at a step edge reports one
+ *      change (the first reading) in 3 s.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_nvic.h"
+#include "sim_adc.h"
+#include "systick.h"
+#include "adc.h"
+#include "potentiometer.h"
+#include "pot_traces.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SS0_VECTOR          30U         /* INT_ADC0SS0 */
+#define CYCLES_PER_PERIOD   (ADC_SAMPLE_PERIOD_MS * 16000U)
+#define TIMEOUT_MIN         5U
+#define TIMEOUT_MAX         30U
+#define STEP_CENTRE         900U        /* Middle of the codes that map to 10 s */
+#define NOISE_CODES         120U        /* Uniform noise, +/- */
+#define NOISE_RUN_MS        3000U
+#define POLL_MS             20U
+#define MAX_FILTER_ERROR    10U
+#define STEP_FROM           900U
+#define STEP_TO             3000U
+#define EDGE_9_10           788U        /* First code of the 10 s step */
+#define EDGE_10_11          946U
+#define TRACE_LENGTH(t)     ((uint32_t)(sizeof(t) / sizeof((t)[0])))
+
+typedef struct {
+    uint32_t changes;           /* Output changes after the first reading */
+    uint32_t reversals;         /* Changes against the previous direction */
+    uint32_t first;
+    uint32_t last;
+} TraceResult;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint16_t s_level;
+static uint32_t s_noise;
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * NoisySource
+ * s_level plus uniform noise of +/- s_noise, a fixed function of the cycle.
+ */
+static uint16_t NoisySource(uint8_t channel, uint64_t cycle)
+{
+    uint64_t x = cycle * 0x9E3779B97F4A7C15ULL;
+    int32_t value;
+
+    (void)channel;
+    x ^= x >> 29;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 32;
+    value = (int32_t)s_level;
+    if (s_noise != 0U) {
+        value += (int32_t)(x % (2U * s_noise + 1U)) - (int32_t)s_noise;
+    }
+    if (value < 0) {
+        value = 0;
+    } else if (value > ADC_MAX_VALUE) {
+        value = ADC_MAX_VALUE;
+    }
+    return (uint16_t)value;
+}
+
+static uint32_t Distance(uint32_t a, uint32_t b)
+{
+    return (a > b) ? a - b : b - a;
+}
+
+static void TestSequences(void)
+{
+    uint32_t sequences = ADC_Sequences();
+    uint32_t conversions = SimAdc_Conversions();
+    uint32_t start = (uint32_t)Time_NowMs();
+    uint32_t count;
+
+    s_level = 2000U;
+    s_noise = 0U;
+    DelayMs(1000);
+    count = ADC_Sequences() - sequences;
+
+    CHECK(Distance(count, 1000U / ADC_SAMPLE_PERIOD_MS) <= 1U,
+          "%u sequences in %u ms", (unsigned)count, (unsigned)((uint32_t)Time_NowMs() - start));
+    CHECK(SimNvic_Taken(SS0_VECTOR) == ADC_Sequences(), "%u interrupts for %u sequences",
+          (unsigned)SimNvic_Taken(SS0_VECTOR), (unsigned)ADC_Sequences());
+    CHECK(Distance(SimAdc_Conversions() - conversions, count * ADC_SS0_STEPS) <= ADC_SS0_STEPS,
+          "%u results for %u sequences", (unsigned)(SimAdc_Conversions() - conversions),
+          (unsigned)count);
+    CHECK(SimAdc_Overflows() == 0U, "%u FIFO overflows", (unsigned)SimAdc_Overflows());
+    CHECK(POT_ReadFiltered() == 2000U, "steady input read as %u", (unsigned)POT_ReadFiltered());
+}
+
+static void TestNonBlocking(void)
+{
+    uint32_t conversions = SimAdc_Conversions();
+    uint64_t start = Sim_Cycles();
+    uint64_t filtered;
+    uint64_t raw;
+    uint16_t value;
+
+    value = POT_ReadFiltered();
+    filtered = Sim_Cycles() - start;
+    CHECK(SimAdc_Conversions() == conversions, "POT_ReadFiltered started a conversion");
+
+    start = Sim_Cycles();
+    (void)POT_ReadRaw();
+    raw = Sim_Cycles() - start;
+
+    printf("read cost (cycles): POT_ReadRaw %u, POT_ReadFiltered %u\n",
+           (unsigned)raw, (unsigned)filtered);
+    CHECK(value == 2000U, "read %u", (unsigned)value);
+    CHECK(filtered < 20U, "POT_ReadFiltered took %u cycles", (unsigned)filtered);
+    CHECK(raw >= (uint64_t)ADC_HW_AVERAGING * SIM_ADC_SAMPLE_CYCLES,
+          "POT_ReadRaw took only %u cycles", (unsigned)raw);
+}
+
+static void TestNoise(void)
+{
+    uint32_t end;
+    uint32_t worst = 0U;
+    uint32_t expected = POT_Map(STEP_CENTRE, TIMEOUT_MIN, TIMEOUT_MAX);
+    uint32_t changes = 0U;
+
+    s_level = STEP_CENTRE;
+    s_noise = NOISE_CODES;
+    CHECK(POT_Map(STEP_CENTRE - NOISE_CODES, TIMEOUT_MIN, TIMEOUT_MAX) != expected &&
+          POT_Map(STEP_CENTRE + NOISE_CODES, TIMEOUT_MIN, TIMEOUT_MAX) != expected,
+          "noise does not reach the neighbouring steps");
+    DelayMs((ADC_BUFFER_SIZE + 1U) * ADC_SAMPLE_PERIOD_MS);
+
+    end = (uint32_t)Time_NowMs() + NOISE_RUN_MS;
+    while (!Time_Reached32((uint32_t)Time_NowMs(), end)) {
+        uint16_t value = POT_ReadFiltered();
+
+        if (Distance(value, STEP_CENTRE) > worst) {
+            worst = Distance(value, STEP_CENTRE);
+        }
+        if (POT_Map(value, TIMEOUT_MIN, TIMEOUT_MAX) != expected) {
+            changes++;
+        }
+        DelayMs(POLL_MS);
+    }
+
+    printf("noise +/-%u codes: filtered within +/-%u codes\n",
+           (unsigned)NOISE_CODES, (unsigned)worst);
+    CHECK(worst <= MAX_FILTER_ERROR, "filtered value off by %u codes", (unsigned)worst);
+    CHECK(changes == 0U, "mapped timeout left %u s %u times", (unsigned)expected,
+          (unsigned)changes);
+}
+
+static void TestStep(void)
+{
+    uint32_t settleMs = (ADC_BUFFER_SIZE + 1U) * ADC_SAMPLE_PERIOD_MS;
+    uint32_t start;
+    uint16_t previous;
+    bool settled = false;
+
+    s_noise = 0U;
+    s_level = STEP_FROM;
+    DelayMs(settleMs);
+    CHECK(POT_ReadFiltered() == STEP_FROM, "read %u before the step", (unsigned)POT_ReadFiltered());
+
+    s_level = STEP_TO;
+    start = (uint32_t)Time_NowMs();
+    previous = POT_ReadFiltered();
+    while ((uint32_t)Time_NowMs() - start <= settleMs) {
+        uint16_t value = POT_ReadFiltered();
+
+        CHECK(value >= previous && value <= STEP_TO, "%u after %u", (unsigned)value,
+              (unsigned)previous);
+        if (value == STEP_TO) {
+            settled = true;
+            break;
+        }
+        previous = value;
+        DelayMs(1);
+    }
+    CHECK(settled, "still at %u after %u ms", (unsigned)POT_ReadFiltered(), (unsigned)settleMs);
+}
+
+static void TestIsrCost(void)
+{
+    uint32_t taken = SimNvic_Taken(SS0_VECTOR);
+    uint32_t perIsr = (taken != 0U) ? (uint32_t)(SimNvic_Cycles(SS0_VECTOR) / taken) : 0U;
+
+    printf("SS0 interrupt: %u cycles every %u ms (%.3f%% CPU)\n", (unsigned)perIsr,
+           (unsigned)ADC_SAMPLE_PERIOD_MS, 100.0 * perIsr / CYCLES_PER_PERIOD);
+    CHECK(perIsr * 100U < CYCLES_PER_PERIOD, "SS0 interrupt costs %u cycles", (unsigned)perIsr);
+}
+
+static void TestFilterEdges(void)
+{
+    POT_Filter filter;
+    uint16_t h = POT_DEFAULT_HYSTERESIS;
+
+    POT_FilterInit(&filter, TIMEOUT_MIN, TIMEOUT_MAX, 0U, h);
+    CHECK(POT_FilterUpdate(&filter, 900U) && POT_FilterValue(&filter) == 10U,
+          "first reading gave %u", (unsigned)POT_FilterValue(&filter));
+    CHECK(!POT_FilterUpdate(&filter, (uint16_t)(EDGE_10_11 + h - 1U)),
+          "left 10 s inside the dead band");
+    CHECK(POT_FilterUpdate(&filter, (uint16_t)(EDGE_10_11 + h)) && POT_FilterValue(&filter) == 11U,
+          "did not move to 11 s past the dead band (%u)", (unsigned)POT_FilterValue(&filter));
+    CHECK(!POT_FilterUpdate(&filter, (uint16_t)(EDGE_10_11 - h)),
+          "left 11 s inside the dead band");
+    CHECK(POT_FilterUpdate(&filter, (uint16_t)(EDGE_10_11 - h - 1U)) && POT_FilterValue(&filter) == 10U,
+          "did not move back to 10 s (%u)", (unsigned)POT_FilterValue(&filter));
+    CHECK(POT_FilterUpdate(&filter, 100U) && POT_FilterValue(&filter) == TIMEOUT_MIN,
+          "large move gave %u", (unsigned)POT_FilterValue(&filter));
+    CHECK(POT_FilterUpdate(&filter, ADC_MAX_VALUE - h) && POT_FilterValue(&filter) == TIMEOUT_MAX,
+          "near full scale gave %u", (unsigned)POT_FilterValue(&filter));
+
+    POT_FilterInit(&filter, TIMEOUT_MIN, TIMEOUT_MAX, 2U, 0U);
+    (void)POT_FilterUpdate(&filter, 0U);
+    (void)POT_FilterUpdate(&filter, 4000U);
+    CHECK(filter.smoothed == (1000UL << POT_SMOOTH_FRACTION), "average %u/16 after one step",
+          (unsigned)filter.smoothed);
+}
+
+/*
+ * RunTrace
+ * Feeds a trace to a filter and counts how often, and which way, the
+ * output changed.
+ */
+static TraceResult RunTrace(const uint16_t *trace, uint32_t length, uint32_t from, uint32_t to,
+                            uint8_t smoothingShift, uint16_t hysteresis)
+{
+    POT_Filter filter;
+    TraceResult result = {0U, 0U, 0U, 0U};
+    int32_t direction = 0;
+    uint32_t i;
+
+    POT_FilterInit(&filter, TIMEOUT_MIN, TIMEOUT_MAX, smoothingShift, hysteresis);
+    for (i = from; i < to && i < length; i++) {
+        uint32_t previous = POT_FilterValue(&filter);
+
+        if (!POT_FilterUpdate(&filter, trace[i])) {
+            continue;
+        }
+        if (i == from) {
+            result.first = POT_FilterValue(&filter);
+            continue;
+        }
+        result.changes++;
+        if ((POT_FilterValue(&filter) > previous && direction < 0) ||
+            (POT_FilterValue(&filter) < previous && direction > 0)) {
+            result.reversals++;
+        }
+        direction = (POT_FilterValue(&filter) > previous) ? 1 : -1;
+    }
+    result.last = POT_FilterValue(&filter);
+    return result;
+}
+
+static void TestTraces(void)
+{
+    uint32_t rest = TRACE_LENGTH(g_traceRest);
+    uint32_t turn = TRACE_LENGTH(g_traceTurn);
+    uint32_t sweep = TRACE_LENGTH(g_traceSweep);
+    TraceResult raw;
+    TraceResult filtered;
+
+    raw = RunTrace(g_traceRest, rest, 0U, rest, 0U, 0U);
+    filtered = RunTrace(g_traceRest, rest, 0U, rest, POT_DEFAULT_SMOOTHING, POT_DEFAULT_HYSTERESIS);
+    printf("trace at rest on a step edge: %u changes unfiltered, %u filtered\n",
+           (unsigned)raw.changes, (unsigned)filtered.changes);
+    CHECK(raw.changes > 0U, "rest trace does not cross the edge");
+    CHECK(filtered.changes == 0U, "%u changes at rest", (unsigned)filtered.changes);
+
+    raw = RunTrace(g_traceTurn, turn, 0U, turn, 0U, 0U);
+    filtered = RunTrace(g_traceTurn, turn, 0U, turn, POT_DEFAULT_SMOOTHING, POT_DEFAULT_HYSTERESIS);
+    printf("trace turned 10 s -> 20 s: %u changes unfiltered, %u filtered\n",
+           (unsigned)raw.changes, (unsigned)filtered.changes);
+    CHECK(filtered.first == 10U && filtered.last == 20U, "went from %u to %u",
+          (unsigned)filtered.first, (unsigned)filtered.last);
+    CHECK(filtered.changes == 10U && filtered.reversals == 0U, "%u changes, %u reversals",
+          (unsigned)filtered.changes, (unsigned)filtered.reversals);
+
+    filtered = RunTrace(g_traceSweep, sweep, 0U, sweep / 2U, POT_DEFAULT_SMOOTHING,
+                        POT_DEFAULT_HYSTERESIS);
+    CHECK(filtered.first == TIMEOUT_MIN && filtered.last == TIMEOUT_MAX &&
+          filtered.changes == TIMEOUT_MAX - TIMEOUT_MIN && filtered.reversals == 0U,
+          "sweep up: %u to %u in %u changes, %u reversals", (unsigned)filtered.first,
+          (unsigned)filtered.last, (unsigned)filtered.changes, (unsigned)filtered.reversals);
+    filtered = RunTrace(g_traceSweep, sweep, sweep / 2U, sweep, POT_DEFAULT_SMOOTHING,
+                        POT_DEFAULT_HYSTERESIS);
+    CHECK(filtered.first == TIMEOUT_MAX && filtered.last == TIMEOUT_MIN &&
+          filtered.changes == TIMEOUT_MAX - TIMEOUT_MIN && filtered.reversals == 0U,
+          "sweep down: %u to %u in %u changes, %u reversals", (unsigned)filtered.first,
+          (unsigned)filtered.last, (unsigned)filtered.changes, (unsigned)filtered.reversals);
+}
+
+static void TestReadStable(void)
+{
+    POT_Filter filter;
+    uint32_t changes = 0U;
+    uint32_t end;
+
+    s_level = EDGE_9_10;
+    s_noise = NOISE_CODES;
+    DelayMs((ADC_BUFFER_SIZE + 1U) * ADC_SAMPLE_PERIOD_MS);
+
+    POT_FilterInit(&filter, TIMEOUT_MIN, TIMEOUT_MAX, POT_DEFAULT_SMOOTHING,
+                   POT_DEFAULT_HYSTERESIS);
+    end = (uint32_t)Time_NowMs() + NOISE_RUN_MS;
+    while (!Time_Reached32((uint32_t)Time_NowMs(), end)) {
+        if (POT_ReadStable(&filter)) {
+            changes++;
+        }
+        DelayMs(POLL_MS);
+    }
+    CHECK(changes == 1U, "%u changes at rest on a step edge", (unsigned)changes);
+}
+
+static int PotApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    POT_Init();
+
+    CHECK(POT_ReadFiltered() == 0U, "value before the first sequence");
+    TestSequences();
+    TestNonBlocking();
+    TestNoise();
+    TestStep();
+    TestIsrCost();
+    TestFilterEdges();
+    TestTraces();
+    TestReadStable();
+
+    s_done = true;
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    SimAdc_SetSource(NoisySource);
+    Sim_Boot(PotApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(60000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
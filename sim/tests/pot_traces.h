@@ -0,0 +1,114 @@
+/******************************************************************************
+ * File: pot_traces.h
+ * Module: Potentiometer sampling host test
+ * Description: POT_ReadFiltered readings for the mapped-value filter tests
+ *
+ * Recorded from the simulator every 20 ms (the timeout screen's poll
+ * rate). The input had +/-120 codes of uniform noise and a +400 code
+ * wiper glitch of 3 ms about once a second.
+ *   g_traceRest:  knob left on the 9 s / 10 s edge (code 788), +/-2 codes
+ *                 of slow drift, 6 s
+ *   g_traceTurn:  1 s at code 900 (10 s), turned to 2500 (20 s) over 1 s,
+ *                 then left there for 2 s
+ *   g_traceSweep: 0 to 4095 and back, 5 s each way
+ ******************************************************************************/
+
+#ifndef POT_TRACES_H_
+#define POT_TRACES_H_
+
+#include <stdint.h>
+
+static const uint16_t g_traceRest[] = {
+     785,  785,  786,  787,  789,  789,  789,  787,  787,  786,  785,  788,
+     785,  785,  785,  784,  786,  786,  787,  788,  789,  790,  792,  793,
+     791,  791,  788,  789,  790,  791,  791,  786,  785,  784,  784,  787,
+     788,  789,  790,  792,  792,  791,  791,  788,  785,  786,  787,  789,
+     789,  789,  789,  788,  789,  789,  789,  790,  791,  791,  790,  789,
+     789,  791,  791,  791,  790,  790,  790,  790,  791,  792,  793,  794,
+     793,  791,  792,  790,  793,  792,  791,  791,  790,  789,  791,  790,
+     790,  792,  790,  790,  788,  788,  790,  791,  793,  792,  793,  791,
+     789,  788,  786,  788,  788,  790,  788,  789,  791,  789,  791,  789,
+     789,  791,  792,  792,  790,  787,  787,  788,  788,  789,  788,  786,
+     788,  787,  786,  787,  787,  788,  788,  789,  789,  787,  787,  786,
+     786,  787,  787,  786,  787,  789,  787,  789,  788,  785,  788,  786,
+     786,  788,  787,  788,  789,  791,  791,  790,  790,  788,  788,  787,
+     785,  787,  789,  787,  787,  783,  781,  781,  784,  787,  788,  790,
+     786,  785,  784,  784,  786,  787,  788,  788,  787,  787,  784,  784,
+     783,  783,  784,  785,  786,  787,  787,  785,  784,  835,  838,  838,
+     838,  785,  782,  784,  785,  788,  789,  787,  784,  782,  781,  781,
+     784,  785,  787,  789,  788,  789,  787,  786,  786,  786,  788,  787,
+     789,  788,  787,  786,  785,  784,  783,  786,  786,  784,  785,  784,
+     783,  784,  784,  783,  784,  786,  788,  788,  788,  788,  786,  785,
+     784,  785,  785,  785,  787,  784,  788,  790,  790,  791,  789,  787,
+     787,  786,  785,  785,  786,  786,  786,  788,  786,  786,  784,  783,
+     782,  784,  787,  790,  791,  789,  788,  786,  785,  786,  787,  789,
+     789,  789,  790,  788,  789,  787,  787,  787,  788,  789,  789,  790,
+     790,  790,  791,  790,  788,  788,  787,  789,  791,  792,  792,  792
+};
+
+static const uint16_t g_traceTurn[] = {
+     899,  898,  899,  898,  897,  898,  896,  896,  897,  898,  900,  899,
+     899,  898,  898,  899,  897,  898,  897,  898,  901,  903,  900,  902,
+     901,  900,  903,  901,  902,  955,  954,  956,  954,  900,  900,  899,
+     896,  898,  896,  897,  898,  898,  900,  900,  903,  905,  905,  905,
+     902,  899,  899,  905,  920,  946,  979, 1011, 1046, 1077, 1109, 1142,
+    1173, 1205, 1236, 1267, 1298, 1332, 1361, 1393, 1424, 1455, 1487, 1521,
+    1556, 1591, 1625, 1656, 1687, 1719, 1749, 1782, 1812, 1845, 1879, 1910,
+    1942, 1972, 1999, 2031, 2064, 2099, 2133, 2165, 2194, 2225, 2257, 2288,
+    2322, 2354, 2386, 2419, 2452, 2474, 2491, 2500, 2500, 2500, 2501, 2499,
+    2499, 2497, 2498, 2499, 2499, 2501, 2501, 2500, 2499, 2499, 2496, 2497,
+    2498, 2497, 2497, 2496, 2496, 2499, 2501, 2501, 2501, 2501, 2501, 2504,
+    2504, 2505, 2505, 2501, 2502, 2502, 2500, 2502, 2500, 2501, 2500, 2501,
+    2500, 2500, 2501, 2502, 2503, 2500, 2498, 2496, 2496, 2497, 2498, 2499,
+    2497, 2497, 2499, 2499, 2500, 2501, 2500, 2500, 2500, 2499, 2499, 2501,
+    2499, 2499, 2501, 2500, 2501, 2502, 2500, 2502, 2501, 2502, 2552, 2551,
+    2550, 2550, 2500, 2499, 2502, 2503, 2502, 2502, 2499, 2497, 2497, 2500,
+    2501, 2502, 2501, 2499, 2500, 2499, 2501, 2502
+};
+
+static const uint16_t g_traceSweep[] = {
+      30,   33,   38,   45,   55,   65,   79,   95,  109,  126,  141,  154,
+     172,  188,  204,  223,  238,  255,  271,  286,  300,  314,  334,  351,
+     370,  388,  401,  418,  432,  447,  466,  482,  502,  520,  536,  553,
+     568,  584,  601,  618,  634,  651,  667,  683,  701,  717,  735,  752,
+     770,  786,  802,  818,  832,  852,  867,  882,  899,  912,  931,  950,
+     968,  982,  996, 1009, 1026, 1043, 1059, 1077, 1091, 1107, 1126, 1144,
+    1161, 1177, 1194, 1210, 1225, 1241, 1255, 1270, 1288, 1307, 1326, 1342,
+    1358, 1373, 1389, 1405, 1422, 1438, 1452, 1470, 1487, 1504, 1522, 1539,
+    1555, 1570, 1588, 1603, 1620, 1638, 1652, 1671, 1687, 1705, 1721, 1736,
+    1756, 1773, 1789, 1805, 1818, 1832, 1848, 1864, 1879, 1896, 1914, 1932,
+    1949, 1966, 1984, 1999, 2017, 2033, 2048, 2066, 2082, 2099, 2114, 2126,
+    2142, 2158, 2177, 2197, 2214, 2231, 2247, 2263, 2276, 2292, 2309, 2325,
+    2343, 2361, 2377, 2393, 2408, 2423, 2439, 2458, 2477, 2493, 2510, 2524,
+    2541, 2560, 2576, 2592, 2607, 2622, 2639, 2656, 2671, 2685, 2701, 2716,
+    2783, 2801, 2818, 2837, 2804, 2818, 2837, 2852, 2870, 2889, 2905, 2923,
+    2937, 2956, 2969, 2983, 3001, 3015, 3035, 3055, 3071, 3085, 3099, 3112,
+    3127, 3147, 3164, 3183, 3199, 3215, 3231, 3247, 3265, 3282, 3301, 3316,
+    3332, 3346, 3362, 3379, 3394, 3410, 3426, 3443, 3460, 3475, 3492, 3509,
+    3526, 3544, 3560, 3577, 3593, 3610, 3627, 3644, 3661, 3675, 3691, 3706,
+    3721, 3738, 3754, 3770, 3788, 3807, 3824, 3839, 3856, 3873, 3890, 3910,
+    3926, 3943, 3961, 3973, 3986, 4001, 4014, 4028, 4041, 4050, 4058, 4061,
+    4059, 4053, 4042, 4029, 4016, 4001, 3985, 3969, 3952, 3935, 3920, 3904,
+    3889, 3874, 3857, 3841, 3824, 3806, 3791, 3773, 3757, 3742, 3725, 3709,
+    3692, 3675, 3660, 3643, 3628, 3610, 3593, 3579, 3562, 3547, 3530, 3511,
+    3495, 3477, 3463, 3448, 3432, 3416, 3397, 3380, 3364, 3345, 3332, 3315,
+    3295, 3282, 3265, 3247, 3230, 3211, 3193, 3178, 3165, 3151, 3134, 3117,
+    3100, 3082, 3067, 3051, 3034, 3070, 3052, 3037, 3024, 2956, 2941, 2924,
+    2905, 2887, 2869, 2855, 2839, 2823, 2806, 2787, 2769, 2753, 2735, 2720,
+    2703, 2687, 2673, 2657, 2643, 2626, 2609, 2593, 2576, 2557, 2541, 2523,
+    2505, 2491, 2473, 2457, 2442, 2425, 2409, 2395, 2379, 2364, 2348, 2328,
+    2311, 2291, 2275, 2259, 2241, 2225, 2208, 2193, 2177, 2161, 2145, 2127,
+    2111, 2094, 2079, 2064, 2049, 2034, 2017, 1999, 1982, 1964, 1946, 1932,
+    1913, 1898, 1884, 1868, 1852, 1834, 1816, 1798, 1784, 1767, 1752, 1735,
+    1717, 1701, 1684, 1667, 1652, 1636, 1620, 1603, 1587, 1571, 1555, 1540,
+    1523, 1506, 1488, 1472, 1455, 1438, 1423, 1403, 1387, 1372, 1357, 1343,
+    1325, 1308, 1289, 1272, 1259, 1241, 1226, 1210, 1191, 1176, 1163, 1144,
+    1129, 1112, 1093, 1076, 1058, 1042, 1026, 1012,  995,  979,  963,  946,
+     929,  911,  895,  879,  863,  847,  828,  813,  798,  781,  765,  744,
+     727,  713,  697,  684,  668,  649,  632,  614,  596,  580,  565,  601,
+     586,  568,  552,  483,  467,  453,  436,  420,  404,  386,  371,  355,
+     337,  322,  302,  285,  268,  252,  237,  221,  206,  189,  175,  157,
+     139,  122,  107,   93,   80,   68,   56,   46
+};
+
+#endif /* POT_TRACES_H_ */
@@ -0,0 +1,338 @@
+/******************************************************************************
+ * File: powercut_test.c
+ * Module: Settings power-fail host test
+ * Description: Cuts power at every EEPROM write boundary of each commit
+ *
+ * For each scenario the harness builds a starting EEPROM image, runs the
+ * operation once to count the words it programs (N), then for every k
+ * from 0 to N restores the image, boots, cuts power after k words of the
+ * operation, and boots again. Checks:
+ *   1. Before the commit word (k < N) every setting reads as before the
+ *      operation; once it is written (k = N), every setting reads as
+ *      after it. No cut leaves a mix, a half-written password or a
+ *      password without its valid flag. An erase commits with the first
+ *      word of the newest record it erases, the oldest records going
+ *      first, so no cut brings back an older password.
+ *   2. After any cut the next commit succeeds and survives a reboot.
+ *   3. A record of another key being moved by compaction is readable at
+ *      every cut, and a cut while settings from the old block 0 layout are
+ *      moved into the log loses nothing.
+ *
+ * Scenarios: first password on a blank EEPROM, password change, timeout
+ * change, both in one flush, a commit that wraps from the last slot to
+ * the first, the old-layout move at boot, a compaction step, and erases
+ * of a fresh and of a full log.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_eeprom.h"
+#include "systick.h"
+#include "eeprom.h"
+#include "config.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TOTAL_WORDS         (EEPROM_TOTAL_SIZE / EEPROM_WORD_SIZE)
+#define OTHER_KEY           5U          /* A key config.c does not use */
+#define OTHER_VALUE         0x0DDBA11U
+#define NO_VALUE            0xFFFFFFFFU
+
+/* What a boot sees */
+typedef struct {
+    bool hasPassword;
+    char password[PASSWORD_LENGTH + 1];
+    uint8_t timeout;
+    uint32_t other;                     /* OTHER_KEY's value, NO_VALUE if none */
+} Settings;
+
+typedef struct {
+    const char *name;
+    void (*prepare)(void);              /* Builds the starting image */
+    void (*operation)(void);            /* Boots and commits */
+    uint32_t commitWords;               /* Trailing words any of which commits */
+} Scenario;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_image[TOTAL_WORDS];
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint64_t TotalWrites(void)
+{
+    uint64_t total = 0U;
+    uint32_t i;
+
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        total += SimEeprom_WriteCount(i);
+    }
+    return total;
+}
+
+static void SaveImage(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        s_image[i] = SimEeprom_Read(i);
+    }
+}
+
+static void RestoreImage(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TOTAL_WORDS; i++) {
+        if (SimEeprom_Read(i) != s_image[i]) {
+            SimEeprom_Program(i, s_image[i]);
+        }
+    }
+}
+
+/*
+ * Boot
+ * What the Control ECU knows after a reset.
+ */
+static Settings Boot(void)
+{
+    Settings settings;
+    uint32_t other;
+
+    Config_Load();
+    settings.hasPassword = Config_HasPassword();
+    memset(settings.password, 0, sizeof(settings.password));
+    strncpy(settings.password, Config_GetPassword(), PASSWORD_LENGTH);
+    settings.timeout = Config_GetTimeout();
+    settings.other = (EEPROM_LogGet(OTHER_KEY, &other, 1U) == 1U) ? other : NO_VALUE;
+    return settings;
+}
+
+static bool Same(const Settings *a, const Settings *b)
+{
+    return a->hasPassword == b->hasPassword && strcmp(a->password, b->password) == 0 &&
+           a->timeout == b->timeout && a->other == b->other;
+}
+
+static void Commit(const char *password, uint8_t timeout)
+{
+    if (password != NULL) {
+        Config_SetPassword(password);
+    }
+    if (timeout != 0U) {
+        Config_SetTimeout(timeout);
+    }
+    (void)Config_Flush();
+}
+
+/* Starting images */
+
+static void PrepareBlank(void)
+{
+    (void)Config_Erase();
+}
+
+static void PrepareSet(void)
+{
+    (void)Config_Erase();
+    Commit("11111", 10U);
+}
+
+static void PrepareLastSlot(void)
+{
+    uint32_t i;
+
+    (void)Config_Erase();
+    for (i = 0; i < (EEPROM_LOG_SLOTS - 2U); i++) {
+        Commit("11111", (uint8_t)(CONFIG_TIMEOUT_MIN + (i % 2U)));
+    }
+    /* The newest record is in the last slot; the next commit wraps */
+    Commit("11111", 10U);
+}
+
+static void PrepareLegacy(void)
+{
+    SimEeprom_Erase();
+    SimEeprom_Program(0U, ((uint32_t)'2' << 24) | ((uint32_t)'4' << 16) |
+                          ((uint32_t)'6' << 8) | (uint32_t)'8');
+    SimEeprom_Program(1U, (uint32_t)'0' << 24);
+    SimEeprom_Program(2U, 12U);
+    SimEeprom_Program(3U, CONFIG_VALID_MARKER);
+}
+
+static void PrepareCompact(void)
+{
+    uint32_t other = OTHER_VALUE;
+    uint32_t i;
+
+    (void)Config_Erase();
+    Commit("11111", 10U);
+    (void)EEPROM_LogPut(OTHER_KEY, &other, 1U);
+    /* Go round until the other key's record is just ahead */
+    for (i = 0; i < (EEPROM_LOG_SLOTS - 3U); i++) {
+        Commit("11111", (uint8_t)(CONFIG_TIMEOUT_MIN + (i % 2U)));
+    }
+}
+
+/* Operations */
+
+static void SetFirstPassword(void)
+{
+    (void)Boot();
+    Commit("13579", 0U);
+}
+
+static void ChangePassword(void)
+{
+    (void)Boot();
+    Commit("97531", 0U);
+}
+
+static void ChangeTimeout(void)
+{
+    (void)Boot();
+    Commit(NULL, 25U);
+}
+
+static void ChangeBoth(void)
+{
+    (void)Boot();
+    Commit("24680", 30U);
+}
+
+static void BootOnly(void)
+{
+    (void)Boot();
+}
+
+static void CompactStep(void)
+{
+    (void)Boot();
+    (void)Config_Compact();
+    (void)EEPROM_Sync();
+}
+
+static void Erase(void)
+{
+    (void)Boot();
+    (void)Config_Erase();
+}
+
+static const Scenario s_scenarios[] = {
+    { "first password",      PrepareBlank,    SetFirstPassword, 1U },
+    { "password change",     PrepareSet,      ChangePassword,   1U },
+    { "timeout change",      PrepareSet,      ChangeTimeout,    1U },
+    { "both in one flush",   PrepareSet,      ChangeBoth,       1U },
+    { "wrap to slot 0",      PrepareLastSlot, ChangeBoth,       1U },
+    { "old layout at boot",  PrepareLegacy,   BootOnly,         1U },
+    { "compaction step",     PrepareCompact,  CompactStep,      1U },
+    { "erase one record",    PrepareSet,      Erase,            EEPROM_LOG_SLOT_WORDS },
+    { "erase full log",      PrepareLastSlot, Erase,            EEPROM_LOG_SLOT_WORDS },
+};
+
+/*
+ * RunScenario
+ * Cuts power after every word the operation programs.
+ * Returns: number of cut points tried
+ */
+static uint32_t RunScenario(const Scenario *scenario)
+{
+    Settings before;
+    Settings after;
+    Settings seen;
+    uint64_t start;
+    uint32_t words;
+    uint32_t k;
+
+    scenario->prepare();
+    SaveImage();
+    before = Boot();
+    RestoreImage();
+
+    start = TotalWrites();
+    scenario->operation();
+    words = (uint32_t)(TotalWrites() - start);
+    after = Boot();
+    CHECK(words > 0U, "%s: operation wrote nothing", scenario->name);
+
+    for (k = 0; k <= words; k++) {
+        RestoreImage();
+        SimEeprom_CutPowerAfter(k);
+        scenario->operation();
+        SimEeprom_RestorePower();
+
+        seen = Boot();
+        CHECK(Same(&seen, (k + scenario->commitWords <= words) ? &before : &after),
+              "%s: cut after %u of %u words: %d \"%s\" %u 0x%X", scenario->name, (unsigned)k,
+              (unsigned)words, (int)seen.hasPassword, seen.password, (unsigned)seen.timeout,
+              (unsigned)seen.other);
+        CHECK(seen.hasPassword == (seen.password[0] != '\0'),
+              "%s: cut after %u: password flag and password disagree", scenario->name, (unsigned)k);
+
+        Commit("55555", 15U);
+        seen = Boot();
+        CHECK(seen.hasPassword && strcmp(seen.password, "55555") == 0 && seen.timeout == 15U,
+              "%s: cut after %u: next commit lost", scenario->name, (unsigned)k);
+    }
+
+    printf("%-20s %2u words, %2u cut points\n", scenario->name, (unsigned)words,
+           (unsigned)(words + 1U));
+    return words + 1U;
+}
+
+static int PowerCutApp_Main(void)
+{
+    uint32_t cuts = 0U;
+    uint32_t i;
+
+    SysTick_Init(16000, SYSTICK_INT);
+    EEPROM_Init();
+
+    for (i = 0; i < (sizeof(s_scenarios) / sizeof(s_scenarios[0])); i++) {
+        cuts += RunScenario(&s_scenarios[i]);
+    }
+    printf("%u power cuts\n", (unsigned)cuts);
+
+    s_done = true;
+    Sim_Wake();
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(PowerCutApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(600000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
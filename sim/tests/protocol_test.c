@@ -0,0 +1,302 @@
+/******************************************************************************
+ * File: protocol_test.c
+ * Module: Protocol host test
+ * Description: Frame encoder, CRC-16 and parser resynchronisation
+ *
+ * Checks:
+ *   1. CRC-16/CCITT-FALSE gives the standard check value 0x29B1.
+ *   2. Every payload length round-trips through Proto_Encode/Proto_Parse.
+ *   3. After a flipped bit or a dropped byte the very next frame is
+ *      recovered, even when it starts inside the damaged one. When the
+ *      resync finds two complete frames held behind a corrupt prefix,
+ *      Proto_ParsePending() reports the second without another byte.
+ *   4. A long stream with random damage never yields a frame that was not
+ *      sent, and every undamaged frame is delivered.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "protocol.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define FUZZ_FRAMES         20000U
+#define FUZZ_DAMAGE_PERCENT 10U
+#define STREAM_SIZE         (FUZZ_FRAMES * PROTO_MAX_FRAME)
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_random = 12345U;
+
+static uint8_t s_stream[STREAM_SIZE];
+static bool s_damaged[FUZZ_FRAMES];
+static bool s_delivered[FUZZ_FRAMES];
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint32_t Random(void)
+{
+    s_random = s_random * 1103515245U + 12345U;
+    return s_random >> 8;
+}
+
+/*
+ * MakeFrame
+ * Frame n of a test stream: the sequence number and payload identify it.
+ */
+static uint8_t MakeFrame(uint8_t *buffer, uint32_t n)
+{
+    uint8_t payload[PROTO_MAX_PAYLOAD];
+    uint8_t length = (uint8_t)(n % (PROTO_MAX_PAYLOAD + 1U));
+    uint8_t i;
+
+    for (i = 0; i < length; i++) {
+        payload[i] = (uint8_t)(n >> (8U * (i % 2U)));
+    }
+    if (length > 0U) {
+        payload[0] = PROTO_SOF;     /* An SOF inside every payload */
+    }
+    return Proto_Encode(buffer, (uint8_t)n, (uint8_t)(n >> 8), payload, length);
+}
+
+static bool SameFrame(const Proto_Frame *frame, uint32_t n)
+{
+    uint8_t expected[PROTO_MAX_FRAME];
+    uint8_t size = MakeFrame(expected, n);
+
+    return frame->seq == expected[2] && frame->type == expected[3] &&
+           frame->length == (uint8_t)(size - PROTO_HEADER_SIZE - PROTO_CRC_SIZE) &&
+           memcmp(frame->payload, &expected[PROTO_HEADER_SIZE], frame->length) == 0;
+}
+
+static void TestCrc(void)
+{
+    const uint8_t check[] = "123456789";
+    uint16_t crc = Proto_Crc16(PROTO_CRC_INIT, check, 9U);
+
+    CHECK(crc == 0x29B1U, "CRC of \"123456789\" is 0x%04X, expected 0x29B1", crc);
+}
+
+static void TestRoundTrip(void)
+{
+    Proto_Parser parser;
+    uint8_t frame[PROTO_MAX_FRAME];
+    uint32_t n;
+
+    Proto_ParserInit(&parser);
+    for (n = 0; n <= PROTO_MAX_PAYLOAD; n++) {
+        uint8_t size = MakeFrame(frame, n);
+        uint32_t complete = 0U;
+        uint8_t i;
+
+        for (i = 0; i < size; i++) {
+            if (Proto_Parse(&parser, frame[i])) {
+                complete++;
+                CHECK(i == size - 1U, "length %u completed at byte %u of %u",
+                      (unsigned)n, (unsigned)i, (unsigned)size);
+                CHECK(SameFrame(&parser.frame, n), "length %u decoded wrongly", (unsigned)n);
+            }
+        }
+        CHECK(complete == 1U, "length %u: %u frames", (unsigned)n, (unsigned)complete);
+    }
+    CHECK(parser.errors == 0U, "%u errors on clean frames", (unsigned)parser.errors);
+
+    CHECK(Proto_Encode(frame, 0U, 0U, frame, PROTO_MAX_PAYLOAD + 1U) == 0U,
+          "oversized payload encoded");
+}
+
+/*
+ * Resync
+ * Sends a damaged frame, then a good one. Returns how many bytes of the
+ * good frame had to be received before it was reported (its full size
+ * when nothing beyond the damaged frame was lost).
+ */
+static uint32_t Resync(bool dropByte, uint32_t *errors)
+{
+    Proto_Parser parser;
+    uint8_t bad[PROTO_MAX_FRAME];
+    uint8_t good[PROTO_MAX_FRAME];
+    uint8_t badSize = MakeFrame(bad, 16U);
+    uint8_t goodSize = MakeFrame(good, 5U);
+    uint8_t i;
+
+    Proto_ParserInit(&parser);
+    for (i = 0; i < badSize; i++) {
+        if (dropByte && i == 6U) {
+            continue;
+        }
+        if (!dropByte && i == 6U) {
+            bad[i] ^= 0x10U;
+        }
+        CHECK(!Proto_Parse(&parser, bad[i]), "damaged frame accepted");
+    }
+    for (i = 0; i < goodSize; i++) {
+        if (Proto_Parse(&parser, good[i])) {
+            CHECK(SameFrame(&parser.frame, 5U), "wrong frame after resync");
+            *errors = parser.errors;
+            return i + 1U;
+        }
+    }
+    *errors = parser.errors;
+    return 0U;
+}
+
+static void TestResync(void)
+{
+    uint8_t good[PROTO_MAX_FRAME];
+    uint32_t goodSize = MakeFrame(good, 5U);
+    uint32_t errors;
+    uint32_t bytes;
+
+    bytes = Resync(false, &errors);
+    CHECK(bytes == goodSize, "flipped bit: next frame after %u bytes, expected %u",
+          (unsigned)bytes, (unsigned)goodSize);
+    CHECK(errors >= 1U, "flipped bit not counted");
+    printf("flipped bit: next frame recovered, %u rejected start(s)\n", (unsigned)errors);
+
+    bytes = Resync(true, &errors);
+    CHECK(bytes == goodSize, "dropped byte: next frame after %u bytes, expected %u",
+          (unsigned)bytes, (unsigned)goodSize);
+    CHECK(errors >= 1U, "dropped byte not counted");
+    printf("dropped byte: next frame recovered, %u rejected start(s)\n", (unsigned)errors);
+}
+
+/*
+ * TestBackToBack
+ * A corrupt prefix claims a frame as long as the two good frames behind
+ * it, so its CRC fails on the last byte of the second one. Both must be
+ * reported by then.
+ */
+static void TestBackToBack(void)
+{
+    Proto_Parser parser;
+    uint8_t stream[2U + (2U * PROTO_MAX_FRAME)];
+    uint32_t reported[2];
+    uint32_t found = 0U;
+    uint32_t length = 0U;
+    uint32_t i;
+
+    stream[length++] = PROTO_SOF;
+    stream[length++] = 16U;                 /* Ends with the second frame */
+    length += MakeFrame(&stream[length], 4U);
+    length += MakeFrame(&stream[length], 21U);
+    CHECK(length == PROTO_HEADER_SIZE + 16U + PROTO_CRC_SIZE, "prefix does not span both frames");
+
+    Proto_ParserInit(&parser);
+    for (i = 0; i < length; i++) {
+        if (!Proto_Parse(&parser, stream[i])) {
+            continue;
+        }
+        do {
+            if (found < 2U) {
+                reported[found] = SameFrame(&parser.frame, 4U) ? 4U :
+                                  SameFrame(&parser.frame, 21U) ? 21U : 0U;
+            }
+            found++;
+        } while (Proto_ParsePending(&parser));
+    }
+    CHECK(found == 2U, "%u of 2 frames reported behind a corrupt prefix", (unsigned)found);
+    CHECK(found < 2U || (reported[0] == 4U && reported[1] == 21U), "frames reported as %u, %u",
+          (unsigned)reported[0], (unsigned)reported[1]);
+    CHECK(parser.count == 0U, "%u bytes still held", (unsigned)parser.count);
+    printf("corrupt prefix: %u back-to-back frames reported, %u rejected start(s)\n",
+           (unsigned)found, (unsigned)parser.errors);
+}
+
+static void TestFuzz(void)
+{
+    Proto_Parser parser;
+    uint32_t length = 0U;
+    uint32_t damaged = 0U;
+    uint32_t delivered = 0U;
+    uint32_t lost = 0U;
+    uint32_t bogus = 0U;
+    uint32_t next = 0U;
+    uint32_t n;
+    uint32_t i;
+
+    for (n = 0; n < FUZZ_FRAMES; n++) {
+        uint8_t size = MakeFrame(&s_stream[length], n);
+
+        s_damaged[n] = (Random() % 100U) < FUZZ_DAMAGE_PERCENT;
+        if (s_damaged[n]) {
+            uint32_t at = Random() % size;
+
+            damaged++;
+            if ((Random() & 1U) != 0U) {
+                s_stream[length + at] ^= (uint8_t)(1U << (Random() % 8U));
+            } else {
+                memmove(&s_stream[length + at], &s_stream[length + at + 1U], size - at - 1U);
+                size--;
+            }
+        }
+        length += size;
+    }
+
+    /* Sequence numbers wrap, so match each frame against the next few sent */
+    Proto_ParserInit(&parser);
+    for (i = 0; i < length + PROTO_MAX_FRAME; i++) {
+        uint8_t byte = (i < length) ? s_stream[i] : 0U;
+        uint32_t k;
+
+        if (!Proto_Parse(&parser, byte)) {
+            continue;
+        }
+        do {
+            for (k = next; k < FUZZ_FRAMES && k < next + 4U; k++) {
+                if (SameFrame(&parser.frame, k)) {
+                    break;
+                }
+            }
+            if (k < FUZZ_FRAMES && k < next + 4U) {
+                s_delivered[k] = true;
+                delivered++;
+                next = k + 1U;
+            } else {
+                bogus++;
+            }
+        } while (Proto_ParsePending(&parser));
+    }
+    for (n = 0; n < FUZZ_FRAMES; n++) {
+        if (!s_damaged[n] && !s_delivered[n]) {
+            lost++;
+        }
+    }
+
+    CHECK(bogus == 0U, "%u frames delivered that were never sent", (unsigned)bogus);
+    CHECK(lost == 0U, "%u undamaged frames lost", (unsigned)lost);
+
+    printf("fuzz: %u frames, %u damaged, %u delivered, %u parser errors\n",
+           (unsigned)FUZZ_FRAMES, (unsigned)damaged, (unsigned)delivered,
+           (unsigned)parser.errors);
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    TestCrc();
+    TestRoundTrip();
+    TestResync();
+    TestBackToBack();
+    TestFuzz();
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,259 @@
+/******************************************************************************
+ * File: sched_test.c
+ * Module: Cooperative scheduler host test and benchmark
+ * Description: Priority selection, event merging, dispatch latency, jitter
+ *
+ * A stand-in application runs three tasks on the scheduler:
+ *   IRQ task     highest priority, posted from an interrupt that fires at
+ *                random times (a Timer0A-style peripheral)
+ *   tick task    posted by a 1 ms periodic timer
+ *   hog task     lowest priority, posted every 3 ms, busy for up to
+ *                HOG_MAX_US each time
+ * Tasks run to completion, so a ready task waits at most for the task that
+ * is running. Checks:
+ *   1. Ready tasks run highest priority first and merged posts arrive as
+ *      one call with all their events.
+ *   2. With an idle CPU the IRQ task starts within IDLE_LATENCY_US of its
+ *      interrupt (wake from WFI plus dispatch).
+ *   3. Under load, IRQ latency and tick jitter stay below the longest hog
+ *      run plus DISPATCH_US.
+ * The latency and jitter figures are printed as the benchmark.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "systick.h"
+#include "sched.h"
+#include "driverlib/interrupt.h"
+#include "tm4c123gh6pm.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define TEST_VECTOR         35U         /* INT_TIMER0A */
+
+#define TASK_IRQ            31U
+#define TASK_TICK           20U
+#define TASK_HOG            0U
+
+#define RUN_MS              10000U
+#define HOG_PERIOD_MS       3U
+#define HOG_MAX_US          200U
+#define IRQ_MIN_GAP_US      300U
+#define IRQ_MAX_GAP_US      2000U
+
+#define IDLE_LATENCY_US     25U
+#define DISPATCH_US         30U
+
+typedef struct {
+    uint64_t count;
+    uint64_t sumUs;
+    uint64_t maxUs;
+} Stat;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_random = 11U;
+static uint64_t s_irqAt;            /* Cycle of the last test interrupt */
+static bool s_irqArmed;             /* Harness keeps raising interrupts */
+static bool s_hogOn;
+static Stat s_irqLatency;
+static Stat s_tickJitter;
+static uint8_t s_order[8];
+static uint32_t s_orderCount;
+static uint32_t s_mergedEvents;
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint32_t Random(void)
+{
+    s_random = s_random * 1103515245U + 12345U;
+    return s_random >> 8;
+}
+
+static void Record(Stat *stat, uint64_t us)
+{
+    stat->count++;
+    stat->sumUs += us;
+    if (us > stat->maxUs) {
+        stat->maxUs = us;
+    }
+}
+
+static void ResetStats(void)
+{
+    s_irqLatency = (Stat){ 0U, 0U, 0U };
+    s_tickJitter = (Stat){ 0U, 0U, 0U };
+}
+
+static void PrintStat(const char *name, const Stat *stat)
+{
+    printf("  %-22s %8llu %10.2f %8llu\n", name, (unsigned long long)stat->count,
+           stat->count != 0U ? (double)stat->sumUs / (double)stat->count : 0.0,
+           (unsigned long long)stat->maxUs);
+}
+
+/* Harness event: raises the test interrupt and schedules the next one */
+static void RaiseIrq(void *ctx)
+{
+    (void)ctx;
+    if (!s_irqArmed) {
+        return;
+    }
+    IntPendSet(TEST_VECTOR);
+    Sim_Schedule(Sim_Cycles() + SIM_US(IRQ_MIN_GAP_US + Random() % (IRQ_MAX_GAP_US - IRQ_MIN_GAP_US)),
+                 RaiseIrq, NULL);
+}
+
+static void TestIsr(void)
+{
+    s_irqAt = Sim_Cycles();
+    Sched_Post(TASK_IRQ, 0x01U);
+}
+
+static void IrqTask(uint32_t events)
+{
+    (void)events;
+    Record(&s_irqLatency, (Sim_Cycles() - s_irqAt) / SIM_CYCLES_PER_US);
+}
+
+static void TickTask(uint32_t events)
+{
+    (void)events;
+    Record(&s_tickJitter, Time_NowUs() % 1000U);
+}
+
+static void HogTask(uint32_t events)
+{
+    uint64_t until = Sim_NowUs() + (s_hogOn ? Random() % (HOG_MAX_US + 1U) : 0U);
+
+    (void)events;
+    while (Sim_NowUs() < until) {
+        (void)NVIC_ST_CURRENT_R;
+    }
+}
+
+static bool OnTimer(void *context)
+{
+    Sched_Post((uint8_t)(uintptr_t)context, 0x01U);
+    return true;
+}
+
+/* Tasks for the ordering check: record their priority and events */
+static void OrderTask(uint8_t priority, uint32_t events)
+{
+    if (s_orderCount < sizeof(s_order)) {
+        s_order[s_orderCount++] = priority;
+    }
+    s_mergedEvents = events;
+}
+
+static void Order3(uint32_t events)  { OrderTask(3U, events); }
+static void Order7(uint32_t events)  { OrderTask(7U, events); }
+static void Order12(uint32_t events) { OrderTask(12U, events); }
+static void Order25(uint32_t events) { OrderTask(25U, events); }
+
+static void TestOrder(void)
+{
+    static const uint8_t expected[] = { 25U, 12U, 7U, 3U };
+    uint32_t i;
+
+    CHECK(Sched_AddTask(3U, Order3) && Sched_AddTask(7U, Order7) &&
+          Sched_AddTask(12U, Order12) && Sched_AddTask(25U, Order25), "AddTask failed");
+    CHECK(!Sched_AddTask(7U, Order3), "priority registered twice");
+    CHECK(!Sched_AddTask(SCHED_MAX_TASKS, Order3), "out of range priority accepted");
+
+    Sched_Post(7U, 0x01U);
+    Sched_Post(3U, 0x10U);
+    Sched_Post(25U, 0x02U);
+    Sched_Post(12U, 0x04U);
+    Sched_Post(3U, 0x20U);              /* Merged with the first post */
+    Sched_RunFor(1U);
+
+    CHECK(s_orderCount == 4U, "%u tasks ran, expected 4", (unsigned)s_orderCount);
+    for (i = 0; i < s_orderCount && i < 4U; i++) {
+        CHECK(s_order[i] == expected[i], "run %u was priority %u, expected %u",
+              (unsigned)i, (unsigned)s_order[i], (unsigned)expected[i]);
+    }
+    CHECK(s_mergedEvents == 0x30U, "merged events 0x%X, expected 0x30", (unsigned)s_mergedEvents);
+}
+
+static void Measure(const char *title, bool hog)
+{
+    ResetStats();
+    s_hogOn = hog;
+    Sched_RunFor(RUN_MS);
+    printf("%s\n  %-22s %8s %10s %8s\n", title, "(us)", "count", "mean", "max");
+    PrintStat("IRQ -> task latency", &s_irqLatency);
+    PrintStat("1 ms tick jitter", &s_tickJitter);
+}
+
+static int SchedApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+    Sched_Init();
+
+    TestOrder();
+
+    CHECK(Sched_AddTask(TASK_IRQ, IrqTask) && Sched_AddTask(TASK_TICK, TickTask) &&
+          Sched_AddTask(TASK_HOG, HogTask), "AddTask failed");
+    IntRegister(TEST_VECTOR, TestIsr);
+    IntEnable(TEST_VECTOR);
+    (void)Timer_Start(1U, OnTimer, (void *)(uintptr_t)TASK_TICK);
+    (void)Timer_Start(HOG_PERIOD_MS, OnTimer, (void *)(uintptr_t)TASK_HOG);
+    s_irqArmed = true;
+    RaiseIrq(NULL);
+
+    Measure("idle CPU", false);
+    CHECK(s_irqLatency.count > 1000U && s_irqLatency.maxUs <= IDLE_LATENCY_US,
+          "idle IRQ latency up to %llu us", (unsigned long long)s_irqLatency.maxUs);
+    CHECK(s_tickJitter.count >= RUN_MS - 1U && s_tickJitter.maxUs <= IDLE_LATENCY_US,
+          "idle tick jitter up to %llu us over %llu ticks",
+          (unsigned long long)s_tickJitter.maxUs, (unsigned long long)s_tickJitter.count);
+
+    Measure("hog task busy up to 200 us every 3 ms", true);
+    CHECK(s_irqLatency.maxUs <= HOG_MAX_US + DISPATCH_US,
+          "loaded IRQ latency up to %llu us", (unsigned long long)s_irqLatency.maxUs);
+    CHECK(s_tickJitter.count >= RUN_MS - 1U && s_tickJitter.maxUs <= HOG_MAX_US + DISPATCH_US,
+          "loaded tick jitter up to %llu us over %llu ticks",
+          (unsigned long long)s_tickJitter.maxUs, (unsigned long long)s_tickJitter.count);
+
+    s_irqArmed = false;
+    s_done = true;
+    Sched_Run();
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(SchedApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(60000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,217 @@
+/******************************************************************************
+ * File: timebase_test.c
+ * Module: SysTick timebase host test
+ * Description: Time_NowUs/Time_NowMs against the simulator clock
+ *
+ * A stand-in application samples the timebase at irregular intervals and
+ * compares it with the simulated clock. Checks:
+ *   1. Time_NowUs() tracks the clock to within 1 us at every phase of the
+ *      tick, across thousands of wraps, and never goes backwards.
+ *   2. With interrupts masked over a wrap the pending tick is still
+ *      counted, and the late handler does not make time jump.
+ *   3. DelayMs(n) returns on a tick boundary after (n - 1, n] ms.
+ *   4. Time_Reached/Time_Reached32 hold across a counter wrap.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "systick.h"
+#include "driverlib/interrupt.h"
+#include "tm4c123gh6pm.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SAMPLES             20000U
+#define MAX_ERROR_US        1U
+#define MASKED_US           1500U       /* Longer than one tick, shorter than two */
+#define DELAY_SLACK_US      20U         /* Wake-up and call overhead */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static uint32_t s_random = 1U;
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint32_t Random(void)
+{
+    s_random = s_random * 1103515245U + 12345U;
+    return s_random >> 8;
+}
+
+/*
+ * Spin
+ * Burns simulated time with register reads, as firmware code would. The
+ * counter is read because it changes on every access: polling a constant
+ * register would let the simulator skip ahead to the next event.
+ */
+static void Spin(uint32_t reads)
+{
+    while (reads-- > 0U) {
+        (void)NVIC_ST_CURRENT_R;
+    }
+}
+
+static void SpinUntilUs(uint64_t simUs)
+{
+    while (Sim_NowUs() < simUs) {
+        (void)NVIC_ST_CURRENT_R;
+    }
+}
+
+static void TestTracksClock(void)
+{
+    uint64_t timeStart = Time_NowUs();
+    uint64_t simStart = Sim_NowUs();
+    uint64_t previous = timeStart;
+    uint64_t maxError = 0U;
+    uint64_t callCycles;
+    uint64_t before;
+    bool monotonic = true;
+    uint32_t i;
+
+    for (i = 0; i < SAMPLES; i++) {
+        uint64_t now;
+        uint64_t sim;
+        uint64_t error;
+
+        Spin(Random() % 2000U);
+        now = Time_NowUs();
+        sim = Sim_NowUs();
+        error = (sim - simStart > now - timeStart) ? (sim - simStart) - (now - timeStart)
+                                                   : (now - timeStart) - (sim - simStart);
+        if (error > maxError) {
+            maxError = error;
+        }
+        if (now < previous) {
+            monotonic = false;
+        }
+        previous = now;
+    }
+
+    before = Sim_Cycles();
+    (void)Time_NowUs();
+    callCycles = Sim_Cycles() - before;
+
+    CHECK(maxError <= MAX_ERROR_US, "Time_NowUs off by up to %llu us",
+          (unsigned long long)maxError);
+    CHECK(monotonic, "Time_NowUs went backwards");
+    CHECK(Time_NowMs() == Time_NowUs() / 1000U, "Time_NowMs disagrees with Time_NowUs");
+
+    printf("%u samples over %.3f s: max error %llu us, Time_NowUs %llu cycles\n",
+           (unsigned)SAMPLES, (double)(Sim_NowUs() - simStart) / 1e6,
+           (unsigned long long)maxError, (unsigned long long)callCycles);
+}
+
+static void TestMaskedWrap(void)
+{
+    uint64_t timeStart;
+    uint64_t simStart;
+    uint64_t masked;
+    uint64_t unmasked;
+    uint64_t elapsed;
+
+    (void)IntMasterDisable();
+    timeStart = Time_NowUs();
+    simStart = Sim_NowUs();
+    SpinUntilUs(simStart + MASKED_US);
+    masked = Time_NowUs();
+    elapsed = Sim_NowUs() - simStart;
+    (void)IntMasterEnable();
+    unmasked = Time_NowUs();
+
+    CHECK(masked - timeStart + MAX_ERROR_US >= elapsed &&
+          masked - timeStart <= elapsed + MAX_ERROR_US,
+          "masked over a wrap: %llu us measured, %llu us elapsed",
+          (unsigned long long)(masked - timeStart), (unsigned long long)elapsed);
+    CHECK(unmasked >= masked && unmasked - masked <= 10U,
+          "late tick moved time by %lld us", (long long)(unmasked - masked));
+
+    printf("masked for %llu us across a wrap: measured %llu us\n",
+           (unsigned long long)elapsed, (unsigned long long)(masked - timeStart));
+}
+
+static void TestDelay(void)
+{
+    static const uint32_t delays[] = { 1U, 2U, 5U, 10U, 100U };
+    uint32_t i;
+
+    for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        uint64_t start;
+        uint64_t took;
+
+        Spin(Random() % 3000U);         /* Start at some phase of the tick */
+        start = Sim_NowUs();
+        DelayMs(delays[i]);
+        took = Sim_NowUs() - start;
+
+        CHECK(took + DELAY_SLACK_US > (delays[i] - 1U) * 1000U &&
+              took <= delays[i] * 1000U + DELAY_SLACK_US,
+              "DelayMs(%u) took %llu us", (unsigned)delays[i], (unsigned long long)took);
+        CHECK(Time_NowUs() % 1000U <= DELAY_SLACK_US,
+              "DelayMs(%u) returned %llu us into a tick", (unsigned)delays[i],
+              (unsigned long long)(Time_NowUs() % 1000U));
+    }
+}
+
+static void TestReached(void)
+{
+    CHECK(Time_Reached32(5U, 0xFFFFFFF0U), "deadline before the wrap not reached");
+    CHECK(!Time_Reached32(0xFFFFFFF0U, 5U), "deadline after the wrap reached early");
+    CHECK(Time_Reached32(7U, 7U), "deadline not reached when equal");
+    CHECK(Time_Reached(1000U, 999U) && !Time_Reached(999U, 1000U), "64-bit compare wrong");
+}
+
+/*
+ * TimebaseApp_Main
+ * Firmware side: runs every check, then idles.
+ */
+static int TimebaseApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+
+    TestTracksClock();
+    TestMaskedWrap();
+    TestDelay();
+    TestReached();
+
+    s_done = true;
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(TimebaseApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(60000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,324 @@
+/******************************************************************************
+ * File: timer_test.c
+ * Module: Software timer wheel host test
+ * Description: Timer_Start/Timer_Cancel/Timer_Dispatch against a reference
+ *
+ * A stand-in application keeps every timer slot busy with a random mix of
+ * one-shot and periodic timers, cancels and restarts them at random, and
+ * records when each callback runs. Checks:
+ *   1. Dispatched every millisecond, each callback runs in exactly the
+ *      millisecond of its deadline and periodic timers do not drift, for
+ *      periods from 1 ms up to the top level of the wheel.
+ *   2. Cancelled timers never run, stale ids do not cancel a reused timer
+ *      and a full pool refuses new timers.
+ *   3. Dispatched at irregular gaps, no callback runs early and periodic
+ *      timers catch up without losing a period.
+ *   4. A callback can cancel itself and start other timers.
+ *   5. Skipping idle milliseconds never skips past the present.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sim.h"
+#include "systick.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define RUN_MS              60000U
+#define LAG_RUN_MS          60000U
+#define MAX_GAP_MS          300U
+#define LONG_PERIOD_MS      300000U     /* Beyond level 2 (2^18 ms) */
+
+typedef struct {
+    Timer_Id id;
+    uint32_t periodMs;
+    uint32_t dueMs;                     /* Next deadline */
+    uint32_t fired;
+    bool periodic;
+    bool live;
+} Expect;
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+static Expect s_expect[TIMER_MAX];
+static uint32_t s_random = 7U;
+static uint32_t s_maxLateMs;        /* 0 when dispatched every millisecond */
+static uint32_t s_firings;
+static bool s_done;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static uint32_t Random(void)
+{
+    s_random = s_random * 1103515245U + 12345U;
+    return s_random >> 8;
+}
+
+static bool OnTimer(void *context)
+{
+    Expect *expect = (Expect *)context;
+    uint32_t now = (uint32_t)Time_NowMs();
+
+    s_firings++;
+    CHECK(expect->live, "cancelled or finished timer ran at %u ms", (unsigned)now);
+    CHECK(now >= expect->dueMs && now - expect->dueMs <= s_maxLateMs,
+          "timer of %u ms due at %u ran at %u", (unsigned)expect->periodMs,
+          (unsigned)expect->dueMs, (unsigned)now);
+    expect->fired++;
+    expect->dueMs += expect->periodMs;
+    expect->live = expect->periodic;
+    return expect->periodic;
+}
+
+static uint32_t RandomPeriod(void)
+{
+    switch (Random() % 4U) {
+        case 0:  return 1U + (Random() % 64U);         /* Level 0 */
+        case 1:  return 64U + (Random() % 4032U);      /* Level 1 */
+        case 2:  return 4096U + (Random() % 20000U);   /* Level 2 */
+        default: return 1U + (Random() % 5U);          /* Busy periodic */
+    }
+}
+
+static void StartRandom(Expect *expect)
+{
+    expect->periodMs = RandomPeriod();
+    expect->periodic = (Random() % 2U) == 0U;
+    expect->dueMs = (uint32_t)Time_NowMs() + expect->periodMs;
+    expect->fired = 0U;
+    expect->id = Timer_Start(expect->periodMs, OnTimer, expect);
+    expect->live = (expect->id != TIMER_NONE);
+    CHECK(expect->live, "no free timer");
+}
+
+static void CheckNotOverdue(const Expect *expect)
+{
+    uint32_t now = (uint32_t)Time_NowMs();
+
+    CHECK(!Time_Reached32(now, expect->dueMs + s_maxLateMs + 1U),
+          "timer due at %u still pending at %u", (unsigned)expect->dueMs, (unsigned)now);
+}
+
+/*
+ * Churn
+ * Cancels one random timer or restarts a finished one.
+ */
+static void Churn(void)
+{
+    Expect *expect = &s_expect[Random() % TIMER_MAX];
+
+    if (expect->live) {
+        CheckNotOverdue(expect);
+        CHECK(Timer_Cancel(expect->id), "live timer would not cancel");
+        expect->live = false;
+        CHECK(!Timer_Cancel(expect->id), "timer cancelled twice");
+    }
+    StartRandom(expect);
+}
+
+static void RunFor(uint32_t ms, uint32_t maxGapMs)
+{
+    uint32_t end = (uint32_t)Time_NowMs() + ms;
+
+    s_maxLateMs = maxGapMs - 1U;
+    while (!Time_Reached32((uint32_t)Time_NowMs(), end)) {
+        DelayMs(1U + (Random() % maxGapMs));
+        Timer_Dispatch();
+        if (Random() % 16U == 0U) {
+            Churn();
+        }
+    }
+}
+
+/*
+ * CancelAll
+ * Stops every timer, checking that none of them is overdue.
+ */
+static void CancelAll(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TIMER_MAX; i++) {
+        if (s_expect[i].live) {
+            CheckNotOverdue(&s_expect[i]);
+            (void)Timer_Cancel(s_expect[i].id);
+            s_expect[i].live = false;
+        }
+    }
+}
+
+static void TestRandomMix(void)
+{
+    Timer_Id stale;
+    uint32_t i;
+
+    for (i = 0; i < TIMER_MAX; i++) {
+        StartRandom(&s_expect[i]);
+    }
+    CHECK(Timer_Start(10U, OnTimer, &s_expect[0]) == TIMER_NONE, "pool overfilled");
+
+    /* A stale id must not reach the timer that reuses its slot */
+    stale = s_expect[0].id;
+    CHECK(Timer_Cancel(stale), "cancel failed");
+    s_expect[0].live = false;
+    StartRandom(&s_expect[0]);
+    CHECK(!Timer_Cancel(stale), "stale id cancelled a reused timer");
+
+    RunFor(RUN_MS, 1U);
+    printf("every 1 ms:     %u callbacks in %u s\n", (unsigned)s_firings, (unsigned)(RUN_MS / 1000U));
+
+    s_firings = 0U;
+    RunFor(LAG_RUN_MS, MAX_GAP_MS);
+    printf("gaps to %3u ms: %u callbacks in %u s\n", (unsigned)MAX_GAP_MS, (unsigned)s_firings,
+           (unsigned)(LAG_RUN_MS / 1000U));
+    CancelAll();
+}
+
+static void TestPeriodicCatchUp(void)
+{
+    Expect *expect = &s_expect[0];
+    uint32_t start = (uint32_t)Time_NowMs();
+
+    expect->periodMs = 7U;
+    expect->periodic = true;
+    expect->dueMs = start + 7U;
+    expect->fired = 0U;
+    expect->id = Timer_Start(7U, OnTimer, expect);
+    expect->live = true;
+
+    s_maxLateMs = 1000U;
+    DelayMs(1000);                      /* 142 periods pass undispatched */
+    Timer_Dispatch();
+    CHECK(expect->fired == ((uint32_t)Time_NowMs() - start) / 7U,
+          "caught up %u of %u periods", (unsigned)expect->fired,
+          (unsigned)(((uint32_t)Time_NowMs() - start) / 7U));
+    CancelAll();
+}
+
+/*
+ * TestAfterIdle
+ * An idle wheel skips ahead to the present; a 1 ms timer started right
+ * after that must still run in the next millisecond.
+ */
+static void TestAfterIdle(void)
+{
+    Expect *expect = &s_expect[0];
+
+    DelayMs(100);
+    Timer_Dispatch();
+    expect->periodMs = 1U;
+    expect->periodic = false;
+    expect->dueMs = (uint32_t)Time_NowMs() + 1U;
+    expect->fired = 0U;
+    expect->id = Timer_Start(1U, OnTimer, expect);
+    expect->live = true;
+
+    s_maxLateMs = 0U;
+    DelayMs(1);
+    Timer_Dispatch();
+    CHECK(expect->fired == 1U, "1 ms timer after an idle spell did not run");
+    CancelAll();
+}
+
+static void TestLong(void)
+{
+    Expect *expect = &s_expect[0];
+
+    expect->periodMs = LONG_PERIOD_MS;
+    expect->periodic = false;
+    expect->dueMs = (uint32_t)Time_NowMs() + LONG_PERIOD_MS;
+    expect->fired = 0U;
+    expect->id = Timer_Start(LONG_PERIOD_MS, OnTimer, expect);
+    expect->live = true;
+
+    s_maxLateMs = 0U;
+    while (expect->fired == 0U && !Time_Reached32((uint32_t)Time_NowMs(),
+                                                  expect->dueMs + 1000U)) {
+        DelayMs(1);
+        Timer_Dispatch();
+    }
+    CHECK(expect->fired == 1U, "%u s timer did not run", (unsigned)(LONG_PERIOD_MS / 1000U));
+}
+
+static Timer_Id s_self;
+static uint32_t s_selfRuns;
+static bool s_chainedRan;
+
+static bool OnChained(void *context)
+{
+    (void)context;
+    s_chainedRan = true;
+    return false;
+}
+
+static bool OnSelfCancel(void *context)
+{
+    (void)context;
+    s_selfRuns++;
+    CHECK(Timer_Cancel(s_self), "could not cancel from own callback");
+    CHECK(Timer_Start(5U, OnChained, NULL) != TIMER_NONE, "could not start from a callback");
+    return true;                        /* Overridden by the cancel */
+}
+
+static void TestFromCallback(void)
+{
+    uint32_t i;
+
+    s_self = Timer_Start(3U, OnSelfCancel, NULL);
+    for (i = 0; i < 20U; i++) {
+        DelayMs(1);
+        Timer_Dispatch();
+    }
+    CHECK(s_selfRuns == 1U, "self-cancelled periodic timer ran %u times", (unsigned)s_selfRuns);
+    CHECK(s_chainedRan, "timer started from a callback did not run");
+}
+
+static int TimerApp_Main(void)
+{
+    SysTick_Init(16000, SYSTICK_INT);
+
+    TestRandomMix();
+    TestPeriodicCatchUp();
+    TestFromCallback();
+    TestAfterIdle();
+    TestLong();
+
+    s_done = true;
+    for (;;) {
+        DelayMs(1000);
+    }
+    return 0;
+}
+
+static bool Done(void *ctx)
+{
+    (void)ctx;
+    return s_done;
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(TimerApp_Main);
+    CHECK(Sim_WaitFor(Done, NULL, SIM_MS(600000)), "firmware side did not finish");
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
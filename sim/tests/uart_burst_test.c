@@ -0,0 +1,298 @@
+/******************************************************************************
+ * File: uart_burst_test.c
+ * Module: UART5 driver host test
+ * Description: Bursts faster than the main loop drains them
+ *
+ * A stand-in application polls UART5_Read() only every SLOW_LOOP_MS and
+ * echoes what it got with one UART5_Write(). The hardware FIFO alone holds
+ * 16 bytes (1.4 ms of line time), so every burst below would overrun a
+ * polled driver. Checks:
+ *   1. Bursts that fit the ring buffer arrive complete, in order, with no
+ *      hardware or ring overruns.
+ *   2. The echo leaves back to back at line rate and UART5_Write() returns
+ *      without waiting for the line.
+ *   3. A burst larger than the ring is accounted for exactly: every byte
+ *      is either delivered or counted by UART5_GetRxOverruns().
+ *   4. A uDMA frame returns from UART5_SendFrame() at once, leaves back to
+ *      back between the ring bytes written before and after it, and
+ *      completes exactly once.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_uart.h"
+#include "sim_nvic.h"
+#include "sim_udma.h"
+#include "uart.h"
+#include "systick.h"
+#include "check.h"
+
+/******************************************************************************
+ *                              Definitions                                    *
+ ******************************************************************************/
+
+#define SLOW_LOOP_MS        20U
+#define BURST_LENGTH        48U     /* 3x the hardware FIFO, fits the ring */
+#define BURST_COUNT         10U
+#define BURST_PERIOD        SIM_MS(25)
+#define FLOOD_LENGTH        100U    /* Larger than the ring */
+#define MAX_WRITE_CYCLES    2000U   /* UART5_Write of a full burst */
+#define LOG_SIZE            2048U
+#define FRAME_LENGTH        40U     /* More than two hardware FIFOs */
+#define MAX_FRAME_CYCLES    400U    /* UART5_SendFrame, independent of length */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/* Filled by the firmware side */
+static uint8_t s_received[LOG_SIZE];
+static uint32_t s_receivedCount;
+static bool s_echo = true;
+static bool s_paused;
+static uint32_t s_echoDropped;
+static uint64_t s_maxWriteCycles;
+static bool s_sendFrame;
+static uint8_t s_frame[FRAME_LENGTH];
+static uint64_t s_frameCallCycles;
+static bool s_frameQueued;
+static bool s_frameRejected;
+static uint32_t s_frameDone;
+
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+static void OnFrameDone(void)
+{
+    s_frameDone++;
+}
+
+/*
+ * SendFramedMessage
+ * Firmware side: ring bytes, a uDMA frame, then more ring bytes.
+ */
+static void SendFramedMessage(void)
+{
+    uint64_t start;
+
+    (void)UART5_Write((const uint8_t *)"<<", 2U);
+    start = Sim_Cycles();
+    s_frameQueued = UART5_SendFrame(s_frame, FRAME_LENGTH, OnFrameDone);
+    s_frameCallCycles = Sim_Cycles() - start;
+    s_frameRejected = !UART5_SendFrame(s_frame, FRAME_LENGTH, OnFrameDone);
+    (void)UART5_Write((const uint8_t *)">>", 2U);
+}
+
+/*
+ * SlowApp_Main
+ * Firmware side: a main loop that is busy for SLOW_LOOP_MS between polls.
+ */
+static int SlowApp_Main(void)
+{
+    uint8_t buf[UART5_RX_BUFFER_SIZE];
+
+    SysTick_Init(16000, SYSTICK_NOINT);
+    UART5_Init();
+
+    for (;;) {
+        uint32_t n;
+
+        DelayMs(SLOW_LOOP_MS);
+        if (s_sendFrame) {
+            s_sendFrame = false;
+            SendFramedMessage();
+        }
+        if (s_paused) {
+            continue;
+        }
+        n = UART5_Read(buf, sizeof(buf));
+        if (n > 0U && s_receivedCount + n <= LOG_SIZE) {
+            memcpy(&s_received[s_receivedCount], buf, n);
+            s_receivedCount += n;
+        }
+        if (n > 0U && s_echo) {
+            uint64_t start = Sim_Cycles();
+            uint32_t queued = UART5_Write(buf, n);
+
+            if (Sim_Cycles() - start > s_maxWriteCycles) {
+                s_maxWriteCycles = Sim_Cycles() - start;
+            }
+            s_echoDropped += n - queued;
+        }
+    }
+    return 0;
+}
+
+static void MakeBurst(uint8_t *data, uint32_t length, uint32_t seed)
+{
+    uint32_t i;
+
+    for (i = 0; i < length; i++) {
+        data[i] = (uint8_t)(seed * 31U + i);
+    }
+}
+
+/*
+ * TestBurstsWithinRing
+ * Bursts of BURST_LENGTH at line rate, BURST_PERIOD apart.
+ */
+static void TestBurstsWithinRing(void)
+{
+    uint8_t sent[BURST_LENGTH * BURST_COUNT];
+    uint64_t prevArrival = 0U;
+    uint32_t gaps = 0U;
+    uint32_t b;
+    uint32_t i;
+
+    for (b = 0; b < BURST_COUNT; b++) {
+        uint64_t start = Sim_Cycles();
+
+        MakeBurst(&sent[b * BURST_LENGTH], BURST_LENGTH, b);
+        (void)SimUart_PeerSend(&sent[b * BURST_LENGTH], BURST_LENGTH);
+        Sim_WaitUntil(start + BURST_PERIOD);
+    }
+    Sim_WaitUntil(Sim_Cycles() + SIM_MS(3U * SLOW_LOOP_MS));
+
+    CHECK(s_receivedCount == sizeof(sent), "received %u of %u bytes",
+          (unsigned)s_receivedCount, (unsigned)sizeof(sent));
+    CHECK(memcmp(s_received, sent, sizeof(sent)) == 0, "received bytes differ");
+    CHECK(SimUart_RxOverruns() == 0U, "%u hardware FIFO overruns", (unsigned)SimUart_RxOverruns());
+    CHECK(UART5_GetHwOverruns() == 0U, "driver saw %u overrun errors", (unsigned)UART5_GetHwOverruns());
+    CHECK(UART5_GetRxOverruns() == 0U, "%u bytes dropped by the ring", (unsigned)UART5_GetRxOverruns());
+
+    /* Echo: same bytes, back to back within each burst */
+    CHECK(s_echoDropped == 0U, "%u echo bytes did not fit the TX ring", (unsigned)s_echoDropped);
+    CHECK(s_maxWriteCycles <= MAX_WRITE_CYCLES, "UART5_Write took %llu cycles",
+          (unsigned long long)s_maxWriteCycles);
+    for (i = 0; i < sizeof(sent); i++) {
+        uint8_t byte;
+        uint64_t arrival;
+
+        if (!SimUart_PeerReceive(&byte, &arrival, SIM_MS(100))) {
+            CHECK(false, "echo stopped after %u bytes", (unsigned)i);
+            break;
+        }
+        CHECK(byte == sent[i], "echo byte %u is 0x%02X, expected 0x%02X",
+              (unsigned)i, byte, sent[i]);
+        if (i % BURST_LENGTH != 0U && arrival - prevArrival != SIM_UART_BYTE_CYCLES) {
+            gaps++;
+        }
+        prevArrival = arrival;
+    }
+    CHECK(gaps == 0U, "%u gaps in the echoed bursts", (unsigned)gaps);
+
+    printf("%u bursts of %u bytes: %u received, %u UART5 interrupts, "
+           "UART5_Write max %llu cycles\n",
+           (unsigned)BURST_COUNT, (unsigned)BURST_LENGTH, (unsigned)s_receivedCount,
+           (unsigned)SimNvic_Taken(SIM_VECTOR_UART5), (unsigned long long)s_maxWriteCycles);
+}
+
+/*
+ * TestFloodBeyondRing
+ * One burst larger than the ring while the main loop is not reading.
+ */
+static void TestFloodBeyondRing(void)
+{
+    uint8_t sent[FLOOD_LENGTH];
+    uint32_t before = s_receivedCount;
+    uint32_t delivered;
+    uint32_t dropped;
+
+    s_echo = false;
+    s_paused = true;
+    MakeBurst(sent, sizeof(sent), 99U);
+    Sim_WaitUntil(SimUart_PeerSend(sent, sizeof(sent)) + SIM_MS(1));
+    s_paused = false;
+    Sim_WaitUntil(Sim_Cycles() + SIM_MS(2U * SLOW_LOOP_MS));
+
+    delivered = s_receivedCount - before;
+    dropped = UART5_GetRxOverruns();
+    CHECK(delivered + dropped == FLOOD_LENGTH, "%u delivered + %u dropped != %u sent",
+          (unsigned)delivered, (unsigned)dropped, (unsigned)FLOOD_LENGTH);
+    CHECK(delivered == UART5_RX_BUFFER_SIZE, "%u delivered, expected a full ring of %u",
+          (unsigned)delivered, (unsigned)UART5_RX_BUFFER_SIZE);
+    CHECK(SimUart_RxOverruns() == 0U, "%u hardware FIFO overruns", (unsigned)SimUart_RxOverruns());
+    CHECK(memcmp(&s_received[before], sent, delivered) == 0, "delivered prefix differs");
+
+    printf("flood of %u bytes: %u delivered, %u counted as ring overruns\n",
+           (unsigned)FLOOD_LENGTH, (unsigned)delivered, (unsigned)dropped);
+}
+
+/*
+ * TestFrameDma
+ * One frame through uDMA channel 7, framed by ring writes.
+ */
+static void TestFrameDma(void)
+{
+    uint8_t expected[FRAME_LENGTH + 4U];
+    uint64_t prevArrival = 0U;
+    uint32_t gaps = 0U;
+    uint32_t i;
+
+    MakeBurst(s_frame, FRAME_LENGTH, 7U);
+    memcpy(expected, "<<", 2U);
+    memcpy(&expected[2], s_frame, FRAME_LENGTH);
+    memcpy(&expected[2U + FRAME_LENGTH], ">>", 2U);
+
+    SimUart_PeerFlush();
+    s_sendFrame = true;
+
+    for (i = 0; i < sizeof(expected); i++) {
+        uint8_t byte;
+        uint64_t arrival;
+
+        if (!SimUart_PeerReceive(&byte, &arrival, SIM_MS(100U + SLOW_LOOP_MS))) {
+            CHECK(false, "frame output stopped after %u bytes", (unsigned)i);
+            break;
+        }
+        CHECK(byte == expected[i], "frame byte %u is 0x%02X, expected 0x%02X",
+              (unsigned)i, byte, expected[i]);
+        if (i > 0U && arrival - prevArrival != SIM_UART_BYTE_CYCLES) {
+            gaps++;
+        }
+        prevArrival = arrival;
+    }
+    Sim_WaitUntil(Sim_Cycles() + SIM_MS(2U * SLOW_LOOP_MS));
+
+    CHECK(s_frameQueued, "UART5_SendFrame refused an idle channel");
+    CHECK(s_frameRejected, "UART5_SendFrame accepted a second frame in flight");
+    CHECK(s_frameCallCycles <= MAX_FRAME_CYCLES, "UART5_SendFrame took %llu cycles",
+          (unsigned long long)s_frameCallCycles);
+    CHECK(gaps == 0U, "%u gaps around the frame", (unsigned)gaps);
+    CHECK(s_frameDone == 1U, "completion callback ran %u times", (unsigned)s_frameDone);
+    CHECK(SimUdma_Transfers() == 1U, "%u uDMA transfers", (unsigned)SimUdma_Transfers());
+
+    printf("frame of %u bytes: UART5_SendFrame %llu cycles, %u bytes on the wire "
+           "in %.3f ms\n",
+           (unsigned)FRAME_LENGTH, (unsigned long long)s_frameCallCycles,
+           (unsigned)sizeof(expected),
+           (double)(sizeof(expected) * SIM_UART_BYTE_CYCLES) / (double)SIM_CYCLES_PER_MS);
+}
+
+/******************************************************************************
+ *                          Main                                               *
+ ******************************************************************************/
+
+int main(void)
+{
+    Sim_Init();
+    Sim_Boot(SlowApp_Main);
+    Sim_WaitUntil(SIM_MS(5));
+
+    TestBurstsWithinRing();
+    TestFrameDma();
+    TestFloodBeyondRing();
+
+    if (s_failures != 0U) {
+        printf("%u check(s) failed\n", (unsigned)s_failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * File: eeprom.c
+ * Module: TivaWare host stubs
+ * Description: EEPROM API backed by the simulated EEPROM array
+ *
+ * EEPROMProgram() and EEPROMMassErase() block for the modelled program and
+ * erase times, as the TivaWare versions do. EEPROMProgramNonBlocking()
+ * returns at once and the EEPROM interrupt reports the word done. The
+ * blocking calls first wait for a background program to finish, as in
+ * TivaWare; EEPROMProgramNonBlocking() does not, and refuses a word
+ * started while another is in progress with EEPROM_RC_WRBUSY.
+ ******************************************************************************/
+
+#include "driverlib/eeprom.h"
+#include "sim.h"
+#include "sim_eeprom.h"
+
+uint32_t EEPROMInit(void)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return EEPROM_INIT_OK;
+}
+
+uint32_t EEPROMSizeGet(void)
+{
+    return SIM_EEPROM_WORDS * 4U;
+}
+
+uint32_t EEPROMBlockCountGet(void)
+{
+    return SIM_EEPROM_WORDS / 16U;
+}
+
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t ui32Word = ui32Address / 4U;
+    uint32_t ui32Words = ui32Count / 4U;
+    uint32_t i;
+
+    SimEeprom_WaitIdle();
+    Sim_Sync(SIM_CYCLES_PER_CALL + (ui32Words * SIM_EEPROM_READ_CYCLES));
+    for (i = 0; i < ui32Words; i++) {
+        pui32Data[i] = SimEeprom_Read(ui32Word + i);
+    }
+}
+
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t ui32Word = ui32Address / 4U;
+    uint32_t ui32Words = ui32Count / 4U;
+    uint32_t i;
+
+    SimEeprom_WaitIdle();
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    for (i = 0; i < ui32Words; i++) {
+        Sim_Sync((uint32_t)SIM_EEPROM_PROGRAM_CYCLES);
+        SimEeprom_Program(ui32Word + i, pui32Data[i]);
+    }
+    return 0;
+}
+
+uint32_t EEPROMMassErase(void)
+{
+    SimEeprom_WaitIdle();
+    Sim_Sync((uint32_t)SIM_EEPROM_ERASE_CYCLES);
+    SimEeprom_Erase();
+    return 0;
+}
+
+uint32_t EEPROMProgramNonBlocking(uint32_t ui32Data, uint32_t ui32Address)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if (!SimEeprom_Start(ui32Address / 4U, ui32Data)) {
+        return EEPROM_RC_WRBUSY | EEPROM_RC_WORKING;
+    }
+    return EEPROM_RC_WORKING;
+}
+
+uint32_t EEPROMStatusGet(void)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if (SimEeprom_Busy()) {
+        return EEPROM_RC_WORKING;
+    }
+    return SimEeprom_Failed() ? EEPROM_RC_NOPERM : 0U;
+}
+
+void EEPROMIntEnable(uint32_t ui32IntFlags)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if ((ui32IntFlags & EEPROM_INT_PROGRAM) != 0U) {
+        SimEeprom_IntEnable(true);
+    }
+}
+
+void EEPROMIntDisable(uint32_t ui32IntFlags)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if ((ui32IntFlags & EEPROM_INT_PROGRAM) != 0U) {
+        SimEeprom_IntEnable(false);
+    }
+}
+
+uint32_t EEPROMIntStatus(bool bMasked)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimEeprom_IntStatus(bMasked) ? EEPROM_INT_PROGRAM : 0U;
+}
+
+void EEPROMIntClear(uint32_t ui32IntFlags)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if ((ui32IntFlags & EEPROM_INT_PROGRAM) != 0U) {
+        SimEeprom_IntClear();
+    }
+}
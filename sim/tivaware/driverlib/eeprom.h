@@ -0,0 +1,39 @@
+/******************************************************************************
+ * File: eeprom.h
+ * Module: TivaWare host stubs
+ * Description: EEPROM API (subset of TivaWare driverlib/eeprom.h)
+ ******************************************************************************/
+
+#ifndef __DRIVERLIB_EEPROM_H__
+#define __DRIVERLIB_EEPROM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EEPROM_INIT_OK          0
+#define EEPROM_INIT_ERROR       2
+
+/* EEPROMStatusGet() / EEPROMProgramNonBlocking() return codes */
+#define EEPROM_RC_WRBUSY        0x00000020
+#define EEPROM_RC_NOPERM        0x00000010
+#define EEPROM_RC_WKCOPY        0x00000008
+#define EEPROM_RC_WKERASE       0x00000004
+#define EEPROM_RC_WORKING       0x00000001
+
+/* EEPROMIntEnable() and friends */
+#define EEPROM_INT_PROGRAM      0x00000004
+
+extern uint32_t EEPROMInit(void);
+extern uint32_t EEPROMSizeGet(void);
+extern uint32_t EEPROMBlockCountGet(void);
+extern void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count);
+extern uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count);
+extern uint32_t EEPROMMassErase(void);
+extern uint32_t EEPROMProgramNonBlocking(uint32_t ui32Data, uint32_t ui32Address);
+extern uint32_t EEPROMStatusGet(void);
+extern void EEPROMIntEnable(uint32_t ui32IntFlags);
+extern void EEPROMIntDisable(uint32_t ui32IntFlags);
+extern uint32_t EEPROMIntStatus(bool bMasked);
+extern void EEPROMIntClear(uint32_t ui32IntFlags);
+
+#endif /* __DRIVERLIB_EEPROM_H__ */
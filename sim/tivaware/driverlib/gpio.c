@@ -0,0 +1,22 @@
+/******************************************************************************
+ * File: gpio.c
+ * Module: TivaWare host stubs
+ * Description: GPIO pin muxing; the simulator does not model alternate
+ *              functions, so these only charge their cost
+ ******************************************************************************/
+
+#include "driverlib/gpio.h"
+#include "sim.h"
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    (void)ui32PinConfig;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
@@ -0,0 +1,25 @@
+/******************************************************************************
+ * File: gpio.h
+ * Module: TivaWare host stubs
+ * Description: GPIO API (subset of TivaWare driverlib/gpio.h)
+ ******************************************************************************/
+
+#ifndef __DRIVERLIB_GPIO_H__
+#define __DRIVERLIB_GPIO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_PIN_0              0x00000001
+#define GPIO_PIN_1              0x00000002
+#define GPIO_PIN_2              0x00000004
+#define GPIO_PIN_3              0x00000008
+#define GPIO_PIN_4              0x00000010
+#define GPIO_PIN_5              0x00000020
+#define GPIO_PIN_6              0x00000040
+#define GPIO_PIN_7              0x00000080
+
+extern void GPIOPinConfigure(uint32_t ui32PinConfig);
+extern void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins);
+
+#endif /* __DRIVERLIB_GPIO_H__ */
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * File: interrupt.c
+ * Module: TivaWare host stubs
+ * Description: NVIC API backed by the simulated interrupt controller
+ *
+ * Priorities are accepted but not modelled: handlers never preempt each
+ * other.
+ ******************************************************************************/
+
+#include "driverlib/interrupt.h"
+#include "sim.h"
+#include "sim_nvic.h"
+
+/*
+ * IntMasterEnable / IntMasterDisable
+ * CPSIE / CPSID. Return the previous state like the real functions.
+ */
+bool IntMasterEnable(void)
+{
+    bool bWasMasked = SimNvic_SetMasked(false);
+
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return bWasMasked;
+}
+
+bool IntMasterDisable(void)
+{
+    bool bWasMasked = SimNvic_SetMasked(true);
+
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return bWasMasked;
+}
+
+void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimNvic_Register(ui32Interrupt, pfnHandler);
+}
+
+void IntUnregister(uint32_t ui32Interrupt)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimNvic_Register(ui32Interrupt, 0);
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+    SimNvic_Enable(ui32Interrupt, true);
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+    SimNvic_Enable(ui32Interrupt, false);
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+uint32_t IntIsEnabled(uint32_t ui32Interrupt)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimNvic_IsEnabled(ui32Interrupt) ? 1U : 0U;
+}
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    (void)ui32Interrupt;
+    (void)ui8Priority;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void IntPendSet(uint32_t ui32Interrupt)
+{
+    SimNvic_Pend(ui32Interrupt);
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
@@ -0,0 +1,23 @@
+/******************************************************************************
+ * File: interrupt.h
+ * Module: TivaWare host stubs
+ * Description: NVIC API (subset of TivaWare driverlib/interrupt.h)
+ ******************************************************************************/
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void));
+extern void IntUnregister(uint32_t ui32Interrupt);
+extern void IntEnable(uint32_t ui32Interrupt);
+extern void IntDisable(uint32_t ui32Interrupt);
+extern uint32_t IntIsEnabled(uint32_t ui32Interrupt);
+extern void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority);
+extern void IntPendSet(uint32_t ui32Interrupt);
+
+#endif /* __DRIVERLIB_INTERRUPT_H__ */
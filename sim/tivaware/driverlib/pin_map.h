@@ -0,0 +1,13 @@
+/******************************************************************************
+ * File: pin_map.h
+ * Module: TivaWare host stubs
+ * Description: Pin mux encodings used by the firmware (TM4C123GH6PM)
+ ******************************************************************************/
+
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PE4_U5RX           0x00041001
+#define GPIO_PE5_U5TX           0x00041401
+
+#endif /* __DRIVERLIB_PIN_MAP_H__ */
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * File: sysctl.c
+ * Module: TivaWare host stubs
+ * Description: System control API backed by the simulated SYSCTL registers
+ ******************************************************************************/
+
+#include "driverlib/sysctl.h"
+#include "sim.h"
+#include "sim_nvic.h"
+#include "sim_sysctl.h"
+
+#define SYSCTL_RCGC_BASE    0x400FE600U
+
+/*
+ * SysCtl_Rcgc
+ * Decodes a peripheral ID into its RCGC register and bit.
+ */
+static volatile uint32_t *SysCtl_Rcgc(uint32_t ui32Peripheral, uint32_t *pui32Bit)
+{
+    *pui32Bit = 1U << (ui32Peripheral & 0xFFU);
+    return Sim_Reg(SYSCTL_RCGC_BASE + ((ui32Peripheral & 0xFF00U) >> 8));
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Bit;
+    volatile uint32_t *pui32Rcgc = SysCtl_Rcgc(ui32Peripheral, &ui32Bit);
+
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    *pui32Rcgc |= ui32Bit;
+}
+
+void SysCtlPeripheralDisable(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Bit;
+    volatile uint32_t *pui32Rcgc = SysCtl_Rcgc(ui32Peripheral, &ui32Bit);
+
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    *pui32Rcgc &= ~ui32Bit;
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Bit;
+    volatile uint32_t *pui32Rcgc = SysCtl_Rcgc(ui32Peripheral, &ui32Bit);
+
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return (*pui32Rcgc & ui32Bit) != 0U;
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    return (uint32_t)SIM_CPU_HZ;
+}
+
+/*
+ * SysCtlDelay
+ * Three cycles per loop iteration, as on the real part.
+ */
+void SysCtlDelay(uint32_t ui32Count)
+{
+    Sim_Sync(3U * ui32Count);
+}
+
+/*
+ * SysCtlSleep
+ * WFI: the clock runs on until an enabled interrupt is pending, even with
+ * PRIMASK set.
+ */
+void SysCtlSleep(void)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimSysCtl_NoteSleep();
+    while (!SimNvic_Pending()) {
+        Sim_Idle();
+    }
+}
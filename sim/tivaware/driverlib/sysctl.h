@@ -0,0 +1,34 @@
+/******************************************************************************
+ * File: sysctl.h
+ * Module: TivaWare host stubs
+ * Description: System control API (subset of TivaWare driverlib/sysctl.h)
+ ******************************************************************************/
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Peripheral IDs: 0xF000rrbb, RCGC register offset rr, bit bb */
+#define SYSCTL_PERIPH_TIMER0    0xf0000400
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOC     0xf0000802
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_UDMA      0xf0000c00
+#define SYSCTL_PERIPH_UART5     0xf0001805
+#define SYSCTL_PERIPH_ADC0      0xf0003800
+#define SYSCTL_PERIPH_EEPROM0   0xf0005800
+
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralDisable(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlDelay(uint32_t ui32Count);
+extern void SysCtlSleep(void);
+
+#endif /* __DRIVERLIB_SYSCTL_H__ */
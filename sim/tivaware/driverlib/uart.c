@@ -0,0 +1,181 @@
+/******************************************************************************
+ * File: uart.c
+ * Module: TivaWare host stubs
+ * Description: UART API backed by the simulated UART5 line
+ *
+ * Only UART5 is modelled; the base address argument is ignored. Of the
+ * DMA requests only TX is modelled.
+ ******************************************************************************/
+
+#include "driverlib/uart.h"
+#include "driverlib/interrupt.h"
+#include "inc/hw_ints.h"
+#include "sim.h"
+#include "sim_uart.h"
+
+/* UARTIFLS trigger levels in bytes, indexed by the TX level code */
+static const uint32_t s_fifoLevelBytes[] = { 2U, 4U, 8U, 12U, 14U };
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                         uint32_t ui32Baud, uint32_t ui32Config)
+{
+    (void)ui32Base;
+    (void)ui32UARTClk;
+    (void)ui32Baud;
+    (void)ui32Config;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void UARTEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUart_Enable(true);
+}
+
+void UARTDisable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUart_Enable(false);
+}
+
+bool UARTCharsAvail(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimUart_RxCount() > 0U;
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return !SimUart_TxFull();
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return (SimUart_RxCount() > 0U) ? (int32_t)SimUart_RxPop() : -1;
+}
+
+int32_t UARTCharGet(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    while (SimUart_RxCount() == 0U) {
+        Sim_Idle();
+    }
+    return (int32_t)SimUart_RxPop();
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if (SimUart_TxFull()) {
+        return false;
+    }
+    SimUart_TxPush(ucData);
+    return true;
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    while (SimUart_TxFull()) {
+        Sim_Idle();
+    }
+    SimUart_TxPush(ucData);
+}
+
+bool UARTBusy(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimUart_TxBusy();
+}
+
+void UARTFIFOEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUart_SetFifoLevels(s_fifoLevelBytes[ui32TxLevel % 5U],
+                          s_fifoLevelBytes[(ui32RxLevel >> 3) % 5U]);
+}
+
+void UARTTxIntModeSet(uint32_t ui32Base, uint32_t ui32Mode)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUart_SetTxEot(ui32Mode == UART_TXINT_MODE_EOT);
+}
+
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    (void)ui32Base;
+    IntRegister(INT_UART5, pfnHandler);
+    IntEnable(INT_UART5);
+}
+
+void UARTIntUnregister(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    IntDisable(INT_UART5);
+    IntUnregister(INT_UART5);
+}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    SimUart_IntEnable(ui32IntFlags, true);
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    SimUart_IntEnable(ui32IntFlags, false);
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimUart_IntStatus(bMasked);
+}
+
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    SimUart_IntClear(ui32IntFlags);
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void UARTDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if ((ui32DMAFlags & UART_DMA_TX) != 0U) {
+        SimUart_DmaEnable(true);
+    }
+}
+
+void UARTDMADisable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    (void)ui32Base;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    if ((ui32DMAFlags & UART_DMA_TX) != 0U) {
+        SimUart_DmaEnable(false);
+    }
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+ * File: udma.c
+ * Module: TivaWare host stubs
+ * Description: uDMA API backed by the simulated uDMA controller
+ *
+ * Channel attributes and control words (element size, increments,
+ * arbitration) are accepted but not modelled: transfers are always 8-bit,
+ * source-incrementing, into a peripheral FIFO.
+ ******************************************************************************/
+
+#include "driverlib/udma.h"
+#include "sim.h"
+#include "sim_udma.h"
+
+void uDMAEnable(void)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_Enable(true);
+}
+
+void uDMADisable(void)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_Enable(false);
+}
+
+void uDMAControlBaseSet(void *pControlTable)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_SetControlBase(pControlTable);
+}
+
+void uDMAChannelAssign(uint32_t ui32Mapping)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_Assign(SIM_UDMA_CHANNEL(ui32Mapping), SIM_UDMA_ENCODING(ui32Mapping));
+}
+
+void uDMAChannelAttributeEnable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    (void)ui32ChannelNum;
+    (void)ui32Attr;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    (void)ui32ChannelNum;
+    (void)ui32Attr;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    (void)ui32ChannelStructIndex;
+    (void)ui32Control;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+}
+
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                            void *pvSrcAddr, void *pvDstAddr,
+                            uint32_t ui32TransferSize)
+{
+    (void)pvDstAddr;
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_SetTransfer(ui32ChannelStructIndex, ui32Mode, pvSrcAddr, ui32TransferSize);
+}
+
+void uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_ChannelEnable(ui32ChannelNum, true);
+}
+
+void uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    SimUdma_ChannelEnable(ui32ChannelNum, false);
+}
+
+bool uDMAChannelIsEnabled(uint32_t ui32ChannelNum)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimUdma_ChannelIsEnabled(ui32ChannelNum);
+}
+
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimUdma_ChannelMode(ui32ChannelStructIndex);
+}
+
+uint32_t uDMAChannelSizeGet(uint32_t ui32ChannelStructIndex)
+{
+    Sim_Sync(SIM_CYCLES_PER_CALL);
+    return SimUdma_ChannelSize(ui32ChannelStructIndex);
+}
@@ -0,0 +1,22 @@
+/******************************************************************************
+ * File: hw_ints.h
+ * Module: TivaWare host stubs
+ * Description: Interrupt vector numbers (subset of TivaWare inc/hw_ints.h)
+ ******************************************************************************/
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define FAULT_SYSTICK           15
+#define INT_GPIOA               16
+#define INT_GPIOC               18
+#define INT_ADC0SS0             30
+#define INT_ADC0SS3             33
+#define INT_FLASH               45
+#define INT_TIMER0A             35
+#define INT_TIMER1A             37
+#define INT_UDMA                62
+#define INT_UDMAERR             63
+#define INT_UART5               77
+
+#endif /* __HW_INTS_H__ */
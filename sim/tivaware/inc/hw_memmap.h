@@ -0,0 +1,26 @@
+/******************************************************************************
+ * File: hw_memmap.h
+ * Module: TivaWare host stubs
+ * Description: Peripheral base addresses (subset of TivaWare inc/hw_memmap.h)
+ ******************************************************************************/
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTC_BASE         0x40006000
+#define GPIO_PORTD_BASE         0x40007000
+#define GPIO_PORTE_BASE         0x40024000
+#define GPIO_PORTF_BASE         0x40025000
+#define UART0_BASE              0x4000C000
+#define UART5_BASE              0x40011000
+#define TIMER0_BASE             0x40030000
+#define TIMER1_BASE             0x40031000
+#define ADC0_BASE               0x40038000
+#define EEPROM_BASE             0x400AF000
+#define SYSCTL_BASE             0x400FE000
+#define UDMA_BASE               0x400FF000
+#define NVIC_BASE               0xE000E000
+
+#endif /* __HW_MEMMAP_H__ */
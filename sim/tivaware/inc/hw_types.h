@@ -0,0 +1,16 @@
+/******************************************************************************
+ * File: hw_types.h
+ * Module: TivaWare host stubs
+ * Description: Register access macros routed through the simulator
+ ******************************************************************************/
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim_reg.h"
+
+#define HWREG(x)                (*SIM_REG(x))
+
+#endif /* __HW_TYPES_H__ */
@@ -0,0 +1,14 @@
+/******************************************************************************
+ * File: hw_uart.h
+ * Module: TivaWare host stubs
+ * Description: UART register offsets (subset of TivaWare inc/hw_uart.h)
+ ******************************************************************************/
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#define UART_O_DR               0x00000000  /* UART Data */
+#define UART_O_FR               0x00000018  /* UART Flag */
+#define UART_O_DMACTL           0x00000048  /* UART DMA Control */
+
+#endif /* __HW_UART_H__ */
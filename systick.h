@@ -2,11 +2,64 @@
 #define SYSTICK_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define SYSTICK_NOINT   0
 #define SYSTICK_INT     1
 
+#define SYSTICK_CLOCK_MHZ   16U     /* SysTick runs from the 16 MHz system clock */
+
 void SysTick_Init(uint32_t reload, uint8_t mode);
+
+/* Waits ms tick boundaries: (ms - 1, ms] milliseconds with a 1 ms tick */
 void DelayMs(uint32_t ms);
 
+/*
+ * Busy-waits at least us microseconds by counting SysTick cycles. Works in
+ * either mode and with interrupts masked; meant for waits shorter than a
+ * tick, where DelayMs is too coarse.
+ */
+void DelayUs(uint32_t us);
+
+/*
+ * Monotonic time since SysTick_Init (SYSTICK_INT mode): ticks counted by
+ * SystickHandler plus the cycles elapsed in the current tick. Safe to
+ * call with interrupts masked and from interrupt handlers.
+ */
+uint64_t Time_NowUs(void);
+uint64_t Time_NowMs(void);
+
+/*
+ * Wrap-safe deadline checks: true once now has reached deadline. The
+ * 32-bit form is for truncated timestamps and holds while the two are
+ * less than 2^31 apart.
+ */
+bool Time_Reached(uint64_t now, uint64_t deadline);
+bool Time_Reached32(uint32_t now, uint32_t deadline);
+
+void SystickHandler(void);
+
+/*
+ * Software timers, run from the main loop by Timer_Dispatch(). The
+ * callback returns true to run again one period after its deadline
+ * (periodic) or false to stop (one-shot). Timer_Start and Timer_Cancel are
+ * O(1); Timer_Dispatch only visits the milliseconds at which a timer is
+ * due or a wheel level turns over. Not for use from interrupt handlers.
+ */
+#define TIMER_MAX               32U
+#define TIMER_NONE              0U
+#define TIMER_MAX_PERIOD_MS     0x00FFFFFFU     /* ~4.6 hours */
+
+typedef uint16_t Timer_Id;
+typedef bool (*Timer_Callback)(void *context);
+
+/* Returns TIMER_NONE if all TIMER_MAX timers are in use */
+Timer_Id Timer_Start(uint32_t periodMs, Timer_Callback callback, void *context);
+
+/* Returns false if the timer already expired or was cancelled */
+bool Timer_Cancel(Timer_Id id);
+
+/* Runs every callback that is due by Time_NowMs() */
+void Timer_Dispatch(void);
+
 #endif
@@ -10,6 +10,9 @@
  *   - Parity: None
  *   - Stop: 1 bit
  *   - System Clock: 16 MHz
+ *   - RX: interrupt at 2 bytes or receive timeout, drained into a ring buffer
+ *   - TX: ring buffer, FIFO refilled by the ISR when it drains to 2 bytes
+ *   - TX frames: uDMA channel 7 feeds the FIFO, completion on the UART5 ISR
  * 
  * Note: This implementation uses TivaWare peripheral driver library.
  *       TivaWare functions simplify UART configuration and provide
@@ -19,13 +22,20 @@
 #include "uart.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "udma.h"
 
 /* TivaWare includes */
 #include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
 #include "inc/hw_types.h"
+#include "inc/hw_uart.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/uart.h"
+#include "driverlib/udma.h"
 #include "driverlib/pin_map.h"
 
 /******************************************************************************
@@ -35,6 +45,161 @@
 #define SYSTEM_CLOCK    16000000    /* 16 MHz system clock */
 #define BAUD_RATE       115200      /* Target baud rate */
 
+#define RX_MASK         (UART5_RX_BUFFER_SIZE - 1U)
+#define TX_MASK         (UART5_TX_BUFFER_SIZE - 1U)
+
+#define TX_DMA_CHANNEL  UDMA_CH7_UART5TX
+
+/* Frame transmit states */
+#define FRAME_IDLE      0U      /* Application may queue a frame */
+#define FRAME_PENDING   1U      /* Waiting for earlier ring bytes to leave */
+#define FRAME_ACTIVE    2U      /* uDMA owns the TX FIFO */
+
+/******************************************************************************
+ *                          Private Variables                                  *
+ ******************************************************************************/
+
+/*
+ * Single-producer/single-consumer rings. The producer alone advances head
+ * and the consumer alone advances tail, so neither side needs a lock.
+ * Indices run freely and are masked on use; head - tail is the fill level.
+ *   RX: UART5_ISR produces, the application consumes.
+ *   TX: the application produces, UART5_ISR consumes.
+ */
+static volatile uint8_t g_rxBuffer[UART5_RX_BUFFER_SIZE];
+static volatile uint16_t g_rxHead;
+static volatile uint16_t g_rxTail;
+
+static volatile uint8_t g_txBuffer[UART5_TX_BUFFER_SIZE];
+static volatile uint16_t g_txHead;
+static volatile uint16_t g_txTail;
+
+/*
+ * At most one uDMA frame. UART5_SendFrame() moves IDLE -> PENDING; only
+ * the ISR moves PENDING -> ACTIVE -> IDLE. g_frameStart is the TX ring
+ * head when the frame was queued: bytes written before it go out first,
+ * bytes written after it wait until the frame has been handed over.
+ */
+static const uint8_t *volatile g_frame;
+static volatile uint16_t g_frameLength;
+static volatile uint16_t g_frameStart;
+static UART5_TxCallback volatile g_frameDone;
+static volatile uint8_t g_frameState = FRAME_IDLE;
+
+static UART5_RxCallback volatile g_rxNotify;
+
+static volatile uint32_t g_rxOverruns;
+static volatile uint32_t g_hwOverruns;
+
+/******************************************************************************
+ *                          Private Functions                                  *
+ ******************************************************************************/
+
+/*
+ * UART5_TxRefill
+ * Moves TX ring bytes into the FIFO, then hands the FIFO to the uDMA once
+ * every byte queued ahead of a pending frame has gone in.
+ */
+static void UART5_TxRefill(void)
+{
+    uint16_t end;
+
+    if (g_frameState == FRAME_ACTIVE) {
+        return;
+    }
+    end = (g_frameState == FRAME_PENDING) ? g_frameStart : g_txHead;
+
+    while (g_txTail != end) {
+        uint16_t tail = g_txTail;
+
+        if (!UARTCharPutNonBlocking(UART5_BASE, g_txBuffer[tail & TX_MASK])) {
+            break;
+        }
+        g_txTail = tail + 1U;
+    }
+
+    if (g_frameState == FRAME_PENDING && g_txTail == g_frameStart) {
+        uDMAChannelTransferSet(TX_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                               (void *)g_frame, (void *)(UART5_BASE + UART_O_DR),
+                               g_frameLength);
+        g_frameState = FRAME_ACTIVE;
+        uDMAChannelEnable(TX_DMA_CHANNEL);
+    }
+}
+
+/*
+ * UART5_ISR
+ * Drains the RX FIFO into the RX ring and refills the TX FIFO from the TX
+ * ring. Also entered through IntPendSet() when UART5_Write or
+ * UART5_SendFrame queue data, and when the TX uDMA transfer completes.
+ */
+static void UART5_ISR(void)
+{
+    uint32_t status = UARTIntStatus(UART5_BASE, true);
+    uint16_t received = g_rxHead;
+    int32_t data;
+
+    UARTIntClear(UART5_BASE, status);
+
+    if ((status & UART_INT_OE) != 0U) {
+        g_hwOverruns++;
+    }
+
+    while ((data = UARTCharGetNonBlocking(UART5_BASE)) != -1) {
+        uint16_t head = g_rxHead;
+
+        if ((uint16_t)(head - g_rxTail) < UART5_RX_BUFFER_SIZE) {
+            g_rxBuffer[head & RX_MASK] = (uint8_t)data;
+            g_rxHead = head + 1U;
+        } else {
+            g_rxOverruns++;
+        }
+    }
+    if (g_rxHead != received && g_rxNotify != NULL) {
+        g_rxNotify();
+    }
+
+    /* The channel disables itself once the last byte is in the FIFO */
+    if (g_frameState == FRAME_ACTIVE && !uDMAChannelIsEnabled(TX_DMA_CHANNEL)) {
+        UART5_TxCallback done = g_frameDone;
+
+        g_frameState = FRAME_IDLE;
+        if (done != NULL) {
+            done();
+        }
+    }
+
+    UART5_TxRefill();
+}
+
+static bool UART5_TxFull(void)
+{
+    return (uint16_t)(g_txHead - g_txTail) >= UART5_TX_BUFFER_SIZE;
+}
+
+static bool UART5_RxEmpty(void)
+{
+    return g_rxHead == g_rxTail;
+}
+
+/*
+ * UART5_SleepWhile
+ * Sleeps until the next interrupt if blocked() still holds. The check runs
+ * with interrupts masked; WFI wakes on a pending interrupt even then, so
+ * an ISR that fires just before the sleep cannot be missed.
+ */
+static void UART5_SleepWhile(bool (*blocked)(void))
+{
+    bool wasMasked = IntMasterDisable();
+
+    if (blocked()) {
+        SysCtlSleep();
+    }
+    if (!wasMasked) {
+        IntMasterEnable();
+    }
+}
+
 /******************************************************************************
  *                          Function Implementations                           *
  ******************************************************************************/
@@ -48,6 +213,10 @@
  *   - GPIOPinConfigure(): Configure pin muxing
  *   - GPIOPinTypeUART(): Configure pins for UART alternate function
  *   - UARTConfigSetExpClk(): Configure UART parameters
+ *   - UARTFIFOLevelSet(): Set RX/TX interrupt trigger levels
+ *   - UARTIntRegister(): Install UART5_ISR and enable it in the NVIC
+ *   - uDMAChannelAssign(): Route uDMA channel 7 to UART5 TX
+ *   - UARTDMAEnable(): Let the TX FIFO request uDMA transfers
  *   - UARTEnable(): Enable UART module
  */
 void UART5_Init(void)
@@ -75,52 +244,182 @@ void UART5_Init(void)
                         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | 
                          UART_CONFIG_PAR_NONE));
     
-    /* 4. Enable UART5 */
+    /* 4. Interrupts: RX at 1/8 full or on receive timeout, TX at 1/8 full */
+    g_rxHead = g_rxTail = 0U;
+    g_txHead = g_txTail = 0U;
+    UARTFIFOLevelSet(UART5_BASE, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
+    UARTTxIntModeSet(UART5_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntRegister(UART5_BASE, UART5_ISR);
+    UARTIntEnable(UART5_BASE, UART_INT_RX | UART_INT_RT | UART_INT_TX | UART_INT_OE);
+    IntMasterEnable();
+    
+    /* 5. TX uDMA: byte-wide, source incrementing, into the data register */
+    g_frameState = FRAME_IDLE;
+    UDMA_Init();
+    uDMAChannelAssign(TX_DMA_CHANNEL);
+    uDMAChannelAttributeDisable(TX_DMA_CHANNEL, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(TX_DMA_CHANNEL | UDMA_PRI_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+    UARTDMAEnable(UART5_BASE, UART_DMA_TX);
+    
+    /* 6. Enable UART5 */
     UARTEnable(UART5_BASE);
 }
 
 /*
  * UART5_SendChar
- * Transmits a single character through UART5 using TivaWare.
- * Uses UARTCharPut() which blocks until FIFO has space.
+ * Queues a single character for transmission.
+ * Sleeps only while the TX ring buffer is full.
  */
 void UART5_SendChar(char data)
 {
-    /* UARTCharPut() blocks until space is available in TX FIFO */
-    UARTCharPut(UART5_BASE, data);
+    uint8_t byte = (uint8_t)data;
+
+    while (UART5_Write(&byte, 1U) == 0U) {
+        UART5_SleepWhile(UART5_TxFull);
+    }
 }
 
 /*
  * UART5_ReceiveChar
- * Receives a single character from UART5 using TivaWare.
- * Uses UARTCharGet() which blocks until data is available.
+ * Takes a single character from the RX ring buffer.
+ * Sleeps until one is available.
  */
 char UART5_ReceiveChar(void)
 {
-    /* UARTCharGet() blocks until data is available in RX FIFO */
-    return (char)UARTCharGet(UART5_BASE);
+    uint8_t byte;
+
+    while (UART5_Read(&byte, 1U) == 0U) {
+        UART5_SleepWhile(UART5_RxEmpty);
+    }
+    return (char)byte;
 }
 
 /*
  * UART5_SendString
- * Transmits a null-terminated string through UART5.
+ * Queues a null-terminated string in as few ring copies as possible.
+ * Sleeps only while the TX ring buffer is full.
  */
 void UART5_SendString(const char *str)
 {
-    while (*str != '\0')
-    {
-        UART5_SendChar(*str);
-        str++;
+    uint32_t length = (uint32_t)strlen(str);
+
+    while (length > 0U) {
+        uint32_t queued = UART5_Write((const uint8_t *)str, length);
+
+        str += queued;
+        length -= queued;
+        if (length > 0U) {
+            UART5_SleepWhile(UART5_TxFull);
+        }
     }
 }
 
 /*
  * UART5_IsDataAvailable
- * Checks if data is available in the receive FIFO using TivaWare.
- * Uses UARTCharsAvail() to check RX FIFO status.
+ * Checks if the ISR has placed data in the RX ring buffer.
  */
 uint8_t UART5_IsDataAvailable(void)
 {
-    /* UARTCharsAvail() returns true if characters are available */
-    return (UARTCharsAvail(UART5_BASE)) ? 1 : 0;
+    return UART5_RxEmpty() ? 0 : 1;
+}
+
+/*
+ * UART5_SetRxCallback
+ * Registers the function the ISR calls when bytes arrive
+ */
+void UART5_SetRxCallback(UART5_RxCallback onRx)
+{
+    g_rxNotify = onRx;
+}
+
+/*
+ * UART5_Read
+ * Copies up to n bytes out of the RX ring buffer.
+ */
+uint32_t UART5_Read(uint8_t *buf, uint32_t n)
+{
+    uint16_t tail = g_rxTail;
+    uint16_t head = g_rxHead;
+    uint32_t count = 0U;
+
+    if (buf == NULL) {
+        return 0U;
+    }
+
+    while (count < n && tail != head) {
+        buf[count++] = g_rxBuffer[tail & RX_MASK];
+        tail++;
+    }
+    g_rxTail = tail;
+    return count;
+}
+
+/*
+ * UART5_Write
+ * Copies up to n bytes into the TX ring buffer, then pends UART5_ISR so
+ * the ISR (the only consumer) starts the FIFO if the line was idle.
+ */
+uint32_t UART5_Write(const uint8_t *buf, uint32_t n)
+{
+    uint16_t head = g_txHead;
+    uint16_t tail = g_txTail;
+    uint32_t count = 0U;
+
+    if (buf == NULL) {
+        return 0U;
+    }
+
+    while (count < n && (uint16_t)(head - tail) < UART5_TX_BUFFER_SIZE) {
+        g_txBuffer[head & TX_MASK] = buf[count++];
+        head++;
+    }
+    g_txHead = head;
+
+    if (count > 0U) {
+        IntPendSet(INT_UART5);
+    }
+    return count;
+}
+
+/*
+ * UART5_SendFrame
+ * Queues a whole frame for uDMA transmission and returns immediately.
+ * The frame is not copied; onDone (if any) runs in interrupt context once
+ * the last byte has been handed to the TX FIFO.
+ */
+bool UART5_SendFrame(const uint8_t *frame, uint16_t length, UART5_TxCallback onDone)
+{
+    if (frame == NULL || length == 0U || length > UDMA_MAX_TRANSFER ||
+        g_frameState != FRAME_IDLE) {
+        return false;
+    }
+
+    g_frame = frame;
+    g_frameLength = length;
+    g_frameDone = onDone;
+    g_frameStart = g_txHead;
+    g_frameState = FRAME_PENDING;
+
+    IntPendSet(INT_UART5);
+    return true;
+}
+
+/*
+ * UART5_IsFrameBusy
+ * True from UART5_SendFrame() until the frame's buffer may be reused.
+ */
+bool UART5_IsFrameBusy(void)
+{
+    return g_frameState != FRAME_IDLE;
+}
+
+uint32_t UART5_GetRxOverruns(void)
+{
+    return g_rxOverruns;
+}
+
+uint32_t UART5_GetHwOverruns(void)
+{
+    return g_hwOverruns;
 }